@@ -10,7 +10,8 @@
 AOAResult CalcAOA(
     float pfwd,
     float p45,
-    const SuCalibrationCurve& curve
+    const SuCalibrationCurve& curve,
+    const SuCompiledCurve* pCompiled
 ) {
     AOAResult result;
     result.valid = true;
@@ -25,8 +26,11 @@ AOAResult CalcAOA(
 
     result.coeffP = pressureCoeff(pfwd, p45);
 
-    // Calculate raw AOA from calibration curve
-    result.aoa = CurveCalc(result.coeffP, curve);
+    // Calculate raw AOA from the compiled curve if there is one
+    if (pCompiled != nullptr)
+        result.aoa = compiledCurveEval(*pCompiled, result.coeffP);
+    else
+        result.aoa = CurveCalc(result.coeffP, curve);
 
     // Check for NaN (can occur with bad curve coefficients)
     if (std::isnan(result.aoa)) {
@@ -44,18 +48,21 @@ AOAResult CalcAOA(
 AOACalculatorResult AOACalculator::calculate(
     float pfwd,
     float p45,
-    const SuCalibrationCurve& curve
+    const SuCalibrationCurve& curve,
+    const SuCompiledCurve* pCompiled
 ) {
     AOACalculatorResult out;
 
-    AOAResult raw = CalcAOA(pfwd, p45, curve);
+    AOAResult raw = CalcAOA(pfwd, p45, curve, pCompiled);
 
     out.coeffP = raw.coeffP;
     out.valid  = raw.valid;
 
     // Smooth and clamp
     float valueToSmooth = raw.valid ? raw.aoa : AOA_MIN_VALUE;
-    out.aoa = clampAOA(_smoother.update(valueToSmooth));
+    float smoothed      = (_filter == AoaFilterKind::AlphaBeta) ? _alphaBeta.update(valueToSmooth)
+                                                               : _smoother.update(valueToSmooth);
+    out.aoa = clampAOA(smoothed);
 
     return out;
 }
@@ -4,7 +4,9 @@
 
 #include "OnSpeedTypes.h"
 #include "CurveCalc.h"
+#include "CurveTable.h"
 #include "EMAFilter.h"
+#include "AlphaBetaFilter.h"
 
 /// Pure AOA calculation
 ///
@@ -14,11 +16,13 @@
 /// @param pfwd  Forward (dynamic) pressure
 /// @param p45   45-degree (AOA differential) pressure
 /// @param curve AOA calibration curve for current flap position
+/// @param pCompiled Optional compiled form of the same curve, used instead
 /// @return AOAResult with raw AOA and pressure coefficient
 AOAResult CalcAOA(
     float pfwd,
     float p45,
-    const SuCalibrationCurve& curve
+    const SuCalibrationCurve& curve,
+    const SuCompiledCurve* pCompiled = nullptr
 );
 
 // ============================================================================
@@ -32,7 +36,13 @@ struct AOACalculatorResult {
     bool  valid;   ///< False if calculation failed
 };
 
-/// Stateful AOA calculator with built-in EMA smoothing.
+/// Which filter smooths the calculated AOA (AOA_FILTER in the config)
+enum class AoaFilterKind : uint8_t {
+    Ema       = 0,      ///< EMA, the original smoothing
+    AlphaBeta = 1,      ///< Alpha-beta, no lag on a steady AOA ramp
+};
+
+/// Stateful AOA calculator with built-in smoothing, EMA by default.
 ///
 /// Each instance owns its smoother state, so different callers
 /// (live sensors vs log replay) can have independent smoothing.
@@ -42,6 +52,7 @@ public:
     /// @param smoothingSamples Number of samples for smoothing (0 = no smoothing)
     explicit AOACalculator(int smoothingSamples = 0)
         : _smoother(smoothingSamples)
+        , _filter(AoaFilterKind::Ema)
     {
     }
 
@@ -50,14 +61,35 @@ public:
     /// @param pfwd  Forward (dynamic) pressure
     /// @param p45   45-degree (AOA differential) pressure
     /// @param curve Calibration curve for current flap position
+    /// @param pCompiled Optional compiled form of the same curve (see CalcAOA)
     /// @return Smoothed AOA, coeffP, and validity flag
-    AOACalculatorResult calculate(float pfwd, float p45, const SuCalibrationCurve& curve);
+    AOACalculatorResult calculate(float pfwd, float p45, const SuCalibrationCurve& curve,
+                                  const SuCompiledCurve* pCompiled = nullptr);
 
     /// Reset smoother state.
     /// Call when starting log replay or other discontinuity.
     void reset()
     {
         _smoother.reset();
+        _alphaBeta.reset();
+    }
+
+    /// Choose the smoothing filter. Resets the smoother state.
+    void setFilter(AoaFilterKind filter)
+    {
+        _filter = filter;
+        reset();
+    }
+
+    AoaFilterKind filter() const
+    {
+        return _filter;
+    }
+
+    /// Alpha-beta memory factor, e.g. from matchAlphaBetaTheta().
+    void setTheta(float theta)
+    {
+        _alphaBeta.setTheta(theta);
     }
 
     /// Change smoothing factor.
@@ -66,6 +98,14 @@ public:
         _smoother.setSamples(samples);
     }
 
+    /// Change smoothing via alpha directly, e.g. from emaAlphaForTau().
+    void setAlpha(float alpha)
+    {
+        _smoother.setAlpha(alpha);
+    }
+
 private:
-    EMAFilter _smoother;
+    EMAFilter       _smoother;
+    AlphaBetaFilter _alphaBeta;
+    AoaFilterKind   _filter;
 };
@@ -0,0 +1,111 @@
+// AlphaBetaFilter.h - Critically damped alpha-beta (g-h) tracking filter
+
+#pragma once
+
+#include <cmath>
+
+/// Alpha-beta filter: tracks a value and its rate of change per sample.
+///
+///   predicted = value + rate
+///   residual  = input - predicted
+///   value     = predicted + alpha * residual
+///   rate      = rate + beta * residual
+///
+/// Unlike an EMA it follows a steady ramp with no lag, because the rate
+/// term carries the output along with the input. Gains come from a single
+/// memory factor theta in [0, 1) as the fading memory (critically damped)
+/// pair alpha = 1 - theta^2, beta = (1 - theta)^2. Larger theta = more
+/// smoothing; theta 0 is pass-through.
+class AlphaBetaFilter {
+public:
+    /// @param theta Memory factor, clamped to [0, 0.999]
+    explicit AlphaBetaFilter(float theta = 0.0f)
+        : _value(0.0f)
+        , _rate(0.0f)
+        , _initialized(false)
+    {
+        setTheta(theta);
+    }
+
+    /// Update with a new value and return the filtered result.
+    ///
+    /// The first call seeds the value with zero rate. NaN inputs are
+    /// ignored - returns the previous value.
+    float update(float value)
+    {
+        if (std::isnan(value)) {
+            return _value;
+        }
+
+        if (!_initialized) {
+            _value = value;
+            _rate  = 0.0f;
+            _initialized = true;
+        } else {
+            const float predicted = _value + _rate;
+            const float residual  = value - predicted;
+            _value = predicted + _alpha * residual;
+            _rate += _beta * residual;
+        }
+        return _value;
+    }
+
+    /// Current value without updating.
+    float get() const
+    {
+        return _value;
+    }
+
+    /// Current rate estimate, units per sample.
+    float rate() const
+    {
+        return _rate;
+    }
+
+    /// Reset to uninitialized state.
+    void reset()
+    {
+        _value = 0.0f;
+        _rate  = 0.0f;
+        _initialized = false;
+    }
+
+    /// Change smoothing via the memory factor.
+    void setTheta(float theta)
+    {
+        if (!(theta > 0.0f)) {
+            theta = 0.0f;
+        } else if (theta > 0.999f) {
+            theta = 0.999f;
+        }
+        _theta = theta;
+        _alpha = 1.0f - theta * theta;
+        _beta  = (1.0f - theta) * (1.0f - theta);
+    }
+
+    float getTheta() const  { return _theta; }
+    float getAlpha() const  { return _alpha; }
+    float getBeta() const   { return _beta; }
+
+    bool isInitialized() const
+    {
+        return _initialized;
+    }
+
+    /// White noise variance reduction of the value output for a theta,
+    /// (1 - theta)(1 + 4 theta + 5 theta^2) / (1 + theta)^3.
+    static float noiseVarianceRatio(float theta)
+    {
+        const float onePlus = 1.0f + theta;
+        return (1.0f - theta) * (1.0f + 4.0f * theta + 5.0f * theta * theta)
+             / (onePlus * onePlus * onePlus);
+    }
+
+private:
+    float _value;
+    float _rate;
+    float _theta;
+    float _alpha;
+    float _beta;
+    bool  _initialized;
+};
@@ -0,0 +1,81 @@
+// AoaFusion.cpp - Inertially aided AOA
+
+#include "AoaFusion.h"
+
+#include <cmath>
+
+// ============================================================================
+// INERTIAL AOA RATE
+// ============================================================================
+
+float aoaRateDps(const AoaInertialInput & imu, float fAoaDeg)
+{
+    constexpr float kGravity = 9.80665f;
+
+    const float fA      = deg2rad(fAoaDeg);
+    const float fTheta  = deg2rad(imu.fPitchDeg);
+    const float fPhi    = deg2rad(imu.fRollDeg);
+    const float fSinA   = std::sin(fA),     fCosA     = std::cos(fA);
+    const float fSinT   = std::sin(fTheta), fCosT     = std::cos(fTheta);
+
+    // Specific force plus gravity, at right angles to the flight path
+    const float fNormalG = imu.fFwdG * fSinA + imu.fVertG * fCosA
+                         - fSinT * fSinA - fCosT * std::cos(fPhi) * fCosA;
+
+    return imu.fPitchRateDps - rad2deg(kGravity * fNormalG / imu.fTasMps);
+}
+
+// ============================================================================
+// FUSION
+// ============================================================================
+
+AoaFusion::AoaFusion()
+{
+    configure(SmoothingParams::forRate(SmoothingTimes::fromConfig(0, 0), kReferenceLoopHz), AoaFilterKind::Ema);
+}
+
+void AoaFusion::configure(const SmoothingParams & params, AoaFilterKind enKind, float fTheta, float fLeakTauSec)
+{
+    _Complement.configure(params, enKind, fTheta);
+    _fDtSec = params.fDtSec;
+    _fLeak  = emaAlphaForTau(fLeakTauSec, params.iHz);
+    reset();
+}
+
+void AoaFusion::reset()
+{
+    _Complement.reset();
+    _fInertial = 0.0f;
+    _fRateDps  = 0.0f;
+    _fValue    = 0.0f;
+    _bActive   = false;
+}
+
+float AoaFusion::update(float fPressureAoa, const AoaInertialInput & imu)
+{
+    // Pass the pressure AOA through when the IMU side can't be used
+    if (!(imu.fTasMps >= kMinTasMps) || std::isnan(fPressureAoa) || std::isnan(imu.fPitchRateDps) ||
+        std::isnan(imu.fFwdG) || std::isnan(imu.fVertG))
+    {
+        _bActive  = false;
+        _fRateDps = 0.0f;
+        _fValue   = fPressureAoa;
+        return _fValue;
+    }
+
+    // Restart from the pressure AOA. The copy of the smoothing starts empty,
+    // so the lag correction builds up over the smoothing time.
+    if (!_bActive) {
+        _Complement.reset();
+        _fInertial = fPressureAoa;
+        _fValue    = fPressureAoa;
+        _bActive   = true;
+    }
+
+    // Carry the inertial AOA forward, from the current best estimate
+    _fRateDps   = aoaRateDps(imu, _fValue);
+    _fInertial += _fRateDps * _fDtSec + _fLeak * (fPressureAoa - _fInertial);
+
+    _fValue = fPressureAoa + (_fInertial - _Complement.update(_fInertial));
+    return _fValue;
+}
@@ -0,0 +1,81 @@
+// AoaFusion.h - Inertially aided AOA: pressure AOA for the level, the IMU for the changes
+
+#pragma once
+
+#include "FilterAnalysis.h"
+
+// ============================================================================
+// INERTIAL AOA RATE
+// ============================================================================
+
+/// What the IMU and AHRS give for one sensor cycle.
+struct AoaInertialInput {
+    float   fPitchRateDps;      ///< Body pitch rate, nose up positive, deg/sec
+    float   fFwdG;              ///< Body forward specific force, g (sin pitch when still)
+    float   fVertG;             ///< Body vertical specific force, g (1 in level flight)
+    float   fPitchDeg;          ///< Nose up positive
+    float   fRollDeg;
+    float   fTasMps;            ///< True airspeed, m/sec
+};
+
+/// Rate of change of AOA from body rates and accelerations, deg/sec, for
+/// no sideslip:
+///
+///   dAOA/dt = q - (g / V) * (nx sin a + nz cos a - sin theta sin a - cos theta cos phi cos a)
+///
+/// The bracket is the acceleration at right angles to the flight path, in
+/// the plane of symmetry, so the second term is how fast the flight path
+/// itself is turning. In a steady pull-up or turn the two cancel.
+float aoaRateDps(const AoaInertialInput & imu, float fAoaDeg);
+
+// ============================================================================
+// FUSION
+// ============================================================================
+
+/// Complementary filter between the smoothed pressure AOA (accurate but
+/// late) and an AOA carried forward from aoaRateDps() (prompt but drifts).
+///
+/// The inertial AOA goes through a copy of the same smoothing the pressure
+/// AOA had, and the output is
+///
+///   fused = pressure AOA + (inertial AOA - smoothed inertial AOA)
+///
+/// i.e. the pressure AOA plus exactly what its smoothing took out, taken
+/// from the IMU instead. If the IMU were perfect this is the true AOA with
+/// no lag. Gyro bias or model error only gets in through the difference,
+/// so it can't build up, and the inertial AOA is also pulled slowly toward
+/// the pressure AOA so that a constant bias gives no steady error at all.
+///
+/// Below kMinTasMps the flight path term isn't trustworthy and the output
+/// is the pressure AOA. The fusion restarts when the speed comes back.
+class AoaFusion {
+public:
+    static constexpr float kMinTasMps         = 20.0f;  ///< About 40 kts
+    static constexpr float kDefaultLeakTauSec = 10.0f;  ///< Inertial AOA pull toward the pressure AOA
+
+    AoaFusion();
+
+    /// Mirror the pressure AOA smoothing: params and the AOACalculator
+    /// filter, as AoaFilterChain takes them.
+    void    configure(const SmoothingParams & params, AoaFilterKind enKind, float fTheta = 0.0f,
+                      float fLeakTauSec = kDefaultLeakTauSec);
+    void    reset();
+
+    /// @param fPressureAoa Smoothed AOA from AOACalculator, degrees
+    /// @return Fused AOA, degrees
+    float   update(float fPressureAoa, const AoaInertialInput & imu);
+
+    float   value() const           { return _fValue; }
+    bool    active() const          { return _bActive; }    ///< False when passing the pressure AOA through
+    float   inertialAoa() const     { return _fInertial; }
+    float   rateDps() const         { return _fRateDps; }
+
+private:
+    AoaFilterChain  _Complement;        ///< Same smoothing as the pressure AOA, run on the inertial AOA
+    float           _fDtSec;
+    float           _fLeak;             ///< Per-sample pull of the inertial AOA toward the pressure AOA
+    float           _fInertial;
+    float           _fRateDps;
+    float           _fValue;
+    bool            _bActive;
+};
@@ -0,0 +1,53 @@
+// Atmosphere.cpp - Pressure altitude, density altitude, IAS and TAS in single precision
+
+#include "Atmosphere.h"
+
+#include <cmath>
+
+// ============================================================================
+// ATMOSPHERE
+// ============================================================================
+
+namespace {
+    constexpr float kPaltScaleFt   = 145366.45f;
+    constexpr float kKelvin        = 273.15f;
+    constexpr float kLapseKPerFt   = 0.00198119993f;
+    constexpr float kDensityFactor = 6.8755856e-6f;     // per foot
+    constexpr float kAirDensity    = 1.225f;            // kg/m^3
+    constexpr float kMpsToKts      = 1.94384f;
+
+    // Exponents from https://edwilliams.org/avform147.htm
+    constexpr float kPaltExp       = 0.190284f;
+    constexpr float kDensityAltExp = 0.2349690f;
+    constexpr float kTasExp        = 2.12794f;
+}
+
+float pressureAltitudeFt(float fStaticMb)
+{
+    return kPaltScaleFt * (1.0f - powf(fStaticMb / kStdPressureMb, kPaltExp));
+}
+
+float densityAltitudeFt(float fPaltFt, float fOatC)
+{
+    const float fIsaK = 15.0f - kLapseKPerFt * fPaltFt + kKelvin;
+    const float fOatK = fOatC + kKelvin;
+
+    return fPaltFt + (fIsaK / kLapseKPerFt) * (1.0f - powf(fIsaK / fOatK, kDensityAltExp));
+}
+
+float trueAirspeed(float fIas, float fDensityAltFt)
+{
+    const float fRatio = 1.0f - kDensityFactor * fDensityAltFt;
+    if (!(fRatio > 0.0f))
+        return fIas;
+
+    return fIas / powf(fRatio, kTasExp);
+}
+
+float iasFromDynamicPressureKts(float fPascal)
+{
+    if (!(fPascal > 0.0f))
+        return 0.0f;
+
+    return sqrtf(2.0f * fPascal / kAirDensity) * kMpsToKts;
+}
@@ -0,0 +1,36 @@
+// Atmosphere.h - Pressure altitude, density altitude, IAS and TAS in single precision
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// ATMOSPHERE
+// ============================================================================
+//
+// These are the formulas the firmware has always used, in single precision
+// with powf() in place of double pow(). The error bounds are over the
+// envelope given for each and are checked against double precision libm in
+// test_atmosphere.
+
+/// ISA sea level pressure, millibars
+constexpr float kStdPressureMb = 1013.25f;
+
+/// Pressure altitude in feet from static pressure in millibars.
+/// Max error 0.05 ft for 150 to 1100 mb (about -2,400 to 44,700 ft).
+float pressureAltitudeFt(float fStaticMb);
+
+/// Density altitude in feet from pressure altitude and OAT.
+/// Max error 0.1 ft for -2,000 to 45,000 ft and -70 to +55 C.
+float densityAltitudeFt(float fPaltFt, float fOatC);
+
+/// True airspeed from indicated airspeed and density altitude (any speed
+/// unit in, same unit out).
+/// Max relative error 1e-6 for density altitudes from -10,000 to 50,000 ft.
+float trueAirspeed(float fIas, float fDensityAltFt);
+
+/// Indicated airspeed in knots from dynamic pressure in pascals, sea level
+/// density. Single precision sqrt, so exact to float rounding. Negative
+/// pressure gives 0.
+float iasFromDynamicPressureKts(float fPascal);
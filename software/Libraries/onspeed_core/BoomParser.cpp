@@ -0,0 +1,78 @@
+// BoomParser.cpp - Decoder for flight test boom '$' sentences
+
+#include "BoomParser.h"
+#include "Checksum.h"
+#include "EfisTextParser.h"     // parseHexByte()
+
+#include <cstring>
+
+// Scan one optionally signed decimal integer at p, leading spaces allowed.
+// Returns the position after the last digit, or nullptr if there were none.
+static const char * scanInt(const char * p, const char * pEnd, int32_t & iValue)
+{
+    while (p < pEnd && *p == ' ')
+        p++;
+
+    bool bNegative = false;
+    if (p < pEnd && (*p == '-' || *p == '+')) {
+        bNegative = (*p == '-');
+        p++;
+    }
+
+    const char * pDigits = p;
+    int32_t      iAcc    = 0;
+    while (p < pEnd && *p >= '0' && *p <= '9')
+        iAcc = iAcc * 10 + (*p++ - '0');
+
+    if (p == pDigits)
+        return nullptr;
+
+    iValue = bNegative ? -iAcc : iAcc;
+    return p;
+}
+
+BoomParseResult parseBoomLine(const char * szLine, size_t uLen, BoomData & data, bool bChecksum)
+{
+    if (uLen > 0 && szLine[uLen - 1] == '\r')
+        uLen--;
+
+    const size_t uTrailer = bChecksum ? 3 : 0;
+    if (uLen < uTrailer + 2 || szLine[0] != '$')
+        return BoomParseResult::Ignored;
+
+    const char * pEnd = szLine + uLen - uTrailer;
+
+    // Skip the header, one delimiter per field
+    const char * p = szLine + 1;
+    for (int i = 0; i < kBoomHeaderFields; i++) {
+        p = static_cast<const char *>(std::memchr(p, ',', size_t(pEnd - p)));
+        if (p == nullptr)
+            return BoomParseResult::Ignored;
+        p++;
+    }
+
+    if (bChecksum && sum8(szLine, pEnd - szLine) != parseHexByte(pEnd + 1))
+        return BoomParseResult::BadChecksum;
+
+    // Four comma separated integers. Anything after a fourth comma is a
+    // field we don't use.
+    int32_t      aiField[4];
+    for (int i = 0; i < 4; i++) {
+        p = scanInt(p, pEnd, aiField[i]);
+        if (p == nullptr)
+            return BoomParseResult::BadFormat;
+        if (i < 3) {
+            if (p >= pEnd || *p != ',')
+                return BoomParseResult::BadFormat;
+            p++;
+        }
+    }
+    if (p != pEnd && *p != ',')
+        return BoomParseResult::BadFormat;
+
+    data.iStatic  = aiField[0];
+    data.iDynamic = aiField[1];
+    data.iAlpha   = aiField[2];
+    data.iBeta    = aiField[3];
+    return BoomParseResult::Ok;
+}
@@ -0,0 +1,35 @@
+// BoomParser.h - Decoder for flight test boom '$' sentences
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// Raw counts from one boom sentence.
+struct BoomData {
+    int32_t iStatic;
+    int32_t iDynamic;
+    int32_t iAlpha;
+    int32_t iBeta;
+};
+
+enum class BoomParseResult : uint8_t {
+    Ok,
+    Ignored,        ///< Doesn't start with '$' or has no complete header
+    BadChecksum,    ///< Additive sum doesn't match the two hex digits at the end
+    BadFormat       ///< Checksum fine but the four fields aren't all integers
+};
+
+/// Comma terminated header fields after the '$' (name, sequence number and
+/// time) that we don't decode. The data starts after the last of their
+/// delimiters, however long the fields are.
+static constexpr int kBoomHeaderFields = 3;
+
+/// Decode one sentence: "$" + header, then "static,dynamic,alpha,beta",
+/// then (with bChecksum) a delimiter and two hex digits of the 8-bit sum of
+/// everything before the delimiter. A trailing CR and any fields after the
+/// fourth are ignored.
+///
+/// Reentrant and allocation-free. On anything but Ok, data is untouched.
+/// @param bChecksum false for booms that send no checksum
+BoomParseResult parseBoomLine(const char * szLine, size_t uLen, BoomData & data, bool bChecksum = true);
@@ -0,0 +1,115 @@
+// BootTimeline.cpp - Records how long each startup phase takes
+
+#include "BootTimeline.h"
+
+#include <cstdio>
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+BootTimeline::BootTimeline()
+    : _uCount(0)
+    , _uDropped(0)
+{
+    for (BootPhase & phase : _aPhases)
+        phase = { nullptr, 0, kOpen, false };
+}
+
+int BootTimeline::claim(const char * szName, uint32_t uNowUs, bool bMark)
+{
+    const unsigned uIdx = _uCount.fetch_add(1, std::memory_order_relaxed);
+    if (uIdx >= kMaxPhases) {
+        _uCount.store(kMaxPhases, std::memory_order_relaxed);
+        _uDropped.fetch_add(1, std::memory_order_relaxed);
+        return kNone;
+    }
+
+    BootPhase & phase = _aPhases[uIdx];
+    phase.uStartUs = uNowUs;
+    phase.uEndUs   = bMark ? uNowUs : kOpen;
+    phase.bMark    = bMark;
+
+    // The name goes in last; readers skip slots without one
+    std::atomic_thread_fence(std::memory_order_release);
+    phase.szName   = szName;
+    return int(uIdx);
+}
+
+int BootTimeline::begin(const char * szName, uint32_t uNowUs)
+{
+    return claim(szName, uNowUs, false);
+}
+
+void BootTimeline::end(int iPhase, uint32_t uNowUs)
+{
+    if (iPhase < 0 || iPhase >= int(kMaxPhases))
+        return;
+
+    BootPhase & phase = _aPhases[iPhase];
+    if (phase.uEndUs == kOpen)
+        phase.uEndUs = uNowUs;
+}
+
+void BootTimeline::mark(const char * szName, uint32_t uNowUs)
+{
+    claim(szName, uNowUs, true);
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+size_t BootTimeline::size() const
+{
+    const unsigned uCount = _uCount.load(std::memory_order_relaxed);
+    return uCount < kMaxPhases ? uCount : kMaxPhases;
+}
+
+uint32_t BootTimeline::durationUs(size_t uIdx, uint32_t uNowUs) const
+{
+    const BootPhase & phase = _aPhases[uIdx];
+    const uint32_t    uEnd  = phase.uEndUs == kOpen ? uNowUs : phase.uEndUs;
+    return uEnd - phase.uStartUs;
+}
+
+size_t BootTimeline::format(char * szOut, size_t uSize, uint32_t uNowUs) const
+{
+    if (uSize == 0)
+        return 0;
+
+    size_t uLen = 0;
+    auto   put  = [&](int iWritten) {
+        if (iWritten > 0)
+            uLen += size_t(iWritten);
+        if (uLen >= uSize)
+            uLen = uSize - 1;
+    };
+
+    szOut[0] = '\0';
+    put(std::snprintf(szOut, uSize, "  start us      dur us  phase\n"));
+
+    const size_t uCount = size();
+    for (size_t i = 0; i < uCount; i++) {
+        const BootPhase & phase = _aPhases[i];
+        const char *      szName = phase.szName;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (szName == nullptr)
+            continue;
+
+        const unsigned long uStart = phase.uStartUs;
+        if (phase.bMark)
+            put(std::snprintf(szOut + uLen, uSize - uLen, "%10lu           *  %s\n", uStart, szName));
+        else if (phase.uEndUs == kOpen)
+            put(std::snprintf(szOut + uLen, uSize - uLen, "%10lu %10lu+  %s (running)\n",
+                              uStart, (unsigned long)durationUs(i, uNowUs), szName));
+        else
+            put(std::snprintf(szOut + uLen, uSize - uLen, "%10lu %10lu   %s\n",
+                              uStart, (unsigned long)durationUs(i, uNowUs), szName));
+    }
+
+    if (dropped() > 0)
+        put(std::snprintf(szOut + uLen, uSize - uLen, "(%u more phases not recorded)\n", dropped()));
+
+    return uLen;
+}
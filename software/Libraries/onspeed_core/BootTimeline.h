@@ -0,0 +1,65 @@
+// BootTimeline.h - Records how long each startup phase takes
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// BOOT TIMELINE
+// ============================================================================
+
+/// One startup phase, or a milestone if it has no duration.
+struct BootPhase {
+    const char *    szName;     ///< Static string, nullptr while the slot is being filled
+    uint32_t        uStartUs;
+    uint32_t        uEndUs;     ///< kOpen until end() is called
+    bool            bMark;      ///< A point in time, not a span
+};
+
+/// Fixed-size record of boot phases with micros() times.
+///
+/// Phases can be begun and ended from different tasks, so phases that run
+/// in parallel (WiFi bring-up on core 0 while sensors start on core 1) show
+/// up overlapped. Slots are claimed with an atomic counter and never freed;
+/// once the table is full further phases are dropped and counted.
+class BootTimeline {
+public:
+    static constexpr size_t     kMaxPhases = 32;
+    static constexpr uint32_t   kOpen      = 0xFFFFFFFFu;
+    static constexpr int        kNone      = -1;
+
+    /// format() buffer that holds a full table of names up to 28 characters
+    static constexpr size_t     kFormatMax = kMaxPhases * 64 + 96;
+
+    BootTimeline();
+
+    /// Start a phase. szName must outlive the timeline (a literal).
+    /// @return Handle for end(), or kNone if the table is full
+    int  begin(const char * szName, uint32_t uNowUs);
+
+    /// Finish a phase. Ignores kNone and handles already ended.
+    void end(int iPhase, uint32_t uNowUs);
+
+    /// Record a milestone, like the first tone after boot.
+    void mark(const char * szName, uint32_t uNowUs);
+
+    size_t              size() const;
+    const BootPhase &   phase(size_t uIdx) const   { return _aPhases[uIdx]; }
+    unsigned            dropped() const             { return _uDropped.load(std::memory_order_relaxed); }
+
+    /// Duration of a phase, or of the phase still running at uNowUs.
+    uint32_t durationUs(size_t uIdx, uint32_t uNowUs) const;
+
+    /// Write a plain text table, one phase per line, in the order they began.
+    /// @return Characters written, not counting the NUL
+    size_t format(char * szOut, size_t uSize, uint32_t uNowUs) const;
+
+private:
+    int claim(const char * szName, uint32_t uNowUs, bool bMark);
+
+    BootPhase               _aPhases[kMaxPhases];
+    std::atomic<unsigned>   _uCount;
+    std::atomic<unsigned>   _uDropped;
+};
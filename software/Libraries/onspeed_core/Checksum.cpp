@@ -0,0 +1,125 @@
+// Checksum.cpp - Table-driven checksums used by the serial protocols
+
+#include "Checksum.h"
+
+// ============================================================================
+// CRC-16-CCITT
+// ============================================================================
+
+namespace {
+
+struct Crc16Table {
+    uint16_t a[256];
+
+    constexpr Crc16Table() : a{}
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t uCrc = static_cast<uint16_t>(i << 8);
+            for (int iBit = 0; iBit < 8; iBit++)
+                uCrc = (uCrc & 0x8000) ? static_cast<uint16_t>((uCrc << 1) ^ 0x1021)
+                                       : static_cast<uint16_t>(uCrc << 1);
+            a[i] = uCrc;
+        }
+    }
+};
+
+constexpr Crc16Table kCrc16;
+
+// Table 0 is the classic bytewise table. Table k advances a byte that is
+// k positions further from the end of the 4-byte word.
+struct Crc32Tables {
+    uint32_t a[4][256];
+
+    constexpr Crc32Tables() : a{}
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t uCrc = i;
+            for (int iBit = 0; iBit < 8; iBit++)
+                uCrc = (uCrc & 1) ? (uCrc >> 1) ^ 0xEDB88320u : (uCrc >> 1);
+            a[0][i] = uCrc;
+        }
+        for (uint32_t i = 0; i < 256; i++)
+            for (int k = 1; k < 4; k++)
+                a[k][i] = (a[k - 1][i] >> 8) ^ a[0][a[k - 1][i] & 0xFF];
+    }
+};
+
+constexpr Crc32Tables kCrc32;
+
+struct Crc8MaximTable {
+    uint8_t a[256];
+
+    constexpr Crc8MaximTable() : a{}
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint8_t uCrc = static_cast<uint8_t>(i);
+            for (int iBit = 0; iBit < 8; iBit++)
+                uCrc = (uCrc & 1) ? static_cast<uint8_t>((uCrc >> 1) ^ 0x8C)
+                                  : static_cast<uint8_t>(uCrc >> 1);
+            a[i] = uCrc;
+        }
+    }
+};
+
+constexpr Crc8MaximTable kCrc8Maxim;
+
+} // namespace
+
+uint16_t crc16Ccitt(const uint8_t * pData, size_t uLen, uint16_t uCrc)
+{
+    for (size_t i = 0; i < uLen; i++)
+        uCrc = static_cast<uint16_t>((uCrc << 8) ^ kCrc16.a[((uCrc >> 8) ^ pData[i]) & 0xFF]);
+    return uCrc;
+}
+
+// ============================================================================
+// CRC-32
+// ============================================================================
+
+uint32_t crc32(const uint8_t * pData, size_t uLen, uint32_t uCrc)
+{
+    uCrc = ~uCrc;
+
+    // Four bytes per step, one table lookup each. Assembled explicitly so
+    // neither alignment nor host byte order matter.
+    while (uLen >= 4) {
+        uCrc ^= static_cast<uint32_t>(pData[0])
+              | static_cast<uint32_t>(pData[1]) << 8
+              | static_cast<uint32_t>(pData[2]) << 16
+              | static_cast<uint32_t>(pData[3]) << 24;
+        uCrc = kCrc32.a[3][ uCrc        & 0xFF]
+             ^ kCrc32.a[2][(uCrc >>  8) & 0xFF]
+             ^ kCrc32.a[1][(uCrc >> 16) & 0xFF]
+             ^ kCrc32.a[0][ uCrc >> 24        ];
+        pData += 4;
+        uLen  -= 4;
+    }
+
+    while (uLen--)
+        uCrc = (uCrc >> 8) ^ kCrc32.a[0][(uCrc ^ *pData++) & 0xFF];
+
+    return ~uCrc;
+}
+
+// ============================================================================
+// CRC-8 (MAXIM)
+// ============================================================================
+
+uint8_t crc8Maxim(const uint8_t * pData, size_t uLen, uint8_t uCrc)
+{
+    for (size_t i = 0; i < uLen; i++)
+        uCrc = kCrc8Maxim.a[uCrc ^ pData[i]];
+    return uCrc;
+}
+
+// ============================================================================
+// ADDITIVE SUM
+// ============================================================================
+
+uint8_t sum8(const uint8_t * pData, size_t uLen)
+{
+    uint32_t uSum = 0;
+    for (size_t i = 0; i < uLen; i++)
+        uSum += pData[i];
+    return static_cast<uint8_t>(uSum);
+}
@@ -0,0 +1,51 @@
+// Checksum.h - Table-driven checksums used by the serial protocols
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// CRC-16-CCITT
+// ============================================================================
+
+/// CRC-16-CCITT (polynomial 0x1021, not reflected, no final XOR).
+///
+/// This is the VectorNav binary packet CRC. Running it over a packet
+/// including its big-endian CRC field yields 0 for a good packet.
+/// @param uCrc Initial value, or the result of a previous call to continue
+uint16_t crc16Ccitt(const uint8_t * pData, size_t uLen, uint16_t uCrc = 0);
+
+// ============================================================================
+// CRC-32
+// ============================================================================
+
+/// CRC-32 (IEEE 802.3 / zlib: reflected polynomial 0xEDB88320, init and
+/// final XOR 0xFFFFFFFF), slicing-by-4.
+///
+/// Used by the MGL binary EFIS messages.
+/// @param uCrc Result of a previous call to continue a running CRC, 0 to start
+uint32_t crc32(const uint8_t * pData, size_t uLen, uint32_t uCrc = 0);
+
+// ============================================================================
+// CRC-8 (MAXIM)
+// ============================================================================
+
+/// CRC-8/MAXIM (1-Wire: reflected polynomial 0x8C, init 0, no final XOR).
+///
+/// Guards the DS18B20 scratchpad and ROM codes. Running it over the data
+/// including its trailing CRC byte yields 0 when they match.
+uint8_t crc8Maxim(const uint8_t * pData, size_t uLen, uint8_t uCrc = 0);
+
+// ============================================================================
+// ADDITIVE SUM
+// ============================================================================
+
+/// Low 8 bits of the byte sum. SkyView, D10/D100, G5/G3X and the boom all
+/// send this as two hex digits.
+uint8_t sum8(const uint8_t * pData, size_t uLen);
+
+inline uint8_t sum8(const char * pData, size_t uLen)
+{
+    return sum8(reinterpret_cast<const uint8_t *>(pData), uLen);
+}
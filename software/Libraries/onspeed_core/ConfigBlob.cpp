@@ -0,0 +1,211 @@
+// ConfigBlob.cpp - Versioned, CRC-protected binary image of the config for fast boot
+
+#include "ConfigBlob.h"
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void putLe16(uint8_t * p, uint16_t v)
+{
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+}
+
+static void putLe32(uint8_t * p, uint32_t v)
+{
+    p[0] = uint8_t(v);
+    p[1] = uint8_t(v >> 8);
+    p[2] = uint8_t(v >> 16);
+    p[3] = uint8_t(v >> 24);
+}
+
+static uint16_t getLe16(const uint8_t * p)
+{
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+static uint32_t getLe32(const uint8_t * p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// CRC of the header up to the CRC field, then the payload
+static uint32_t blobCrc(const uint8_t * pBlob, size_t uPayloadLen)
+{
+    const uint32_t uCrc = crc32(pBlob, kConfigBlobHeaderLen - 4);
+    return crc32(pBlob + kConfigBlobHeaderLen, uPayloadLen, uCrc);
+}
+
+// ============================================================================
+// BLOB
+// ============================================================================
+
+size_t sealConfigBlob(uint8_t * pBlob, size_t uPayloadLen, uint16_t uVersion,
+                      uint32_t uLayout, uint32_t uSourceStamp)
+{
+    putLe32(pBlob +  0, kConfigBlobMagic);
+    putLe16(pBlob +  4, uVersion);
+    putLe16(pBlob +  6, uint16_t(kConfigBlobHeaderLen));
+    putLe32(pBlob +  8, uLayout);
+    putLe32(pBlob + 12, uSourceStamp);
+    putLe32(pBlob + 16, uint32_t(uPayloadLen));
+    putLe32(pBlob + 20, blobCrc(pBlob, uPayloadLen));
+    return kConfigBlobHeaderLen + uPayloadLen;
+}
+
+ConfigBlobResult openConfigBlob(const uint8_t * pBlob, size_t uLen, uint16_t uVersion,
+                                uint32_t uLayout, ConfigBlobInfo & info)
+{
+    if (uLen < kConfigBlobHeaderLen)
+        return ConfigBlobResult::TooShort;
+    if (getLe32(pBlob) != kConfigBlobMagic || getLe16(pBlob + 6) != kConfigBlobHeaderLen)
+        return ConfigBlobResult::BadMagic;
+
+    const uint32_t uPayloadLen = getLe32(pBlob + 16);
+    if (uPayloadLen > uLen - kConfigBlobHeaderLen)
+        return ConfigBlobResult::TooShort;
+
+    // CRC before version and layout so a damaged header reads as damaged
+    if (blobCrc(pBlob, uPayloadLen) != getLe32(pBlob + 20))
+        return ConfigBlobResult::BadCrc;
+    if (getLe16(pBlob + 4) != uVersion)
+        return ConfigBlobResult::WrongVersion;
+    if (getLe32(pBlob + 8) != uLayout)
+        return ConfigBlobResult::WrongLayout;
+
+    info.uSourceStamp = getLe32(pBlob + 12);
+    info.pPayload     = pBlob + kConfigBlobHeaderLen;
+    info.uPayloadLen  = uPayloadLen;
+    return ConfigBlobResult::Ok;
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+BlobWriter::BlobWriter(uint8_t * pBuf, size_t uCapacity)
+    : _pBuf(pBuf)
+    , _uCap(uCapacity)
+    , _uLen(0)
+    , _bOk(true)
+{
+}
+
+bool BlobWriter::room(size_t uBytes)
+{
+    if (_bOk && uBytes > _uCap - _uLen)
+        _bOk = false;
+    return _bOk;
+}
+
+void BlobWriter::putU8(uint8_t v)
+{
+    if (room(1))
+        _pBuf[_uLen++] = v;
+}
+
+void BlobWriter::putU16(uint16_t v)
+{
+    if (room(2)) {
+        putLe16(_pBuf + _uLen, v);
+        _uLen += 2;
+    }
+}
+
+void BlobWriter::putU32(uint32_t v)
+{
+    if (room(4)) {
+        putLe32(_pBuf + _uLen, v);
+        _uLen += 4;
+    }
+}
+
+void BlobWriter::putFloat(float f)
+{
+    uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    putU32(v);
+}
+
+void BlobWriter::putString(const char * sz)
+{
+    const size_t uLen = std::strlen(sz);
+    if (uLen > 0xFFFF) {
+        _bOk = false;
+        return;
+    }
+    putU16(uint16_t(uLen));
+    if (room(uLen)) {
+        std::memcpy(_pBuf + _uLen, sz, uLen);
+        _uLen += uLen;
+    }
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+BlobReader::BlobReader(const uint8_t * pBuf, size_t uLen)
+    : _pBuf(pBuf)
+    , _uLen(uLen)
+    , _uPos(0)
+    , _bOk(true)
+{
+}
+
+bool BlobReader::take(size_t uBytes)
+{
+    if (_bOk && uBytes > _uLen - _uPos)
+        _bOk = false;
+    return _bOk;
+}
+
+uint8_t BlobReader::getU8()
+{
+    if (!take(1))
+        return 0;
+    return _pBuf[_uPos++];
+}
+
+uint16_t BlobReader::getU16()
+{
+    if (!take(2))
+        return 0;
+    const uint16_t v = getLe16(_pBuf + _uPos);
+    _uPos += 2;
+    return v;
+}
+
+uint32_t BlobReader::getU32()
+{
+    if (!take(4))
+        return 0;
+    const uint32_t v = getLe32(_pBuf + _uPos);
+    _uPos += 4;
+    return v;
+}
+
+float BlobReader::getFloat()
+{
+    const uint32_t v = getU32();
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+size_t BlobReader::getString(char * szOut, size_t uSize)
+{
+    if (uSize > 0)
+        szOut[0] = '\0';
+
+    const uint16_t uLen = getU16();
+    if (!_bOk || uSize == 0 || uLen >= uSize || !take(uLen)) {
+        _bOk = false;
+        return 0;
+    }
+    std::memcpy(szOut, _pBuf + _uPos, uLen);
+    szOut[uLen] = '\0';
+    _uPos += uLen;
+    return uLen;
+}
@@ -0,0 +1,195 @@
+// ConfigBlob.h - Versioned, CRC-protected binary image of the config for fast boot
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Checksum.h"
+#include "ConfigFields.h"
+
+// ============================================================================
+// BLOB FORMAT
+// ============================================================================
+// Header, all little-endian:
+//   0 u32 magic "OSCB"      4 u16 version       6 u16 header length
+//   8 u32 layout hash      12 u32 source stamp  16 u32 payload length
+//  20 u32 CRC-32 of bytes 0..19 and the payload
+// then the payload.
+//
+// The version is bumped by hand when the payload encoding changes. The
+// layout hash is computed from the field table, so adding, renaming or
+// retyping a config item invalidates old blobs on its own. The source
+// stamp identifies the text config the blob was made from; the owner
+// decides what it is (the firmware uses a CRC of the config files).
+
+constexpr uint32_t kConfigBlobMagic     = 0x4243534Fu;   ///< "OSCB"
+constexpr size_t   kConfigBlobHeaderLen = 24;
+
+enum class ConfigBlobResult : uint8_t {
+    Ok,
+    TooShort,       ///< Smaller than a header, or than the header says
+    BadMagic,       ///< Not a config blob
+    WrongVersion,   ///< Payload encoding from another firmware version
+    WrongLayout,    ///< Made with a different field table
+    BadCrc          ///< Damaged
+};
+
+/// What openConfigBlob() found.
+struct ConfigBlobInfo {
+    uint32_t        uSourceStamp;
+    const uint8_t * pPayload;
+    size_t          uPayloadLen;
+};
+
+/// Fill in the header of a blob whose payload has already been written at
+/// pBlob + kConfigBlobHeaderLen.
+/// @return Total blob length
+size_t sealConfigBlob(uint8_t * pBlob, size_t uPayloadLen, uint16_t uVersion,
+                      uint32_t uLayout, uint32_t uSourceStamp);
+
+/// Check a blob and locate its payload. Nothing is copied.
+ConfigBlobResult openConfigBlob(const uint8_t * pBlob, size_t uLen, uint16_t uVersion,
+                                uint32_t uLayout, ConfigBlobInfo & info);
+
+// ============================================================================
+// WRITER / READER
+// ============================================================================
+
+/// Appends little-endian values to a fixed buffer. Once anything doesn't
+/// fit, ok() is false and nothing more is written.
+class BlobWriter {
+public:
+    BlobWriter(uint8_t * pBuf, size_t uCapacity);
+
+    void putU8 (uint8_t  v);
+    void putU16(uint16_t v);
+    void putU32(uint32_t v);
+    void putI32(int32_t v)      { putU32(uint32_t(v)); }
+    void putFloat(float f);
+    void putBool(bool b)        { putU8(b ? 1 : 0); }
+
+    /// u16 length then the characters, no NUL
+    void putString(const char * sz);
+
+    bool   ok() const           { return _bOk; }
+    size_t size() const         { return _uLen; }
+
+private:
+    bool room(size_t uBytes);
+
+    uint8_t *   _pBuf;
+    size_t      _uCap;
+    size_t      _uLen;
+    bool        _bOk;
+};
+
+/// Reads what BlobWriter wrote. Reading past the end makes ok() false and
+/// returns zeros.
+class BlobReader {
+public:
+    BlobReader(const uint8_t * pBuf, size_t uLen);
+
+    uint8_t  getU8();
+    uint16_t getU16();
+    uint32_t getU32();
+    int32_t  getI32()           { return int32_t(getU32()); }
+    float    getFloat();
+    bool     getBool()          { return getU8() != 0; }
+
+    /// Copy a string to szOut (always NUL terminated). A string longer than
+    /// uSize - 1 makes ok() false.
+    size_t getString(char * szOut, size_t uSize);
+
+    bool   ok() const           { return _bOk; }
+    bool   atEnd() const        { return _uPos == _uLen; }
+
+private:
+    bool take(size_t uBytes);
+
+    const uint8_t * _pBuf;
+    size_t          _uLen;
+    size_t          _uPos;
+    bool            _bOk;
+};
+
+// ============================================================================
+// FIELD TABLE BINDING
+// ============================================================================
+
+/// Hash of a field table's names and types. Custom entries count by name
+/// only; their encoding is covered by the blob version.
+template <typename T, typename S>
+uint32_t configFieldsLayout(const ConfigField<T, S> * pFields, size_t uCount)
+{
+    uint32_t uCrc = 0;
+    for (size_t i = 0; i < uCount; i++) {
+        const ConfigField<T, S> & f = pFields[i];
+        const uint8_t uType = uint8_t(f.enType);
+        uCrc = crc32(&uType, 1, uCrc);
+        if (f.szSection)
+            uCrc = crc32(reinterpret_cast<const uint8_t *>(f.szSection), std::strlen(f.szSection), uCrc);
+        uCrc = crc32(reinterpret_cast<const uint8_t *>("/"), 1, uCrc);
+        uCrc = crc32(reinterpret_cast<const uint8_t *>(f.szName), std::strlen(f.szName), uCrc);
+    }
+    return uCrc;
+}
+
+/// Write every non-Custom item of obj, in table order.
+template <typename T, typename S>
+void saveConfigFieldsBinary(const ConfigField<T, S> * pFields, size_t uCount, const T & obj, BlobWriter & out)
+{
+    for (size_t i = 0; i < uCount; i++) {
+        const ConfigField<T, S> & f = pFields[i];
+        switch (f.enType) {
+            case ConfigFieldType::Int:    out.putI32  (obj.*f.piValue);            break;
+            case ConfigFieldType::UInt:   out.putU32  (obj.*f.puValue);            break;
+            case ConfigFieldType::Float:  out.putFloat(obj.*f.pfValue);            break;
+            case ConfigFieldType::Bool:   out.putBool (obj.*f.pbValue);            break;
+            case ConfigFieldType::String: out.putString((obj.*f.psValue).c_str()); break;
+            case ConfigFieldType::Custom:                                          break;
+        }
+    }
+}
+
+/// Read what saveConfigFieldsBinary() wrote. obj is only changed if the
+/// whole record reads back; check in.ok() afterwards.
+template <typename T, typename S>
+void loadConfigFieldsBinary(const ConfigField<T, S> * pFields, size_t uCount, T & obj, BlobReader & in)
+{
+    // Dry run first so a short or damaged record leaves obj alone
+    BlobReader check = in;
+    for (size_t i = 0; i < uCount && check.ok(); i++) {
+        char szValue[kConfigMaxString];
+        switch (pFields[i].enType) {
+            case ConfigFieldType::Int:
+            case ConfigFieldType::UInt:
+            case ConfigFieldType::Float:  check.getU32();                              break;
+            case ConfigFieldType::Bool:   check.getU8();                               break;
+            case ConfigFieldType::String: check.getString(szValue, sizeof(szValue));   break;
+            case ConfigFieldType::Custom:                                              break;
+        }
+    }
+    if (!check.ok()) {
+        in = check;
+        return;
+    }
+
+    for (size_t i = 0; i < uCount; i++) {
+        const ConfigField<T, S> & f = pFields[i];
+        char szValue[kConfigMaxString];
+        switch (f.enType) {
+            case ConfigFieldType::Int:    obj.*f.piValue = in.getI32();    break;
+            case ConfigFieldType::UInt:   obj.*f.puValue = in.getU32();    break;
+            case ConfigFieldType::Float:  obj.*f.pfValue = in.getFloat();  break;
+            case ConfigFieldType::Bool:   obj.*f.pbValue = in.getBool();   break;
+            case ConfigFieldType::String:
+                in.getString(szValue, sizeof(szValue));
+                obj.*f.psValue = szValue;
+                break;
+            case ConfigFieldType::Custom:
+                break;
+        }
+    }
+}
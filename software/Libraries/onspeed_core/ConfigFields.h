@@ -0,0 +1,166 @@
+// ConfigFields.h - Declarative table binding config file elements to config members
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "ConfigXml.h"
+
+// ============================================================================
+// FIELD DESCRIPTOR
+// ============================================================================
+
+enum class ConfigFieldType : uint8_t {
+    Int,
+    UInt,
+    Float,
+    Bool,
+    String,
+    Custom      ///< Handled by the owner (flap blocks, curves, enums); loaders skip it
+};
+
+/// One config item: where it lives in each file format and which member of
+/// T holds it. S is the owner's string type (Arduino String, std::string).
+///
+/// The same table drives loading and saving, so a new item is added in one
+/// place and can't be read under one name and written under another.
+/// Entries that share a szSection must be consecutive; the writer opens the
+/// section element when szSection changes.
+template <typename T, typename S>
+struct ConfigField {
+    ConfigFieldType enType;
+    const char *    szSection;      ///< CONFIG2 parent element, nullptr for the root
+    const char *    szName;         ///< CONFIG2 element name
+    const char *    szV1Name;       ///< Original <CONFIG> name, nullptr if it has none
+    int      T::*   piValue;
+    unsigned T::*   puValue;
+    float    T::*   pfValue;
+    bool     T::*   pbValue;
+    S        T::*   psValue;
+
+    static constexpr ConfigField Int(const char * szSection, const char * szName, const char * szV1Name, int T::* p)
+        { return { ConfigFieldType::Int, szSection, szName, szV1Name, p, nullptr, nullptr, nullptr, nullptr }; }
+
+    static constexpr ConfigField UInt(const char * szSection, const char * szName, const char * szV1Name, unsigned T::* p)
+        { return { ConfigFieldType::UInt, szSection, szName, szV1Name, nullptr, p, nullptr, nullptr, nullptr }; }
+
+    static constexpr ConfigField Float(const char * szSection, const char * szName, const char * szV1Name, float T::* p)
+        { return { ConfigFieldType::Float, szSection, szName, szV1Name, nullptr, nullptr, p, nullptr, nullptr }; }
+
+    static constexpr ConfigField Bool(const char * szSection, const char * szName, const char * szV1Name, bool T::* p)
+        { return { ConfigFieldType::Bool, szSection, szName, szV1Name, nullptr, nullptr, nullptr, p, nullptr }; }
+
+    static constexpr ConfigField Str(const char * szSection, const char * szName, const char * szV1Name, S T::* p)
+        { return { ConfigFieldType::String, szSection, szName, szV1Name, nullptr, nullptr, nullptr, nullptr, p }; }
+
+    static constexpr ConfigField Custom(const char * szSection, const char * szName)
+        { return { ConfigFieldType::Custom, szSection, szName, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }; }
+};
+
+/// Longest string value the loaders copy out of the document.
+constexpr size_t kConfigMaxString = 128;
+
+/// True if two section names are the same, nullptr being the root.
+inline bool sameConfigSection(const char * szA, const char * szB)
+{
+    if (szA == nullptr || szB == nullptr)
+        return szA == szB;
+    return std::strcmp(szA, szB) == 0;
+}
+
+// ============================================================================
+// LOADERS
+// ============================================================================
+
+/// Load a <CONFIG2> document into obj.
+///
+/// Items that are missing or don't parse keep their current value, so the
+/// defaults loaded beforehand survive a partial file.
+/// @return Number of items set
+template <typename T, typename S>
+size_t loadConfigFields(const ConfigXml & xml, const ConfigField<T, S> * pFields, size_t uCount, T & obj)
+{
+    const int16_t   iRoot     = xml.root();
+    const char *    szSection = nullptr;
+    int16_t         iSection  = iRoot;
+    size_t          uSet      = 0;
+
+    for (size_t i = 0; i < uCount; i++) {
+        const ConfigField<T, S> & f = pFields[i];
+        if (f.enType == ConfigFieldType::Custom)
+            continue;
+
+        if (!sameConfigSection(f.szSection, szSection)) {
+            szSection = f.szSection;
+            iSection  = szSection ? xml.firstChild(iRoot, szSection) : iRoot;
+        }
+
+        const int16_t iElem = xml.firstChild(iSection, f.szName);
+        if (iElem == ConfigXml::kNone)
+            continue;
+
+        bool bOk = false;
+        switch (f.enType) {
+            case ConfigFieldType::Int:   bOk = xml.getInt     (iElem, obj.*f.piValue);  break;
+            case ConfigFieldType::UInt:  bOk = xml.getUnsigned(iElem, obj.*f.puValue);  break;
+            case ConfigFieldType::Float: bOk = xml.getFloat   (iElem, obj.*f.pfValue);  break;
+            case ConfigFieldType::Bool:  bOk = xml.getBool    (iElem, obj.*f.pbValue);  break;
+            case ConfigFieldType::String: {
+                char szValue[kConfigMaxString];
+                xml.copyText(iElem, szValue, sizeof(szValue));
+                obj.*f.psValue = szValue;
+                bOk = true;
+                break;
+            }
+            case ConfigFieldType::Custom:
+                break;
+        }
+        if (bOk)
+            uSet++;
+    }
+    return uSet;
+}
+
+/// Load an original <CONFIG> document into obj.
+///
+/// This keeps the old reader's rules: every item with a V1 name is set, a
+/// missing or unparseable number is 0 and a missing string is empty, and
+/// booleans are true for 1, YES, ENABLED or ON.
+/// @return Number of items found in the document
+template <typename T, typename S>
+size_t loadConfigFieldsV1(const ConfigXml & xml, const ConfigField<T, S> * pFields, size_t uCount, T & obj)
+{
+    const int16_t   iRoot = xml.root();
+    size_t          uFound = 0;
+
+    for (size_t i = 0; i < uCount; i++) {
+        const ConfigField<T, S> & f = pFields[i];
+        if (f.enType == ConfigFieldType::Custom || f.szV1Name == nullptr)
+            continue;
+
+        char          szValue[kConfigMaxString];
+        const int16_t iElem = xml.firstChild(iRoot, f.szV1Name);
+        xml.copyText(iElem, szValue, sizeof(szValue));
+        if (iElem != ConfigXml::kNone)
+            uFound++;
+
+        switch (f.enType) {
+            case ConfigFieldType::Int:    obj.*f.piValue = int(std::atol(szValue));         break;
+            case ConfigFieldType::UInt:   obj.*f.puValue = unsigned(std::atol(szValue));    break;
+            case ConfigFieldType::Float:  obj.*f.pfValue = float(std::atof(szValue));       break;
+            case ConfigFieldType::String: obj.*f.psValue = szValue;                         break;
+            case ConfigFieldType::Bool:
+                obj.*f.pbValue = std::atol(szValue) == 1       ||
+                                 !std::strcmp(szValue, "YES")     ||
+                                 !std::strcmp(szValue, "ENABLED") ||
+                                 !std::strcmp(szValue, "ON");
+                break;
+            case ConfigFieldType::Custom:
+                break;
+        }
+    }
+    return uFound;
+}
@@ -0,0 +1,143 @@
+// ConfigSnapshot.h - Double-buffered, read-mostly configuration publisher
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/// Double-buffered snapshot of a configuration struct.
+///
+/// Real-time readers (sensor task, audio, display, data server) take a
+/// ReadGuard once per cycle: one atomic pointer load plus a reader-count
+/// increment on the slot it points at. Every field they read through the
+/// guard comes from the same published version, and that version cannot
+/// be overwritten until the guard is released.
+///
+/// A writer fills the inactive slot and swaps the pointer. Before a slot
+/// is reused the writer waits for its reader count to drain (an RCU-style
+/// grace period), so a slow reader only ever delays the *next-but-one*
+/// publish, never the readers.
+///
+/// Only one writer at a time is supported; callers serialize publishes.
+/// T must be trivially copyable (fixed-size arrays, no heap ownership).
+template <typename T>
+class ConfigSnapshot {
+public:
+    /// RAII read handle. Holds the slot it was created on until destroyed.
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ConfigSnapshot& snap)
+            : _snap(snap)
+            , _slot(snap.enter())
+        {
+        }
+
+        ~ReadGuard() { _snap.leave(_slot); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const  { return _snap._aSlots[_slot]; }
+        const T* operator->() const { return &_snap._aSlots[_slot]; }
+
+        /// Version number of the snapshot this guard is reading.
+        uint32_t version() const { return _snap._aVersion[_slot]; }
+
+    private:
+        const ConfigSnapshot& _snap;
+        int                   _slot;
+    };
+
+    ConfigSnapshot()
+        : _aSlots{}
+        , _aVersion{0, 0}
+        , _pCurrent(&_aSlots[0])
+        , _uPublished(0)
+    {
+        _aReaders[0].store(0);
+        _aReaders[1].store(0);
+    }
+
+    explicit ConfigSnapshot(const T& initial)
+        : ConfigSnapshot()
+    {
+        _aSlots[0] = initial;
+    }
+
+    ConfigSnapshot(const ConfigSnapshot&) = delete;
+    ConfigSnapshot& operator=(const ConfigSnapshot&) = delete;
+
+    /// Try to publish without blocking.
+    /// @return false if a reader still holds the inactive slot (grace period
+    ///         not yet elapsed); nothing is changed in that case.
+    bool tryPublish(const T& value)
+    {
+        const int iNext = 1 - slotOf(_pCurrent.load());
+
+        // Grace period: nobody may still be reading the slot we're about to
+        // overwrite. seq_cst pairs with the increment-then-recheck in enter().
+        if (_aReaders[iNext].load() != 0)
+            return false;
+
+        _aSlots[iNext]   = value;
+        _aVersion[iNext] = _uPublished + 1;
+        _pCurrent.store(&_aSlots[iNext]);
+        _uPublished++;
+        return true;
+    }
+
+    /// Publish, calling waitFn between attempts while the grace period runs.
+    /// On FreeRTOS pass something that blocks (vTaskDelay) so a higher
+    /// priority writer doesn't starve the reader it is waiting on.
+    /// @return number of times waitFn was called
+    template <typename WaitFn>
+    uint32_t publish(const T& value, WaitFn waitFn)
+    {
+        uint32_t uWaits = 0;
+        while (!tryPublish(value)) {
+            waitFn();
+            uWaits++;
+        }
+        return uWaits;
+    }
+
+    /// Copy of the current snapshot (takes and releases a guard).
+    T load() const
+    {
+        ReadGuard guard(*this);
+        return *guard;
+    }
+
+    /// Number of successful publishes since construction.
+    uint32_t publishCount() const { return _uPublished; }
+
+    /// Readers currently inside the given slot (0 or 1). For diagnostics/tests.
+    uint32_t readers(int slot) const { return _aReaders[slot].load(); }
+
+private:
+    int slotOf(const T* p) const { return (p == &_aSlots[0]) ? 0 : 1; }
+
+    int enter() const
+    {
+        for (;;) {
+            const int iSlot = slotOf(_pCurrent.load());
+            _aReaders[iSlot].fetch_add(1);
+
+            // If the pointer moved between the load and the increment, the
+            // writer may already be past its grace check on this slot. Back
+            // out and retry on the new one.
+            if (slotOf(_pCurrent.load()) == iSlot)
+                return iSlot;
+
+            _aReaders[iSlot].fetch_sub(1);
+        }
+    }
+
+    void leave(int slot) const { _aReaders[slot].fetch_sub(1); }
+
+    T                              _aSlots[2];
+    uint32_t                       _aVersion[2];
+    std::atomic<const T*>          _pCurrent;
+    mutable std::atomic<uint32_t>  _aReaders[2];
+    uint32_t                       _uPublished;
+};
@@ -0,0 +1,307 @@
+// ConfigXml.cpp - Single-pass index of the XML subset used by the config files
+
+#include "ConfigXml.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+bool ConfigText::equals(const char * sz) const
+{
+    return std::strncmp(p, sz, uLen) == 0 && sz[uLen] == '\0';
+}
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool isNameEnd(char c)
+{
+    return isSpace(c) || c == '>' || c == '/';
+}
+
+// Position of the first occurrence of szPattern at or after p, or pEnd
+static const char * findText(const char * p, const char * pEnd, const char * szPattern)
+{
+    const size_t uPatLen = std::strlen(szPattern);
+    for (; p + uPatLen <= pEnd; p++)
+        if (std::memcmp(p, szPattern, uPatLen) == 0)
+            return p;
+    return pEnd;
+}
+
+// ============================================================================
+// PARSER
+// ============================================================================
+
+ConfigXml::ConfigXml()
+    : _uCount(0)
+{
+}
+
+bool ConfigXml::parse(const char * pText, size_t uLen)
+{
+    // Open elements, and the last child added to each so far
+    int16_t     aiOpen[kMaxDepth];
+    int16_t     aiLastChild[kMaxDepth];
+    uint8_t     uDepth = 0;
+
+    const char * p    = pText;
+    const char * pEnd = pText + uLen;
+
+    _uCount = 0;
+
+    while (p < pEnd) {
+        if (*p != '<') {
+            p++;
+            continue;
+        }
+
+        // Declaration, comment, DOCTYPE
+        if (p + 1 < pEnd && p[1] == '?') {
+            p = findText(p, pEnd, "?>") + 2;
+            continue;
+        }
+        if (p + 3 < pEnd && std::memcmp(p, "<!--", 4) == 0) {
+            p = findText(p, pEnd, "-->") + 3;
+            continue;
+        }
+        if (p + 1 < pEnd && p[1] == '!') {
+            p = findText(p, pEnd, ">") + 1;
+            continue;
+        }
+
+        // End tag: must close the innermost open element
+        if (p + 1 < pEnd && p[1] == '/') {
+            const char * pName = p + 2;
+            const char * q     = pName;
+            while (q < pEnd && !isNameEnd(*q))
+                q++;
+            if (uDepth == 0)
+                break;
+
+            Element & elem = _aElems[aiOpen[uDepth - 1]];
+            if (size_t(q - pName) != elem.uNameLen || std::memcmp(pName, elem.pName, elem.uNameLen) != 0)
+                break;
+
+            if (elem.iFirstChild == kNone)
+                elem.uTextLen = uint16_t(p - elem.pText);
+            uDepth--;
+
+            p = findText(q, pEnd, ">") + 1;
+            continue;
+        }
+
+        // Start tag
+        const char * pName = p + 1;
+        const char * q     = pName;
+        while (q < pEnd && !isNameEnd(*q))
+            q++;
+        const char * pClose = findText(q, pEnd, ">");
+        if (q == pName || pClose == pEnd || _uCount >= kMaxElements)
+            break;
+
+        // Only one top-level element
+        if (uDepth == 0 && _uCount > 0)
+            break;
+
+        const int16_t iElem = int16_t(_uCount++);
+        Element & elem    = _aElems[iElem];
+        elem.pName        = pName;
+        elem.uNameLen     = uint16_t(q - pName);
+        elem.pText        = pClose + 1;
+        elem.uTextLen     = 0;
+        elem.iFirstChild  = kNone;
+        elem.iNextSibling = kNone;
+
+        if (uDepth > 0) {
+            const int16_t iParent = aiOpen[uDepth - 1];
+            if (aiLastChild[uDepth - 1] == kNone)
+                _aElems[iParent].iFirstChild = iElem;
+            else
+                _aElems[aiLastChild[uDepth - 1]].iNextSibling = iElem;
+            aiLastChild[uDepth - 1] = iElem;
+        }
+
+        const bool bSelfClosing = pClose[-1] == '/';
+        if (!bSelfClosing) {
+            if (uDepth >= kMaxDepth)
+                break;
+            aiOpen[uDepth]      = iElem;
+            aiLastChild[uDepth] = kNone;
+            uDepth++;
+        }
+
+        p = pClose + 1;
+    }
+
+    // Anything left open, or a break out of the loop, is a bad document
+    if (p < pEnd || uDepth != 0 || _uCount == 0) {
+        _uCount = 0;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// NAVIGATION
+// ============================================================================
+
+ConfigText ConfigXml::name(int16_t iElem) const
+{
+    return { _aElems[iElem].pName, _aElems[iElem].uNameLen };
+}
+
+ConfigText ConfigXml::text(int16_t iElem) const
+{
+    return { _aElems[iElem].pText, _aElems[iElem].uTextLen };
+}
+
+int16_t ConfigXml::firstChild(int16_t iParent, const char * szName) const
+{
+    if (iParent == kNone)
+        return kNone;
+
+    const int16_t iChild = _aElems[iParent].iFirstChild;
+    if (iChild == kNone || szName == nullptr || name(iChild).equals(szName))
+        return iChild;
+    return nextSibling(iChild, szName);
+}
+
+int16_t ConfigXml::nextSibling(int16_t iElem, const char * szName) const
+{
+    if (iElem == kNone)
+        return kNone;
+
+    for (int16_t i = _aElems[iElem].iNextSibling; i != kNone; i = _aElems[i].iNextSibling)
+        if (szName == nullptr || name(i).equals(szName))
+            return i;
+    return kNone;
+}
+
+// ============================================================================
+// VALUES
+// ============================================================================
+
+bool ConfigXml::numberText(int16_t iElem, char * szOut, size_t uSize) const
+{
+    if (iElem == kNone)
+        return false;
+
+    ConfigText t = text(iElem);
+    while (t.uLen > 0 && isSpace(t.p[0]))          { t.p++; t.uLen--; }
+    while (t.uLen > 0 && isSpace(t.p[t.uLen - 1]))   t.uLen--;
+
+    if (t.uLen == 0 || t.uLen >= uSize)
+        return false;
+    std::memcpy(szOut, t.p, t.uLen);
+    szOut[t.uLen] = '\0';
+    return true;
+}
+
+bool ConfigXml::getInt(int16_t iElem, int & iValue) const
+{
+    char    szNum[24];
+    char  * pEnd;
+
+    if (!numberText(iElem, szNum, sizeof(szNum)))
+        return false;
+    const long lValue = std::strtol(szNum, &pEnd, 10);
+    if (pEnd == szNum)
+        return false;
+    iValue = int(lValue);
+    return true;
+}
+
+bool ConfigXml::getUnsigned(int16_t iElem, unsigned & uValue) const
+{
+    char    szNum[24];
+    char  * pEnd;
+
+    if (!numberText(iElem, szNum, sizeof(szNum)) || szNum[0] == '-')
+        return false;
+    const unsigned long ulValue = std::strtoul(szNum, &pEnd, 10);
+    if (pEnd == szNum)
+        return false;
+    uValue = unsigned(ulValue);
+    return true;
+}
+
+bool ConfigXml::getFloat(int16_t iElem, float & fValue) const
+{
+    char    szNum[40];
+    char  * pEnd;
+
+    if (!numberText(iElem, szNum, sizeof(szNum)))
+        return false;
+    const float f = std::strtof(szNum, &pEnd);
+    if (pEnd == szNum)
+        return false;
+    fValue = f;
+    return true;
+}
+
+bool ConfigXml::getBool(int16_t iElem, bool & bValue) const
+{
+    int     iValue;
+    char    szBool[8];
+
+    if (getInt(iElem, iValue)) {
+        bValue = iValue != 0;
+        return true;
+    }
+    if (!numberText(iElem, szBool, sizeof(szBool)))
+        return false;
+
+    if (!std::strcmp(szBool, "true") || !std::strcmp(szBool, "True") || !std::strcmp(szBool, "TRUE")) {
+        bValue = true;
+        return true;
+    }
+    if (!std::strcmp(szBool, "false") || !std::strcmp(szBool, "False") || !std::strcmp(szBool, "FALSE")) {
+        bValue = false;
+        return true;
+    }
+    return false;
+}
+
+size_t ConfigXml::copyText(int16_t iElem, char * szOut, size_t uSize) const
+{
+    static const struct { const char * szEntity; char c; } aEntities[] = {
+        { "&amp;",  '&'  },
+        { "&lt;",   '<'  },
+        { "&gt;",   '>'  },
+        { "&quot;", '"'  },
+        { "&apos;", '\'' },
+    };
+
+    if (uSize == 0)
+        return 0;
+
+    size_t uOut = 0;
+    if (iElem != kNone) {
+        const ConfigText t    = text(iElem);
+        const char *     p    = t.p;
+        const char *     pEnd = t.p + t.uLen;
+
+        while (p < pEnd && uOut + 1 < uSize) {
+            char c = *p++;
+            if (c == '&') {
+                for (const auto & e : aEntities) {
+                    const size_t uLen = std::strlen(e.szEntity) - 1;
+                    if (size_t(pEnd - p) >= uLen && std::memcmp(p, e.szEntity + 1, uLen) == 0) {
+                        c  = e.c;
+                        p += uLen;
+                        break;
+                    }
+                }
+            }
+            szOut[uOut++] = c;
+        }
+    }
+    szOut[uOut] = '\0';
+    return uOut;
+}
@@ -0,0 +1,91 @@
+// ConfigXml.h - Single-pass index of the XML subset used by the config files
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// TEXT VIEW
+// ============================================================================
+
+/// A run of characters inside the parsed document. Not NUL terminated.
+struct ConfigText {
+    const char *    p;
+    uint16_t        uLen;
+
+    bool equals(const char * sz) const;
+};
+
+// ============================================================================
+// CONFIG XML
+// ============================================================================
+
+/// Element tree of an onspeed config file, built in one pass.
+///
+/// Both the original <CONFIG> format (flat list of leaf elements) and
+/// <CONFIG2> (nested sections, repeated FLAP_POSITION blocks) are handled.
+/// The parser records where each element's name and text are in the
+/// caller's buffer and links parents to children; nothing is copied or
+/// allocated, so the buffer must outlive the index.
+///
+/// Supported: elements, text, self-closing elements, attributes (skipped),
+/// the <?xml?> declaration, comments and DOCTYPE (skipped). Element text is
+/// everything between the start and end tags of an element that has no
+/// children. The five predefined entities are decoded by copyText().
+class ConfigXml {
+public:
+    static constexpr uint16_t kMaxElements = 192;
+    static constexpr uint8_t  kMaxDepth    = 8;
+    static constexpr int16_t  kNone        = -1;
+
+    ConfigXml();
+
+    /// Index a document. On false (malformed, too deep, too many elements)
+    /// the index is empty.
+    bool parse(const char * pText, size_t uLen);
+
+    uint16_t size() const           { return _uCount; }
+    int16_t  root() const           { return _uCount > 0 ? 0 : kNone; }
+
+    ConfigText name(int16_t iElem) const;
+    ConfigText text(int16_t iElem) const;
+
+    /// First child of iParent, optionally the first one called szName.
+    int16_t firstChild(int16_t iParent, const char * szName = nullptr) const;
+
+    /// Next sibling of iElem, optionally the next one called szName.
+    int16_t nextSibling(int16_t iElem, const char * szName = nullptr) const;
+
+    // Value conversions. Like the tinyxml2 Query*Text() calls they replace,
+    // these return false and leave the output untouched when the text isn't
+    // a number (or boolean). Surrounding whitespace is ignored.
+
+    bool getInt(int16_t iElem, int & iValue) const;
+    bool getUnsigned(int16_t iElem, unsigned & uValue) const;
+    bool getFloat(int16_t iElem, float & fValue) const;
+
+    /// Integer (non-zero is true), or true / false in any of the usual cases.
+    bool getBool(int16_t iElem, bool & bValue) const;
+
+    /// Copy the element text to szOut with entities decoded, truncating to
+    /// uSize - 1 characters.
+    /// @return Characters written, not counting the NUL
+    size_t copyText(int16_t iElem, char * szOut, size_t uSize) const;
+
+private:
+    struct Element {
+        const char *    pName;
+        const char *    pText;
+        uint16_t        uNameLen;
+        uint16_t        uTextLen;
+        int16_t         iFirstChild;
+        int16_t         iNextSibling;
+    };
+
+    // Whitespace-trimmed text, NUL terminated, for the number parsers
+    bool numberText(int16_t iElem, char * szOut, size_t uSize) const;
+
+    Element     _aElems[kMaxElements];
+    uint16_t    _uCount;
+};
@@ -55,3 +55,35 @@ float CurveCalc(float x, const SuCalibrationCurve& curve) {
 
     return y;
 }
+
+// ============================================================================
+// SPECIALIZED EVALUATORS
+// ============================================================================
+
+CurveEvaluator CurveEvaluator::bind(const SuCalibrationCurve& curve) {
+    CurveEvaluator eval = {};
+
+    for (int i = 0; i < MAX_CURVE_COEFF; ++i) {
+        eval._afCoeff[i] = curve.afCoeff[i];
+    }
+
+    if (curve.iCurveType == 1) {
+        // Drop leading zero coefficients, keeping at least the constant
+        int iTerms = MAX_CURVE_COEFF;
+        while (iTerms > 1 && curve.afCoeff[MAX_CURVE_COEFF - iTerms] == 0.0f) {
+            --iTerms;
+        }
+        eval._enKind = Kind(int(Kind::Poly1) + iTerms - 1);
+    }
+    else if (curve.iCurveType == 2) {
+        eval._enKind = Kind::Log;
+    }
+    else if (curve.iCurveType == 3) {
+        eval._enKind = Kind::Exp;
+    }
+    else {
+        eval._enKind = Kind::None;
+    }
+
+    return eval;
+}
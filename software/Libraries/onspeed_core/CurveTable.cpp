@@ -0,0 +1,96 @@
+// CurveTable.cpp - Calibration curves compiled to a uniform knot table
+
+#include "CurveTable.h"
+#include "CurveCalc.h"
+
+#include <cmath>
+
+static const int kSearchSteps   = 4096;
+static const int kCheckPerKnot  = 16;
+
+static bool inLimits(float y)
+{
+    return y >= AOA_MIN_VALUE && y <= AOA_MAX_VALUE;    // false for NaN
+}
+
+bool buildCurveTable(const SuCalibrationCurve & curve, SuCurveTable & table, CurveInterp enInterp)
+{
+    table           = {};
+    table.enInterp  = enInterp;
+    table.fMaxError = INFINITY;
+
+    if (curve.iCurveType < 1 || curve.iCurveType > 3)
+        return false;
+
+    // Span of x where the curve gives an AOA inside the limits. Points in
+    // between that leave the limits (a polynomial turning round) stay in.
+    float fMin = NAN;
+    float fMax = NAN;
+    for (int n = 0; n <= kSearchSteps; n++) {
+        const float x = kCurveTableSearchMin + (kCurveTableSearchMax - kCurveTableSearchMin) * n / kSearchSteps;
+        if (inLimits(CurveCalc(x, curve))) {
+            if (std::isnan(fMin))
+                fMin = x;
+            fMax = x;
+        }
+    }
+    if (std::isnan(fMin) || !(fMax > fMin))
+        return false;
+
+    table.fMin     = fMin;
+    table.fMax     = fMax;
+    table.fStep    = (fMax - fMin) / (SuCurveTable::kKnots - 1);
+    table.fInvStep = 1.0f / table.fStep;
+
+    for (int i = 0; i < SuCurveTable::kKnots; i++) {
+        const float y = CurveCalc(fMin + table.fStep * i, curve);
+        if (!std::isfinite(y))
+            return false;
+        table.afY[i + 1] = y;
+    }
+
+    // Outer knots from the curve, or extrapolated where it doesn't exist
+    // (log curves stop at 0)
+    const float * pY  = table.afY;
+    const int     iN  = SuCurveTable::kKnots;
+    const float   fLo = CurveCalc(fMin - table.fStep, curve);
+    const float   fHi = CurveCalc(fMax + table.fStep, curve);
+    table.afY[0]      = std::isfinite(fLo) ? fLo : 3.0f * pY[1]  - 3.0f * pY[2]      + pY[3];
+    table.afY[iN + 1] = std::isfinite(fHi) ? fHi : 3.0f * pY[iN] - 3.0f * pY[iN - 1] + pY[iN - 2];
+
+    // Measure the worst error, then decide
+    table.bValid = true;
+    float fWorst = 0.0f;
+    for (int n = 0; n <= (SuCurveTable::kKnots - 1) * kCheckPerKnot; n++) {
+        const float x = fMin + table.fStep * n / kCheckPerKnot;
+        float       y;
+        if (x > fMax || !curveTableLookup(table, x, y))
+            continue;
+        const float fErr = std::fabs(y - CurveCalc(x, curve));
+        if (fErr > fWorst)
+            fWorst = fErr;
+    }
+    table.fMaxError = fWorst;
+    table.bValid    = fWorst <= kCurveTableMaxErrorDeg;
+    return table.bValid;
+}
+
+// ----------------------------------------------------------------------------
+
+float curveTableEval(const SuCurveTable & table, const SuCalibrationCurve & curve, float x)
+{
+    float y;
+    if (curveTableLookup(table, x, y))
+        return y;
+    return CurveCalc(x, curve);
+}
+
+// ----------------------------------------------------------------------------
+
+bool compileCurve(const SuCalibrationCurve & curve, SuCompiledCurve & compiled, bool bTable)
+{
+    compiled.Eval  = CurveEvaluator::bind(curve);
+    compiled.Table = {};
+
+    return bTable && buildCurveTable(curve, compiled.Table);
+}
@@ -0,0 +1,108 @@
+// CurveTable.h - Calibration curves compiled to a uniform knot table
+
+#pragma once
+
+#include "OnSpeedTypes.h"
+#include "CurveCalc.h"
+
+// ============================================================================
+// TABLE
+// ============================================================================
+
+enum class CurveInterp : uint8_t {
+    Linear,
+    Cubic,          ///< Catmull-Rom through the neighbouring knots
+};
+
+/// A calibration curve sampled on uniform knots over [fMin, fMax].
+///
+/// Built once when the config is published, if the firmware is built with
+/// AOA_CURVE_TABLE, so lookups skip the curve type dispatch and the log() /
+/// exp() of types 2 and 3, for up to kCurveTableMaxErrorDeg of
+/// interpolation error. Plain data so it can live in RuntimeConfig.
+/// afY[0] and afY[kKnots + 1] are extra knots one step outside the range
+/// for the cubic; the knot at fMin is afY[1].
+struct SuCurveTable {
+    static constexpr int kKnots = 65;
+
+    float       fMin;
+    float       fMax;
+    float       fStep;
+    float       fInvStep;
+    float       afY[kKnots + 2];
+    float       fMaxError;      ///< Worst |table - CurveCalc| over [fMin, fMax]
+    CurveInterp enInterp;
+    bool        bValid;         ///< False: use CurveCalc
+};
+
+/// Largest table error accepted. Past this buildCurveTable() leaves the
+/// table invalid and the analytic curve is used.
+constexpr float kCurveTableMaxErrorDeg = 0.01f;
+
+/// Build a table for curve. The range is the part of [kCurveTableSearchMin,
+/// kCurveTableSearchMax] where the curve is inside the AOA limits, so
+/// coeffP values that can only ever give a clamped AOA aren't tabled.
+/// fMaxError is measured against CurveCalc at 16 points per knot interval.
+/// @return bValid
+bool buildCurveTable(const SuCalibrationCurve & curve, SuCurveTable & table,
+                     CurveInterp enInterp = CurveInterp::Cubic);
+
+constexpr float kCurveTableSearchMin = -2.0f;
+constexpr float kCurveTableSearchMax =  4.0f;
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+
+/// Table value at x.
+/// @return false if the table is invalid or x is outside [fMin, fMax]
+inline bool curveTableLookup(const SuCurveTable & table, float x, float & y)
+{
+    if (!table.bValid || !(x >= table.fMin && x <= table.fMax))
+        return false;
+
+    const float fPos = (x - table.fMin) * table.fInvStep;
+    int         i    = int(fPos);
+    if (i > SuCurveTable::kKnots - 2)
+        i = SuCurveTable::kKnots - 2;
+    const float t    = fPos - float(i);
+
+    // Knot i is afY[i + 1]
+    const float * p = &table.afY[i];
+    if (table.enInterp == CurveInterp::Linear) {
+        y = p[1] + t * (p[2] - p[1]);
+    }
+    else {
+        y = p[1] + 0.5f * t * (p[2] - p[0]
+                 + t * (2.0f * p[0] - 5.0f * p[1] + 4.0f * p[2] - p[3]
+                 + t * (3.0f * (p[1] - p[2]) + p[3] - p[0])));
+    }
+    return true;
+}
+
+/// Table value where there is one, otherwise CurveCalc.
+float curveTableEval(const SuCurveTable & table, const SuCalibrationCurve & curve, float x);
+
+// ============================================================================
+// COMPILED CURVE
+// ============================================================================
+
+/// Everything worked out for a curve when the config is published: the
+/// bound evaluator, and optionally a table used where it is valid.
+struct SuCompiledCurve {
+    CurveEvaluator  Eval;
+    SuCurveTable    Table;
+};
+
+/// Bind curve, and build its table if bTable.
+/// @return True if the table is usable
+bool compileCurve(const SuCalibrationCurve & curve, SuCompiledCurve & compiled, bool bTable);
+
+/// Table value where there is one, otherwise the bound evaluator
+inline float compiledCurveEval(const SuCompiledCurve & compiled, float x)
+{
+    float y;
+    if (curveTableLookup(compiled.Table, x, y))
+        return y;
+    return compiled.Eval(x);
+}
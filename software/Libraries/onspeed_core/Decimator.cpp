@@ -0,0 +1,226 @@
+// Decimator.cpp - CIC and FIR decimators for oversampled pressure sensors
+
+#include "Decimator.h"
+
+#include <cmath>
+#include <cstring>
+
+static const float kPi = 3.14159265358979f;
+
+// ============================================================================
+// CIC DECIMATOR
+// ============================================================================
+
+CicDecimator::CicDecimator()
+{
+    configure(1, 1);
+}
+
+bool CicDecimator::configure(int iOrder, int iRate)
+{
+    bool bOk = iOrder >= 1 && iOrder <= kMaxOrder && iRate >= 1;
+
+    // Bit growth is iOrder * ceil(log2(iRate))
+    if (bOk) {
+        int iBits = 0;
+        while ((1 << iBits) < iRate)
+            iBits++;
+        bOk = iOrder * iBits + kInputBits <= 32;
+    }
+
+    if (!bOk) {
+        iOrder = 1;
+        iRate  = 1;
+    }
+
+    _iOrder = iOrder;
+    _iRate  = iRate;
+    _fScale = 1.0f / std::pow(float(iRate), float(iOrder));
+    reset();
+    return bOk;
+}
+
+void CicDecimator::reset()
+{
+    std::memset(_auInteg, 0, sizeof(_auInteg));
+    std::memset(_auComb,  0, sizeof(_auComb));
+    _iPhase  = 0;
+    _iWarmup = _iOrder;
+    _fOutput = 0.0f;
+}
+
+bool CicDecimator::push(int32_t iSample)
+{
+    uint32_t uValue = uint32_t(iSample);
+    for (int i = 0; i < _iOrder; i++) {
+        _auInteg[i] += uValue;
+        uValue = _auInteg[i];
+    }
+
+    if (++_iPhase < _iRate)
+        return false;
+    _iPhase = 0;
+
+    for (int i = 0; i < _iOrder; i++) {
+        const uint32_t uIn = uValue;
+        uValue    -= _auComb[i];
+        _auComb[i] = uIn;
+    }
+
+    if (_iWarmup > 0 && --_iWarmup > 0)
+        return false;
+
+    _fOutput = float(int32_t(uValue)) * _fScale;
+    return true;
+}
+
+float CicDecimator::response(float fNorm) const
+{
+    const float fDen = float(_iRate) * std::sin(kPi * fNorm);
+    if (std::fabs(fDen) < 1e-9f)
+        return 1.0f;
+
+    return std::pow(std::fabs(std::sin(kPi * fNorm * float(_iRate)) / fDen), float(_iOrder));
+}
+
+// ============================================================================
+// FIR DECIMATOR
+// ============================================================================
+
+FirDecimator::FirDecimator()
+{
+    const float fUnity = 1.0f;
+    configure(&fUnity, 1, 1);
+}
+
+bool FirDecimator::configure(const float * pfTaps, int iTaps, int iRate)
+{
+    if (!pfTaps || iTaps < 1 || iTaps > kMaxTaps || iRate < 1)
+        return false;
+
+    std::memcpy(_afTaps, pfTaps, sizeof(float) * size_t(iTaps));
+    _iTaps = iTaps;
+    _iRate = iRate;
+    reset();
+    return true;
+}
+
+bool FirDecimator::designLowpass(int iTaps, float fCutoffNorm, int iRate)
+{
+    if (iTaps < 1 || iTaps > kMaxTaps || fCutoffNorm <= 0.0f || fCutoffNorm >= 0.5f)
+        return false;
+
+    float        afTaps[kMaxTaps];
+    float        fSum    = 0.0f;
+    const float  fCenter = 0.5f * float(iTaps - 1);
+
+    for (int i = 0; i < iTaps; i++) {
+        const float fN    = float(i) - fCenter;
+        const float fSinc = (fN == 0.0f) ? 2.0f * fCutoffNorm
+                                         : std::sin(2.0f * kPi * fCutoffNorm * fN) / (kPi * fN);
+        const float fWin  = (iTaps == 1) ? 1.0f
+                                         : 0.54f - 0.46f * std::cos(2.0f * kPi * float(i) / float(iTaps - 1));
+        afTaps[i] = fSinc * fWin;
+        fSum     += afTaps[i];
+    }
+
+    for (int i = 0; i < iTaps; i++)
+        afTaps[i] /= fSum;
+
+    return configure(afTaps, iTaps, iRate);
+}
+
+void FirDecimator::reset()
+{
+    std::memset(_afHist, 0, sizeof(_afHist));
+    _iHead   = 0;
+    _iPhase  = 0;
+    _iFill   = 0;
+    _fOutput = 0.0f;
+}
+
+bool FirDecimator::push(float fSample)
+{
+    // Fill the history with the first sample so the output starts there
+    // instead of ramping up from zero
+    if (_iFill == 0) {
+        for (int i = 0; i < _iTaps; i++)
+            _afHist[i] = fSample;
+        _iFill = _iTaps;
+    }
+
+    _iHead = (_iHead + 1 == _iTaps) ? 0 : _iHead + 1;
+    _afHist[_iHead] = fSample;
+
+    if (++_iPhase < _iRate)
+        return false;
+    _iPhase = 0;
+
+    float fAcc = 0.0f;
+    int   iIdx = _iHead;
+    for (int i = 0; i < _iTaps; i++) {
+        fAcc += _afTaps[i] * _afHist[iIdx];
+        iIdx  = (iIdx == 0) ? _iTaps - 1 : iIdx - 1;
+    }
+
+    _fOutput = fAcc;
+    return true;
+}
+
+float FirDecimator::response(float fNorm) const
+{
+    float fRe = 0.0f;
+    float fIm = 0.0f;
+    for (int i = 0; i < _iTaps; i++) {
+        fRe += _afTaps[i] * std::cos(2.0f * kPi * fNorm * float(i));
+        fIm -= _afTaps[i] * std::sin(2.0f * kPi * fNorm * float(i));
+    }
+    return std::sqrt(fRe * fRe + fIm * fIm);
+}
+
+// ============================================================================
+// PRESSURE DECIMATOR
+// ============================================================================
+
+bool PressureDecimator::configure(int iInputHz, int iOutputHz, int iCicOrder, int iFirTaps)
+{
+    if (iOutputHz <= 0 || iInputHz < 2 * iOutputHz || iInputHz % (2 * iOutputHz) != 0)
+        return false;
+
+    // FIR runs at twice the output rate and passes up to 0.4 of the output rate
+    if (!_Cic.configure(iCicOrder, iInputHz / (2 * iOutputHz)) ||
+        !_Fir.designLowpass(iFirTaps, 0.2f, 2))
+        return false;
+
+    _iInputHz  = iInputHz;
+    _iOutputHz = iOutputHz;
+    return true;
+}
+
+void PressureDecimator::reset()
+{
+    _Cic.reset();
+    _Fir.reset();
+}
+
+bool PressureDecimator::push(int32_t iCounts)
+{
+    return _Cic.push(iCounts) && _Fir.push(_Cic.output());
+}
+
+float PressureDecimator::groupDelayMs() const
+{
+    if (_iInputHz == 0)
+        return 0.0f;
+
+    const float fMidHz = 2.0f * float(_iOutputHz);
+    return 1000.0f * (_Cic.groupDelay() / float(_iInputHz) + _Fir.groupDelay() / fMidHz);
+}
+
+float PressureDecimator::response(float fHz) const
+{
+    if (_iInputHz == 0)
+        return 1.0f;
+
+    return _Cic.response(fHz / float(_iInputHz)) * _Fir.response(fHz / (2.0f * float(_iOutputHz)));
+}
@@ -0,0 +1,154 @@
+// Decimator.h - CIC and FIR decimators for oversampled pressure sensors
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// CIC DECIMATOR
+// ============================================================================
+
+/// Cascaded integrator-comb decimator: iOrder moving sums of iRate samples,
+/// evaluated once per iRate inputs. No multiplies, and its nulls land on
+/// every multiple of the output rate, which is exactly where the noise that
+/// would alias down to DC sits.
+///
+/// Integer input (sensor counts). The integrators run in wrapping uint32_t
+/// arithmetic, which gives exact results as long as the input fits in
+/// kInputBits and iOrder * log2(iRate) + kInputBits <= 32.
+class CicDecimator {
+public:
+    static constexpr int kMaxOrder  = 5;
+    static constexpr int kInputBits = 16;
+
+    CicDecimator();
+
+    /// @return false (and leaves the decimator a pass-through) if the order or
+    ///         rate is out of range or the bit growth doesn't fit 32 bits
+    bool    configure(int iOrder, int iRate);
+    void    reset();
+
+    /// Add one input sample. The first iOrder outputs after a reset are
+    /// swallowed while the sums fill, so the first one reported is valid.
+    /// @return true when a new output is ready in output()
+    bool    push(int32_t iSample);
+
+    /// Last output, scaled for unity DC gain.
+    float   output() const          { return _fOutput; }
+
+    int     order() const           { return _iOrder; }
+    int     rate() const            { return _iRate; }
+
+    /// Group delay in input samples.
+    float   groupDelay() const      { return 0.5f * float(_iOrder * (_iRate - 1)); }
+
+    /// Magnitude response at fNorm = f / input sample rate.
+    float   response(float fNorm) const;
+
+private:
+    uint32_t    _auInteg[kMaxOrder];
+    uint32_t    _auComb[kMaxOrder];     ///< Previous input to each comb stage
+    int         _iOrder;
+    int         _iRate;
+    int         _iPhase;
+    int         _iWarmup;               ///< Outputs still to swallow
+    float       _fScale;                ///< 1 / iRate^iOrder
+    float       _fOutput;
+};
+
+// ============================================================================
+// FIR DECIMATOR
+// ============================================================================
+
+/// Direct form FIR filter that only computes every iRate'th output.
+/// Taps are either supplied or designed here as a windowed-sinc lowpass.
+class FirDecimator {
+public:
+    static constexpr int kMaxTaps = 32;
+
+    FirDecimator();
+
+    /// Use the given taps.
+    /// @return false if iTaps or iRate is out of range
+    bool    configure(const float * pfTaps, int iTaps, int iRate);
+
+    /// Design a Hamming windowed-sinc lowpass with unity DC gain.
+    /// @param fCutoffNorm -6 dB point as a fraction of the input rate (< 0.5)
+    bool    designLowpass(int iTaps, float fCutoffNorm, int iRate);
+
+    void    reset();
+
+    /// Add one input sample.
+    /// @return true when a new output is ready in output()
+    bool    push(float fSample);
+
+    float   output() const          { return _fOutput; }
+
+    int     tapCount() const        { return _iTaps; }
+    float   tap(int i) const        { return _afTaps[i]; }
+    int     rate() const            { return _iRate; }
+
+    /// Group delay in input samples. The designed taps are symmetric, so
+    /// this is exact and the same at every frequency.
+    float   groupDelay() const      { return 0.5f * float(_iTaps - 1); }
+
+    /// Magnitude response at fNorm = f / input sample rate.
+    float   response(float fNorm) const;
+
+private:
+    float       _afTaps[kMaxTaps];
+    float       _afHist[kMaxTaps];      ///< Circular, _iHead is the newest
+    int         _iTaps;
+    int         _iRate;
+    int         _iHead;
+    int         _iPhase;
+    int         _iFill;                 ///< Nonzero once the history is primed
+    float       _fOutput;
+};
+
+// ============================================================================
+// PRESSURE DECIMATOR
+// ============================================================================
+
+/// The oversampled pressure chain: a CIC stage down to twice the output
+/// rate, then a short FIR lowpass that halves it again and cleans up what
+/// the CIC lets through between its nulls.
+///
+/// For 1 kHz in and 50 Hz out with the defaults this is a 3rd order CIC of
+/// rate 10 and a 9 tap FIR, with about 54 ms of total group delay.
+class PressureDecimator {
+public:
+    static constexpr int kDefaultCicOrder = 3;
+    static constexpr int kDefaultFirTaps  = 9;
+
+    /// @return false if iInputHz is not a multiple of 2 * iOutputHz or a
+    ///         stage rejects its settings
+    bool    configure(int iInputHz, int iOutputHz,
+                      int iCicOrder = kDefaultCicOrder, int iFirTaps = kDefaultFirTaps);
+    void    reset();
+
+    /// Add one raw count sample.
+    /// @return true when a new output is ready in output()
+    bool    push(int32_t iCounts);
+
+    float   output() const          { return _Fir.output(); }
+
+    int     inputHz() const         { return _iInputHz; }
+    int     outputHz() const        { return _iOutputHz; }
+
+    /// Total group delay in milliseconds.
+    float   groupDelayMs() const;
+
+    /// Magnitude response at fHz.
+    float   response(float fHz) const;
+
+    const CicDecimator & cic() const { return _Cic; }
+    const FirDecimator & fir() const { return _Fir; }
+
+private:
+    CicDecimator    _Cic;
+    FirDecimator    _Fir;
+    int             _iInputHz  = 0;
+    int             _iOutputHz = 0;
+};
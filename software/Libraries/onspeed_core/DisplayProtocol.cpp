@@ -0,0 +1,276 @@
+// DisplayProtocol.cpp - Display serial link: ONSPEED and G3X text sentences and a framed binary form
+
+#include "DisplayProtocol.h"
+#include "Checksum.h"
+
+#include <cstdio>
+
+// ============================================================================
+// TEXT SENTENCES
+// ============================================================================
+
+// Append the two hex digit additive checksum of szOut[0, uLen) and CR LF
+static size_t finishSentence(char * szOut, size_t uSize, size_t uLen)
+{
+    if (uLen + 5 > uSize)
+        return 0;
+    snprintf(szOut + uLen, uSize - uLen, "%02X\r\n", sum8(szOut, uLen));
+    return uLen + 4;
+}
+
+//  0 - #                         Escape character  '#'
+//  1 - 1                         Sentence ID '1'
+//  2 - %+04i  Pitch              Pitch, 4 bytes, 0.1 degree, positive = up
+//  6 - %+05i  Roll               Roll, 5 bytes, 0.1 degree, positive = right
+// 11 - %04u   IAS                IAS, 4 bytes, 0.1 kts
+// 15 - %+06i  PALT               PALT, 6 bytes, 1 ft
+// 21 - %+05i  Rate of Turn       Rate of Turn,  5 bytes, .1 deg/sec, positive = right
+// 26 - %+03i  LateralG           Lateral G, 3 bytes , 0.01g, positive = leftward
+// 29 - %+03i  VerticalG          VerticalG, 3 bytes, 0.1g, positive = upward
+// 32 - %02i   Percent Lift       Percent Lift, 2 bytes, 00-99%
+// 34 - %+04i  AOA Degrees        AOA Degrees, 4 bytes, 0.1 degree
+// 38 - %+04i  iVSI               iVSI, 4 bytes, 10 fpm, positive up [-999;999]
+// 42 - %+03i  OAT                OAT, 3 bytes, 1 deg C
+// 45 - %+04i  FlightPath         FlightPath angle, 4 bytes, 0.1 degree
+// 49 - %+03i  Flaps              Flaps Pos, 3 bytes, 1 degree, with +/-sign
+// 52 - %+04i  StallWarn          StallWarn AOA, 4 bytes, 0.1 degrees
+// 56 - %+04i  OnSpeedSlow        OnSpeedSlow AOA, 4 bytes, 0.1 degrees
+// 60 - %+04i  OnSpeedFast        OnSpeedFast AOA, 4 bytes, 0.1 degrees
+// 64 - %+04i  Tones On           Tones On AOA, 4 bytes, 0.1 degrees
+// 68 - %+04i  G onset rate       G onset rate, 4 bytes, 0.01 G/sec
+// 72 - %+02i  Spin Recovery Cue  Spin Recovery Cue, 2 bytes, -1/0/+1
+// 74 - %02u   DataMark           DataMark, 2 bytes
+// 76 -                           Checksum, 2 bytes, ASCII HEX, sum of all previous bytes
+// 78 -                           CR/LF,2 bytes, 0x0D 0x0A
+
+size_t formatOnSpeedSentence(const DisplayData & data, char * szOut, size_t uSize)
+{
+    const int iChars = snprintf(szOut, uSize,
+        "#1%+04i%+05i%04u%+06i%+05i%+03i%+03i%02u%+04i%+04i%+03i%+04i%+03i%+04i%+04i%+04i%+04i%+04i%+02i%02u",
+        int(data.iPitch10),
+        int(data.iRoll10),
+        unsigned(data.uIas10),
+        int(data.iPaltFt),
+        int(data.iYawRate10),
+        int(data.iLatG100),
+        int(data.iVertG10),
+        unsigned(data.uPctLift),
+        int(data.iAoa10),
+        int(data.iVsi10Fpm),
+        int(data.iOatC),
+        int(data.iFpa10),
+        int(data.iFlapsDeg),
+        int(data.iStall10),
+        int(data.iSlow10),
+        int(data.iFast10),
+        int(data.iLdMax10),
+        int(data.iOnset100),
+        int(data.iSpinCue),
+        unsigned(data.uDataMark));
+
+    if (iChars != int(kOnSpeedSentenceLen) - 4)
+        return 0;
+    return finishSentence(szOut, uSize, size_t(iChars));
+}
+
+size_t formatG3xSentence(const DisplayData & data, char * szOut, size_t uSize)
+{
+    const int iChars = snprintf(szOut, uSize,
+        "=1100000000%+04i%+05i___%04u%+06i____%+03i%+03i%02u__________",
+        int(data.iPitch10),
+        int(data.iRoll10),
+        unsigned(data.uIas10),
+        int(data.iPaltFt),
+        int(data.iLatG100),
+        int(data.iVertG10),
+        unsigned(data.uPctLift));
+
+    if (iChars != int(kG3xSentenceLen) - 4)
+        return 0;
+    return finishSentence(szOut, uSize, size_t(iChars));
+}
+
+// ============================================================================
+// BINARY FRAMES
+// ============================================================================
+
+// Flight payload, little-endian:
+//  0 i16 pitch      2 i16 roll       4 u16 IAS        6 i24 palt
+//  9 i16 yaw rate  11 i8  lat G     12 i8  vert G    13 u8  % lift
+// 14 i16 AOA       16 i16 VSI       18 i8  OAT       19 i16 FPA
+// 21 i8  flaps     22 i16 G onset   24 i8  spin cue  25 u8  data mark
+//
+// Setpoint payload: i16 stall, slow, fast, L/D max
+
+static uint8_t * put8 (uint8_t * p, uint8_t  v) { p[0] = v; return p + 1; }
+static uint8_t * put16(uint8_t * p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); return p + 2; }
+static uint8_t * put24(uint8_t * p, uint32_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); p[2] = uint8_t(v >> 16); return p + 3; }
+
+static uint16_t get16(const uint8_t * p) { return uint16_t(p[0] | (p[1] << 8)); }
+
+static int32_t getI24(const uint8_t * p)
+{
+    const uint32_t v = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+    return (v & 0x800000u) ? int32_t(v | 0xFF000000u) : int32_t(v);
+}
+
+// Header, then payload written by the caller between the two, then CRC
+static uint8_t * startFrame(uint8_t * p, uint8_t uType, uint8_t uPayload, uint8_t uSeq)
+{
+    p[0] = kDisplaySync1;
+    p[1] = kDisplaySync2;
+    p[2] = uType;
+    p[3] = uPayload;
+    p[4] = uSeq;
+    return p + 5;
+}
+
+static size_t finishFrame(uint8_t * pFrame, uint8_t * p)
+{
+    const uint16_t uCrc = crc16Ccitt(pFrame + 2, size_t(p - pFrame) - 2);
+    p = put16(p, uCrc);
+    return size_t(p - pFrame);
+}
+
+size_t encodeDisplayFlight(const DisplayData & data, uint8_t uSeq, uint8_t * pOut, size_t uSize)
+{
+    if (uSize < kDisplayFlightFrameLen)
+        return 0;
+
+    uint8_t * p = startFrame(pOut, kDisplayMsgFlight, kDisplayFlightPayload, uSeq);
+    p = put16(p, uint16_t(data.iPitch10));
+    p = put16(p, uint16_t(data.iRoll10));
+    p = put16(p, data.uIas10);
+    p = put24(p, uint32_t(data.iPaltFt));
+    p = put16(p, uint16_t(data.iYawRate10));
+    p = put8 (p, uint8_t(data.iLatG100));
+    p = put8 (p, uint8_t(data.iVertG10));
+    p = put8 (p, data.uPctLift);
+    p = put16(p, uint16_t(data.iAoa10));
+    p = put16(p, uint16_t(data.iVsi10Fpm));
+    p = put8 (p, uint8_t(data.iOatC));
+    p = put16(p, uint16_t(data.iFpa10));
+    p = put8 (p, uint8_t(data.iFlapsDeg));
+    p = put16(p, uint16_t(data.iOnset100));
+    p = put8 (p, uint8_t(data.iSpinCue));
+    p = put8 (p, data.uDataMark);
+    return finishFrame(pOut, p);
+}
+
+size_t encodeDisplaySetpoints(const DisplayData & data, uint8_t uSeq, uint8_t * pOut, size_t uSize)
+{
+    if (uSize < kDisplaySetpointFrameLen)
+        return 0;
+
+    uint8_t * p = startFrame(pOut, kDisplayMsgSetpoints, kDisplaySetpointPayload, uSeq);
+    p = put16(p, uint16_t(data.iStall10));
+    p = put16(p, uint16_t(data.iSlow10));
+    p = put16(p, uint16_t(data.iFast10));
+    p = put16(p, uint16_t(data.iLdMax10));
+    return finishFrame(pOut, p);
+}
+
+DisplayDecodeResult decodeDisplayFrame(const uint8_t * pFrame, size_t uLen, DisplayData & data, uint8_t * puSeq)
+{
+    if (uLen < kDisplayFrameOverhead || uLen != size_t(pFrame[3]) + kDisplayFrameOverhead)
+        return DisplayDecodeResult::BadLength;
+    if (pFrame[0] != kDisplaySync1 || pFrame[1] != kDisplaySync2)
+        return DisplayDecodeResult::BadHeader;
+    if (crc16Ccitt(pFrame + 2, uLen - 4) != get16(pFrame + uLen - 2))
+        return DisplayDecodeResult::BadCrc;
+
+    const uint8_t   uType = pFrame[2];
+    const uint8_t * p     = pFrame + 5;
+
+    if (uType == kDisplayMsgFlight) {
+        if (pFrame[3] != kDisplayFlightPayload)
+            return DisplayDecodeResult::BadLength;
+        data.iPitch10   = int16_t(get16(p +  0));
+        data.iRoll10    = int16_t(get16(p +  2));
+        data.uIas10     =         get16(p +  4);
+        data.iPaltFt    =         getI24(p + 6);
+        data.iYawRate10 = int16_t(get16(p +  9));
+        data.iLatG100   = int8_t (p[11]);
+        data.iVertG10   = int8_t (p[12]);
+        data.uPctLift   =         p[13];
+        data.iAoa10     = int16_t(get16(p + 14));
+        data.iVsi10Fpm  = int16_t(get16(p + 16));
+        data.iOatC      = int8_t (p[18]);
+        data.iFpa10     = int16_t(get16(p + 19));
+        data.iFlapsDeg  = int8_t (p[21]);
+        data.iOnset100  = int16_t(get16(p + 22));
+        data.iSpinCue   = int8_t (p[24]);
+        data.uDataMark  =         p[25];
+    } else if (uType == kDisplayMsgSetpoints) {
+        if (pFrame[3] != kDisplaySetpointPayload)
+            return DisplayDecodeResult::BadLength;
+        data.iStall10   = int16_t(get16(p + 0));
+        data.iSlow10    = int16_t(get16(p + 2));
+        data.iFast10    = int16_t(get16(p + 4));
+        data.iLdMax10   = int16_t(get16(p + 6));
+    } else {
+        return DisplayDecodeResult::UnknownType;
+    }
+
+    if (puSeq)
+        *puSeq = pFrame[4];
+    return DisplayDecodeResult::Ok;
+}
+
+// ============================================================================
+// FRAMER
+// ============================================================================
+
+DisplayFramer::DisplayFramer(uint32_t uByteTimeUs)
+    : SerialFramer(_aBuf, sizeof(_aBuf), uByteTimeUs)
+{
+}
+
+SerialFramer::EnStep DisplayFramer::consume(uint8_t b)
+{
+    switch (_uLen) {
+        case 0:
+            if (b == kDisplaySync1) {
+                beginFrame();
+                append(b);
+            } else {
+                discard();
+            }
+            return EnStep::NeedMore;
+
+        case 1:
+            if (b == kDisplaySync2) {
+                append(b);
+            } else {
+                discard();
+                _uLen = 0;
+                if (b == kDisplaySync1) {
+                    beginFrame();
+                    append(b);
+                } else {
+                    discard();
+                }
+            }
+            return EnStep::NeedMore;
+
+        case 3:     // Payload length
+            if (b > kDisplayMaxPayload) {
+                discard(4);
+                _uLen = 0;
+                return EnStep::NeedMore;
+            }
+            append(b);
+            return EnStep::NeedMore;
+
+        default:
+            append(b);
+            if (_uLen >= 4 && _uLen >= size_t(_pBuf[3]) + kDisplayFrameOverhead)
+                return EnStep::Complete;
+            return EnStep::NeedMore;
+    }
+}
+
+bool DisplayFramer::validate(const uint8_t * pData, size_t uLen)
+{
+    return crc16Ccitt(pData + 2, uLen - 4) == get16(pData + uLen - 2);
+}
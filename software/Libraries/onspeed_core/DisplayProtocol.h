@@ -0,0 +1,117 @@
+// DisplayProtocol.h - Display serial link: ONSPEED and G3X text sentences and a framed binary form
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SerialFramer.h"
+
+// ============================================================================
+// DISPLAY DATA
+// ============================================================================
+
+/// One display update in the fixed-point units the sentences carry.
+///
+/// The caller scales and clamps; every encoder sends these values as is.
+/// Ranges are the widths of the text fields.
+struct DisplayData {
+    int16_t     iPitch10;       ///< 0.1 deg, positive up, [-999, 999]
+    int16_t     iRoll10;        ///< 0.1 deg, positive right, [-9999, 9999]
+    uint16_t    uIas10;         ///< 0.1 kt, [0, 9999]
+    int32_t     iPaltFt;        ///< ft, [-99999, 99999]
+    int16_t     iYawRate10;     ///< Rate of turn, 0.1 deg/s, positive right, [-9999, 9999]
+    int8_t      iLatG100;       ///< 0.01 g, positive left, [-99, 99]
+    int8_t      iVertG10;       ///< 0.1 g, positive up, [-99, 99]
+    uint8_t     uPctLift;       ///< [0, 99]
+    int16_t     iAoa10;         ///< 0.1 deg, [-999, 999]
+    int16_t     iVsi10Fpm;      ///< 10 fpm, positive up, [-999, 999]
+    int8_t      iOatC;          ///< deg C, [-99, 99]
+    int16_t     iFpa10;         ///< Flight path angle, 0.1 deg, [-999, 999]
+    int8_t      iFlapsDeg;      ///< [-99, 99]
+    int16_t     iStall10;       ///< Stall warning AOA, 0.1 deg, [-999, 999]
+    int16_t     iSlow10;        ///< On-speed slow AOA
+    int16_t     iFast10;        ///< On-speed fast AOA
+    int16_t     iLdMax10;       ///< L/D max AOA (tones on)
+    int16_t     iOnset100;      ///< G onset rate, 0.01 g/s, [-999, 999]
+    int8_t      iSpinCue;       ///< Spin recovery cue, -1 / 0 / +1
+    uint8_t     uDataMark;      ///< [0, 99]
+};
+
+// ============================================================================
+// TEXT SENTENCES
+// ============================================================================
+// Both are fixed length, followed by the additive checksum as two hex digits
+// and CR LF. The output is byte for byte what the display has always
+// received.
+
+constexpr size_t kOnSpeedSentenceLen = 80;  ///< "#1..." incl. checksum and CR LF
+constexpr size_t kG3xSentenceLen     = 59;  ///< "=11..." incl. checksum and CR LF
+
+/// Format an ONSPEED "#1" sentence.
+/// @param uSize Size of szOut, at least kOnSpeedSentenceLen + 1
+/// @return Bytes to send (kOnSpeedSentenceLen), 0 if a field overflowed
+size_t formatOnSpeedSentence(const DisplayData & data, char * szOut, size_t uSize);
+
+/// Format a Garmin G3X "=11" attitude sentence.
+/// @param uSize Size of szOut, at least kG3xSentenceLen + 1
+/// @return Bytes to send (kG3xSentenceLen), 0 if a field overflowed
+size_t formatG3xSentence(const DisplayData & data, char * szOut, size_t uSize);
+
+// ============================================================================
+// BINARY FRAMES
+// ============================================================================
+// Frame: sync 0xA5 0x5A, message type, payload length, sequence number,
+// payload (little-endian), CRC-16-CCITT of type through payload, little-endian.
+//
+// Flight frames carry everything that changes every update. Setpoint frames
+// carry the flap-dependent AOA setpoints and only need to go out when they
+// change (and now and then so a display that just powered up gets them).
+
+constexpr uint8_t  kDisplaySync1           = 0xA5;
+constexpr uint8_t  kDisplaySync2           = 0x5A;
+constexpr uint8_t  kDisplayMsgFlight       = 0x01;
+constexpr uint8_t  kDisplayMsgSetpoints    = 0x02;
+constexpr uint8_t  kDisplayFlightPayload   = 26;
+constexpr uint8_t  kDisplaySetpointPayload = 8;
+constexpr size_t   kDisplayFrameOverhead   = 7;    ///< Header 5 + CRC 2
+constexpr uint8_t  kDisplayMaxPayload      = 64;
+
+constexpr size_t   kDisplayFlightFrameLen   = kDisplayFlightPayload   + kDisplayFrameOverhead;
+constexpr size_t   kDisplaySetpointFrameLen = kDisplaySetpointPayload + kDisplayFrameOverhead;
+
+/// Encode a flight frame.
+/// @return Frame length (kDisplayFlightFrameLen), 0 if uSize is too small
+size_t encodeDisplayFlight(const DisplayData & data, uint8_t uSeq, uint8_t * pOut, size_t uSize);
+
+/// Encode a setpoint frame.
+/// @return Frame length (kDisplaySetpointFrameLen), 0 if uSize is too small
+size_t encodeDisplaySetpoints(const DisplayData & data, uint8_t uSeq, uint8_t * pOut, size_t uSize);
+
+enum class DisplayDecodeResult : uint8_t {
+    Ok,             ///< Fields carried by this message type updated
+    BadLength,      ///< Truncated, or payload length wrong for the type
+    BadHeader,      ///< Not sync bytes
+    BadCrc,
+    UnknownType     ///< Good frame of a type this decoder doesn't know; skip it
+};
+
+/// Reference decoder for one complete frame. Fields the message type
+/// doesn't carry keep their previous values.
+/// @param puSeq Receives the sequence number, may be nullptr
+DisplayDecodeResult decodeDisplayFrame(const uint8_t * pFrame, size_t uLen, DisplayData & data,
+                                       uint8_t * puSeq = nullptr);
+
+/// Finds binary display frames in a byte stream (display side, and tests).
+/// Frames with a bad CRC are counted as rejected and dropped.
+class DisplayFramer : public SerialFramer {
+public:
+    explicit DisplayFramer(uint32_t uByteTimeUs);
+
+protected:
+    EnStep consume(uint8_t b) override;
+    bool validate(const uint8_t * pData, size_t uLen) override;
+
+private:
+    uint8_t _aBuf[kDisplayMaxPayload + kDisplayFrameOverhead];
+};
@@ -0,0 +1,91 @@
+// Ds18b20.cpp - Non-blocking DS18B20 temperature reader over a 1-Wire bus
+
+#include "Ds18b20.h"
+#include "Checksum.h"
+
+// Scratchpad temperature register after power on, before any conversion
+static const int16_t kPowerOnCounts = 0x0550;     // 85 C
+
+Ds18b20Reader::Ds18b20Reader(OneWirePort * pBus, uint32_t uPeriodMs)
+{
+    _pBus          = pBus;
+    _uPeriodMs     = uPeriodMs;
+    _enState       = State::Idle;
+    _bStarted      = false;
+    _uStartMs      = 0;
+    _uReadingMs    = 0;
+    _iScratchBytes = 0;
+    _fTempC        = 0.0f;
+    _bValid        = false;
+    _uReadings     = 0;
+    _uErrors       = 0;
+}
+
+void Ds18b20Reader::update(uint32_t uNowMs)
+{
+    if (_pBus == nullptr)
+        return;
+
+    switch (_enState) {
+    case State::Idle:
+        if (_bStarted && uNowMs - _uStartMs < _uPeriodMs)
+            return;
+
+        // Start a conversion. Retry a missing sensor next period.
+        _bStarted = true;
+        _uStartMs = uNowMs;
+        if (!_pBus->reset()) {
+            _uErrors++;
+            return;
+        }
+        _pBus->write(kSkipRom);
+        _pBus->write(kConvertT);
+        _enState = State::Converting;
+        return;
+
+    case State::Converting:
+        if (uNowMs - _uStartMs < kConvertMs)
+            return;
+
+        if (!_pBus->reset()) {
+            _uErrors++;
+            _enState = State::Idle;
+            return;
+        }
+        _pBus->write(kSkipRom);
+        _pBus->write(kReadScratchpad);
+        _iScratchBytes = 0;
+        _enState       = State::Reading;
+        return;
+
+    case State::Reading:
+        for (int i = 0; i < kBytesPerUpdate && _iScratchBytes < int(sizeof(_aScratch)); i++)
+            _aScratch[_iScratchBytes++] = _pBus->read();
+
+        if (_iScratchBytes == int(sizeof(_aScratch))) {
+            finishRead(uNowMs);
+            _enState = State::Idle;
+        }
+        return;
+    }
+}
+
+void Ds18b20Reader::finishRead(uint32_t uNowMs)
+{
+    const int16_t iCounts = int16_t(uint16_t(_aScratch[0]) | (uint16_t(_aScratch[1]) << 8));
+
+    // CRC alone passes an all zero read from a shorted bus, so also check
+    // the config register's always-one low bits. 85 C is the power-on value,
+    // meaning the conversion never ran.
+    if (crc8Maxim(_aScratch, sizeof(_aScratch)) != 0 ||
+        (_aScratch[4] & 0x1F) != 0x1F ||
+        iCounts == kPowerOnCounts) {
+        _uErrors++;
+        return;
+    }
+
+    _fTempC     = float(iCounts) / 16.0f;
+    _bValid     = true;
+    _uReadingMs = uNowMs;
+    _uReadings++;
+}
@@ -0,0 +1,83 @@
+// Ds18b20.h - Non-blocking DS18B20 temperature reader over a 1-Wire bus
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// BUS
+// ============================================================================
+
+/// The 1-Wire primitives the reader needs. On the ESP32 this wraps the
+/// Arduino OneWire library; in native tests it is a fake sensor.
+class OneWirePort {
+public:
+    virtual ~OneWirePort() = default;
+
+    /// Reset pulse. @return true if a device answered with a presence pulse
+    virtual bool    reset() = 0;
+    virtual void    write(uint8_t uByte) = 0;
+    virtual uint8_t read() = 0;
+};
+
+// ============================================================================
+// READER
+// ============================================================================
+
+/// Reads a single DS18B20 (skip ROM) without ever waiting on it.
+///
+/// Call update() once per sensor cycle. Each call does at most one short
+/// piece of bus work, a couple of msec at most, and returns: start a
+/// conversion, then once the conversion time has passed, send the read
+/// command, then read the scratchpad a few bytes per call. A CRC-checked
+/// result is cached in tempC() until the next one replaces it.
+class Ds18b20Reader {
+public:
+    static constexpr uint32_t kConvertMs      = 750;   ///< 12 bit conversion, worst case
+    static constexpr uint32_t kDefaultPeriodMs = 1000;
+    static constexpr int      kBytesPerUpdate = 3;     ///< Scratchpad bytes read per update()
+    static constexpr uint8_t  kSkipRom        = 0xCC;
+    static constexpr uint8_t  kConvertT       = 0x44;
+    static constexpr uint8_t  kReadScratchpad = 0xBE;
+
+    enum class State : uint8_t {
+        Idle,           ///< Waiting for the next period
+        Converting,     ///< Conversion started, waiting kConvertMs
+        Reading,        ///< Read command sent, collecting scratchpad bytes
+    };
+
+    explicit Ds18b20Reader(OneWirePort * pBus = nullptr, uint32_t uPeriodMs = kDefaultPeriodMs);
+
+    void        setBus(OneWirePort * pBus)      { _pBus = pBus; }
+
+    /// Do the next step if it is due. uNowMs is a free running msec clock.
+    void        update(uint32_t uNowMs);
+
+    /// Last good temperature, degrees C. Only meaningful once valid().
+    float       tempC() const                   { return _fTempC; }
+    bool        valid() const                   { return _bValid; }
+
+    /// msec since the last good reading.
+    uint32_t    ageMs(uint32_t uNowMs) const    { return uNowMs - _uReadingMs; }
+
+    State       state() const                   { return _enState; }
+    uint32_t    readings() const                { return _uReadings; }
+    uint32_t    errors() const                  { return _uErrors; }    ///< No presence, bad CRC or power-on value
+
+private:
+    void        finishRead(uint32_t uNowMs);
+
+    OneWirePort   * _pBus;
+    uint32_t        _uPeriodMs;
+    State           _enState;
+    bool            _bStarted;          ///< A conversion has been started at least once
+    uint32_t        _uStartMs;          ///< Last conversion start
+    uint32_t        _uReadingMs;        ///< Last good reading
+    uint8_t         _aScratch[9];
+    int             _iScratchBytes;
+    float           _fTempC;
+    bool            _bValid;
+    uint32_t        _uReadings;
+    uint32_t        _uErrors;
+};
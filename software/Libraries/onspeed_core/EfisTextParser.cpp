@@ -0,0 +1,234 @@
+// EfisTextParser.cpp - Fixed-offset decoders for Dynon and Garmin text EFIS sentences
+
+#include "EfisTextParser.h"
+#include "Checksum.h"
+
+#include <cstring>
+
+// ============================================================================
+// FIELD TABLES
+// ============================================================================
+// Offsets are zero-based character positions in the received line.
+
+// Dynon SkyView ADAHRS, "!1". All-'X' fields are set to an out-of-range value.
+static constexpr EfisTextField kSkyViewAdahrsFields[] = {
+    // off wid  float target              int target               scale factor  invalid
+    {  23,  4, &EfisData::IAS,            nullptr,                  10,   1.0,       -1.0f },  // knots
+    {  11,  4, &EfisData::Pitch,          nullptr,                  10,   1.0,     -100.0f },  // degrees
+    {  15,  5, &EfisData::Roll,           nullptr,                  10,   1.0,     -180.0f },  // degrees
+    {  20,  3, nullptr,                   &EfisData::Heading,        1,   1.0,       -1.0f },
+    {  37,  3, &EfisData::LateralG,       nullptr,                 100,   1.0,     -100.0f },
+    {  40,  3, &EfisData::VerticalG,      nullptr,                  10,   1.0,     -100.0f },
+    {  43,  2, nullptr,                   &EfisData::PercentLift,    1,   1.0,       -1.0f },  // 00 to 99
+    {  27,  6, nullptr,                   &EfisData::Palt,           1,   1.0,   -10000.0f },  // feet
+    {  45,  4, nullptr,                   &EfisData::VSI,           10,   1.0,   -10000.0f },  // 10s of feet/min
+    {  52,  4, &EfisData::TAS,            nullptr,                  10,   1.0,       -1.0f },  // knots
+    {  49,  3, &EfisData::OAT,            nullptr,                   1,   1.0,     -100.0f },  // Celsius
+};
+
+// Dynon SkyView EMS, "!3"
+static constexpr EfisTextField kSkyViewEmsFields[] = {
+    {  44,  3, &EfisData::FuelRemaining,  nullptr,                  10,   1.0,       -1.0f },  // gallons
+    {  29,  3, &EfisData::FuelFlow,       nullptr,                  10,   1.0,       -1.0f },  // gph
+    {  26,  3, &EfisData::MAP,            nullptr,                  10,   1.0,       -1.0f },  // inHg
+    {  18,  4, nullptr,                   &EfisData::RPM,            1,   1.0,       -1.0f },
+    { 217,  3, nullptr,                   &EfisData::PercentPower,   1,   1.0,       -1.0f },
+};
+
+// Dynon D10/D100. No sentinel. Pressure altitude and VSI depend on a status
+// bit and use different arithmetic so parseDynonD10Line() handles them.
+static constexpr EfisTextField kDynonD10Fields[] = {
+    {  20,  4, &EfisData::IAS,            nullptr,                  10,   1.94384,    0.0f },  // m/s to knots
+    {   8,  4, &EfisData::Pitch,          nullptr,                  10,   1.0,        0.0f },
+    {  12,  5, &EfisData::Roll,           nullptr,                  10,   1.0,        0.0f },
+    {  33,  3, &EfisData::LateralG,       nullptr,                 100,   1.0,        0.0f },
+    {  36,  3, &EfisData::VerticalG,      nullptr,                  10,   1.0,        0.0f },
+    {  39,  2, nullptr,                   &EfisData::PercentLift,    1,   1.0,        0.0f },  // 00 to 99
+};
+
+// Garmin attitude, "=11". All-'_' fields keep their previous value.
+// The G5 uses the first 8 entries; the G3X adds percent lift and OAT.
+static constexpr EfisTextField kGarminAttitudeFields[] = {
+    {  23,  4, &EfisData::IAS,            nullptr,                  10,   1.0,        0.0f },
+    {  11,  4, &EfisData::Pitch,          nullptr,                  10,   1.0,        0.0f },
+    {  15,  5, &EfisData::Roll,           nullptr,                  10,   1.0,        0.0f },
+    {  20,  3, nullptr,                   &EfisData::Heading,        1,   1.0,        0.0f },
+    {  37,  3, &EfisData::LateralG,       nullptr,                 100,   1.0,        0.0f },
+    {  40,  3, &EfisData::VerticalG,      nullptr,                  10,   1.0,        0.0f },
+    {  27,  6, nullptr,                   &EfisData::Palt,           1,   1.0,        0.0f },  // feet
+    {  45,  4, nullptr,                   &EfisData::VSI,           10,   1.0,        0.0f },  // 10 fpm
+    {  43,  2, nullptr,                   &EfisData::PercentLift,    1,   1.0,        0.0f },  // G3X only
+    {  49,  3, &EfisData::OAT,            nullptr,                   1,   1.0,        0.0f },  // G3X only, Celsius
+};
+static constexpr uint8_t kGarminG5FieldCount = 8;
+
+// Garmin G3X engine, "=31"
+static constexpr EfisTextField kGarminEngineFields[] = {
+    {  44,  3, &EfisData::FuelRemaining,  nullptr,                  10,   1.0,        0.0f },
+    {  29,  3, &EfisData::FuelFlow,       nullptr,                  10,   1.0,        0.0f },
+    {  26,  3, &EfisData::MAP,            nullptr,                  10,   1.0,        0.0f },
+    {  18,  4, nullptr,                   &EfisData::RPM,            1,   1.0,        0.0f },
+};
+
+#define FIELD_COUNT(a)  static_cast<uint8_t>(sizeof(a) / sizeof(a[0]))
+
+//                                          prefix  len  crc  sentinel set-invalid time  fields
+const EfisSentenceFormat kSkyViewAdahrs  = { "!1",   74,  70,   'X',     true,       3,  kSkyViewAdahrsFields,  FIELD_COUNT(kSkyViewAdahrsFields)  };
+const EfisSentenceFormat kSkyViewEms     = { "!3",  225, 221,   'X',     true,      -1,  kSkyViewEmsFields,     FIELD_COUNT(kSkyViewEmsFields)     };
+const EfisSentenceFormat kDynonD10       = { "",     53,  49,    0,      false,      0,  kDynonD10Fields,       FIELD_COUNT(kDynonD10Fields)       };
+const EfisSentenceFormat kGarminAttitude = { "=11",  59,  55,   '_',     false,      3,  kGarminAttitudeFields, FIELD_COUNT(kGarminAttitudeFields) };
+const EfisSentenceFormat kGarminEngine   = { "=31", 221, 217,   '_',     false,     -1,  kGarminEngineFields,   FIELD_COUNT(kGarminEngineFields)   };
+
+// ============================================================================
+// LOW-LEVEL HELPERS
+// ============================================================================
+
+int32_t parseFixedInt(const char * p, size_t uWidth)
+{
+    size_t  i    = 0;
+    bool    bNeg = false;
+    int32_t iVal = 0;
+
+    while (i < uWidth && p[i] == ' ')
+        i++;
+
+    if (i < uWidth && (p[i] == '+' || p[i] == '-')) {
+        bNeg = (p[i] == '-');
+        i++;
+    }
+
+    for (; i < uWidth; i++) {
+        const unsigned d = static_cast<unsigned>(p[i] - '0');
+        if (d > 9)
+            break;
+        iVal = iVal * 10 + static_cast<int32_t>(d);
+    }
+
+    return bNeg ? -iVal : iVal;
+}
+
+bool isSentinelField(const char * p, size_t uWidth, char c)
+{
+    for (size_t i = 0; i < uWidth; i++) {
+        if (p[i] != c)
+            return false;
+    }
+    return true;
+}
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+int parseHexByte(const char * p)
+{
+    const int hi = hexDigit(p[0]);
+    const int lo = hexDigit(p[1]);
+    if (hi < 0 || lo < 0)
+        return -1;
+    return (hi << 4) | lo;
+}
+
+// "HHMMSSFF" -> "HH:MM:SS.FF"
+static void formatTime(const char * p, char * szOut)
+{
+    szOut[0]  = p[0];  szOut[1]  = p[1];  szOut[2]  = ':';
+    szOut[3]  = p[2];  szOut[4]  = p[3];  szOut[5]  = ':';
+    szOut[6]  = p[4];  szOut[7]  = p[5];  szOut[8]  = '.';
+    szOut[9]  = p[6];  szOut[10] = p[7];  szOut[11] = '\0';
+}
+
+// ============================================================================
+// PARSERS
+// ============================================================================
+
+EfisParseResult parseEfisSentence(const EfisSentenceFormat & fmt, uint8_t uFieldCount,
+                                  const char * szLine, size_t uLen, EfisData & data)
+{
+    if (uLen != fmt.uLength)
+        return EfisParseResult::Ignored;
+
+    const size_t uPrefixLen = std::strlen(fmt.szPrefix);
+    if (std::memcmp(szLine, fmt.szPrefix, uPrefixLen) != 0)
+        return EfisParseResult::Ignored;
+
+    if (sum8(szLine, fmt.uCrcOffset) != parseHexByte(szLine + fmt.uCrcOffset))
+        return EfisParseResult::BadChecksum;
+
+    if (uFieldCount > fmt.uFieldCount)
+        uFieldCount = fmt.uFieldCount;
+
+    for (uint8_t i = 0; i < uFieldCount; i++) {
+        const EfisTextField & f = fmt.pFields[i];
+        const char * p = szLine + f.uOffset;
+
+        if (fmt.cSentinel && isSentinelField(p, f.uWidth, fmt.cSentinel)) {
+            if (fmt.bSetInvalid) {
+                if (f.pfValue) data.*f.pfValue = f.fInvalid;
+                else           data.*f.piValue = static_cast<int>(f.fInvalid);
+            }
+            continue;
+        }
+
+        const int32_t n = parseFixedInt(p, f.uWidth);
+        if (f.pfValue) {
+            float fValue = static_cast<float>(n) / f.iScale;
+            if (f.dFactor != 1.0)
+                fValue = static_cast<float>(fValue * f.dFactor);
+            data.*f.pfValue = fValue;
+        } else {
+            data.*f.piValue = static_cast<int>(n) * f.iScale;
+        }
+    }
+
+    if (fmt.iTimeOffset >= 0)
+        formatTime(szLine + fmt.iTimeOffset, data.szTime);
+
+    return EfisParseResult::Ok;
+}
+
+EfisParseResult parseSkyViewLine(const char * szLine, size_t uLen, EfisData & data)
+{
+    if (uLen == kSkyViewAdahrs.uLength)
+        return parseEfisSentence(kSkyViewAdahrs, kSkyViewAdahrs.uFieldCount, szLine, uLen, data);
+    if (uLen == kSkyViewEms.uLength)
+        return parseEfisSentence(kSkyViewEms, kSkyViewEms.uFieldCount, szLine, uLen, data);
+    return EfisParseResult::Ignored;
+}
+
+EfisParseResult parseDynonD10Line(const char * szLine, size_t uLen, EfisData & data)
+{
+    const EfisParseResult enResult =
+        parseEfisSentence(kDynonD10, kDynonD10.uFieldCount, szLine, uLen, data);
+    if (enResult != EfisParseResult::Ok)
+        return enResult;
+
+    // Status bitmask, hex digit at offset 46. When bit 0 is set the sentence
+    // carries pressure altitude and VSI, otherwise turn rate and density
+    // altitude, in which case keep the previous values.
+    const int iStatus = hexDigit(szLine[46]);
+    if (iStatus > 0 && (iStatus & 0x01)) {
+        data.Palt = static_cast<int>(parseFixedInt(szLine + 24, 5) * 3.28084);                 // meters to feet
+        data.VSI  = static_cast<int>(static_cast<float>(parseFixedInt(szLine + 29, 4)) / 10 * 60); // feet/sec to feet/min
+    }
+
+    return EfisParseResult::Ok;
+}
+
+EfisParseResult parseGarminG5Line(const char * szLine, size_t uLen, EfisData & data)
+{
+    return parseEfisSentence(kGarminAttitude, kGarminG5FieldCount, szLine, uLen, data);
+}
+
+EfisParseResult parseGarminG3XLine(const char * szLine, size_t uLen, EfisData & data)
+{
+    if (uLen == kGarminAttitude.uLength)
+        return parseEfisSentence(kGarminAttitude, kGarminAttitude.uFieldCount, szLine, uLen, data);
+    if (uLen == kGarminEngine.uLength)
+        return parseEfisSentence(kGarminEngine, kGarminEngine.uFieldCount, szLine, uLen, data);
+    return EfisParseResult::Ignored;
+}
@@ -0,0 +1,124 @@
+// EfisTextParser.h - Fixed-offset decoders for Dynon and Garmin text EFIS sentences
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// DECODED DATA
+// ============================================================================
+
+/// Values decoded from EFIS data streams.
+///
+/// The parsers update this in place. Fields a sentence doesn't carry (or marks
+/// invalid, for protocols that leave invalid fields alone) keep their previous
+/// values.
+struct EfisData {
+    float   DecelRate;
+    float   IAS;            ///< Knots
+    float   Pitch;          ///< Degrees
+    float   Roll;           ///< Degrees
+    float   LateralG;
+    float   VerticalG;
+    int     PercentLift;    ///< 0-99, percentage of stall angle
+    int     Palt;           ///< Feet
+    int     VSI;            ///< Feet/minute
+    float   TAS;            ///< Knots
+    float   OAT;            ///< Celsius
+    float   FuelRemaining;  ///< Gallons
+    float   FuelFlow;       ///< Gallons/hour
+    float   MAP;            ///< inHg
+    int     RPM;
+    int     PercentPower;
+    int     Heading;        ///< Degrees magnetic, -1 if unknown
+    char    szTime[12];     ///< "HH:MM:SS.FF", empty if unknown
+};
+
+/// Outcome of handing one line to a parser.
+enum class EfisParseResult : uint8_t {
+    Ok,             ///< Sentence recognized, checksum good, fields updated
+    Ignored,        ///< Not a sentence this parser decodes (type or length)
+    BadChecksum     ///< Recognized sentence with a bad checksum; nothing updated
+};
+
+// ============================================================================
+// FIELD TABLES
+// ============================================================================
+
+/// One fixed-width numeric field in a text sentence.
+///
+/// The text is an optionally signed decimal integer. Floats are decoded as
+/// float(n) / divisor (then * factor if factor != 1), ints as n * divisor.
+/// That is the same arithmetic the original String::toFloat()/toInt() code
+/// did, so decoded values are bit-identical to it.
+struct EfisTextField {
+    uint8_t             uOffset;
+    uint8_t             uWidth;
+    float EfisData::*   pfValue;    ///< Float target, or nullptr
+    int   EfisData::*   piValue;    ///< Int target, or nullptr
+    int16_t             iScale;     ///< Divisor for floats, multiplier for ints
+    double              dFactor;    ///< Extra unit conversion for floats (1.0 = none)
+    float               fInvalid;   ///< Value stored when the field is all sentinel chars
+};
+
+/// Layout of one sentence type.
+struct EfisSentenceFormat {
+    const char *            szPrefix;       ///< Leading characters, e.g. "!1"
+    uint16_t                uLength;        ///< Full line length including CR LF
+    uint16_t                uCrcOffset;     ///< Checksum covers [0, uCrcOffset), 2 hex digits at uCrcOffset
+    char                    cSentinel;      ///< Character marking an invalid field, 0 = none
+    bool                    bSetInvalid;    ///< true: store fInvalid; false: keep previous value
+    int8_t                  iTimeOffset;    ///< Offset of HHMMSSFF, -1 = none
+    const EfisTextField *   pFields;
+    uint8_t                 uFieldCount;
+};
+
+/// Sentence formats, exposed so tests and tools can walk them.
+extern const EfisSentenceFormat kSkyViewAdahrs;     ///< "!1", 74 chars
+extern const EfisSentenceFormat kSkyViewEms;        ///< "!3", 225 chars
+extern const EfisSentenceFormat kDynonD10;          ///< 53 chars with live data, no prefix
+extern const EfisSentenceFormat kGarminAttitude;    ///< "=11", 59 chars (G5 and G3X)
+extern const EfisSentenceFormat kGarminEngine;      ///< "=31", 221 chars (G3X)
+
+// ============================================================================
+// PARSERS
+// ============================================================================
+// Each takes one complete line as received, including the trailing CR LF,
+// and never allocates.
+
+/// Dynon SkyView: ADAHRS ("!1") and EMS ("!3") sentences.
+EfisParseResult parseSkyViewLine(const char * szLine, size_t uLen, EfisData & data);
+
+/// Dynon D10/D100 53-character sentence.
+EfisParseResult parseDynonD10Line(const char * szLine, size_t uLen, EfisData & data);
+
+/// Garmin G5: attitude ("=11") sentence. Percent lift and OAT are not used.
+EfisParseResult parseGarminG5Line(const char * szLine, size_t uLen, EfisData & data);
+
+/// Garmin G3X: attitude ("=11") and engine ("=31") sentences.
+EfisParseResult parseGarminG3XLine(const char * szLine, size_t uLen, EfisData & data);
+
+/// Decode one sentence against a format table. The protocol functions above
+/// are thin wrappers around this (plus D10's status-dependent fields).
+/// @param uFieldCount Number of leading table entries to decode
+EfisParseResult parseEfisSentence(const EfisSentenceFormat & fmt, uint8_t uFieldCount,
+                                  const char * szLine, size_t uLen, EfisData & data);
+
+// ============================================================================
+// LOW-LEVEL HELPERS
+// ============================================================================
+
+/// Parse a fixed-width, optionally signed decimal integer with atol()
+/// semantics: leading spaces skipped, stops at the first non-digit, and
+/// returns 0 if there are no digits.
+int32_t parseFixedInt(const char * p, size_t uWidth);
+
+/// True if all uWidth characters equal c.
+bool isSentinelField(const char * p, size_t uWidth, char c);
+
+/// Value of one hex digit, or -1.
+int hexDigit(char c);
+
+/// Parse two hex digits, or -1 if either is not hex.
+int parseHexByte(const char * p);
@@ -0,0 +1,192 @@
+// FilterAnalysis.cpp - Lag and noise figures for smoothing filter chains
+
+#include "FilterAnalysis.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ============================================================================
+// TEST SIGNALS
+// ============================================================================
+
+namespace {
+
+constexpr float kSettleSec    = 5.0f;   ///< Ahead of each measurement, longer than any window or memory here
+constexpr float kStepSec      = 10.0f;
+constexpr float kRampSec      = 20.0f;
+constexpr float kRampAvgSec   = 1.0f;   ///< Lag is averaged over the end of the ramp
+constexpr int   kNoiseSamples = 4096;
+
+/// Unit variance Gaussian noise, xorshift32 then Box-Muller. Always the
+/// same sequence from the same seed.
+class GaussianNoise {
+public:
+    explicit GaussianNoise(uint32_t uSeed) : _uState(uSeed ? uSeed : 1) {}
+
+    float next()
+    {
+        if (_bHaveSpare) {
+            _bHaveSpare = false;
+            return _fSpare;
+        }
+        // (0, 1], never 0 so the log is finite
+        const float fU1 = (float(nextBits() >> 8) + 1.0f) * (1.0f / 16777216.0f);
+        const float fU2 =  float(nextBits() >> 8)         * (1.0f / 16777216.0f);
+        const float fR  = std::sqrt(-2.0f * std::log(fU1));
+        const float fA  = 6.28318531f * fU2;
+        _fSpare     = fR * std::sin(fA);
+        _bHaveSpare = true;
+        return fR * std::cos(fA);
+    }
+
+private:
+    uint32_t nextBits()
+    {
+        _uState ^= _uState << 13;
+        _uState ^= _uState >> 17;
+        _uState ^= _uState << 5;
+        return _uState;
+    }
+
+    uint32_t    _uState;
+    float       _fSpare     = 0.0f;
+    bool        _bHaveSpare = false;
+};
+
+int samplesFor(float fSec, int iHz)
+{
+    return std::max(1, int(std::lround(fSec * float(iHz))));
+}
+
+} // namespace
+
+// ============================================================================
+// MEASUREMENTS
+// ============================================================================
+
+FilterFigures measureFilter(SignalFilter & filter, int iHz)
+{
+    FilterFigures figures;
+    iHz = std::max(iHz, 1);
+
+    const float fDtSec = 1.0f / float(iHz);
+
+    // Step from 0 to 1, timed from the first sample at 1
+    filter.reset();
+    for (int k = samplesFor(kSettleSec, iHz); k > 0; k--)
+        filter.update(0.0f);
+
+    const int   iStepSamples = samplesFor(kStepSec, iHz);
+    int         iStep50      = -1;
+    int         iStep90      = -1;
+    float       fPeak        = 0.0f;
+    for (int k = 0; k < iStepSamples; k++) {
+        const float fOut = filter.update(1.0f);
+        if (iStep50 < 0 && fOut >= 0.5f)
+            iStep50 = k;
+        if (iStep90 < 0 && fOut >= 0.9f)
+            iStep90 = k;
+        fPeak = std::max(fPeak, fOut);
+    }
+    figures.fStep50Sec = float(iStep50 < 0 ? iStepSamples : iStep50) * fDtSec;
+    figures.fStep90Sec = float(iStep90 < 0 ? iStepSamples : iStep90) * fDtSec;
+    figures.fOvershoot = std::max(0.0f, fPeak - 1.0f);
+
+    // Ramp at 1 unit per second, lag = input minus output near the end.
+    // Samples are counted in integers so the input is exact.
+    filter.reset();
+    const int   iRampSamples = samplesFor(kRampSec, iHz);
+    const int   iAvgSamples  = samplesFor(kRampAvgSec, iHz);
+    double      dLagSum      = 0.0;
+    for (int k = 0; k < iRampSamples; k++) {
+        const float fIn  = float(k) * fDtSec;
+        const float fOut = filter.update(fIn);
+        if (k >= iRampSamples - iAvgSamples)
+            dLagSum += double(fIn - fOut);
+    }
+    figures.fRampLagSec = float(dLagSum / iAvgSamples);
+
+    figures.fNoiseGain = measureNoiseGain(filter, iHz);
+    return figures;
+}
+
+// ----------------------------------------------------------------------------
+
+float measureNoiseGain(SignalFilter & filter, int iHz)
+{
+    GaussianNoise   noise(0x2545F491u);
+
+    filter.reset();
+    for (int k = samplesFor(kSettleSec, std::max(iHz, 1)); k > 0; k--)
+        filter.update(noise.next());
+
+    // RMS about the mean, in and out, over the same samples
+    double  dInSum = 0.0, dInSq = 0.0, dOutSum = 0.0, dOutSq = 0.0;
+    for (int k = 0; k < kNoiseSamples; k++) {
+        const float fIn  = noise.next();
+        const float fOut = filter.update(fIn);
+        dInSum  += fIn;
+        dInSq   += double(fIn) * fIn;
+        dOutSum += fOut;
+        dOutSq  += double(fOut) * fOut;
+    }
+    const double dInVar  = dInSq  / kNoiseSamples - (dInSum  / kNoiseSamples) * (dInSum  / kNoiseSamples);
+    const double dOutVar = dOutSq / kNoiseSamples - (dOutSum / kNoiseSamples) * (dOutSum / kNoiseSamples);
+
+    return float(std::sqrt(std::max(dOutVar, 0.0) / dInVar));
+}
+
+// ============================================================================
+// AOA CHAIN
+// ============================================================================
+
+void AoaFilterChain::configure(const SmoothingParams & params, AoaFilterKind enKind, float fTheta)
+{
+    _Pressure.configure(params);
+    _Ema.setAlpha(params.fAoaAlpha);
+    _AlphaBeta.setTheta(fTheta);
+    _enKind = enKind;
+    reset();
+}
+
+void AoaFilterChain::reset()
+{
+    _Pressure.reset();
+    _Ema.reset();
+    _AlphaBeta.reset();
+}
+
+float AoaFilterChain::update(float fValue)
+{
+    const float fSmoothed = _Pressure.add(fValue);
+    return (_enKind == AoaFilterKind::AlphaBeta) ? _AlphaBeta.update(fSmoothed) : _Ema.update(fSmoothed);
+}
+
+// ----------------------------------------------------------------------------
+
+float matchAlphaBetaTheta(const SmoothingParams & params)
+{
+    AoaFilterChain  chain;
+
+    chain.configure(params, AoaFilterKind::Ema);
+    const float fTarget = measureNoiseGain(chain, params.iHz);
+
+    // Noise gain falls as theta rises. Keep the smoother end that is at
+    // least as quiet as the EMA chain.
+    float   fLo = 0.0f;
+    float   fHi = 0.999f;
+
+    chain.configure(params, AoaFilterKind::AlphaBeta, fLo);
+    if (measureNoiseGain(chain, params.iHz) <= fTarget)
+        return fLo;
+
+    for (int i = 0; i < 14; i++) {
+        const float fMid = 0.5f * (fLo + fHi);
+        chain.configure(params, AoaFilterKind::AlphaBeta, fMid);
+        if (measureNoiseGain(chain, params.iHz) > fTarget)
+            fLo = fMid;
+        else
+            fHi = fMid;
+    }
+    return fHi;
+}
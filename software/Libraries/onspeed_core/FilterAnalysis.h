@@ -0,0 +1,79 @@
+// FilterAnalysis.h - Lag and noise figures for smoothing filter chains
+
+#pragma once
+
+#include <cstdint>
+
+#include "AOACalculator.h"
+#include "AlphaBetaFilter.h"
+#include "EMAFilter.h"
+#include "RateFilters.h"
+
+// ============================================================================
+// FILTER UNDER TEST
+// ============================================================================
+
+/// Anything with one input and one output that can be measured: a single
+/// filter or a whole chain of them.
+class SignalFilter {
+public:
+    virtual ~SignalFilter() = default;
+
+    virtual void    reset() = 0;
+    virtual float   update(float fValue) = 0;
+};
+
+// ============================================================================
+// FIGURES
+// ============================================================================
+
+/// How a filter responds, measured by running test signals through it.
+///
+/// The median and the alpha-beta filter are not linear so nothing here is
+/// worked out from the coefficients. For a linear low-pass filter the ramp
+/// lag is its group delay at low frequency, the centroid of its impulse
+/// response.
+struct FilterFigures {
+    float   fRampLagSec;        ///< Steady lag behind a ramp, the low frequency group delay
+    float   fStep50Sec;         ///< From a unit step to 50% of it
+    float   fStep90Sec;         ///< From a unit step to 90% of it
+    float   fOvershoot;         ///< Largest excursion past the step, fraction of the step
+    float   fNoiseGain;         ///< Output RMS over input RMS for white Gaussian noise
+};
+
+/// Step, ramp and noise figures for a filter running at iHz. Resets the
+/// filter before each signal. Deterministic: the noise is the same
+/// pseudo-random sequence every call.
+FilterFigures measureFilter(SignalFilter & filter, int iHz);
+
+/// Only the noise gain, the expensive part of measureFilter().
+float measureNoiseGain(SignalFilter & filter, int iHz);
+
+// ============================================================================
+// AOA CHAIN
+// ============================================================================
+
+/// The AOA smoothing as SensorIO runs it, on an AOA-like signal: pressure
+/// median and moving average (PressureSmoother), then the AOACalculator
+/// smoother, EMA or alpha-beta. The pressure stages really act on the
+/// pressures before the coeffP division, which is close to linear for a
+/// steady Pfwd.
+class AoaFilterChain : public SignalFilter {
+public:
+    /// @param fTheta Alpha-beta memory factor, only used for AlphaBeta
+    void    configure(const SmoothingParams & params, AoaFilterKind enKind, float fTheta = 0.0f);
+
+    void    reset() override;
+    float   update(float fValue) override;
+
+private:
+    PressureSmoother    _Pressure;
+    EMAFilter           _Ema;
+    AlphaBetaFilter     _AlphaBeta;
+    AoaFilterKind       _enKind = AoaFilterKind::Ema;
+};
+
+/// The alpha-beta memory factor that gives the AOA chain the same noise
+/// gain with AlphaBeta as it has with the EMA from params. Bisection on
+/// measureNoiseGain(), a few tens of thousands of filter updates.
+float matchAlphaBetaTheta(const SmoothingParams & params);
@@ -0,0 +1,76 @@
+// ImuFifo.cpp - ISM330DHCX FIFO status and word decoding
+
+#include "ImuFifo.h"
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+ImuFifoStatus ImuFifoStatus::decode(const uint8_t * pStatus)
+{
+    ImuFifoStatus status;
+
+    // DIFF_FIFO is STATUS1 plus the low two bits of STATUS2
+    status.iWords   = int(pStatus[0]) | (int(pStatus[1] & 0x03) << 8);
+    status.bOverrun = (pStatus[1] & 0x40) != 0;
+    return status;
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+ImuFifoDecoder::ImuFifoDecoder()
+{
+    _uDropped = 0;
+    reset();
+}
+
+void ImuFifoDecoder::reset()
+{
+    _bHaveGyro     = false;
+    _bHaveAccel    = false;
+    _uPendingCount = 0;
+}
+
+int ImuFifoDecoder::decode(const uint8_t * pWords, int iWords, ImuRawSample * pOut, int iMaxOut)
+{
+    int iOut = 0;
+
+    for (int w = 0; w < iWords; w++) {
+        const uint8_t *  pWord  = pWords + size_t(w) * kImuFifoWordBytes;
+        const ImuFifoTag enTag  = imuFifoTagSensor(pWord[0]);
+        const uint8_t    uCount = imuFifoTagCount(pWord[0]);
+
+        if (enTag != ImuFifoTag::Gyro && enTag != ImuFifoTag::Accel)
+            continue;
+
+        // A half pair from a different tick lost its partner
+        if ((_bHaveGyro || _bHaveAccel) && uCount != _uPendingCount) {
+            _uDropped++;
+            reset();
+        }
+        _uPendingCount = uCount;
+
+        int16_t * pAxes = (enTag == ImuFifoTag::Gyro) ? _Pending.aiGyro : _Pending.aiAccel;
+        bool    & bHave = (enTag == ImuFifoTag::Gyro) ? _bHaveGyro       : _bHaveAccel;
+
+        // The same sensor twice in one tick means one word went missing
+        if (bHave)
+            _uDropped++;
+
+        for (int i = 0; i < 3; i++)
+            pAxes[i] = int16_t(uint16_t(pWord[1 + 2 * i]) | (uint16_t(pWord[2 + 2 * i]) << 8));
+        bHave = true;
+
+        if (_bHaveGyro && _bHaveAccel) {
+            if (iOut < iMaxOut)
+                pOut[iOut++] = _Pending;
+            else
+                _uDropped += 2;
+            reset();
+        }
+    }
+
+    return iOut;
+}
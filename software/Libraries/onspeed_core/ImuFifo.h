@@ -0,0 +1,79 @@
+// ImuFifo.h - ISM330DHCX FIFO status and word decoding
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// FIFO LAYOUT
+// ============================================================================
+
+/// Each FIFO word is a tag byte then six data bytes (X, Y, Z little endian).
+/// A burst read starting at FIFO_DATA_OUT_TAG rolls back to the tag register
+/// after the last data byte, so N words come out of one N * 7 byte read.
+constexpr size_t  kImuFifoWordBytes = 7;
+
+/// Gyro and accel are both batched at the 208 Hz ODR.
+constexpr float   kImuFifoOdrHz     = 208.0f;
+
+/// TAG_SENSOR values (tag byte bits 7:3) this code cares about.
+enum class ImuFifoTag : uint8_t {
+    Gyro         = 0x01,
+    Accel        = 0x02,
+    Temperature  = 0x03,
+    Timestamp    = 0x04,
+    ConfigChange = 0x05,
+};
+
+/// FIFO_STATUS1 and FIFO_STATUS2, read together.
+struct ImuFifoStatus {
+    int     iWords;         ///< Unread words, DIFF_FIFO
+    bool    bOverrun;       ///< FIFO_OVR_IA, data was lost since the last read
+
+    static ImuFifoStatus decode(const uint8_t * pStatus);
+};
+
+/// Sensor from a tag byte.
+inline ImuFifoTag imuFifoTagSensor(uint8_t uTag)    { return ImuFifoTag(uTag >> 3); }
+
+/// TAG_CNT, the 2 bit sample counter gyro and accel words from the same ODR
+/// tick share.
+inline uint8_t    imuFifoTagCount(uint8_t uTag)     { return uint8_t((uTag >> 1) & 0x03); }
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+/// One gyro and accel pair from the same ODR tick, raw counts in IMU axes.
+struct ImuRawSample {
+    int16_t     aiGyro[3];
+    int16_t     aiAccel[3];
+};
+
+/// Pairs up gyro and accel words into samples, oldest first.
+///
+/// The two words from one tick can come in either order and can be split
+/// across two reads, so a half pair is held over to the next decode(). A
+/// half pair whose partner never turns up (different TAG_CNT) is dropped.
+/// Other tags (temperature, timestamp) are skipped.
+class ImuFifoDecoder {
+public:
+    ImuFifoDecoder();
+
+    void        reset();
+
+    /// Decode iWords words from pWords into pOut.
+    /// @return Samples written, at most iMaxOut; any more are counted as dropped
+    int         decode(const uint8_t * pWords, int iWords, ImuRawSample * pOut, int iMaxOut);
+
+    /// Words thrown away: unpaired halves and samples that didn't fit.
+    uint32_t    droppedWords() const    { return _uDropped; }
+
+private:
+    ImuRawSample    _Pending;
+    bool            _bHaveGyro;
+    bool            _bHaveAccel;
+    uint8_t         _uPendingCount;
+    uint32_t        _uDropped;
+};
@@ -2,6 +2,7 @@
 
 #include <algorithm>  // for std::clamp
 #include <cmath>
+#include <cstring>   // for std::memcpy
 #include "KalmanFilter.h"
 
 // Tracks the position z and velocity v of an object moving in a straight line,
@@ -11,8 +12,68 @@
 // This can be calculated offline for the specific sensor, and is supplied
 // as an initialization parameter.
 
+// Dynamic acceleration variance for a given acceleration. It is the floor,
+// 1, for anything under 50 m/s^2, which is what the steady-state gains use.
+static float AccelVariance(float accel)
+{
+    return std::clamp(std::fabs(accel)/50.0f, 1.0f, 50.0f);
+}
+
+// ----------------------------------------------------------------------------
+
+// 3x3 helpers for the steady-state solution, in double because the bias
+// variance is many orders of magnitude below the others
+
+typedef double Mat3[3][3];
+
+static void Mul3(const Mat3 a, const Mat3 b, Mat3 c)
+{
+    Mat3 t;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            t[i][j] = a[i][0]*b[0][j] + a[i][1]*b[1][j] + a[i][2]*b[2][j];
+    std::memcpy(c, t, sizeof(Mat3));
+}
+
+static void Transpose3(const Mat3 a, Mat3 c)
+{
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            c[i][j] = a[j][i];
+}
+
+static bool Invert3(const Mat3 a, Mat3 c)
+{
+    const double c00 = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+    const double c01 = a[1][2]*a[2][0] - a[1][0]*a[2][2];
+    const double c02 = a[1][0]*a[2][1] - a[1][1]*a[2][0];
+    const double det = a[0][0]*c00 + a[0][1]*c01 + a[0][2]*c02;
+    if (!(std::fabs(det) > 0.0))
+        return false;
+
+    const double r = 1.0 / det;
+    c[0][0] = c00 * r;
+    c[0][1] = (a[0][2]*a[2][1] - a[0][1]*a[2][2]) * r;
+    c[0][2] = (a[0][1]*a[1][2] - a[0][2]*a[1][1]) * r;
+    c[1][0] = c01 * r;
+    c[1][1] = (a[0][0]*a[2][2] - a[0][2]*a[2][0]) * r;
+    c[1][2] = (a[0][2]*a[1][0] - a[0][0]*a[1][2]) * r;
+    c[2][0] = c02 * r;
+    c[2][1] = (a[0][1]*a[2][0] - a[0][0]*a[2][1]) * r;
+    c[2][2] = (a[0][0]*a[1][1] - a[0][1]*a[1][0]) * r;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
 KalmanFilter::KalmanFilter()
 {
+    steadyEnabled_   = false;
+    steady_          = false;
+    steadyTolerance_ = 0.0f;
+    kzSS_ = 0.0f;
+    kvSS_ = 0.0f;
+    kaSS_ = 0.0f;
 }
 
 // ----------------------------------------------------------------------------
@@ -37,6 +98,102 @@ void KalmanFilter::Configure(float zVariance, float zAccelVariance, float zAccel
     Paz_ = 0.0f;
     Pav_ = 0.0;
     Paa_ = 100000.0f;
+
+    steady_ = false;
+}
+
+// ----------------------------------------------------------------------------
+
+// The converged predicted covariance P solves the discrete algebraic Riccati
+// equation
+//
+//   P = F P F' - F P H' (H P H' + R)^-1 H P F' + Q
+//
+// for the F and Q Update() uses and H = [1 0 0]. Just running Update()'s
+// covariance steps would take hours of samples, as the bias gain only
+// settles at the rate its tiny variance allows. The doubling algorithm gets
+// there in a few dozen steps, each one doubling the number of samples
+// covered:
+//
+//   W = I + G H,  A' = A W^-1 A,  G' = G + A W^-1 G A',  H' = H + A' H W^-1 A
+//
+// starting from A = F', G = H' R^-1 H, H = Q, with H converging to P.
+
+bool KalmanFilter::EnableSteadyState(float dt, float tolerance)
+{
+    const double d  = dt;
+    const double qa = zAccelBiasVariance_;
+    const double q  = AccelVariance(0.0f);
+    const double r  = zVariance_;
+
+    steadyEnabled_ = false;
+    if (!(d > 0.0) || !(r > 0.0))
+        return false;
+
+    Mat3 A = { { 1.0,   0.0,    0.0 },
+               { d,     1.0,    0.0 },
+               { -d*d/2.0, -d,  1.0 } };
+    Mat3 G = { { 1.0/r, 0.0,    0.0 },
+               { 0.0,   0.0,    0.0 },
+               { 0.0,   0.0,    0.0 } };
+    Mat3 H = { { d*d*d*d/4.0*q, d*d*d/2.0*q, 0.0 },
+               { d*d*d/2.0*q,   d*d*q,       0.0 },
+               { 0.0,           0.0,         qa  } };
+
+    bool converged = false;
+    for (int iter = 0; iter < 64 && !converged; iter++)
+    {
+        Mat3 W, Wi, At, AWi, T;
+        Mul3(G, H, W);
+        for (int i = 0; i < 3; i++)
+            W[i][i] += 1.0;
+        if (!Invert3(W, Wi))
+            return false;
+        Transpose3(A, At);
+        Mul3(A, Wi, AWi);
+
+        Mat3 Gn, Hn;
+        Mul3(AWi, G, T);
+        Mul3(T, At, Gn);
+        Mul3(At, H, T);
+        Mul3(T, Wi, T);
+        Mul3(T, A, Hn);
+
+        double change = 0.0, size = 0.0;
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+            {
+                Gn[i][j] += G[i][j];
+                Hn[i][j] += H[i][j];
+                change += std::fabs(Hn[i][j] - H[i][j]);
+                size   += std::fabs(Hn[i][j]);
+            }
+
+        Mul3(AWi, A, A);
+        std::memcpy(G, Gn, sizeof(Mat3));
+        std::memcpy(H, Hn, sizeof(Mat3));
+        converged = change <= 1e-13 * size;
+    }
+    if (!converged || !std::isfinite(H[0][0]))
+        return false;
+
+    const double sInv = 1.0 / (H[0][0] + r);
+    kzSS_ = float(H[0][0] * sInv);
+    kvSS_ = float(H[1][0] * sInv);
+    kaSS_ = float(H[2][0] * sInv);
+
+    steadyTolerance_ = tolerance;
+    steadyEnabled_   = true;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+
+void KalmanFilter::SteadyStateGains(float* pKz, float* pKv, float* pKa) const
+{
+    *pKz = kzSS_;
+    *pKv = kvSS_;
+    *pKa = kaSS_;
 }
 
 // ----------------------------------------------------------------------------
@@ -52,8 +209,26 @@ void KalmanFilter::Update(float z, float a, float dt, volatile float* pZ, volati
     v_ += accel * dt;
     z_ += v_ * dt;
 
-    zAccelVariance_ = std::fabs(accel)/50.0f;
-    zAccelVariance_ = std::clamp(zAccelVariance_, 1.0f, 50.0f);
+    zAccelVariance_ = AccelVariance(accel);
+
+    // The fixed gains assume the nominal acceleration variance. Above it
+    // run the full filter again, from the covariance held since the switch,
+    // until its gains are back within tolerance of the fixed ones.
+    if (steady_ && zAccelVariance_ > AccelVariance(0.0f))
+        steady_ = false;
+
+    // Steady state, fixed gains and no covariance
+    if (steady_)
+    {
+        float innov = z - z_;
+        z_ += kzSS_ * innov;
+        v_ += kvSS_ * innov;
+        aBias_ += kaSS_ * innov;
+
+        *pZ = z_;
+        *pV = v_;
+        return;
+    }
 
     // Predict State Covariance matrix
     float t00,t01,t02;
@@ -125,4 +300,11 @@ void KalmanFilter::Update(float z, float a, float dt, volatile float* pZ, volati
     Pzz_ -= kz * Pzz_;
     Pzv_ -= kz * Pzv_;
     Pza_ -= kz * Pza_;
+
+    // Start-up transient over, the bias gain takes much longer but is tiny
+    // by then
+    if (steadyEnabled_ &&
+        std::fabs(kz - kzSS_) <= steadyTolerance_ * kzSS_ &&
+        std::fabs(kv - kvSS_) <= steadyTolerance_ * kvSS_)
+        steady_ = true;
 }
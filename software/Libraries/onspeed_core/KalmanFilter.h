@@ -11,6 +11,18 @@ public :
     void Configure(float zVariance, float zAccelVariance, float zAccelBiasVariance, float zInitial, float vInitial, float aBiasInitial);
     void Update(float z, float a, float dt, volatile float* pZ, volatile float* pV);
 
+    // Steady-state gain mode. Solves once for the gains the full filter
+    // converges to at this dt, then lets the full filter run the start-up
+    // transient and switches to the fixed gains once its z and v gains are
+    // within tolerance of them. After that Update() only updates the state,
+    // except that an acceleration above the nominal variance (50 m/s^2)
+    // drops back to the full filter until the gains settle again.
+    // Call after Configure(); Configure() starts the full filter again.
+    // Returns false, leaving the full filter on, if there's no solution.
+    bool EnableSteadyState(float dt, float tolerance = 0.01f);
+    bool IsSteadyState() const { return steady_; }
+    void SteadyStateGains(float* pKz, float* pKv, float* pKa) const;
+
 private :
     // State being tracked
     float z_;       // position
@@ -32,6 +44,14 @@ private :
     float zAccelVariance_;      // dynamic acceleration variance
     float zVariance_;           //  z measurement noise variance fixed
 
+    // Steady-state gains
+    bool  steadyEnabled_;       // switch to them after start-up
+    bool  steady_;              // using them now
+    float steadyTolerance_;
+    float kzSS_;
+    float kvSS_;
+    float kaSS_;
+
 };
 
 #endif
@@ -14,6 +14,7 @@
 // 02/10/2011   SOH Madgwick    Optimised for reduced CPU load
 // 19/02/2012   SOH Madgwick    Magnetometer measurement is normalised
 // 08/17/202    OnSpeed         Adjusted parameters for optimized Onspeed AHRS stability
+//              OnSpeed         Folded IMU update constants, exact invSqrt, angles on demand
 //
 //=============================================================================================
 
@@ -22,7 +23,6 @@
 
 #include "MadgwickFusion.h"
 #include <math.h>
-#include <cstring>
 
 //-------------------------------------------------------------------------------------------
 // Definitions
@@ -68,6 +68,7 @@ void Madgwick::begin(float sampleFrequency, float Pitch, float Roll)
     q1 = sr2*cp2*cy2 - cr2*sp2*sy2;
     q2 = cr2*sp2*cy2 + sr2*cp2*sy2;
     q3 = cr2*cp2*sy2 - sr2*sp2*cy2;
+    anglesComputed = 0;
     }
 
 //-----------------------------------------------------------------------------
@@ -181,115 +182,121 @@ void Madgwick::Update(float gx, float gy, float gz, float ax, float ay, float az
 // IMU algorithm update
 
 void Madgwick::UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az) {
-    float recipNorm;
-    float s0, s1, s2, s3;
-    float qDot1, qDot2, qDot3, qDot4;
-    float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2 ,_8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
+    UpdateIMU(gx, gy, gz, ax, ay, az, invSampleFreq);
+}
 
-    // Convert gyroscope degrees/sec to radians/sec
-    gx *= 0.0174533f;
-    gy *= 0.0174533f;
-    gz *= 0.0174533f;
+//-------------------------------------------------------------------------------------------
+// IMU algorithm update over dt seconds. Used for IMU FIFO samples, which come
+// at the IMU's own rate rather than the rate begin() was given.
+//
+// This is the original x-io update with the constant factors folded
+// together: the gyro rates are scaled straight to the half angle over dt,
+// and the gradient normalisation, beta and dt are one multiplier. The
+// quaternion is renormalised with one Newton step from 1, good to 4e-9 for
+// the small change one sample makes, and the full inverse square-root
+// after a bigger one.
+
+void Madgwick::UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+    {
+    const float halfDtRad = 0.5f * 0.0174533f * dt;
+    const float betaDt    = beta * dt;
 
-    // Rate of change of quaternion from gyroscope
-    qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
-    qDot2 = 0.5f * ( q0 * gx + q2 * gz - q3 * gy);
-    qDot3 = 0.5f * ( q0 * gy - q1 * gz + q3 * gx);
-    qDot4 = 0.5f * ( q0 * gz + q1 * gy - q2 * gx);
+    // Change of quaternion over dt from the gyroscope
+    gx *= halfDtRad;
+    gy *= halfDtRad;
+    gz *= halfDtRad;
+
+    float d0 = -q1 * gx - q2 * gy - q3 * gz;
+    float d1 =  q0 * gx + q2 * gz - q3 * gy;
+    float d2 =  q0 * gy - q1 * gz + q3 * gx;
+    float d3 =  q0 * gz + q1 * gy - q2 * gx;
 
     // Compute feedback only if accelerometer measurement valid (avoids NaN in accelerometer normalisation)
-    if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
+    const float accNormSq = ax * ax + ay * ay + az * az;
+    if (accNormSq > 0.0f)
         {
         // Normalise accelerometer measurement
-        recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+        const float recipNorm = invSqrt(accNormSq);
         ax *= recipNorm;
         ay *= recipNorm;
         az *= recipNorm;
 
         // Auxiliary variables to avoid repeated arithmetic
-        _2q0 = 2.0f * q0;
-        _2q1 = 2.0f * q1;
-        _2q2 = 2.0f * q2;
-        _2q3 = 2.0f * q3;
-        _4q0 = 4.0f * q0;
-        _4q1 = 4.0f * q1;
-        _4q2 = 4.0f * q2;
-        _8q1 = 8.0f * q1;
-        _8q2 = 8.0f * q2;
-
-        q0q0 = q0 * q0;
-        q1q1 = q1 * q1;
-        q2q2 = q2 * q2;
-        q3q3 = q3 * q3;
+        const float _2q0 = 2.0f * q0;
+        const float _2q1 = 2.0f * q1;
+        const float _2q2 = 2.0f * q2;
+        const float _2q3 = 2.0f * q3;
+        const float _4q0 = 4.0f * q0;
+        const float _4q1 = 4.0f * q1;
+        const float _4q2 = 4.0f * q2;
+        const float _8q1 = 8.0f * q1;
+        const float _8q2 = 8.0f * q2;
+        const float q0q0 = q0 * q0;
+        const float q1q1 = q1 * q1;
+        const float q2q2 = q2 * q2;
+        const float q3q3 = q3 * q3;
 
         // Gradient decent algorithm corrective step
-        s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
-        s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
-        s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
-        s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
-        recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3); // normalise step magnitude
-        s0 *= recipNorm;
-        s1 *= recipNorm;
-        s2 *= recipNorm;
-        s3 *= recipNorm;
-
-        // Apply feedback step
-        qDot1 -= beta * s0;
-        qDot2 -= beta * s1;
-        qDot3 -= beta * s2;
-        qDot4 -= beta * s3;
-    } // end if non-zero accels
-
-    // Integrate rate of change of quaternion to yield quaternion
-    q0 += qDot1 * invSampleFreq;
-    q1 += qDot2 * invSampleFreq;
-    q2 += qDot3 * invSampleFreq;
-    q3 += qDot4 * invSampleFreq;
-
-    // Normalise quaternion
-    recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        const float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        const float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        const float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        const float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+        // Normalised step times beta and dt, no step if already on target
+        const float step = betaDt * invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+        d0 -= step * s0;
+        d1 -= step * s1;
+        d2 -= step * s2;
+        d3 -= step * s3;
+        } // end if non-zero accels
+
+    // Integrate, then normalise quaternion
+    q0 += d0;
+    q1 += d1;
+    q2 += d2;
+    q3 += d3;
+
+    const float normSq = q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3;
+    const float recipNorm = fabsf(normSq - 1.0f) < 1e-4f ? 1.5f - 0.5f * normSq : invSqrt(normSq);
     q0 *= recipNorm;
     q1 *= recipNorm;
     q2 *= recipNorm;
     q3 *= recipNorm;
     anglesComputed = 0;
-}
+    }
 
 //-------------------------------------------------------------------------------------------
-// Fast inverse square-root
-// See: http://en.wikipedia.org/wiki/Fast_inverse_square_root
+// Inverse square-root
+//
+// This used to be the 0x5f375a86 bit trick with one Newton step, good to
+// only about 0.2%. Correctly rounded 1/sqrtf() changes the filter output:
+// the quaternion is now normalised to 1.0000000 instead of 0.9983, so the
+// roll, pitch and yaw it gives are slightly different, by up to 0.04 deg
+// over the test flight in test_madgwick. Zero gives zero, so a zero vector
+// normalises to zero rather than NaN, as the trick's large finite result
+// did.
 
 float Madgwick::invSqrt(float x)
 {
-//  return 1.0 / sqrt(x);
-//  float halfx = 0.5f * x;
-//  float y = x;
-//  long i = *(long*)&y;
-//  i = 0x5f3759df - (i>>1);
-//  y = *(float*)&i;
-//  y = y * (1.5f - (halfx * y * y));
-//  y = y * (1.5f - (halfx * y * y));
-//  return y;
-
-    // this code uses memcpy instead of old code that breaks strict-aliasing rules
-    float xhalf = 0.5f*x;
-    unsigned int i;
-    //assert(sizeof(x) == sizeof(i));
-    memcpy(&i, &x, sizeof(i));
-    i = 0x5f375a86 - (i>>1);
-    memcpy(&x, &i, sizeof(i));
-    x = x*(1.5f - xhalf*x*x);
-
-    return x;
+    return x > 0.0f ? 1.0f / sqrtf(x) : 0.0f;
 }
 
 //-------------------------------------------------------------------------------------------
 
-void Madgwick::computeAngles()
+void Madgwick::computeRoll()
 {
     roll  = atan2f(q0*q1 + q2*q3, 0.5f - q1*q1 - q2*q2);
+    anglesComputed |= ANGLE_ROLL;
+}
+
+void Madgwick::computePitch()
+{
     pitch = asinf(-2.0f * (q1*q3 - q0*q2));
-    yaw   = atan2f(q1*q2 + q0*q3, 0.5f - q2*q2 - q3*q3);
+    anglesComputed |= ANGLE_PITCH;
+}
 
-    anglesComputed = 1;
+void Madgwick::computeYaw()
+{
+    yaw   = atan2f(q1*q2 + q0*q3, 0.5f - q2*q2 - q3*q3);
+    anglesComputed |= ANGLE_YAW;
 }
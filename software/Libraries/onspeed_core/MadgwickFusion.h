@@ -24,8 +24,12 @@
 class Madgwick
 {
 private:
+    enum { ANGLE_ROLL = 0x01, ANGLE_PITCH = 0x02, ANGLE_YAW = 0x04 };
+
     static float invSqrt(float x);
-    void    computeAngles();
+    void    computeRoll();
+    void    computePitch();
+    void    computeYaw();
 
     float   beta;             // algorithm gain
     float   q0;
@@ -36,7 +40,7 @@ private:
     float   roll;
     float   pitch;
     float   yaw;
-    char    anglesComputed;
+    char    anglesComputed;   // ANGLE_ROLL etc. bits for the angles that are current
     float   initialPitch;
     float   initialRoll;
 
@@ -48,42 +52,46 @@ public:
 
     void Update(float gx, float gy, float gz, float ax, float ay, float az, float mx, float my, float mz);
     void UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az);
+    void UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt);   // dt in seconds, for samples that aren't at sampleFrequency
+
     //float getPitch(){return atan2f(2.0f * q2 * q3 - 2.0f * q0 * q1, 2.0f * q0 * q0 + 2.0f * q3 * q3 - 1.0f);};
     //float getRoll(){return -1.0f * asinf(2.0f * q1 * q3 + 2.0f * q0 * q2);};
     //float getYaw(){return atan2f(2.0f * q1 * q2 - 2.0f * q0 * q3, 2.0f * q0 * q0 + 2.0f * q1 * q1 - 1.0f);};
+    // Each angle is worked out from the quaternion the first time it is
+    // asked for after an update, and only that angle
     float getRoll()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_ROLL)) computeRoll();
         return roll * 57.29578f;
     }
 
     float getPitch()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_PITCH)) computePitch();
         return pitch * 57.29578f;
     }
 
     float getYaw()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_YAW)) computeYaw();
         return yaw * 57.29578f + 180.0f;
     }
 
     float getRollRadians()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_ROLL)) computeRoll();
         return roll;
     }
 
     float getPitchRadians()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_PITCH)) computePitch();
         return pitch;
     }
 
     float getYawRadians()
     {
-        if (!anglesComputed) computeAngles();
+        if (!(anglesComputed & ANGLE_YAW)) computeYaw();
         return yaw;
     }
 
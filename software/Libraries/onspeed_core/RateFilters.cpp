@@ -0,0 +1,249 @@
+// RateFilters.cpp - Sensor loop rate and the filters sized from it
+
+#include "RateFilters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ============================================================================
+// LOOP RATE
+// ============================================================================
+
+bool isValidLoopRate(int iHz)
+{
+    return iHz == 50 || iHz == 100 || iHz == 200;
+}
+
+int validLoopRate(int iHz)
+{
+    return isValidLoopRate(iHz) ? iHz : kReferenceLoopHz;
+}
+
+int samplesForSpan(float fSpanSec, int iHz)
+{
+    if (fSpanSec <= 0.0f || iHz <= 0)
+        return 1;
+    return int(std::lround(fSpanSec * float(iHz))) + 1;
+}
+
+float spanForSamples(int iSamples, int iHz)
+{
+    if (iSamples <= 1 || iHz <= 0)
+        return 0.0f;
+    return float(iSamples - 1) / float(iHz);
+}
+
+float emaAlphaForTau(float fTauSec, int iHz)
+{
+    if (fTauSec <= 0.0f || iHz <= 0)
+        return 1.0f;
+    return 1.0f - std::exp(-1.0f / (fTauSec * float(iHz)));
+}
+
+float tauForEmaAlpha(float fAlpha, int iHz)
+{
+    if (fAlpha >= 1.0f || fAlpha <= 0.0f || iHz <= 0)
+        return 0.0f;
+    return -1.0f / (float(iHz) * std::log(1.0f - fAlpha));
+}
+
+// ============================================================================
+// SMOOTHING SETTINGS
+// ============================================================================
+
+SmoothingTimes SmoothingTimes::fromConfig(int iAoaSmoothing, int iPressureSmoothing)
+{
+    SmoothingTimes times;
+
+    // Same 1/N alpha the AOA EMA has always used at 50 Hz
+    const float fAoaAlpha = (iAoaSmoothing <= 0) ? 1.0f : 1.0f / float(iAoaSmoothing);
+
+    times.fPressureMedianSec  = spanForSamples(iPressureSmoothing, kReferenceLoopHz);
+    times.fPressureAverageSec = spanForSamples(10, kReferenceLoopHz);
+    times.fAoaTauSec          = tauForEmaAlpha(fAoaAlpha, kReferenceLoopHz);
+    times.fDecelSpanSec       = spanForSamples(15, kReferenceLoopHz);
+    times.fGyroAverageSec     = spanForSamples(30, kReferenceLoopHz);
+    times.fAccelTauSec        = tauForEmaAlpha(0.060899f, kReferenceLoopHz);
+    times.fTasDiffTauSec      = tauForEmaAlpha(0.0179f,   kReferenceLoopHz);
+    return times;
+}
+
+SmoothingParams SmoothingParams::forRate(const SmoothingTimes & times, int iHz)
+{
+    SmoothingParams params;
+
+    iHz = validLoopRate(iHz);
+    params.iHz              = iHz;
+    params.fDtSec           = 1.0f / float(iHz);
+    params.iPressureMedian  = samplesForSpan(times.fPressureMedianSec,  iHz);
+    params.iPressureAverage = samplesForSpan(times.fPressureAverageSec, iHz);
+    params.iDecelWindow     = samplesForSpan(times.fDecelSpanSec,       iHz);
+    params.iGyroAverage     = samplesForSpan(times.fGyroAverageSec,     iHz);
+    params.fAoaAlpha        = emaAlphaForTau(times.fAoaTauSec,          iHz);
+    params.fAccelAlpha      = emaAlphaForTau(times.fAccelTauSec,        iHz);
+    params.fTasDiffAlpha    = emaAlphaForTau(times.fTasDiffTauSec,      iHz);
+    return params;
+}
+
+// ============================================================================
+// MOVING AVERAGE
+// ============================================================================
+
+MovingAverage::MovingAverage(int iWindow)
+{
+    setWindow(iWindow);
+}
+
+void MovingAverage::setWindow(int iWindow)
+{
+    _iWindow = std::clamp(iWindow, 1, kMaxWindow);
+    reset();
+}
+
+void MovingAverage::reset()
+{
+    _iHead  = 0;
+    _iCount = 0;
+    _fSum   = 0.0f;
+    _fValue = 0.0f;
+}
+
+float MovingAverage::add(float fValue)
+{
+    if (_iCount == _iWindow)
+        _fSum -= _afRing[_iHead];
+    else
+        _iCount++;
+
+    _afRing[_iHead] = fValue;
+    _fSum += fValue;
+
+    // Re-add from scratch once per lap so rounding in the running sum
+    // can't build up
+    if (++_iHead == _iWindow) {
+        _iHead = 0;
+        _fSum  = 0.0f;
+        for (int i = 0; i < _iCount; i++)
+            _fSum += _afRing[i];
+    }
+
+    _fValue = _fSum / float(_iCount);
+    return _fValue;
+}
+
+// ============================================================================
+// MOVING MEDIAN
+// ============================================================================
+
+MovingMedian::MovingMedian(int iWindow)
+{
+    setWindow(iWindow);
+}
+
+void MovingMedian::setWindow(int iWindow)
+{
+    _iWindow = std::clamp(iWindow, 1, kMaxWindow);
+    reset();
+}
+
+void MovingMedian::reset()
+{
+    _iHead  = 0;
+    _iCount = 0;
+    _fValue = 0.0f;
+}
+
+float MovingMedian::add(float fValue)
+{
+    // Drop the oldest sample from the sorted copy
+    if (_iCount == _iWindow) {
+        float * pOld = std::lower_bound(_afSorted, _afSorted + _iCount, _afRing[_iHead]);
+        std::memmove(pOld, pOld + 1, sizeof(float) * size_t(_afSorted + _iCount - pOld - 1));
+        _iCount--;
+    }
+
+    // Insert the new one in order
+    float * pNew = std::upper_bound(_afSorted, _afSorted + _iCount, fValue);
+    std::memmove(pNew + 1, pNew, sizeof(float) * size_t(_afSorted + _iCount - pNew));
+    *pNew = fValue;
+    _iCount++;
+
+    _afRing[_iHead] = fValue;
+    _iHead = (_iHead + 1 == _iWindow) ? 0 : _iHead + 1;
+
+    const int iMid = _iCount / 2;
+    _fValue = (_iCount & 1) ? _afSorted[iMid] : 0.5f * (_afSorted[iMid - 1] + _afSorted[iMid]);
+    return _fValue;
+}
+
+// ============================================================================
+// SLOPE
+// ============================================================================
+
+SlopeFilter::SlopeFilter()
+{
+    configure(2, kReferenceLoopHz);
+}
+
+void SlopeFilter::configure(int iWindow, int iHz)
+{
+    _iWindow = std::clamp(iWindow, 2, kMaxWindow);
+    _fDtSec  = 1.0f / float(iHz > 0 ? iHz : kReferenceLoopHz);
+    reset();
+}
+
+void SlopeFilter::reset()
+{
+    _iHead  = 0;
+    _iCount = 0;
+    _fValue = 0.0f;
+}
+
+float SlopeFilter::add(float fValue)
+{
+    _afRing[_iHead] = fValue;
+    _iHead = (_iHead + 1 == _iWindow) ? 0 : _iHead + 1;
+    if (_iCount < _iWindow)
+        _iCount++;
+
+    if (_iCount < 2) {
+        _fValue = 0.0f;
+        return _fValue;
+    }
+
+    // Slope = sum((k - c) * y[k]) / sum((k - c)^2), k = 0 oldest
+    const float fCenter = 0.5f * float(_iCount - 1);
+    const float fDen    = float(_iCount) * (float(_iCount) * float(_iCount) - 1.0f) / 12.0f;
+    int         iIdx    = (_iCount == _iWindow) ? _iHead : 0;
+    float       fNum    = 0.0f;
+
+    for (int k = 0; k < _iCount; k++) {
+        fNum += (float(k) - fCenter) * _afRing[iIdx];
+        iIdx  = (iIdx + 1 == _iWindow) ? 0 : iIdx + 1;
+    }
+
+    _fValue = fNum / (fDen * _fDtSec);
+    return _fValue;
+}
+
+// ============================================================================
+// PRESSURE SMOOTHER
+// ============================================================================
+
+void PressureSmoother::configure(const SmoothingParams & params)
+{
+    _Median.setWindow(params.iPressureMedian);
+    _Average.setWindow(params.iPressureAverage);
+}
+
+void PressureSmoother::reset()
+{
+    _Median.reset();
+    _Average.reset();
+}
+
+float PressureSmoother::add(float fCounts)
+{
+    return _Average.add(_Median.add(fCounts));
+}
@@ -0,0 +1,163 @@
+// RateFilters.h - Sensor loop rate and the filters sized from it
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// LOOP RATE
+// ============================================================================
+
+/// The rate the smoothing settings were tuned at. Config items that count
+/// samples (AOA_SMOOTHING, PRESSURE_SMOOTHING) are in samples at this rate.
+constexpr int kReferenceLoopHz = 50;
+
+/// 50, 100 or 200 Hz: whole msec periods, all below the IMU's 208 Hz ODR.
+bool    isValidLoopRate(int iHz);
+
+/// iHz if it is a valid loop rate, otherwise kReferenceLoopHz.
+int     validLoopRate(int iHz);
+
+/// Samples whose first-to-last span is fSpanSec at iHz, at least 1.
+/// A window of N reference samples spans (N - 1) / 50 seconds, so
+/// converting through the span keeps its group delay the same.
+int     samplesForSpan(float fSpanSec, int iHz);
+
+/// Span in seconds of an iSamples window at iHz.
+float   spanForSamples(int iSamples, int iHz);
+
+/// Per-sample EMA alpha for time constant fTauSec at iHz. 0 means no
+/// smoothing (alpha 1).
+float   emaAlphaForTau(float fTauSec, int iHz);
+
+/// Time constant of a per-sample EMA alpha at iHz. Alpha 1 gives 0.
+float   tauForEmaAlpha(float fAlpha, int iHz);
+
+// ============================================================================
+// SMOOTHING SETTINGS
+// ============================================================================
+
+/// Every smoothing window and time constant in the sensor pipeline, in
+/// seconds, independent of the loop rate.
+struct SmoothingTimes {
+    float   fPressureMedianSec;     ///< Pitot / AOA running median span
+    float   fPressureAverageSec;    ///< Pitot / AOA moving average span after the median
+    float   fAoaTauSec;             ///< AOA EMA time constant
+    float   fDecelSpanSec;          ///< IAS derivative least squares span
+    float   fGyroAverageSec;        ///< Displayed gyro rate moving average span
+    float   fAccelTauSec;           ///< Accelerometer EMA before Madgwick
+    float   fTasDiffTauSec;         ///< EMA on the per-sample TAS change
+
+    /// The pipeline as tuned at 50 Hz, with the two configurable windows
+    /// given in samples at kReferenceLoopHz as they are in the config file.
+    static SmoothingTimes fromConfig(int iAoaSmoothing, int iPressureSmoothing);
+};
+
+/// SmoothingTimes converted to per-sample parameters for one loop rate.
+struct SmoothingParams {
+    int     iHz;
+    float   fDtSec;
+    int     iPressureMedian;        ///< Samples
+    int     iPressureAverage;
+    int     iDecelWindow;
+    int     iGyroAverage;
+    float   fAoaAlpha;              ///< Per-sample EMA alpha
+    float   fAccelAlpha;
+    float   fTasDiffAlpha;
+
+    static SmoothingParams forRate(const SmoothingTimes & times, int iHz);
+};
+
+// ============================================================================
+// FILTERS
+// ============================================================================
+
+/// Moving average over the last N samples, N up to kMaxWindow. Before N
+/// samples have been seen it averages what it has.
+class MovingAverage {
+public:
+    static constexpr int kMaxWindow = 128;
+
+    explicit MovingAverage(int iWindow = 1);
+
+    /// Clamped to 1..kMaxWindow. Clears the history.
+    void    setWindow(int iWindow);
+    void    reset();
+    float   add(float fValue);
+
+    float   value() const       { return _fValue; }
+    int     window() const      { return _iWindow; }
+
+private:
+    float   _afRing[kMaxWindow];
+    int     _iWindow;
+    int     _iHead;
+    int     _iCount;
+    float   _fSum;
+    float   _fValue;
+};
+
+/// Running median over the last N samples, N up to kMaxWindow. An even
+/// count gives the mean of the two middle samples.
+class MovingMedian {
+public:
+    static constexpr int kMaxWindow = 128;
+
+    explicit MovingMedian(int iWindow = 1);
+
+    void    setWindow(int iWindow);
+    void    reset();
+    float   add(float fValue);
+
+    float   value() const       { return _fValue; }
+    int     window() const      { return _iWindow; }
+
+private:
+    float   _afRing[kMaxWindow];    ///< Arrival order
+    float   _afSorted[kMaxWindow];  ///< The same samples, ascending
+    int     _iWindow;
+    int     _iHead;
+    int     _iCount;
+    float   _fValue;
+};
+
+/// Least squares slope of the last N samples, in units per second. For the
+/// centre sample this is the same as a Savitzky-Golay first derivative of
+/// order 1 or 2.
+class SlopeFilter {
+public:
+    static constexpr int kMaxWindow = 128;
+
+    SlopeFilter();
+
+    void    configure(int iWindow, int iHz);
+    void    reset();
+    float   add(float fValue);
+
+    float   value() const       { return _fValue; }
+    int     window() const      { return _iWindow; }
+
+private:
+    float   _afRing[kMaxWindow];
+    int     _iWindow;
+    int     _iHead;                 ///< Next slot to write
+    int     _iCount;
+    float   _fDtSec;
+    float   _fValue;
+};
+
+/// Pitot or AOA pressure smoothing: a running median to knock out spikes,
+/// then a moving average.
+class PressureSmoother {
+public:
+    void    configure(const SmoothingParams & params);
+    void    reset();
+    float   add(float fCounts);
+
+    float   value() const       { return _Average.value(); }
+
+private:
+    MovingMedian    _Median;
+    MovingAverage   _Average;
+};
@@ -0,0 +1,166 @@
+// RateScheduler.cpp - Rate groups for the work done inside the sensor task
+
+#include "RateScheduler.h"
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+RateScheduler::RateScheduler()
+{
+    configure(50);
+}
+
+void RateScheduler::configure(int iBaseHz)
+{
+    _iTasks   = 0;
+    _iBaseHz  = iBaseHz > 0 ? iBaseHz : 1;
+    _uCycle   = 0;
+    _bPlanned = false;
+}
+
+int RateScheduler::add(const char * szName, int iHz, TaskFn pfnTask, void * pContext, uint16_t uCost)
+{
+    if (_bPlanned || _iTasks >= kMaxTasks || pfnTask == nullptr || iHz <= 0)
+        return kNone;
+
+    // Nearest whole number of cycles. Faster than the base runs every cycle.
+    uint32_t uDivisor = uint32_t((_iBaseHz + iHz / 2) / iHz);
+    if (uDivisor < 1)
+        uDivisor = 1;
+
+    Task & task   = _aTasks[_iTasks];
+    task.szName   = szName != nullptr ? szName : "";
+    task.pfnTask  = pfnTask;
+    task.pContext = pContext;
+    task.uDivisor = uDivisor;
+    task.uPhase   = 0;
+    task.uCost    = uCost;
+    task.uRuns    = 0;
+
+    return _iTasks++;
+}
+
+// ----------------------------------------------------------------------------
+
+uint32_t RateScheduler::hyperperiod() const
+{
+    uint32_t uPeriod = 1;
+
+    for (int i = 0; i < _iTasks; i++) {
+        const uint32_t uDiv = _aTasks[i].uDivisor;
+        const uint32_t uLcm = uPeriod / gcd(uPeriod, uDiv) * uDiv;
+        if (uLcm > kMaxHyperperiod)
+            return kMaxHyperperiod;
+        uPeriod = uLcm;
+    }
+    return uPeriod;
+}
+
+void RateScheduler::plan()
+{
+    if (_bPlanned)
+        return;
+
+    // Fastest first since they have the fewest phases to choose from, then
+    // most expensive, then in the order added
+    int aOrder[kMaxTasks];
+    for (int i = 0; i < _iTasks; i++) {
+        int j = i;
+        while (j > 0) {
+            const Task & prev = _aTasks[aOrder[j - 1]];
+            const Task & task = _aTasks[i];
+            if (prev.uDivisor < task.uDivisor ||
+                (prev.uDivisor == task.uDivisor && prev.uCost >= task.uCost))
+                break;
+            aOrder[j] = aOrder[j - 1];
+            j--;
+        }
+        aOrder[j] = i;
+    }
+
+    const uint32_t uPeriod = hyperperiod();
+    uint32_t       aLoad[kMaxHyperperiod] = {};
+
+    for (int n = 0; n < _iTasks; n++) {
+        Task &   task       = _aTasks[aOrder[n]];
+        uint32_t uBestPhase = 0;
+        uint32_t uBestPeak  = UINT32_MAX;
+        uint32_t uBestSum   = UINT32_MAX;
+
+        for (uint32_t uPhase = 0; uPhase < task.uDivisor && uPhase < uPeriod; uPhase++) {
+            uint32_t uPeak = 0;
+            uint32_t uSum  = 0;
+            for (uint32_t c = uPhase; c < uPeriod; c += task.uDivisor) {
+                if (aLoad[c] > uPeak)
+                    uPeak = aLoad[c];
+                uSum += aLoad[c];
+            }
+            if (uPeak < uBestPeak || (uPeak == uBestPeak && uSum < uBestSum)) {
+                uBestPhase = uPhase;
+                uBestPeak  = uPeak;
+                uBestSum   = uSum;
+            }
+        }
+
+        task.uPhase = uBestPhase;
+        for (uint32_t c = uBestPhase; c < uPeriod; c += task.uDivisor)
+            aLoad[c] += task.uCost;
+    }
+
+    _bPlanned = true;
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+int RateScheduler::tick()
+{
+    if (!_bPlanned)
+        plan();
+
+    int iRun = 0;
+    for (int i = 0; i < _iTasks; i++) {
+        if (due(i, _uCycle)) {
+            _aTasks[i].pfnTask(_aTasks[i].pContext);
+            _aTasks[i].uRuns++;
+            iRun++;
+        }
+    }
+
+    _uCycle++;
+    return iRun;
+}
+
+uint32_t RateScheduler::costInCycle(uint32_t uCycle) const
+{
+    uint32_t uCost = 0;
+    for (int i = 0; i < _iTasks; i++)
+        if (due(i, uCycle))
+            uCost += _aTasks[i].uCost;
+    return uCost;
+}
+
+uint32_t RateScheduler::peakCost() const
+{
+    const uint32_t uPeriod = hyperperiod();
+    uint32_t       uPeak   = 0;
+
+    for (uint32_t c = 0; c < uPeriod; c++) {
+        const uint32_t uCost = costInCycle(c);
+        if (uCost > uPeak)
+            uPeak = uCost;
+    }
+    return uPeak;
+}
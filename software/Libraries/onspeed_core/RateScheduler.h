@@ -0,0 +1,87 @@
+// RateScheduler.h - Rate groups for the work done inside the sensor task
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// SCHEDULER
+// ============================================================================
+
+/// Runs registered tasks at whole fractions of a base loop rate.
+///
+/// The sensor task calls tick() once per cycle. A task asking for iHz runs
+/// every base / iHz cycles (rounded, at least every cycle), so at a 50 Hz
+/// base a 10 Hz task runs every 5th cycle and a 1 Hz task every 50th.
+///
+/// plan() gives each slower task a phase so that slow work is spread over
+/// the cycles instead of all landing on cycle 0. Phases are picked greedily,
+/// fastest and most expensive tasks first, by the lowest resulting peak
+/// cost; ties go to the earliest phase. The result only depends on what was
+/// registered, so the same tasks always give the same schedule. Tasks due in
+/// the same cycle run in the order they were added.
+class RateScheduler {
+public:
+    typedef void (*TaskFn)(void * pContext);
+
+    static constexpr int      kMaxTasks       = 12;
+    static constexpr uint32_t kMaxHyperperiod = 400;    ///< Cycles plan() balances over
+    static constexpr int      kNone           = -1;
+
+    RateScheduler();
+
+    /// Drop all tasks and set the rate tick() will be called at.
+    void        configure(int iBaseHz);
+
+    /// Register a task. uCost is a relative cost (say usec) used to balance
+    /// the phases; only the ratios matter.
+    /// @return Task handle, or kNone if full, already planned or bad arguments
+    int         add(const char * szName, int iHz, TaskFn pfnTask, void * pContext = nullptr, uint16_t uCost = 1);
+
+    /// Assign phases. No tasks can be added after. tick() calls it if needed.
+    void        plan();
+
+    /// Run the tasks due this cycle and move on to the next.
+    /// @return Number of tasks run
+    int         tick();
+
+    bool        planned() const                 { return _bPlanned; }
+    int         baseHz() const                  { return _iBaseHz; }
+    uint32_t    cycle() const                   { return _uCycle; }
+    int         taskCount() const               { return _iTasks; }
+    const char *name(int iTask) const           { return _aTasks[iTask].szName; }
+    uint32_t    divisor(int iTask) const        { return _aTasks[iTask].uDivisor; }
+    uint32_t    phase(int iTask) const          { return _aTasks[iTask].uPhase; }
+    float       rateHz(int iTask) const         { return float(_iBaseHz) / float(_aTasks[iTask].uDivisor); }
+    uint32_t    runs(int iTask) const           { return _aTasks[iTask].uRuns; }
+
+    bool        due(int iTask, uint32_t uCycle) const
+                    { return uCycle % _aTasks[iTask].uDivisor == _aTasks[iTask].uPhase; }
+
+    /// Summed cost of the tasks due in cycle uCycle
+    uint32_t    costInCycle(uint32_t uCycle) const;
+
+    /// Cycles after which the whole schedule repeats (capped at kMaxHyperperiod)
+    uint32_t    hyperperiod() const;
+
+    /// Highest costInCycle() over one hyperperiod
+    uint32_t    peakCost() const;
+
+private:
+    struct Task {
+        const char *    szName;
+        TaskFn          pfnTask;
+        void *          pContext;
+        uint32_t        uDivisor;
+        uint32_t        uPhase;
+        uint16_t        uCost;
+        uint32_t        uRuns;
+    };
+
+    Task        _aTasks[kMaxTasks];
+    int         _iTasks;
+    int         _iBaseHz;
+    uint32_t    _uCycle;
+    bool        _bPlanned;
+};
@@ -0,0 +1,61 @@
+// RuntimeConfig.h - Immutable per-cycle view of the settings the real-time tasks use
+
+#pragma once
+
+#include "OnSpeedTypes.h"
+#include "ConfigSnapshot.h"
+#include "CurveTable.h"
+
+/// Setpoints and calibration curve for one flap position.
+struct SuFlapSetpoints {
+    int                 iDegrees;
+    int                 iPotPosition;
+    float               fLDMAXAOA;
+    float               fONSPEEDFASTAOA;
+    float               fONSPEEDSLOWAOA;
+    float               fSTALLWARNAOA;
+    float               fSTALLAOA;
+    float               fMANAOA;
+    SuCalibrationCurve  AoaCurve;
+    SuCompiledCurve     AoaCompiled;    ///< AoaCurve bound, and tabled if enabled, at publish
+};
+
+/// Flat, fixed-size copy of the configuration consumed every sensor cycle.
+///
+/// The firmware's FOSConfig holds Strings and a std::vector that the web
+/// handlers edit in place. Real-time code reads this POD instead, through a
+/// ConfigSnapshot, so a save from the web UI can never be observed half-done.
+struct RuntimeConfig {
+    SuFlapSetpoints     aFlaps[MAX_AOA_CURVES];
+    int                 iFlapCount;         ///< Valid entries in aFlaps, 0..MAX_AOA_CURVES
+
+    int                 iAoaSmoothing;
+    int                 iPressureSmoothing;
+    int                 iMuteAudioUnderIAS;
+
+    SuCalibrationCurve  CasCurve;
+    CurveEvaluator      CasEval;            ///< CasCurve bound at publish
+    bool                bCasCurveEnabled;
+
+    int                 iPFwdBias;          ///< Counts
+    int                 iP45Bias;           ///< Counts
+    float               fPStaticBias;       ///< Millibars
+    float               fPitchBias;         ///< Degrees
+    float               fRollBias;          ///< Degrees
+
+    /// Setpoints for a flap index, clamped to the valid range.
+    /// A flap index computed against an older snapshot can be out of range
+    /// for this one; clamping keeps that from ever reading past the array.
+    /// With no flap entries this returns a zeroed entry.
+    const SuFlapSetpoints& flap(int iIndex) const
+    {
+        if (iFlapCount <= 0 || iIndex < 0)
+            return aFlaps[0];
+        if (iIndex >= iFlapCount)
+            return aFlaps[iFlapCount - 1];
+        return aFlaps[iIndex];
+    }
+};
+
+/// Snapshot type shared between the config writer and real-time readers.
+using RuntimeConfigSnapshot = ConfigSnapshot<RuntimeConfig>;
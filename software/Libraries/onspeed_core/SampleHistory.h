@@ -0,0 +1,159 @@
+// SampleHistory.h - Short timestamped history of an external data source, for time alignment
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/// How a value at a requested time was produced.
+enum class SampleFit : uint8_t {
+    Empty,          ///< Nothing recorded yet, output untouched
+    Interpolated,   ///< Between two samples
+    Held,           ///< After the newest sample, newest value held
+    BeforeOldest    ///< Before the oldest sample kept, oldest value used
+};
+
+/// A float member of T that is linearly interpolated. Members not listed
+/// are sample-and-hold from the earlier of the two samples.
+template <typename T>
+struct LerpField {
+    float T::*  pfValue;
+    bool        bAngle;     ///< Degrees in [-180, 180), interpolated the short way round
+};
+
+// ============================================================================
+// INTERPOLATION HELPERS
+// ============================================================================
+
+inline float lerp(float a, float b, float fFrac)
+{
+    return a + (b - a) * fFrac;
+}
+
+/// Interpolate between two angles in degrees across the +/-180 seam.
+/// Result is in [-180, 180).
+inline float lerpAngleDeg(float a, float b, float fFrac)
+{
+    float fDelta = b - a;
+    if      (fDelta >=  180.0f) fDelta -= 360.0f;
+    else if (fDelta <  -180.0f) fDelta += 360.0f;
+
+    float fOut = a + fDelta * fFrac;
+    if      (fOut >=  180.0f) fOut -= 360.0f;
+    else if (fOut <  -180.0f) fOut += 360.0f;
+    return fOut;
+}
+
+// ============================================================================
+// SAMPLE HISTORY
+// ============================================================================
+
+/// The last N decoded samples of an external source (boom, EFIS, VN-300),
+/// each stamped with its receive time in microseconds.
+///
+/// The logger asks for the value at the sensor sample time instead of
+/// writing whatever was decoded last, which removes the 0-100 ms skew
+/// between internal and external columns. Times are uint32_t micros() and
+/// are compared as signed differences, so the 71 minute wrap is harmless
+/// as long as the history spans less than half of that.
+///
+/// Not thread-safe; the firmware guards push() and sampleAt() with a
+/// spinlock. T must be trivially copyable.
+template <typename T, uint16_t N>
+class SampleHistory {
+public:
+    SampleHistory()
+        : _uHead(0)
+        , _uCount(0)
+    {
+    }
+
+    /// Record a sample. Times must not go backwards.
+    /// @return false (and nothing recorded) if uTimeUs is older than the newest sample
+    bool push(uint32_t uTimeUs, const T& value)
+    {
+        if (_uCount > 0 && diff(uTimeUs, _aTimes[index(0)]) < 0)
+            return false;
+
+        _aTimes[_uHead]  = uTimeUs;
+        _aValues[_uHead] = value;
+        _uHead = static_cast<uint16_t>((_uHead + 1) % N);
+        if (_uCount < N)
+            _uCount++;
+        return true;
+    }
+
+    void clear()            { _uHead = 0; _uCount = 0; }
+    uint16_t size() const   { return _uCount; }
+
+    /// Value at uTimeUs.
+    ///
+    /// Between two samples the fields in pFields are interpolated and the
+    /// rest are taken from the earlier sample. Outside the history the
+    /// nearest sample is copied as is.
+    ///
+    /// @param iAgeUs uTimeUs minus the time of the sample the held fields
+    ///               came from; negative for BeforeOldest
+    SampleFit sampleAt(uint32_t uTimeUs, const LerpField<T>* pFields, size_t uFieldCount,
+                       T& out, int32_t& iAgeUs) const
+    {
+        if (_uCount == 0)
+            return SampleFit::Empty;
+
+        // Walk back from the newest; the query is nearly always recent
+        const uint16_t uNewest = index(0);
+        iAgeUs = diff(uTimeUs, _aTimes[uNewest]);
+        if (iAgeUs >= 0) {
+            out = _aValues[uNewest];
+            return SampleFit::Held;
+        }
+
+        for (uint16_t i = 1; i < _uCount; i++) {
+            const uint16_t uBefore = index(i);
+            const int32_t  iSince  = diff(uTimeUs, _aTimes[uBefore]);
+            if (iSince < 0)
+                continue;
+
+            const uint16_t uAfter = index(i - 1);
+            const int32_t  iSpan  = diff(_aTimes[uAfter], _aTimes[uBefore]);
+            const float    fFrac  = iSpan > 0 ? static_cast<float>(iSince) / static_cast<float>(iSpan) : 0.0f;
+
+            const T& before = _aValues[uBefore];
+            const T& after  = _aValues[uAfter];
+            out = before;
+            for (size_t f = 0; f < uFieldCount; f++) {
+                float T::* pf = pFields[f].pfValue;
+                out.*pf = pFields[f].bAngle ? lerpAngleDeg(before.*pf, after.*pf, fFrac)
+                                            : lerp(before.*pf, after.*pf, fFrac);
+            }
+            iAgeUs = iSince;
+            return SampleFit::Interpolated;
+        }
+
+        const uint16_t uOldest = index(_uCount - 1);
+        out    = _aValues[uOldest];
+        iAgeUs = diff(uTimeUs, _aTimes[uOldest]);
+        return SampleFit::BeforeOldest;
+    }
+
+private:
+    // Slot of the i'th newest sample
+    uint16_t index(uint16_t i) const
+    {
+        return static_cast<uint16_t>((_uHead + N - 1 - i) % N);
+    }
+
+    static int32_t diff(uint32_t a, uint32_t b)
+    {
+        return static_cast<int32_t>(a - b);
+    }
+
+    uint32_t    _aTimes[N];
+    T           _aValues[N];
+    uint16_t    _uHead;     // Next slot to write
+    uint16_t    _uCount;
+};
@@ -0,0 +1,127 @@
+// SensorBus.cpp - One batched SPI transaction list for the per-cycle sensor reads
+
+#include "SensorBus.h"
+
+#include <cstring>
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+SensorBusPlan::SensorBusPlan()
+    : _uReads(0)
+    , _uSegments(0)
+    , _uBytes(0)
+    , _bCompiled(false)
+{
+    std::memset(_aTx, 0, sizeof(_aTx));
+    std::memset(_aRx, 0, sizeof(_aRx));
+}
+
+int SensorBusPlan::add(const Read & read)
+{
+    if (_bCompiled || _uReads >= kMaxReads || read.uLen == 0)
+        return kNone;
+
+    _aReads[_uReads] = read;
+    return int(_uReads++);
+}
+
+int SensorBusPlan::addRead(uint8_t uChipSel, uint8_t uLen)
+{
+    return add({ uChipSel, false, 0, uLen, 0, 0 });
+}
+
+int SensorBusPlan::addRegisterRead(uint8_t uChipSel, uint8_t uReg, uint8_t uLen, uint8_t uReadBit)
+{
+    return add({ uChipSel, true, uReg, uLen, uReadBit, 0 });
+}
+
+bool SensorBusPlan::compile()
+{
+    if (_bCompiled)
+        return true;
+
+    // First read in each segment and the register range it covers
+    size_t   aFirst[kMaxSegments];
+    unsigned aLo[kMaxSegments];
+    unsigned aHi[kMaxSegments];
+
+    _uSegments = 0;
+    for (size_t i = 0; i < _uReads; i++) {
+        Read &          read = _aReads[i];
+        const unsigned  uLo  = read.uReg;
+        const unsigned  uHi  = read.uReg + read.uLen;
+        size_t          s    = 0;
+
+        // Join a register burst on the same chip that this one touches
+        if (read.bRegister) {
+            for (s = 0; s < _uSegments; s++) {
+                const Read & first = _aReads[aFirst[s]];
+                if (first.bRegister && first.uChipSel == read.uChipSel && first.uReadBit == read.uReadBit &&
+                    uLo <= aHi[s] && uHi >= aLo[s])
+                    break;
+            }
+        }
+        else
+            s = _uSegments;
+
+        if (s == _uSegments) {
+            _aSegments[s] = { read.uChipSel, 0, 0 };
+            aFirst[s] = i;
+            aLo[s] = uLo;
+            aHi[s] = uHi;
+            _uSegments++;
+        }
+        else {
+            if (uLo < aLo[s]) aLo[s] = uLo;
+            if (uHi > aHi[s]) aHi[s] = uHi;
+        }
+        read.uSegment = uint8_t(s);
+    }
+
+    // Lay the segments out back to back
+    size_t uBytes = 0;
+    for (size_t s = 0; s < _uSegments; s++) {
+        const Read & first = _aReads[aFirst[s]];
+        const size_t uLen  = first.bRegister ? 1 + (aHi[s] - aLo[s]) : first.uLen;
+        if (uBytes + uLen > kMaxBytes)
+            return false;
+
+        std::memset(_aTx + uBytes, 0, uLen);
+        if (first.bRegister)
+            _aTx[uBytes] = uint8_t(aLo[s] | first.uReadBit);
+
+        _aSegments[s].uOffset = uint16_t(uBytes);
+        _aSegments[s].uLen    = uint16_t(uLen);
+        uBytes += uLen;
+    }
+    _uBytes = uBytes;
+
+    for (size_t i = 0; i < _uReads; i++) {
+        const Read &             read = _aReads[i];
+        const SensorBusSegment & seg  = _aSegments[read.uSegment];
+        _aDataOffset[i] = read.bRegister ? uint16_t(seg.uOffset + 1 + (read.uReg - aLo[read.uSegment]))
+                                         : seg.uOffset;
+    }
+
+    _bCompiled = true;
+    return true;
+}
+
+// ============================================================================
+// RUNNING
+// ============================================================================
+
+void SensorBusPlan::run(SensorBus & bus)
+{
+    if (_bCompiled)
+        bus.transfer(_aSegments, _uSegments, _aTx, _aRx);
+}
+
+const uint8_t * SensorBusPlan::data(int iRead) const
+{
+    if (!_bCompiled || iRead < 0 || size_t(iRead) >= _uReads)
+        return nullptr;
+    return _aRx + _aDataOffset[iRead];
+}
@@ -0,0 +1,96 @@
+// SensorBus.h - One batched SPI transaction list for the per-cycle sensor reads
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// BUS
+// ============================================================================
+
+/// One chip select assertion: uLen bytes clocked out of the tx buffer and
+/// into the rx buffer at uOffset while uChipSel is low.
+struct SensorBusSegment {
+    uint8_t     uChipSel;
+    uint16_t    uOffset;
+    uint16_t    uLen;
+};
+
+/// Runs a list of segments in order as one bus transaction (one lock, one
+/// clock setup). On the ESP32 this is the sensor SPI port; in native tests
+/// it is a mock that records what was issued.
+class SensorBus {
+public:
+    virtual ~SensorBus() = default;
+
+    virtual void transfer(const SensorBusSegment * pSegments, size_t uCount,
+                          const uint8_t * pTx, uint8_t * pRx) = 0;
+};
+
+// ============================================================================
+// PLAN
+// ============================================================================
+
+/// The reads a sensor cycle makes, planned once and then run every cycle.
+///
+/// Reads are added in the order they should happen. compile() lays them out
+/// as segments and merges register reads on the same chip that touch each
+/// other into one burst (the IMU gyro and accel blocks are adjacent), so
+/// each chip is selected once. After run(), data() points at the bytes each
+/// read asked for, with the register address byte skipped.
+class SensorBusPlan {
+public:
+    static constexpr size_t kMaxReads    = 8;
+    static constexpr size_t kMaxSegments = kMaxReads;
+    static constexpr size_t kMaxBytes    = 64;
+    static constexpr int    kNone        = -1;
+
+    SensorBusPlan();
+
+    /// A read with no command byte (Honeywell HSC: just clock out uLen bytes).
+    /// @return Handle for data(), or kNone if the plan is full or compiled
+    int addRead(uint8_t uChipSel, uint8_t uLen);
+
+    /// A burst read starting at register uReg. The address byte sent is
+    /// uReg | uReadBit; the chip must auto-increment.
+    int addRegisterRead(uint8_t uChipSel, uint8_t uReg, uint8_t uLen, uint8_t uReadBit = 0x80);
+
+    /// Lay out segments and the tx buffer. No reads can be added after.
+    /// @return false if the reads don't fit in kMaxBytes
+    bool compile();
+
+    /// Run the whole plan as one transaction. Does nothing before compile().
+    void run(SensorBus & bus);
+
+    const uint8_t *             data(int iRead) const;
+
+    bool                        compiled() const        { return _bCompiled; }
+    size_t                      readCount() const       { return _uReads; }
+    size_t                      segmentCount() const    { return _uSegments; }
+    const SensorBusSegment &    segment(size_t i) const { return _aSegments[i]; }
+    size_t                      totalBytes() const      { return _uBytes; }
+    const uint8_t *             txBuffer() const        { return _aTx; }
+
+private:
+    struct Read {
+        uint8_t     uChipSel;
+        bool        bRegister;
+        uint8_t     uReg;
+        uint8_t     uLen;
+        uint8_t     uReadBit;
+        uint8_t     uSegment;       ///< Filled in by compile()
+    };
+
+    int add(const Read & read);
+
+    Read                _aReads[kMaxReads];
+    size_t              _uReads;
+    SensorBusSegment    _aSegments[kMaxSegments];
+    size_t              _uSegments;
+    uint16_t            _aDataOffset[kMaxReads];
+    uint8_t             _aTx[kMaxBytes];
+    uint8_t             _aRx[kMaxBytes];
+    size_t              _uBytes;
+    bool                _bCompiled;
+};
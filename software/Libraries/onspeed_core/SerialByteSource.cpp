@@ -0,0 +1,39 @@
+// SerialByteSource.cpp - Byte source abstraction that feeds the serial framers
+
+#include "SerialByteSource.h"
+
+// ============================================================================
+// BYTE SOURCE
+// ============================================================================
+
+size_t pumpSerial(SerialByteSource & source, SerialFramer & framer, SerialFrameSink & sink, size_t uMaxBytes)
+{
+    uint8_t aChunk[64];
+    size_t  uMoved = 0;
+
+    while (uMoved < uMaxBytes) {
+        size_t uWant = uMaxBytes - uMoved;
+        if (uWant > sizeof(aChunk))
+            uWant = sizeof(aChunk);
+
+        size_t uRead = source.read(aChunk, uWant);
+        if (uRead == 0)
+            break;
+
+        framer.push(aChunk, uRead, source.lastByteUs(), sink);
+        uMoved += uRead;
+    }
+
+    return uMoved;
+}
+
+// ============================================================================
+// RX EVENT TIMING
+// ============================================================================
+
+uint32_t estimateLastByteUs(uint32_t uEventUs, size_t uNewBytes, const UartRxEventConfig & cfg)
+{
+    if (uNewBytes < cfg.uFifoFull)
+        return uEventUs - static_cast<uint32_t>(cfg.uTimeoutSymbols) * cfg.uByteTimeUs;
+    return uEventUs;
+}
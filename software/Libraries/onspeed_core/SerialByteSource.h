@@ -0,0 +1,52 @@
+// SerialByteSource.h - Byte source abstraction that feeds the serial framers
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SerialFramer.h"
+
+// ============================================================================
+// BYTE SOURCE
+// ============================================================================
+
+/// Where a framer's bytes come from. On the ESP32 this wraps a UART and its
+/// RX events; in native tests it is a scripted timeline.
+class SerialByteSource {
+public:
+    virtual ~SerialByteSource() = default;
+
+    /// Copy up to uMax bytes that have already been received.
+    /// @return Number of bytes copied, 0 when nothing is waiting
+    virtual size_t read(uint8_t * pBuf, size_t uMax) = 0;
+
+    /// Estimated receive time (us) of the last byte returned by read().
+    virtual uint32_t lastByteUs() const = 0;
+};
+
+/// Move bytes from a source into a framer until the source runs dry or
+/// uMaxBytes have been moved. Frames go to sink as they complete.
+/// @return Number of bytes moved
+size_t pumpSerial(SerialByteSource & source, SerialFramer & framer, SerialFrameSink & sink,
+                  size_t uMaxBytes = SIZE_MAX);
+
+// ============================================================================
+// RX EVENT TIMING
+// ============================================================================
+
+/// UART RX event settings, in the terms the ESP32 UART driver uses.
+struct UartRxEventConfig {
+    uint8_t     uFifoFull;          ///< Event when this many bytes are in the RX FIFO
+    uint8_t     uTimeoutSymbols;    ///< Event after this many idle character times
+    uint32_t    uByteTimeUs;        ///< One character time
+};
+
+/// Estimate when the newest buffered byte arrived, from the time an RX
+/// event was handled.
+///
+/// A FIFO-full event fires as the threshold byte lands. A timeout event fires
+/// uTimeoutSymbols character times after the last byte, so that much is
+/// taken off. Fewer than uFifoFull new bytes means it was a timeout.
+/// Handler latency is not known here and is not removed.
+uint32_t estimateLastByteUs(uint32_t uEventUs, size_t uNewBytes, const UartRxEventConfig & cfg);
@@ -0,0 +1,192 @@
+// SerialFramer.cpp - Incremental byte-stream framers for the EFIS, VN-300 and boom inputs
+
+#include "SerialFramer.h"
+#include "Checksum.h"
+
+#include <cstring>
+
+// ============================================================================
+// BASE FRAMER
+// ============================================================================
+
+SerialFramer::SerialFramer(uint8_t * pBuffer, uint16_t uCapacity, uint32_t uByteTimeUs)
+    : _pBuf(pBuffer)
+    , _uCap(uCapacity)
+    , _uLen(0)
+    , _uByteTimeUs(uByteTimeUs)
+    , _uByteUs(0)
+    , _uStartUs(0)
+    , _stats{}
+{
+}
+
+void SerialFramer::reset()
+{
+    _uLen = 0;
+}
+
+bool SerialFramer::append(uint8_t b)
+{
+    if (_uLen >= _uCap) {
+        _stats.uOverflows++;
+        _uLen = 0;
+        return false;
+    }
+    _pBuf[_uLen++] = b;
+    return true;
+}
+
+size_t SerialFramer::push(const uint8_t * pData, size_t uLen, uint32_t uLastByteUs, SerialFrameSink & sink)
+{
+    size_t uFrames = 0;
+
+    for (size_t i = 0; i < uLen; i++) {
+        // Back-date earlier bytes in the chunk by one character time each
+        _uByteUs = uLastByteUs - static_cast<uint32_t>(uLen - 1 - i) * _uByteTimeUs;
+        _stats.uBytes++;
+
+        if (consume(pData[i]) != EnStep::Complete)
+            continue;
+
+        if (validate(_pBuf, _uLen)) {
+            const SerialFrame frame = { _pBuf, _uLen, _uStartUs, _uByteUs };
+            _stats.uFrames++;
+            uFrames++;
+            sink.onFrame(frame);
+        } else {
+            _stats.uRejected++;
+        }
+        _uLen = 0;
+    }
+
+    return uFrames;
+}
+
+// ============================================================================
+// VN-300 BINARY FRAMER
+// ============================================================================
+
+VN300Framer::VN300Framer(uint32_t uByteTimeUs)
+    : SerialFramer(_aBuf, kPacketLen, uByteTimeUs)
+{
+}
+
+void VN300Framer::reset()
+{
+    SerialFramer::reset();
+}
+
+SerialFramer::EnStep VN300Framer::consume(uint8_t b)
+{
+    // Sync byte
+    if (_uLen == 0) {
+        if (b == 0xFA) {
+            beginFrame();
+            append(b);
+        } else {
+            discard();
+        }
+        return EnStep::NeedMore;
+    }
+
+    // Group byte. Another 0xFA may be the real sync byte.
+    if (_uLen == 1 && b != 0x19) {
+        discard();
+        _uLen = 0;
+        if (b == 0xFA) {
+            beginFrame();
+            append(b);
+        } else {
+            discard();
+        }
+        return EnStep::NeedMore;
+    }
+
+    append(b);
+    return (_uLen == kPacketLen) ? EnStep::Complete : EnStep::NeedMore;
+}
+
+// ============================================================================
+// MGL BINARY FRAMER
+// ============================================================================
+
+MglFramer::MglFramer(uint32_t uByteTimeUs, bool bCheckCrc)
+    : SerialFramer(_aBuf, kMaxMsgLen, uByteTimeUs)
+    , _bCheckCrc(bCheckCrc)
+    , _uMsgLen(0)
+{
+}
+
+void MglFramer::reset()
+{
+    SerialFramer::reset();
+    _uMsgLen = 0;
+}
+
+SerialFramer::EnStep MglFramer::consume(uint8_t b)
+{
+    switch (_uLen) {
+        case 0:     // DLE
+            if (b == 0x05) {
+                beginFrame();
+                append(b);
+            } else {
+                discard();
+            }
+            return EnStep::NeedMore;
+
+        case 1:     // STX
+            if (b == 0x02) {
+                append(b);
+            } else {
+                discard();
+                _uLen = 0;
+                if (b == 0x05) {
+                    beginFrame();
+                    append(b);
+                } else {
+                    discard();
+                }
+            }
+            return EnStep::NeedMore;
+
+        case 2:     // Length
+            append(b);
+            return EnStep::NeedMore;
+
+        case 3:     // Length XOR, check against length
+            append(b);
+            if ((_pBuf[2] ^ _pBuf[3]) != 0xFF) {
+                discard(4);
+                _uLen = 0;
+                return EnStep::NeedMore;
+            }
+            _uMsgLen = (_pBuf[2] == 0) ? 256 : _pBuf[2];
+            _uMsgLen += 20;
+            return EnStep::NeedMore;
+
+        default:
+            append(b);
+            return (_uLen >= _uMsgLen) ? EnStep::Complete : EnStep::NeedMore;
+    }
+}
+
+bool MglFramer::validate(const uint8_t * pData, size_t uLen)
+{
+    return !_bCheckCrc || crcOk(pData, uLen);
+}
+
+bool MglFramer::crcOk(const uint8_t * pMsg, size_t uLen)
+{
+    // DLE, STX, length, ~length aren't covered
+    if (uLen < 8)
+        return false;
+
+    const uint8_t * pCrc  = pMsg + uLen - 4;
+    const uint32_t  uSent = static_cast<uint32_t>(pCrc[0])
+                          | static_cast<uint32_t>(pCrc[1]) << 8
+                          | static_cast<uint32_t>(pCrc[2]) << 16
+                          | static_cast<uint32_t>(pCrc[3]) << 24;
+
+    return crc32(pMsg + 4, uLen - 8) == uSent;
+}
@@ -0,0 +1,219 @@
+// SerialFramer.h - Incremental byte-stream framers for the EFIS, VN-300 and boom inputs
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// FRAME AND SINK
+// ============================================================================
+
+/// One complete frame, valid only for the duration of the onFrame() call.
+struct SerialFrame {
+    const uint8_t * pData;
+    uint16_t        uLen;
+    uint32_t        uStartUs;   ///< Estimated arrival time of the first byte
+    uint32_t        uEndUs;     ///< Estimated arrival time of the last byte
+};
+
+/// Receives frames from a framer.
+class SerialFrameSink {
+public:
+    virtual ~SerialFrameSink() = default;
+    virtual void onFrame(const SerialFrame & frame) = 0;
+};
+
+/// Running counters, for telemetry and tests.
+struct SerialFramerStats {
+    uint32_t uBytes;        ///< Bytes pushed
+    uint32_t uFrames;       ///< Frames emitted
+    uint32_t uDiscarded;    ///< Bytes dropped while hunting for a frame start
+    uint32_t uOverflows;    ///< Frames abandoned because they outgrew the buffer
+    uint32_t uRejected;     ///< Complete frames that failed validate()
+};
+
+// ============================================================================
+// BASE FRAMER
+// ============================================================================
+
+/// Byte-at-a-time framer.
+///
+/// push() accepts any chunk of bytes (one byte, half a frame, several frames)
+/// and emits every frame that completes inside it. The framer never touches a
+/// serial port, so the same code runs on the ESP32 and in native tests.
+///
+/// Timestamps: the caller passes the time the last byte of the chunk was
+/// received. Earlier bytes are back-dated by uByteTimeUs each, which at
+/// 115200 baud is ~87 us (8N1) or ~95 us (8E1).
+class SerialFramer {
+public:
+    SerialFramer(uint8_t * pBuffer, uint16_t uCapacity, uint32_t uByteTimeUs);
+    virtual ~SerialFramer() = default;
+
+    /// Feed a chunk of received bytes.
+    /// @param uLastByteUs Receive time of pData[uLen-1]
+    /// @return Number of frames emitted
+    size_t push(const uint8_t * pData, size_t uLen, uint32_t uLastByteUs, SerialFrameSink & sink);
+
+    /// Drop any partial frame and start hunting again.
+    virtual void reset();
+
+    const SerialFramerStats & stats() const { return _stats; }
+    uint16_t bufferedLength() const         { return _uLen; }
+    void setByteTime(uint32_t uByteTimeUs)  { _uByteTimeUs = uByteTimeUs; }
+
+protected:
+    enum class EnStep : uint8_t {
+        NeedMore,   ///< Keep feeding
+        Complete,   ///< _pBuf[0.._uLen) is a full frame
+    };
+
+    /// Handle one byte. Append to the buffer with append(), mark the first
+    /// byte of a frame with beginFrame(), drop bytes with discard().
+    virtual EnStep consume(uint8_t b) = 0;
+
+    /// Optional integrity check on a complete frame (checksum, header, ...).
+    virtual bool validate(const uint8_t * /*pData*/, size_t /*uLen*/) { return true; }
+
+    void beginFrame()       { _uLen = 0; _uStartUs = _uByteUs; }
+    bool append(uint8_t b);             ///< false (and reset) on overflow
+    void discard(uint16_t uCount = 1) { _stats.uDiscarded += uCount; }
+
+    uint8_t *           _pBuf;
+    uint16_t            _uCap;
+    uint16_t            _uLen;
+
+private:
+    uint32_t            _uByteTimeUs;
+    uint32_t            _uByteUs;       // Time of the byte being consumed
+    uint32_t            _uStartUs;      // Time of the current frame's first byte
+    SerialFramerStats   _stats;
+};
+
+// ============================================================================
+// LINE FRAMER (text EFIS, boom)
+// ============================================================================
+
+/// Text lines terminated by '\n', buffered in N bytes.
+///
+/// With cStart == 0 a line starts on the byte after any '\n' (Dynon/Garmin:
+/// join mid-stream, skip the partial first line). Otherwise a line starts at
+/// cStart (boom: '$'). bKeepTerminator controls whether the '\n' is part of
+/// the emitted frame. A line longer than N is dropped and counted as an
+/// overflow.
+template <uint16_t N>
+class LineFramer : public SerialFramer {
+public:
+    LineFramer(uint32_t uByteTimeUs, char cStart, bool bKeepTerminator)
+        : SerialFramer(_aBuf, N, uByteTimeUs)
+        , _cStart(cStart)
+        , _bKeepTerminator(bKeepTerminator)
+        , _bInLine(false)
+        , _uPrev(0)
+    {
+    }
+
+    void reset() override
+    {
+        SerialFramer::reset();
+        _bInLine = false;
+        _uPrev   = 0;
+    }
+
+protected:
+    EnStep consume(uint8_t b) override
+    {
+        const uint8_t uPrev = _uPrev;
+        _uPrev = b;
+
+        if (!_bInLine) {
+            const bool bStart = _cStart ? (b == static_cast<uint8_t>(_cStart)) : (uPrev == '\n');
+            if (!bStart) {
+                discard();
+                return EnStep::NeedMore;
+            }
+            beginFrame();
+            _bInLine = true;
+        }
+
+        if (b == '\n') {
+            _bInLine = false;
+            if (_bKeepTerminator && !append(b))
+                return EnStep::NeedMore;
+            return EnStep::Complete;
+        }
+
+        if (!append(b))
+            _bInLine = false;
+        return EnStep::NeedMore;
+    }
+
+private:
+    char    _cStart;
+    bool    _bKeepTerminator;
+    bool    _bInLine;
+    uint8_t _uPrev;
+    uint8_t _aBuf[N];
+};
+
+// ============================================================================
+// VN-300 BINARY FRAMER
+// ============================================================================
+
+/// VectorNav binary output: sync 0xFA, group byte 0x19, fixed 127-byte packet.
+class VN300Framer : public SerialFramer {
+public:
+    static constexpr uint16_t kPacketLen = 127;
+
+    explicit VN300Framer(uint32_t uByteTimeUs);
+
+    void reset() override;
+
+protected:
+    EnStep consume(uint8_t b) override;
+
+private:
+    uint8_t _aBuf[kPacketLen];
+};
+
+// ============================================================================
+// MGL BINARY FRAMER
+// ============================================================================
+
+/// MGL binary EFIS: DLE (0x05), STX (0x02), length, ~length, then
+/// length + 16 more bytes (total length + 20). The last four bytes are a
+/// little-endian CRC-32 of everything from the message type byte on.
+class MglFramer : public SerialFramer {
+public:
+    static constexpr uint16_t kMaxMsgLen = 256 + 20;
+
+    /// @param bCheckCrc Reject messages whose CRC-32 doesn't match. Off by
+    ///                  default until checked against a captured MGL stream.
+    explicit MglFramer(uint32_t uByteTimeUs, bool bCheckCrc = false);
+
+    void reset() override;
+
+    /// CRC-32 check on one complete message.
+    static bool crcOk(const uint8_t * pMsg, size_t uLen);
+
+protected:
+    EnStep consume(uint8_t b) override;
+    bool validate(const uint8_t * pData, size_t uLen) override;
+
+private:
+    bool     _bCheckCrc;
+    uint16_t _uMsgLen;
+    uint8_t  _aBuf[kMaxMsgLen];
+};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+/// Microseconds per UART character at the given baud and frame bits
+/// (10 for 8N1, 11 for 8E1).
+constexpr uint32_t uartByteTimeUs(uint32_t uBaud, uint32_t uBitsPerChar)
+{
+    return (1000000UL * uBitsPerChar + uBaud / 2) / uBaud;
+}
@@ -0,0 +1,71 @@
+// Vn300Packet.cpp - VectorNav VN-300 binary output packet layout and decoder
+
+#include "Vn300Packet.h"
+#include "Checksum.h"
+
+#include <cstring>
+
+// groups (0x19): 0001 1001: group 1 (General Purpose), group 4 (GPS1 Measurement), group 5 (INS)
+//   E0 01: 1110 0000 , 0000 0001  (6,7,8,9)
+//   91 00: 1001 0001 , 0000 0000  (1,5,8)
+//   42 01: 0100 0010 , 0000 0001  (2,7,9)
+const uint8_t kVn300Header[8] = { 0xFA, 0x19, 0xE0, 0x01, 0x91, 0x00, 0x42, 0x01 };
+
+bool vn300CrcOk(const uint8_t * pPacket, size_t uLen)
+{
+    // Starts after the sync byte
+    return uLen > 1 && crc16Ccitt(pPacket + 1, uLen - 1) == 0;
+}
+
+Vn300Result decodeVn300Packet(const uint8_t * pPacket, size_t uLen, Vn300Data & data)
+{
+    if (uLen != sizeof(Vn300Wire))
+        return Vn300Result::BadLength;
+
+    if (memcmp(pPacket, kVn300Header, sizeof(kVn300Header)) != 0)
+        return Vn300Result::BadHeader;
+
+    if (!vn300CrcOk(pPacket, uLen))
+        return Vn300Result::BadCrc;
+
+    // One copy into an aligned image, then plain loads
+    Vn300Wire   w;
+    memcpy(&w, pPacket, sizeof(w));
+
+    data.AngularRateRoll  = w.afAngularRate[0];
+    data.AngularRatePitch = w.afAngularRate[1];
+    data.AngularRateYaw   = w.afAngularRate[2];
+    data.GnssLat          = w.adPosLla[0];
+    data.GnssLon          = w.adPosLla[1];
+
+    data.VelNedNorth      = w.afVelNed[0];
+    data.VelNedEast       = w.afVelNed[1];
+    data.VelNedDown       = w.afVelNed[2];
+
+    data.AccelFwd         = w.afAccel[0];
+    data.AccelLat         = w.afAccel[1];
+    data.AccelVert        = w.afAccel[2];
+
+    data.UtcHour          = w.uHour;
+    data.UtcMinute        = w.uMinute;
+    data.UtcSecond        = w.uSecond;
+
+    data.GPSFix           = w.uFix;
+    data.GnssVelNedNorth  = w.afGnssVelNed[0];
+    data.GnssVelNedEast   = w.afGnssVelNed[1];
+    data.GnssVelNedDown   = w.afGnssVelNed[2];
+
+    data.Yaw              = w.afYawPitchRoll[0];
+    data.Pitch            = w.afYawPitchRoll[1];
+    data.Roll             = w.afYawPitchRoll[2];
+
+    data.LinAccFwd        = w.afLinAccelBody[0];
+    data.LinAccLat        = w.afLinAccelBody[1];
+    data.LinAccVert       = w.afLinAccelBody[2];
+
+    data.YawSigma         = w.afYprSigma[0];
+    data.RollSigma        = w.afYprSigma[1];
+    data.PitchSigma       = w.afYprSigma[2];
+
+    return Vn300Result::Ok;
+}
@@ -0,0 +1,102 @@
+// Vn300Packet.h - VectorNav VN-300 binary output packet layout and decoder
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// WIRE LAYOUT
+// ============================================================================
+
+/// The one binary output message the VN-300 is configured for: groups 1, 4
+/// and 5 (0x19) with lat/lon. Little-endian fields, big-endian CRC.
+#pragma pack(push, 1)
+struct Vn300Wire {
+    uint8_t     uSync;              ///< 0xFA
+    uint8_t     uGroups;            ///< 0x19
+    uint16_t    uGroup1Fields;      ///< 0x01E0
+    uint16_t    uGroup4Fields;      ///< 0x0091
+    uint16_t    uGroup5Fields;      ///< 0x0142
+
+    // Group 1, general purpose
+    float       afAngularRate[3];   ///< rad/s, body frame
+    double      adPosLla[3];        ///< Degrees, degrees, meters
+    float       afVelNed[3];        ///< m/s
+    float       afAccel[3];         ///< m/s^2, body frame, includes gravity
+
+    // Group 4, GNSS1
+    int8_t      iYear;              ///< Years since 2000
+    uint8_t     uMonth;
+    uint8_t     uDay;
+    uint8_t     uHour;
+    uint8_t     uMinute;
+    uint8_t     uSecond;
+    uint16_t    uMillisecond;
+    uint8_t     uFix;
+    float       afGnssVelNed[3];    ///< m/s
+
+    // Group 5, INS
+    float       afYawPitchRoll[3];  ///< Degrees
+    float       afLinAccelBody[3];  ///< m/s^2, gravity removed
+    float       afYprSigma[3];      ///< Degrees, 1 sigma
+
+    uint8_t     aCrc[2];            ///< Big-endian CRC-16-CCITT of bytes [1, 125)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Vn300Wire) == 127, "VN-300 packet layout must be 127 bytes");
+
+/// First 8 bytes of every packet: sync, group byte and the field masks.
+extern const uint8_t kVn300Header[8];
+
+// ============================================================================
+// DECODED DATA
+// ============================================================================
+
+struct Vn300Data {
+    float       AngularRateRoll;
+    float       AngularRatePitch;
+    float       AngularRateYaw;
+    float       VelNedNorth;
+    float       VelNedEast;
+    float       VelNedDown;
+    float       AccelFwd;
+    float       AccelLat;
+    float       AccelVert;
+    float       Yaw;
+    float       Pitch;
+    float       Roll;
+    float       LinAccFwd;
+    float       LinAccLat;
+    float       LinAccVert;
+    float       YawSigma;
+    float       RollSigma;
+    float       PitchSigma;
+    float       GnssVelNedNorth;
+    float       GnssVelNedEast;
+    float       GnssVelNedDown;
+    uint8_t     GPSFix;
+    double      GnssLat;
+    double      GnssLon;
+    uint8_t     UtcHour;
+    uint8_t     UtcMinute;
+    uint8_t     UtcSecond;
+};
+
+enum class Vn300Result : uint8_t {
+    Ok,
+    BadLength,      ///< Not a 127 byte packet
+    BadHeader,      ///< Sync, group or field masks don't match our configuration
+    BadCrc
+};
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+/// Validate and decode one packet. On anything but Ok, data is untouched.
+Vn300Result decodeVn300Packet(const uint8_t * pPacket, size_t uLen, Vn300Data & data);
+
+/// True if the CRC over bytes [1, uLen) is zero.
+bool vn300CrcOk(const uint8_t * pPacket, size_t uLen);
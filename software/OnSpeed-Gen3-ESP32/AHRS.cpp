@@ -1,18 +1,26 @@
 
-#include <RunningAverage.h>
-
 #include "Globals.h"
 #include "IMU330.h"
 #include "AHRS.h"
 #include "SensorIO.h"
 
-const float accSmoothing = 0.060899; // accelerometer smoothing, exponential
-const float iasSmoothing = 0.0179;   // airspeed smoothing, exponential [optimized for ISM330 IMU]
+#include <algorithm>
+
+#include <Atmosphere.h>
+
+// Accelerometer (0.060899) and airspeed (0.0179) exponential smoothing were
+// optimized for the ISM330 IMU at 50 Hz. They come in through SmoothingParams
+// as time constants, converted to the IMU FIFO rate (accelerometer) or the
+// loop rate (airspeed).
 
 // ----------------------------------------------------------------------------
 
-AHRS::AHRS(int gyroSmoothing) : GxAvg(gyroSmoothing),GyAvg(gyroSmoothing),GzAvg(gyroSmoothing)
+AHRS::AHRS()
 {
+    fImuSampleRate = kReferenceLoopHz;
+    fImuDtSec      = 1.0 / kImuFifoOdrHz;
+    fAccSmoothing  = 1.0;
+    fIasSmoothing  = 1.0;
     fTAS     = 0.0;
     fPrevTAS = 0.0;
     TASdiffSmoothed = 0.0;
@@ -25,14 +33,23 @@ AHRS::AHRS(int gyroSmoothing) : GxAvg(gyroSmoothing),GyAvg(gyroSmoothing),GzAvg(
     SmoothedPitch =  0.0;
     SmoothedRoll  =  0.0;
     FlightPath    =  0.0;
+    CyclePitchRate = 0.0;
 
 }
 
 // ----------------------------------------------------------------------------
 
-void AHRS::Init(float fSampleRate)
+void AHRS::Init(const SmoothingParams & Smoothing)
 {
-    fImuSampleRate = fSampleRate;
+    // Accelerometer smoothing runs on every IMU FIFO sample, so keep its time
+    // constant and convert the alpha to the IMU rate
+    fImuSampleRate = Smoothing.iHz;
+    fImuDtSec      = 1.0 / kImuFifoOdrHz;
+    fAccSmoothing  = emaAlphaForTau(tauForEmaAlpha(Smoothing.fAccelAlpha, Smoothing.iHz), int(kImuFifoOdrHz));
+    fIasSmoothing  = Smoothing.fTasDiffAlpha;
+    GxAvg.setWindow(Smoothing.iGyroAverage);
+    GyAvg.setWindow(Smoothing.iGyroAverage);
+    GzAvg.setWindow(Smoothing.iGyroAverage);
 
 //    smoothedPitch = CalcPitch(getAccelForAxis(forwardGloadAxis),getAccelForAxis(lateralGloadAxis), getAccelForAxis(verticalGloadAxis))+pitchBias;
 //    smoothedRoll  = calcRoll( getAccelForAxis(forwardGloadAxis),getAccelForAxis(lateralGloadAxis), getAccelForAxis(verticalGloadAxis))+rollBias;
@@ -43,8 +60,22 @@ void AHRS::Init(float fSampleRate)
     // start Madgwick filter at 238Hz for LSM9DS1 and 208Hz for ISM330DHXC
     MadgFilter.begin(fImuSampleRate, -SmoothedPitch, SmoothedRoll);
 
-    // Kalman altitude filter
-    KalFilter.Configure(0.79078, 26.0638, 1e-11, ft2m(g_Sensors.Palt),0.00,0.00); // configure the Kalman filter (Smooth altitude and IVSI from Baro + accelerometers)
+    // Kalman altitude filter. Palt is only read at STATIC_RATE_HZ but goes in
+    // every cycle, so scale the measurement variance for the repeats to count
+    // as one reading instead of several independent ones.
+    float fAltVariance = 0.79078f * std::max(1.0f, fImuSampleRate / STATIC_RATE_HZ);
+    KalFilter.Configure(fAltVariance, 26.0638, 1e-11, ft2m(g_Sensors.Palt),0.00,0.00); // configure the Kalman filter (Smooth altitude and IVSI from Baro + accelerometers)
+#ifdef KALMAN_STEADY_STATE
+    // Full filter through the start-up transient, then the converged gains
+    if (KalFilter.EnableSteadyState(float(1/fImuSampleRate)))
+        {
+        float   fKz, fKv, fKa;
+        KalFilter.SteadyStateGains(&fKz, &fKv, &fKa);
+        g_Log.printf(MsgLog::EnAHRS, MsgLog::EnDebug, "Kalman steady-state gains %.5f %.5f %.3g\n", fKz, fKv, fKa);
+        }
+    else
+        g_Log.println(MsgLog::EnAHRS, MsgLog::EnWarning, "Kalman steady-state gains not found, using the full filter");
+#endif
 
 }
 
@@ -65,16 +96,11 @@ void AHRS::Process()
     float q[4];
 
 #ifdef OAT_AVAILABLE
-    const float Kelvin    = 273.15;
-    const float Temp_rate =   0.00198119993;
-    float       fISA_temp_k;
-    float       fOAT_k;
     float       fDA;
 
-    fISA_temp_k = 15 - Temp_rate * g_Sensors.Palt + Kelvin;
-    fOAT_k      = g_Sensors.ReadOatC() + Kelvin;
-    fDA         = g_Sensors.Palt+(fISA_temp_k/Temp_rate)*(1-pow(fISA_temp_k/fOAT_k,0.2349690));
-    fTAS        = kts2mps(g_Sensors.IAS/pow(1 - 6.8755856 * pow(10,-6) * fDA, 2.12794)); // formulas from https://edwilliams.org/avform147.htm#Mach   // m/sec
+    // Density altitude is pressure altitude until the first OAT reading
+    fDA         = g_Sensors.bOatValid ? densityAltitudeFt(g_Sensors.Palt, g_Sensors.OatC) : g_Sensors.Palt;
+    fTAS        = kts2mps(trueAirspeed(g_Sensors.IAS, fDA)); // formulas from https://edwilliams.org/avform147.htm#Mach   // m/sec
 #else
     fTAS        = kts2mps(g_Sensors.IAS*(1+ g_Sensors.Palt / 1000 * 0.02)); // m/sec
 #endif
@@ -82,78 +108,112 @@ void AHRS::Process()
     // diff IAS and then smooth it. Used for forward acceleration correction
     fTASdiff = fTAS - fPrevTAS;
     fPrevTAS = fTAS;
-    TASdiffSmoothed = iasSmoothing*fTASdiff+(1-iasSmoothing)*TASdiffSmoothed;
+    TASdiffSmoothed = fIasSmoothing*fTASdiff+(1-fIasSmoothing)*TASdiffSmoothed;
 
     // all TAS are in m/sec at this point
 
     // update AHRS
 
     // correct for installation error
-    fPitchBiasRad = deg2rad(g_Config.fPitchBias);
-    fRollBiasRad  = deg2rad(g_Config.fRollBias);
+    {
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    fPitchBiasRad = deg2rad(cfg->fPitchBias);
+    fRollBiasRad  = deg2rad(cfg->fRollBias);
+    }
     fYawBiasRad   = 0.0; // assuming zero yaw (twist) on install
 
-    // Calculate installation corrected gyro values
-    //// This is a lot of sin() and cos() math on constant values. This should be precalcualted in Init().
-    RollRateCorr  =  g_pIMU->Gx *   cos(fPitchBiasRad) * cos(fYawBiasRad) +
-////                 g_pIMU->Gy * ( cos(fYawBiasRad)   * sin(fRollBiasRad) * sin(fPitchBiasRad) * - sin(fYawBiasRad) * cos(fRollBiasRad) ) +  THAT "* -" IN THE ORIGINAL LOOKS FISHY
-                     g_pIMU->Gy * ( cos(fYawBiasRad)   * sin(fRollBiasRad) * sin(fPitchBiasRad) - sin(fYawBiasRad) * cos(fRollBiasRad) ) +
-                     g_pIMU->Gz * ( cos(fYawBiasRad)   * cos(fRollBiasRad) * sin(fPitchBiasRad) + sin(fYawBiasRad) * sin(fRollBiasRad));
-    PitchRateCorr =  g_pIMU->Gx *   cos(fPitchBiasRad) * sin(fYawBiasRad) +
-                     g_pIMU->Gy * ( sin(fYawBiasRad)   * sin(fRollBiasRad) * sin(fPitchBiasRad) + cos(fYawBiasRad) * cos(fRollBiasRad)) +
-                     g_pIMU->Gz * ( sin(fYawBiasRad)   * cos(fRollBiasRad) * sin(fPitchBiasRad) - cos(fYawBiasRad) * sin(fRollBiasRad));
-    YawRateCorr   =  g_pIMU->Gx *  -sin(fPitchBiasRad) +
-                     g_pIMU->Gy *   sin(fRollBiasRad)  * cos(fPitchBiasRad) +
-                     g_pIMU->Gz *   cos(fPitchBiasRad) * cos(fRollBiasRad);
-
-    // Displacement from CG calculation is omitted
-    AccelVertCorr = -g_pIMU->Ax * sin(fPitchBiasRad)                        +  // OK
-                     g_pIMU->Ay * sin(fRollBiasRad)  * cos(fPitchBiasRad) +
-                     g_pIMU->Az * cos(fRollBiasRad)  * cos(fPitchBiasRad);
-    AccelLatCorr  =  g_pIMU->Ax * cos(fPitchBiasRad) * sin(fYawBiasRad)   +
-                     g_pIMU->Ay * (sin(fYawBiasRad)  * sin(fPitchBiasRad) * sin(fRollBiasRad)  + cos(fYawBiasRad) * cos(fRollBiasRad)) +
-                     g_pIMU->Az * (sin(fYawBiasRad)  * cos(fRollBiasRad)  * sin(fPitchBiasRad) - cos(fYawBiasRad) * sin(fRollBiasRad));
-    AccelFwdCorr  =  g_pIMU->Ax * cos(fPitchBiasRad) * cos(fYawBiasRad)   +
-                     g_pIMU->Ay * (sin(fRollBiasRad) * sin(fPitchBiasRad) * cos(fYawBiasRad)   - sin(fYawBiasRad) * cos(fRollBiasRad)) +
-                     g_pIMU->Az * (cos(fYawBiasRad)  * cos(fRollBiasRad)  * sin(fPitchBiasRad) + sin(fYawBiasRad) * sin(fRollBiasRad));
-
-    // Average gyro values, not used for AHRS
-    GxAvg.addValue(RollRateCorr);
-    gRoll = GxAvg.getFastAverage();
-    GyAvg.addValue(PitchRateCorr);
-    gPitch = GyAvg.getFastAverage();
-    GzAvg.addValue(YawRateCorr);
-    gYaw = GzAvg.getFastAverage();
-
+    // The install correction is the same for every IMU sample this cycle
+    const float fSinP = sin(fPitchBiasRad), fCosP = cos(fPitchBiasRad);
+    const float fSinR = sin(fRollBiasRad),  fCosR = cos(fRollBiasRad);
+    const float fSinY = sin(fYawBiasRad),   fCosY = cos(fYawBiasRad);
 
     // calculate linear acceleration compensation
     // correct for forward acceleration
-    AccelFwdCompFactor  = mps2g((TASdiffSmoothed)/(1/fImuSampleRate)); //1/208hz (update rate), m/sec2 to g
-
-    //centripetal acceleration in m/sec2 = speed in m/sec * angular rate in radians
-    AccelLatCompFactor  = mps2g(deg2rad(fTAS * YawRateCorr));
-    AccelVertCompFactor = mps2g(deg2rad(fTAS * PitchRateCorr)); // TAS knots to m/sec, pitchrate in radians, m/sec2 to g
-
-    // AccelVertCorr = install corrected acceleration, unsmoothed
-    // aVert         = install corrected acceleration, smoothed
-    // AccelVertComp     = install corrected compensated acceleration, smoothed
-    // aVert         = avg(AvertCorr)
-    // AccelVertCompFactor       = centripetal compensation
-    // AccelVertComp     = avg(AvertCorr)+avg(avertCp);
-
-    // Smooth accelerometer values and add compensation
-    //aFwdCorrAvg.addValue(AccelFwdCorr);
-    //aFwd=aFwdCorrAvg.getFastAverage(); // corrected, smoothed
-    AccelFwdSmoothed  = accSmoothing * AccelFwdCorr+(1-accSmoothing) * AccelFwdSmoothed;
-    AccelFwdComp      = AccelFwdSmoothed - AccelFwdCompFactor; //corrected, smoothed and compensated
-
-    AccelLatSmoothed  = accSmoothing*AccelLatCorr+(1-accSmoothing)*AccelLatSmoothed;
-    AccelLatComp      = AccelLatSmoothed-AccelLatCompFactor; //corrected, smoothed and compensated
-
-    AccelVertSmoothed = accSmoothing*AccelVertCorr+(1-accSmoothing)*AccelVertSmoothed;
-    AccelVertComp     = AccelVertSmoothed+AccelVertCompFactor; //corrected, smoothed and compensated
-
-    MadgFilter.UpdateIMU(RollRateCorr, PitchRateCorr, YawRateCorr, AccelFwdComp, AccelLatComp, AccelVertComp);
+    AccelFwdCompFactor  = mps2g((TASdiffSmoothed)/(1/fImuSampleRate)); //1/loop rate, m/sec2 to g
+
+    // Run every IMU sample queued since the last cycle, oldest first, through
+    // the install correction, smoothing and Madgwick at the IMU's own dt.
+    const int   iSamples      = g_pIMU->iFifoSamples;
+    float       fRollRateSum  = 0.0, fPitchRateSum = 0.0, fYawRateSum  = 0.0;
+    float       fFwdSum       = 0.0, fLatSum       = 0.0, fVertSum     = 0.0;
+
+    for (int i = 0; i < iSamples; i++)
+    {
+        const SuImuSample & suImu = g_pIMU->asuFifo[i];
+
+        // Calculate installation corrected gyro values
+        RollRateCorr  =  suImu.Gx *   fCosP * fCosY +
+////                     suImu.Gy * ( fCosY * fSinR * fSinP * - fSinY * fCosR ) +  THAT "* -" IN THE ORIGINAL LOOKS FISHY
+                         suImu.Gy * ( fCosY * fSinR * fSinP - fSinY * fCosR ) +
+                         suImu.Gz * ( fCosY * fCosR * fSinP + fSinY * fSinR );
+        PitchRateCorr =  suImu.Gx *   fCosP * fSinY +
+                         suImu.Gy * ( fSinY * fSinR * fSinP + fCosY * fCosR ) +
+                         suImu.Gz * ( fSinY * fCosR * fSinP - fCosY * fSinR );
+        YawRateCorr   =  suImu.Gx *  -fSinP +
+                         suImu.Gy *   fSinR * fCosP +
+                         suImu.Gz *   fCosP * fCosR;
+
+        // Displacement from CG calculation is omitted
+        AccelVertCorr = -suImu.Ax * fSinP +  // OK
+                         suImu.Ay * fSinR * fCosP +
+                         suImu.Az * fCosR * fCosP;
+        AccelLatCorr  =  suImu.Ax * fCosP * fSinY +
+                         suImu.Ay * (fSinY * fSinP * fSinR + fCosY * fCosR) +
+                         suImu.Az * (fSinY * fCosR * fSinP - fCosY * fSinR);
+        AccelFwdCorr  =  suImu.Ax * fCosP * fCosY +
+                         suImu.Ay * (fSinR * fSinP * fCosY - fSinY * fCosR) +
+                         suImu.Az * (fCosY * fCosR * fSinP + fSinY * fSinR);
+
+        //centripetal acceleration in m/sec2 = speed in m/sec * angular rate in radians
+        AccelLatCompFactor  = mps2g(deg2rad(fTAS * YawRateCorr));
+        AccelVertCompFactor = mps2g(deg2rad(fTAS * PitchRateCorr)); // TAS knots to m/sec, pitchrate in radians, m/sec2 to g
+
+        // AccelVertCorr = install corrected acceleration, unsmoothed
+        // aVert         = install corrected acceleration, smoothed
+        // AccelVertComp     = install corrected compensated acceleration, smoothed
+        // aVert         = avg(AvertCorr)
+        // AccelVertCompFactor       = centripetal compensation
+        // AccelVertComp     = avg(AvertCorr)+avg(avertCp);
+
+        // Smooth accelerometer values and add compensation
+        //aFwdCorrAvg.addValue(AccelFwdCorr);
+        //aFwd=aFwdCorrAvg.getFastAverage(); // corrected, smoothed
+        AccelFwdSmoothed  = fAccSmoothing * AccelFwdCorr+(1-fAccSmoothing) * AccelFwdSmoothed;
+        AccelFwdComp      = AccelFwdSmoothed - AccelFwdCompFactor; //corrected, smoothed and compensated
+
+        AccelLatSmoothed  = fAccSmoothing*AccelLatCorr+(1-fAccSmoothing)*AccelLatSmoothed;
+        AccelLatComp      = AccelLatSmoothed-AccelLatCompFactor; //corrected, smoothed and compensated
+
+        AccelVertSmoothed = fAccSmoothing*AccelVertCorr+(1-fAccSmoothing)*AccelVertSmoothed;
+        AccelVertComp     = AccelVertSmoothed+AccelVertCompFactor; //corrected, smoothed and compensated
+
+        MadgFilter.UpdateIMU(RollRateCorr, PitchRateCorr, YawRateCorr, AccelFwdComp, AccelLatComp, AccelVertComp, fImuDtSec);
+
+        fRollRateSum  += RollRateCorr;
+        fPitchRateSum += PitchRateCorr;
+        fYawRateSum   += YawRateCorr;
+        fFwdSum       += AccelFwdCorr;
+        fLatSum       += AccelLatCorr;
+        fVertSum      += AccelVertCorr;
+    }
+
+    // The once per cycle values are the mean of this cycle's samples, which
+    // keeps IMU vibration from aliasing into them. With no new samples they
+    // keep their last values.
+    if (iSamples > 0)
+    {
+        AccelFwdCorr  = fFwdSum  / iSamples;
+        AccelLatCorr  = fLatSum  / iSamples;
+        AccelVertCorr = fVertSum / iSamples;
+
+        // For the AOA fusion, unsmoothed. PitchRateCorr is nose down positive.
+        CyclePitchRate = -fPitchRateSum / iSamples;
+
+        // Average gyro values, not used for AHRS
+        gRoll  = GxAvg.add(fRollRateSum  / iSamples);
+        gPitch = GyAvg.add(fPitchRateSum / iSamples);
+        gYaw   = GzAvg.add(fYawRateSum   / iSamples);
+    }
 
     SmoothedPitch = -MadgFilter.getPitch();
     SmoothedRoll  = -MadgFilter.getRoll();
@@ -1,17 +1,16 @@
 
 #pragma once
 
-#include <RunningAverage.h>
-
 #include "Globals.h"
 
 #include <MadgwickFusion.h>
 #include <KalmanFilter.h>
+#include <RateFilters.h>
 
 class AHRS
 {
 public:
-    AHRS(int gyroSmoothing);
+    AHRS();
 
     // IMU acceleration values are used to eventualy calcuate smoothed and
     // corrected pitch and roll. Here are the 3 steps they go through before
@@ -44,13 +43,17 @@ public:
     float           EarthVertG;
     float           DerivedAOA;
 
-    RunningAverage  GxAvg;
-    RunningAverage  GyAvg;
-    RunningAverage  GzAvg;
+    MovingAverage   GxAvg;
+    MovingAverage   GyAvg;
+    MovingAverage   GzAvg;
 
     float           gRoll,gPitch,gYaw;    // Gyro rates in the various axes
+    float           CyclePitchRate;       // Mean of this cycle's pitch rates, nose up positive, deg/sec
 
-    float           fImuSampleRate;
+    float           fImuSampleRate;       // Sensor loop rate, Process() calls per second
+    float           fImuDtSec;            // Time between IMU FIFO samples
+    float           fAccSmoothing;        // Accelerometer EMA alpha per IMU FIFO sample
+    float           fIasSmoothing;        // TAS change EMA alpha at fImuSampleRate
 
     Madgwick        MadgFilter;
     KalmanFilter    KalFilter;
@@ -60,7 +63,7 @@ public:
     float           fPrevTAS;
 
     // Methods
-    void    Init(float fSampleRate);
+    void    Init(const SmoothingParams & Smoothing);
     void    Process();
 
     float   PitchWithBias();
@@ -451,52 +451,72 @@ void AudioPlay::UpdateTones()
     if (bAudioTest)
         return;
 
+    // First time the tone follows the sensors, for the boot timeline
+    static bool s_bToneLive = false;
+    if (!s_bToneLive)
+        {
+        s_bToneLive = true;
+        g_BootTimeline.mark("AOA tone live", micros());
+        }
+
+    // Config values and setpoints for the current flap position
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    const SuFlapSetpoints & suFlap = cfg->flap(g_Flaps.iIndex);
+
     // If airspeed is low (like taxiing) don't make audio
-    if (g_Sensors.IAS <= g_Config.iMuteAudioUnderIAS)
+    if (g_Sensors.IAS <= cfg->iMuteAudioUnderIAS)
         {
 #ifdef TONEDEBUG
         AudioLogDebugNoBlock("AUDIO MUTED: Airspeed too low. Min:%i IAS:%.2f\n",
-            g_Config.iMuteAudioUnderIAS, g_Sensors.IAS);
+            cfg->iMuteAudioUnderIAS, g_Sensors.IAS);
 #endif
         SetTone(enToneNone);
         SetPulseFreq(20); // set the update rate to LOW_TONE_PPS_MAX if no tone is playing to pick up a pulsed tone quickly
         return;
         }
 
+    // The tones can follow the inertially aided AOA, which doesn't have the
+    // smoothing lag. It is the plain AOA when the fusion isn't running.
+#ifdef AOA_INERTIAL_FUSION
+    const float fAOA = g_Sensors.FusedAOA;
+#else
+    const float fAOA = g_Sensors.AOA;
+#endif
+
     // check AOA value and set tone and pauses between tones according to
-    if      (g_Sensors.AOA >= g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA) // stallWarningAOA
+    if      (fAOA >= suFlap.fSTALLWARNAOA) // stallWarningAOA
         {
         // play 20 pps HIGH tone
         SetTone(enToneHigh);
         SetPulseFreq(HIGH_TONE_STALL_PPS);
         }
-    else if (g_Sensors.AOA > (g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA))    // onSpeedAOAslow
+    else if (fAOA > (suFlap.fONSPEEDSLOWAOA))    // onSpeedAOAslow
         {
         // play HIGH tone at Pulse Rate 1.5 PPS to 6.2 PPS (depending on AOA value)
         SetTone(enToneHigh);
         fNewPulseFreq = mapfloat(
-            g_Sensors.AOA,
-            g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA,    // onSpeedAOAslow
-            g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA,      // stallWarningAOA
+            fAOA,
+            suFlap.fONSPEEDSLOWAOA,    // onSpeedAOAslow
+            suFlap.fSTALLWARNAOA,      // stallWarningAOA
             HIGH_TONE_PPS_MIN,
             HIGH_TONE_PPS_MAX);
         SetPulseFreq(fNewPulseFreq); // when transitioning from solid to high tone make the first one shorter
         }
-    else if(g_Sensors.AOA >= (g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA)) // onSpeedAOAfast
+    else if(fAOA >= (suFlap.fONSPEEDFASTAOA)) // onSpeedAOAfast
         {
         // play a steady LOW tone
         SetTone(enToneLow);
         SetPulseFreq(0);
         }
-    else if ((g_Sensors.AOA >= g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA) && // LDmaxAOA
-             (g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA < g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA)) // onSpeedAOAfast
+    else if ((fAOA >= suFlap.fLDMAXAOA) && // LDmaxAOA
+             (suFlap.fLDMAXAOA < suFlap.fONSPEEDFASTAOA)) // onSpeedAOAfast
         {  // if L/D max AOA is higher than OnSpeedfast, skip the low tone. This usually happens with full flaps.
         SetTone(enToneLow);
         // play LOW tone at Pulse Rate 1.5 PPS to 8.2 PPS (depending on AOA value)
         fNewPulseFreq = mapfloat(
-            g_Sensors.AOA,
-            g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA,       // LDmaxAOA
-            g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA, // onSpeedAOAfast,
+            fAOA,
+            suFlap.fLDMAXAOA,       // LDmaxAOA
+            suFlap.fONSPEEDFASTAOA, // onSpeedAOAfast,
             LOW_TONE_PPS_MIN,
             LOW_TONE_PPS_MAX);
         SetPulseFreq(fNewPulseFreq);
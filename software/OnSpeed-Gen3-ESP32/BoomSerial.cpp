@@ -2,8 +2,11 @@
 //#include "SoftwareSerial.h"
 
 #include "Globals.h"
+#include "Helpers.h"
 #include "BoomSerial.h"
 
+#include <BoomParser.h>
+
 // Not sure what these are all about
 // log raw counts for boom, no curves
 #define BOOM_ALPHA_CALC(x)      x
@@ -17,16 +20,30 @@
 //#define BOOM_STATIC_CALC(x)     0.00012207*(x - 1638)*1000; // millibars
 //#define BOOM_DYNAMIC_CALC(x)    (0.01525902*(x - 1638)) - 100; // millibars
 
-#define BOOM_PACKET_SIZE         50
+#ifdef NOBOOMCHECKSUM
+#define BOOM_CHECKSUM            false
+#else
+#define BOOM_CHECKSUM            true
+#endif
+
+// Boom port runs 8N1
+#define BOOM_BYTE_TIME_US        uartByteTimeUs(115200, 10)
 
 // ----------------------------------------------------------------------------
 
 BoomSerialIO::BoomSerialIO()
+    : srcUart(BOOM_BYTE_TIME_US)
+    , framerBoom(BOOM_BYTE_TIME_US, '$', false)
 {
-    BufferIndex     = 0;
+    xHistoryMux     = portMUX_INITIALIZER_UNLOCKED;
+
     uTimestamp      = millis();
+    uFrameUs        = 0;
+    LastReceivedTime = 0;
+    uGoodLines      = 0;
+    uCrcErrors      = 0;
+    uFormatErrors   = 0;
 
-    MaxAvailable = 0;
     Static       = 0.0;
     Dynamic      = 0.0;
     Alpha        = 0.0;
@@ -37,12 +54,14 @@ BoomSerialIO::BoomSerialIO()
 
 // ----------------------------------------------------------------------------
 
-void BoomSerialIO::Init(Stream * pBoomSerial)
+void BoomSerialIO::Init(HardwareSerial * pBoomSerial)
 {
 //    uint32_t hwSerialConfig = SerialConfig::SERIAL_8E1;
 
-    // Set the boom serial port driver
+    // Set the boom serial port driver. setup() has already opened the port.
     pSerial = pBoomSerial;
+    framerBoom.reset();
+    srcUart.Begin(pSerial);
 
     // Start in enabled mode
 //    Enable(true);
@@ -68,100 +87,96 @@ void BoomSerialIO::Enable(bool bEnable)
 
 void BoomSerialIO::Read()
 {
-    if (g_Config.bReadBoom)
-    {
-        int PacketCount = 0;
+    if (!g_Config.bReadBoom)
+        return;
+
+    // Called from the serial ingest task on a UART RX event
+    if (pumpSerial(srcUart, framerBoom, *this) > 0)
+        LastReceivedTime = millis();
+
+} // end Read()
 
-        while ((pSerial->available() > 0) && (PacketCount < BOOM_PACKET_SIZE))
-        {
-            char InChar = pSerial->read();
-#ifdef BOOMDATADEBUG
-            Serial.print(InChar);
-#endif
-            PacketCount++;
-            LastReceivedTime = millis();
-
-            // Prevent buffer overflow
-            if (BufferIndex >= BOOM_BUFFER_SIZE - 1)
-            {
-                BufferIndex = 0;
-            }
-
-            if ((BufferIndex > 0 || InChar == '$'))
-            {
-                if (InChar == '\n')
-                {
-                    // Ensure the string is null-terminated
-                    Buffer[BufferIndex] = '\0';
-
-                    if (Buffer[0] == '$' && BufferIndex >= 21)
-                    {
-                        uTimestamp=millis();
-
-#ifndef NOBOOMCHECKSUM
-                        // CRC checking
-                        int calcCRC = 0;
-                        for (int i = 0; i < BufferIndex - 4; i++)
-                        {
-                            calcCRC += Buffer[i];
-                        }
-                        calcCRC = calcCRC & 0xFF;
-
-                        // Extract CRC from buffer and convert from hex string to int
-                        char hexCRC[3];
-                        strncpy(hexCRC, &Buffer[BufferIndex - 3], 2);
-                        hexCRC[2] = '\0';  // null-terminate the string
-                        int expectedCRC = (int)strtol(hexCRC, NULL, 16);
-
-                        if (calcCRC != expectedCRC)
-                            {
-                            g_Log.printf(MsgLog::EnBoom, MsgLog::EnError, "Bad CRC  Expectd 0x%s Calc 0x%s\n",
-                                String(expectedCRC,HEX), String(calcCRC,HEX));
-                            } // end bad CRC
-
-                        // CRC OK
-                        else
-#endif
-                        {
-                            // Split the string and convert to integers
-                            int parseArrayInt[4] = {0, 0, 0, 0};
-                            char *token = strtok(Buffer + 21, ",");
-                            int parseArrayIndex = 0;
-                            while (token != NULL && parseArrayIndex < 4)
-                            {
-                                parseArrayInt[parseArrayIndex] = atoi(token);
-                                token = strtok(NULL, ",");
-                                parseArrayIndex++;
-                            }
-
-                            // Continue processing as before
-                            Static  = BOOM_STATIC_CALC(parseArrayInt[0]);
-                            Dynamic = BOOM_DYNAMIC_CALC(parseArrayInt[1]);
-                            IAS     = 0;
-                            Alpha   = BOOM_ALPHA_CALC(parseArrayInt[2]);
-                            Beta    = BOOM_BETA_CALC(parseArrayInt[3]);
-
-                            g_Log.printf(MsgLog::EnBoom, MsgLog::EnDebug, "BOOM: Static %.2f, Dynamic %.2f, Alpha %.2f, Beta %.2f, IAS %.2f\n", Static, Dynamic, Alpha, Beta, IAS);
-                        } // end CRC OK
-                    } // end if full boom message in buffer
-
-                    BufferIndex = 0;
-                } // end if CR
-
-                // No CR so store the character
-                else
-                {
-                    Buffer[BufferIndex++] = InChar;
-                }
-            } // end if reading valid message
+
+// ----------------------------------------------------------------------------
+
+// Decode one '$' sentence, LF already stripped by the framer.
+
+void BoomSerialIO::onFrame(const SerialFrame & frame)
+{
+    BoomData            suBoom;
+    BoomParseResult     enResult;
 
 #ifdef BOOMDATADEBUG
-            // Message hasn't started so this must be an error
-            else
-            {
-                Serial.print(InChar);
-            }
+    Serial.write(frame.pData, frame.uLen);
+    Serial.println();
 #endif
-        } // end while characters are available for reading
-    } // end if read boom
-}// end Read()
+    enResult = parseBoomLine((const char *)frame.pData, frame.uLen, suBoom, BOOM_CHECKSUM);
+
+    switch (enResult)
+    {
+        case BoomParseResult::Ok :
+            uGoodLines++;
+            break;
+
+        // Counted, not logged. A noisy boom cable would otherwise flood the log.
+        case BoomParseResult::BadChecksum :
+            uCrcErrors++;
+            return;
+
+        case BoomParseResult::BadFormat :
+            uFormatErrors++;
+            return;
+
+        default :
+            return;
+    }
+
+    uTimestamp = millis();
+    uFrameUs   = frame.uEndUs;
+
+    Static  = BOOM_STATIC_CALC(suBoom.iStatic);
+    Dynamic = BOOM_DYNAMIC_CALC(suBoom.iDynamic);
+    IAS     = 0;
+    Alpha   = BOOM_ALPHA_CALC(suBoom.iAlpha);
+    Beta    = BOOM_BETA_CALC(suBoom.iBeta);
+
+    SuBoomSample    suSample = { Static, Dynamic, Alpha, Beta, IAS };
+    taskENTER_CRITICAL(&xHistoryMux);
+    History.push(uFrameUs, suSample);
+    taskEXIT_CRITICAL(&xHistoryMux);
+
+    if (g_Log.Test(MsgLog::EnBoom, MsgLog::EnDebug))
+        g_Log.printf(MsgLog::EnBoom, MsgLog::EnDebug, "BOOM: Static %.2f, Dynamic %.2f, Alpha %.2f, Beta %.2f, IAS %.2f\n", Static, Dynamic, Alpha, Beta, IAS);
+
+} // end onFrame()
+
+
+// ----------------------------------------------------------------------------
+
+// Boom values as of uTimeUs. Falls back to the latest values if nothing has
+// been decoded yet.
+
+static const LerpField<BoomSerialIO::SuBoomSample> aBoomLerpFields[] =
+{
+    { &BoomSerialIO::SuBoomSample::Static,  false },
+    { &BoomSerialIO::SuBoomSample::Dynamic, false },
+    { &BoomSerialIO::SuBoomSample::Alpha,   false },
+    { &BoomSerialIO::SuBoomSample::Beta,    false },
+};
+
+SampleFit BoomSerialIO::SampleAt(uint32_t uTimeUs, SuBoomSample & suOut, int32_t & iAgeUs)
+{
+    SampleFit   enFit;
+
+    taskENTER_CRITICAL(&xHistoryMux);
+    enFit = History.sampleAt(uTimeUs, aBoomLerpFields, sizeof(aBoomLerpFields) / sizeof(aBoomLerpFields[0]), suOut, iAgeUs);
+    taskEXIT_CRITICAL(&xHistoryMux);
+
+    if (enFit == SampleFit::Empty)
+    {
+        suOut  = { Static, Dynamic, Alpha, Beta, IAS };
+        iAgeUs = (int32_t)(uTimeUs - uFrameUs);
+    }
+
+    return enFit;
+} // end SampleAt()
@@ -4,32 +4,48 @@
 //#include <SoftwareSerial.h>
 #include <HardwareSerial.h>
 
+#include <SampleHistory.h>
+#include <SerialFramer.h>
+
 #include "Globals.h"
+#include "SerialIngest.h"
 
 #define BOOM_BUFFER_SIZE    127
+#define BOOM_HISTORY_SIZE   16      // Decoded lines kept for time alignment
 
 
-class BoomSerialIO
+class BoomSerialIO : public SerialFrameSink
 {
 public:
     BoomSerialIO();
 
     // Structures
+    struct SuBoomSample
+    {
+        float   Static;
+        float   Dynamic;
+        float   Alpha;
+        float   Beta;
+        float   IAS;
+    };
 
     // Data
 public:
-//  HardwareSerial    * pSerial;
-    Stream            * pSerial;
+    HardwareSerial    * pSerial;
+    UartByteSource      srcUart;    // RX event timestamps for the framer
 
 //    bool                bEnabled;
 
-    char                Buffer[BOOM_BUFFER_SIZE];
-    byte                BufferIndex;
+    // '$' ... '\n' sentences, terminator not kept
+    LineFramer<BOOM_BUFFER_SIZE - 1> framerBoom;
 
     unsigned long       uTimestamp; // Millisecond timestamp of decoded data
+    uint32_t            uFrameUs;   // Microsecond receive time of the last byte of that data
 
     unsigned long       LastReceivedTime;
-    int                 MaxAvailable;   // A debug value
+    uint32_t            uGoodLines;
+    uint32_t            uCrcErrors;     // Lines dropped for a bad checksum
+    uint32_t            uFormatErrors;  // Lines with a good checksum but unreadable fields
     float               Static;
     float               Dynamic;
     float               Alpha;
@@ -38,7 +54,18 @@ public:
 
     // Methods
 public:
-    void Init(Stream * pBoomSerial);
+    void Init(HardwareSerial * pBoomSerial);
 //    void Enable(bool bEnable);
     void Read();
+
+    // SerialFrameSink
+    void onFrame(const SerialFrame & frame) override;
+
+    // Boom values at a sensor sample time, interpolated from the history.
+    // iAgeUs is how old the earlier of the two samples used is.
+    SampleFit SampleAt(uint32_t uTimeUs, SuBoomSample & suOut, int32_t & iAgeUs);
+
+protected:
+    SampleHistory<SuBoomSample, BOOM_HISTORY_SIZE> History;
+    portMUX_TYPE        xHistoryMux;
 };
\ No newline at end of file
@@ -1,7 +1,13 @@
 
 //#include <Arduino.h>
 
+#include <memory>
+
 #include "tinyxml2.h"
+#include <ConfigBlob.h>
+#include <ConfigFields.h>
+#include <RateFilters.h>
+#include <AOACalculator.h>
 
 #include "Globals.h"
 
@@ -17,6 +23,12 @@
 
 using namespace tinyxml2;
 
+// Binary cache of the parsed config in flash. Bump the version when the
+// encoding in SaveConfigCache() changes.
+#define CONFIG_CACHE_FILENAME   "/onspeed2.bin"
+#define CONFIG_CACHE_VERSION    4       // 2: LOOP_RATE added to the field table, 3: AOA_FILTER, 4: both CONFIG2 only
+#define CONFIG_CACHE_MAX        2048
+
 
 // ============================================================================
 
@@ -32,34 +44,59 @@ FOSConfig::FOSConfig()
 // Find and load a valid configuration. First load default compiled in values.
 // Then try loading a configuration stored in flash. Lastly, load a configuration
 // file from the SD card.
+//
+// Parsing the text is the slow part of boot, so the result is cached as a
+// binary blob in flash. The blob remembers which text files it was made from
+// and is used instead of parsing as long as those files haven't changed.
 
 void FOSConfig::LoadConfig()
 {
-    bool    bStatus = false;
+    String  sFlashConfig = "";
+    String  sSdConfig    = "";
+    bool    bSdConfig    = false;
 
     // Load default config
     LoadDefaultConfiguration();
 
 #ifdef SUPPORT_LITTLEFS
+    ReadConfigurationFileFromFlash(szDefaultConfigFilename, sFlashConfig);
+#endif
+
+    if (g_SdFileSys.bSdAvailable && g_SdFileSys.exists(szDefaultConfigFilename))
+        bSdConfig = ReadConfigurationFile(szDefaultConfigFilename, sSdConfig);
+
+#ifdef SUPPORT_LITTLEFS
+    // Use the binary cache if it was made from these same files
+    uint32_t    uStamp = ConfigSourceStamp(sFlashConfig, sSdConfig);
+
+    if (LoadConfigCache(uStamp))
+        {
+        bConfigLoaded = true;
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Configuration loaded.");
+        return;
+        }
+
     // Load configuration from flash
-    bStatus = LoadConfigurationFileFromFlash(szDefaultConfigFilename);
-    if (bStatus)
+    if (sFlashConfig.length() > 0 && LoadConfigFromString(sFlashConfig))
         bConfigLoaded = true;
 #endif
 
     // Load configuration from SD card
-    if (g_SdFileSys.bSdAvailable && g_SdFileSys.exists(szDefaultConfigFilename))
+    if (bSdConfig)
         {
-        // Load config from file
         g_Log.printf("Loading %s configuration\n", szDefaultConfigFilename);
-        bStatus = LoadConfigurationFile(szDefaultConfigFilename);
-        if (bStatus)
+        if (LoadConfigFromString(sSdConfig))
             bConfigLoaded = true;
         }
 
     // Log what happened
     if (bConfigLoaded)
+        {
         g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Configuration loaded.");
+#ifdef SUPPORT_LITTLEFS
+        SaveConfigCache(uStamp);
+#endif
+        }
     else
         g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Default configuration loaded.");
 
@@ -72,11 +109,22 @@ void FOSConfig::LoadConfig()
 bool FOSConfig::LoadConfigurationFile(char* szFilename)
     {
     String  sConfig = "";
-    bool    bStatus = false;
 
+    if (!ReadConfigurationFile(szFilename, sConfig))
+        return false;
+
+    return LoadConfigFromString(sConfig);
+    }
+
+// ----------------------------------------------------------------------------
+
+bool FOSConfig::ReadConfigurationFile(char* szFilename, String & sConfig)
+    {
     // If config file exists on SD card load it
     FsFile  hConfigFile;
 
+    sConfig = "";
+
     if (!xSemaphoreTake(xWriteMutex, pdMS_TO_TICKS(100)))
         return false;
 
@@ -98,9 +146,7 @@ bool FOSConfig::LoadConfigurationFile(char* szFilename)
 
     g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Read file '%s' from SD card\n", szFilename);
 
-    bStatus = LoadConfigFromString(sConfig);
-
-    return bStatus;
+    return true;
     }
 
 // ----------------------------------------------------------------------------
@@ -125,7 +171,7 @@ bool FOSConfig::SaveConfigurationToFile(char* szFilename)
 
 #ifdef SUPPORT_LITTLEFS
     // Save it to flash also
-    SaveConfigurationToFlash(szFilename);
+    bool    bFlashStatus = SaveConfigurationToFlash(szFilename);
 #endif
 
     // Convert the configuration to XML
@@ -152,6 +198,13 @@ bool FOSConfig::SaveConfigurationToFile(char* szFilename)
     else
         g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Saved config file to SD card");
 
+#ifdef SUPPORT_LITTLEFS
+    // Refresh the binary cache to match the files that will be read at boot
+    if (strcmp(szFilename, szDefaultConfigFilename) == 0)
+        SaveConfigCache(ConfigSourceStamp(bFlashStatus ? sConfig : String(""),
+                                          bStatus      ? sConfig : String("")));
+#endif
+
     return bStatus;
     }
 
@@ -166,8 +219,21 @@ bool FOSConfig::SaveConfigurationToFile(char* szFilename)
 bool FOSConfig::LoadConfigurationFileFromFlash(char* szFilename)
     {
     String  sConfig = "";
+
+    if (!ReadConfigurationFileFromFlash(szFilename, sConfig))
+        return false;
+
+    return LoadConfigFromString(sConfig);
+    }
+
+// ----------------------------------------------------------------------------
+
+bool FOSConfig::ReadConfigurationFileFromFlash(char* szFilename, String & sConfig)
+    {
     bool    bStatus = false;
 
+    sConfig = "";
+
     // Load configuration from flash
     if (g_bFlashFS)
         {
@@ -184,7 +250,7 @@ bool FOSConfig::LoadConfigurationFileFromFlash(char* szFilename)
 
             g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Read config file '%s' from flash\n", szFilename);
 
-            bStatus = LoadConfigFromString(sConfig);
+            bStatus = true;
             } // end if config file open OK
 
         else
@@ -242,6 +308,8 @@ bool FOSConfig::LoadDefaultConfiguration()
 
     iAoaSmoothing       = 20;
     iPressureSmoothing  = 15;
+    iLoopRateHz         = 50;
+    iAoaFilter          = int(AoaFilterKind::Ema);
     iMuteAudioUnderIAS  = 30;
 
     suDataSrc.enSrc     = SuDataSource::EnSensors;
@@ -327,9 +395,68 @@ bool FOSConfig::LoadDefaultConfiguration()
     // SD card logging
     bSdLogging          = false;
 
+    PublishRuntimeConfig();
     return true;
 }
 
+// ----------------------------------------------------------------------------
+
+// Copy the values the real-time tasks need into a new runtime snapshot and
+// make it current. Call this after any change to those fields. Only the web
+// server task and setup() change the config so publishes are never concurrent.
+
+void FOSConfig::PublishRuntimeConfig()
+{
+    RuntimeConfig   suRuntime = {};
+
+    suRuntime.iFlapCount = std::min((int)aFlaps.size(), MAX_AOA_CURVES);
+    for (int iFlapIdx = 0; iFlapIdx < suRuntime.iFlapCount; iFlapIdx++)
+        {
+        SuFlapSetpoints & suFlap = suRuntime.aFlaps[iFlapIdx];
+        suFlap.iDegrees        = aFlaps[iFlapIdx].iDegrees;
+        suFlap.iPotPosition    = aFlaps[iFlapIdx].iPotPosition;
+        suFlap.fLDMAXAOA       = aFlaps[iFlapIdx].fLDMAXAOA;
+        suFlap.fONSPEEDFASTAOA = aFlaps[iFlapIdx].fONSPEEDFASTAOA;
+        suFlap.fONSPEEDSLOWAOA = aFlaps[iFlapIdx].fONSPEEDSLOWAOA;
+        suFlap.fSTALLWARNAOA   = aFlaps[iFlapIdx].fSTALLWARNAOA;
+        suFlap.fSTALLAOA       = aFlaps[iFlapIdx].fSTALLAOA;
+        suFlap.fMANAOA         = aFlaps[iFlapIdx].fMANAOA;
+        suFlap.AoaCurve        = aFlaps[iFlapIdx].AoaCurve;
+
+#ifdef AOA_CURVE_TABLE
+        const SuCurveTable & suTable = suFlap.AoaCompiled.Table;
+        if (compileCurve(suFlap.AoaCurve, suFlap.AoaCompiled, true))
+            g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Flap %d AOA table coeffP %.3f to %.3f, max error %.5f deg\n",
+                suFlap.iDegrees, suTable.fMin, suTable.fMax, suTable.fMaxError);
+        else
+            g_Log.printf(MsgLog::EnConfig, MsgLog::EnWarning, "Flap %d AOA table error %.5f deg, using the curve\n",
+                suFlap.iDegrees, suTable.fMaxError);
+#else
+        compileCurve(suFlap.AoaCurve, suFlap.AoaCompiled, false);
+#endif
+        }
+
+    if ((int)aFlaps.size() > MAX_AOA_CURVES)
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnWarning, "Only the first %d of %d flap positions are used\n",
+            MAX_AOA_CURVES, (int)aFlaps.size());
+
+    suRuntime.iAoaSmoothing      = iAoaSmoothing;
+    suRuntime.iPressureSmoothing = iPressureSmoothing;
+    suRuntime.iMuteAudioUnderIAS = iMuteAudioUnderIAS;
+    suRuntime.CasCurve           = CasCurve;
+    suRuntime.CasEval            = CurveEvaluator::bind(CasCurve);
+    suRuntime.bCasCurveEnabled   = bCasCurveEnabled;
+    suRuntime.iPFwdBias          = iPFwdBias;
+    suRuntime.iP45Bias           = iP45Bias;
+    suRuntime.fPStaticBias       = fPStaticBias;
+    suRuntime.fPitchBias         = fPitchBias;
+    suRuntime.fRollBias          = fRollBias;
+
+    // If a reader is still on the slot we need, give it a tick to finish its cycle.
+    // Before the scheduler starts there are no readers so this never blocks there.
+    Runtime.publish(suRuntime, [] { vTaskDelay(1); });
+}
+
 // ----------------------------------------------------------------------------
 // To / From string conversion functions
 // ----------------------------------------------------------------------------
@@ -344,6 +471,59 @@ Someday I may go refactor the code to make the array indexes match the XML
 config tags, but the user never sees these so I defer that for now.
 */
 
+// Every scalar config item, in the order ConfigurationToString() writes them.
+// Both loaders and the writer work from this table. Custom entries are the
+// items that aren't a single member (flap blocks, curves, the data source
+// enum); the code below handles them by name.
+
+typedef ConfigField<FOSConfig, String> CfgField;
+
+static const CfgField s_aConfigFields[] =
+    {
+    //              CONFIG2 section CONFIG2 name          Original CONFIG name    Member
+    CfgField::Int   (nullptr,       "AOA_SMOOTHING",      "AOA_SMOOTHING",        &FOSConfig::iAoaSmoothing),
+    CfgField::Int   (nullptr,       "PRESSURE_SMOOTHING", "PRESSURE_SMOOTHING",   &FOSConfig::iPressureSmoothing),
+    CfgField::Int   (nullptr,       "LOOP_RATE",          nullptr,                &FOSConfig::iLoopRateHz),    // CONFIG2 only
+    CfgField::Int   (nullptr,       "AOA_FILTER",         nullptr,                &FOSConfig::iAoaFilter),     // CONFIG2 only
+    CfgField::Custom(nullptr,       "DATASOURCE"),
+    CfgField::Str   (nullptr,       "REPLAYLOGFILENAME",  "REPLAYLOGFILENAME",    &FOSConfig::sReplayLogFileName),
+    CfgField::Custom(nullptr,       "FLAP_POSITION"),
+    CfgField::Bool  ("VOLUME",      "ENABLED",            "VOLUMECONTROL",        &FOSConfig::bVolumeControl),
+    CfgField::Int   ("VOLUME",      "HIGH_ANALOG",        "VOLUME_HIGH_ANALOG",   &FOSConfig::iVolumeHighAnalog),
+    CfgField::Int   ("VOLUME",      "LOW_ANALOG",         "VOLUME_LOW_ANALOG",    &FOSConfig::iVolumeLowAnalog),
+    CfgField::Int   ("VOLUME",      "DEFAULT",            "VOLUME_DEFAULT",       &FOSConfig::iDefaultVolume),
+    CfgField::Bool  ("VOLUME",      "ENABLE_3DAUDIO",     "3DAUDIO",              &FOSConfig::bAudio3D),
+    CfgField::Int   ("VOLUME",      "MUTE_UNDER_IAS",     "MUTE_AUDIO_UNDER_IAS", &FOSConfig::iMuteAudioUnderIAS),
+    CfgField::Bool  (nullptr,       "OVERGWARNING",       "OVERGWARNING",         &FOSConfig::bOverGWarning),
+    CfgField::Custom("CAS_CURVE",   "CURVE"),
+    CfgField::Bool  ("CAS_CURVE",   "ENABLED",            "CAS_ENABLED",          &FOSConfig::bCasCurveEnabled),
+    CfgField::Str   ("ORIENTATION", "PORTS",              "PORTS_ORIENTATION",    &FOSConfig::sPortsOrientation),
+    CfgField::Str   ("ORIENTATION", "BOX_TOP",            "BOX_TOP_ORIENTATION",  &FOSConfig::sBoxtopOrientation),
+    CfgField::Bool  (nullptr,       "BOOM",               "BOOM",                 &FOSConfig::bReadBoom),
+    CfgField::Bool  (nullptr,       "SERIALEFISDATA",     "SERIALEFISDATA",       &FOSConfig::bReadEfisData),
+    CfgField::Str   (nullptr,       "EFISTYPE",           "EFISTYPE",             &FOSConfig::sEfisType),
+    CfgField::Str   (nullptr,       "SERIALOUTFORMAT",    "SERIALOUTFORMAT",      &FOSConfig::sSerialOutFormat),
+    CfgField::Str   (nullptr,       "CALWIZ_SOURCE",      "CALWIZ_SOURCE",        &FOSConfig::sCalSource),
+    CfgField::Int   ("BIAS",        "PFWD",               "PFWD_BIAS",            &FOSConfig::iPFwdBias),
+    CfgField::Int   ("BIAS",        "P45",                "P45_BIAS",             &FOSConfig::iP45Bias),
+    CfgField::Float ("BIAS",        "PSTATIC",            "PSTATIC_BIAS",         &FOSConfig::fPStaticBias),   // Sign flipped in V1 files
+    CfgField::Float ("BIAS",        "GX",                 "GX_BIAS",              &FOSConfig::fGxBias),
+    CfgField::Float ("BIAS",        "GY",                 "GY_BIAS",              &FOSConfig::fGyBias),
+    CfgField::Float ("BIAS",        "GZ",                 "GZ_BIAS",              &FOSConfig::fGzBias),
+    CfgField::Float ("BIAS",        "PITCH",              "PITCH_BIAS",           &FOSConfig::fPitchBias),
+    CfgField::Float ("BIAS",        "ROLL",               "ROLL_BIAS",            &FOSConfig::fRollBias),
+    CfgField::Float ("LOAD_LIMIT",  "POSITIVE",           "LOADLIMITPOSITIVE",    &FOSConfig::fLoadLimitPositive),
+    CfgField::Float ("LOAD_LIMIT",  "NEGATIVE",           "LOADLIMITNEGATIVE",    &FOSConfig::fLoadLimitNegative),
+    CfgField::Int   ("VNO",         "SPEED",              "VNO",                  &FOSConfig::iVno),
+    CfgField::UInt  ("VNO",         "CHIME_INTERVAL",     "VNO_CHIME_INTERVAL",   &FOSConfig::uVnoChimeInterval),
+    CfgField::Bool  ("VNO",         "CHIME_ENABLED",      "VNO_CHIME_ENABLED",    &FOSConfig::bVnoChimeEnabled),
+    CfgField::Bool  (nullptr,       "SDLOGGING",          "SDLOGGING",            &FOSConfig::bSdLogging),
+    };
+
+#define CONFIG_FIELD_COUNT  (sizeof(s_aConfigFields) / sizeof(s_aConfigFields[0]))
+
+// ----------------------------------------------------------------------------
+
 #define XML_INSERT(root, name)                          \
     XmlConfigNew = root->InsertNewChildElement(name);
 
@@ -356,98 +536,73 @@ String FOSConfig::ConfigurationToString()
     XMLPrinter      XmlPrint;
     XMLDocument     XmlConfigDoc;
     XMLElement    * XmlConfigRoot;
+    XMLElement    * XmlConfigSection;
     XMLElement    * XmlConfigNew;
+    const char    * szSection = nullptr;
     String          sConfig = "";
 
-    sConfig = "";
-
     XmlConfigRoot = XmlConfigDoc.NewElement("CONFIG2");
     XmlConfigDoc.InsertEndChild(XmlConfigRoot);
+    XmlConfigSection = XmlConfigRoot;
 
-    XML_INSERT_SET(XmlConfigRoot, "AOA_SMOOTHING", iAoaSmoothing)
-    XML_INSERT_SET(XmlConfigRoot, "PRESSURE_SMOOTHING", iPressureSmoothing)
-    XML_INSERT_SET(XmlConfigRoot, "DATASOURCE", suDataSrc.toCStr())
-    XML_INSERT_SET(XmlConfigRoot, "REPLAYLOGFILENAME", sReplayLogFileName.c_str())
-
-    for (int iFlapIdx = 0; iFlapIdx < aFlaps.size(); iFlapIdx++)
-        {
-        XML_INSERT(XmlConfigRoot, "FLAP_POSITION")
-        XMLElement * XmlConfigFlaps = XmlConfigNew;
-        XML_INSERT_SET(XmlConfigFlaps, "DEGREES",        aFlaps[iFlapIdx].iDegrees)
-        XML_INSERT_SET(XmlConfigFlaps, "POT_VALUE",      aFlaps[iFlapIdx].iPotPosition)
-        XML_INSERT_SET(XmlConfigFlaps, "LDMAXAOA",       aFlaps[iFlapIdx].fLDMAXAOA)
-        XML_INSERT_SET(XmlConfigFlaps, "ONSPEEDFASTAOA", aFlaps[iFlapIdx].fONSPEEDFASTAOA)
-        XML_INSERT_SET(XmlConfigFlaps, "ONSPEEDSLOWAOA", aFlaps[iFlapIdx].fONSPEEDSLOWAOA)
-        XML_INSERT_SET(XmlConfigFlaps, "STALLWARNAOA",   aFlaps[iFlapIdx].fSTALLWARNAOA)
-        XML_INSERT_SET(XmlConfigFlaps, "STALLAOA",       aFlaps[iFlapIdx].fSTALLAOA)
-        XML_INSERT_SET(XmlConfigFlaps, "MANAOA",         aFlaps[iFlapIdx].fMANAOA)
-
-        XML_INSERT(XmlConfigFlaps, "AOA_CURVE")
-        XMLElement * XmlConfigAoACurve = XmlConfigNew;
-        XML_INSERT_SET(XmlConfigAoACurve, "TYPE", aFlaps[iFlapIdx].AoaCurve.iCurveType)
-        XML_INSERT_SET(XmlConfigAoACurve, "X3",   aFlaps[iFlapIdx].AoaCurve.afCoeff[0])
-        XML_INSERT_SET(XmlConfigAoACurve, "X2",   aFlaps[iFlapIdx].AoaCurve.afCoeff[1])
-        XML_INSERT_SET(XmlConfigAoACurve, "X1",   aFlaps[iFlapIdx].AoaCurve.afCoeff[2])
-        XML_INSERT_SET(XmlConfigAoACurve, "X0",   aFlaps[iFlapIdx].AoaCurve.afCoeff[3])
-        }
+    for (const CfgField & Field : s_aConfigFields)
+        {
+        // Consecutive items with the same section go in one section element
+        if (!sameConfigSection(Field.szSection, szSection))
+            {
+            szSection        = Field.szSection;
+            XmlConfigSection = szSection ? XmlConfigRoot->InsertNewChildElement(szSection) : XmlConfigRoot;
+            }
 
-    XML_INSERT(XmlConfigRoot, "VOLUME")
-    XMLElement * XmlConfigVolume = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigVolume, "ENABLED",        bVolumeControl)
-    XML_INSERT_SET(XmlConfigVolume, "HIGH_ANALOG",    iVolumeHighAnalog)
-    XML_INSERT_SET(XmlConfigVolume, "LOW_ANALOG",     iVolumeLowAnalog)
-    XML_INSERT_SET(XmlConfigVolume, "DEFAULT",        iDefaultVolume)
-    XML_INSERT_SET(XmlConfigVolume, "ENABLE_3DAUDIO", bAudio3D)
-    XML_INSERT_SET(XmlConfigVolume, "MUTE_UNDER_IAS", iMuteAudioUnderIAS)
-
-    XML_INSERT_SET(XmlConfigRoot, "OVERGWARNING", bOverGWarning)
-
-    XML_INSERT(XmlConfigRoot, "CAS_CURVE")
-    XMLElement * XmlConfigCasCurve = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigCasCurve, "TYPE", CasCurve.iCurveType)
-    XML_INSERT_SET(XmlConfigCasCurve, "X3",   CasCurve.afCoeff[0])
-    XML_INSERT_SET(XmlConfigCasCurve, "X2",   CasCurve.afCoeff[1])
-    XML_INSERT_SET(XmlConfigCasCurve, "X1",   CasCurve.afCoeff[2])
-    XML_INSERT_SET(XmlConfigCasCurve, "X0",   CasCurve.afCoeff[3])
-    XML_INSERT_SET(XmlConfigCasCurve, "ENABLED", bCasCurveEnabled)
-
-    XML_INSERT(XmlConfigRoot, "ORIENTATION")
-    XMLElement * XmlConfigOrientation = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigOrientation, "PORTS",   sPortsOrientation.c_str())
-    XML_INSERT_SET(XmlConfigOrientation, "BOX_TOP", sBoxtopOrientation.c_str())
-
-    XML_INSERT_SET(XmlConfigRoot, "BOOM",           bReadBoom)
-    XML_INSERT_SET(XmlConfigRoot, "SERIALEFISDATA", bReadEfisData)
-    XML_INSERT_SET(XmlConfigRoot, "EFISTYPE",       sEfisType.c_str())
-
-    XML_INSERT_SET(XmlConfigRoot, "SERIALOUTFORMAT", sSerialOutFormat.c_str())
-//    XML_INSERT_SET(XmlConfigRoot, "SERIALOUTPORT",   sSerialOutPort.c_str())
-
-    XML_INSERT_SET(XmlConfigRoot, "CALWIZ_SOURCE", sCalSource.c_str())
-
-    XML_INSERT(XmlConfigRoot, "BIAS")
-    XMLElement * XmlConfigBias = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigBias, "PFWD",    iPFwdBias)
-    XML_INSERT_SET(XmlConfigBias, "P45",     iP45Bias)
-    XML_INSERT_SET(XmlConfigBias, "PSTATIC", fPStaticBias)
-    XML_INSERT_SET(XmlConfigBias, "GX",      fGxBias)
-    XML_INSERT_SET(XmlConfigBias, "GY",      fGyBias)
-    XML_INSERT_SET(XmlConfigBias, "GZ",      fGzBias)
-    XML_INSERT_SET(XmlConfigBias, "PITCH",   fPitchBias)
-    XML_INSERT_SET(XmlConfigBias, "ROLL",    fRollBias)
-
-    XML_INSERT(XmlConfigRoot, "LOAD_LIMIT")
-    XMLElement * XmlConfigLoadLimit = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigLoadLimit, "POSITIVE", fLoadLimitPositive)
-    XML_INSERT_SET(XmlConfigLoadLimit, "NEGATIVE", fLoadLimitNegative)
-
-    XML_INSERT(XmlConfigRoot, "VNO")
-    XMLElement * XmlConfigVNO = XmlConfigNew;
-    XML_INSERT_SET(XmlConfigVNO, "SPEED",          iVno)
-    XML_INSERT_SET(XmlConfigVNO, "CHIME_INTERVAL", uVnoChimeInterval)
-    XML_INSERT_SET(XmlConfigVNO, "CHIME_ENABLED",  bVnoChimeEnabled)
-
-    XML_INSERT_SET(XmlConfigRoot, "SDLOGGING", bSdLogging)
+        switch (Field.enType)
+            {
+            case ConfigFieldType::Int    : XML_INSERT_SET(XmlConfigSection, Field.szName, this->*Field.piValue)           break;
+            case ConfigFieldType::UInt   : XML_INSERT_SET(XmlConfigSection, Field.szName, this->*Field.puValue)           break;
+            case ConfigFieldType::Float  : XML_INSERT_SET(XmlConfigSection, Field.szName, this->*Field.pfValue)           break;
+            case ConfigFieldType::Bool   : XML_INSERT_SET(XmlConfigSection, Field.szName, this->*Field.pbValue)           break;
+            case ConfigFieldType::String : XML_INSERT_SET(XmlConfigSection, Field.szName, (this->*Field.psValue).c_str()) break;
+            case ConfigFieldType::Custom :
+                if (strcmp(Field.szName, "DATASOURCE") == 0)
+                    {
+                    XML_INSERT_SET(XmlConfigSection, "DATASOURCE", suDataSrc.toCStr())
+                    }
+
+                else if (strcmp(Field.szName, "FLAP_POSITION") == 0)
+                    {
+                    for (int iFlapIdx = 0; iFlapIdx < aFlaps.size(); iFlapIdx++)
+                        {
+                        XML_INSERT(XmlConfigSection, "FLAP_POSITION")
+                        XMLElement * XmlConfigFlaps = XmlConfigNew;
+                        XML_INSERT_SET(XmlConfigFlaps, "DEGREES",        aFlaps[iFlapIdx].iDegrees)
+                        XML_INSERT_SET(XmlConfigFlaps, "POT_VALUE",      aFlaps[iFlapIdx].iPotPosition)
+                        XML_INSERT_SET(XmlConfigFlaps, "LDMAXAOA",       aFlaps[iFlapIdx].fLDMAXAOA)
+                        XML_INSERT_SET(XmlConfigFlaps, "ONSPEEDFASTAOA", aFlaps[iFlapIdx].fONSPEEDFASTAOA)
+                        XML_INSERT_SET(XmlConfigFlaps, "ONSPEEDSLOWAOA", aFlaps[iFlapIdx].fONSPEEDSLOWAOA)
+                        XML_INSERT_SET(XmlConfigFlaps, "STALLWARNAOA",   aFlaps[iFlapIdx].fSTALLWARNAOA)
+                        XML_INSERT_SET(XmlConfigFlaps, "STALLAOA",       aFlaps[iFlapIdx].fSTALLAOA)
+                        XML_INSERT_SET(XmlConfigFlaps, "MANAOA",         aFlaps[iFlapIdx].fMANAOA)
+
+                        XML_INSERT(XmlConfigFlaps, "AOA_CURVE")
+                        XMLElement * XmlConfigAoACurve = XmlConfigNew;
+                        XML_INSERT_SET(XmlConfigAoACurve, "TYPE", aFlaps[iFlapIdx].AoaCurve.iCurveType)
+                        XML_INSERT_SET(XmlConfigAoACurve, "X3",   aFlaps[iFlapIdx].AoaCurve.afCoeff[0])
+                        XML_INSERT_SET(XmlConfigAoACurve, "X2",   aFlaps[iFlapIdx].AoaCurve.afCoeff[1])
+                        XML_INSERT_SET(XmlConfigAoACurve, "X1",   aFlaps[iFlapIdx].AoaCurve.afCoeff[2])
+                        XML_INSERT_SET(XmlConfigAoACurve, "X0",   aFlaps[iFlapIdx].AoaCurve.afCoeff[3])
+                        }
+                    }
+
+                else if (strcmp(Field.szName, "CURVE") == 0)    // CAS curve, in the CAS_CURVE section
+                    {
+                    XML_INSERT_SET(XmlConfigSection, "TYPE", CasCurve.iCurveType)
+                    XML_INSERT_SET(XmlConfigSection, "X3",   CasCurve.afCoeff[0])
+                    XML_INSERT_SET(XmlConfigSection, "X2",   CasCurve.afCoeff[1])
+                    XML_INSERT_SET(XmlConfigSection, "X1",   CasCurve.afCoeff[2])
+                    XML_INSERT_SET(XmlConfigSection, "X0",   CasCurve.afCoeff[3])
+                    }
+                break;
+            } // end switch on field type
+        } // end for each config field
 
     XmlConfigDoc.Print(&XmlPrint);
     sConfig = XmlPrint.CStr();
@@ -458,61 +613,78 @@ String FOSConfig::ConfigurationToString()
 
 // ----------------------------------------------------------------------------
 
-bool FOSConfig::LoadConfigFromString(String sConfig)
+// Decode a configuration string. The string is indexed once (ConfigXml) and
+// the items are then looked up in that index, for both the original CONFIG
+// and the CONFIG2 formats.
+
+bool FOSConfig::LoadConfigFromString(const String & sConfig)
 {
+    unsigned long   uStartUs = micros();
+
+    // About 3k, too big for the web server task stack
+    std::unique_ptr<ConfigXml>  pXml(new ConfigXml);
+    const ConfigXml           & Xml = *pXml;
+
+    if (!pXml->parse(sConfig.c_str(), sConfig.length()))
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnWarning, "Config string is not valid XML");
+        return false;
+        }
+
+    const ConfigText    XmlRootName = Xml.name(Xml.root());
 
     // Original CONFIG format
     // ----------------------
-    if (sConfig.indexOf("<CONFIG>" ) >= 0 && sConfig.indexOf("</CONFIG>" ) >= 0)
+    if (XmlRootName.equals("CONFIG"))
         {
 #ifdef SUPPORT_CONFIG_V1
         int             iFlapsArraySize;
         int             iIdx;
-        String          sDataSource;
         SuIntArray      aiValues;
         SuFloatArray    afValues;
 
-        iAoaSmoothing       = GetConfigValue(sConfig,"AOA_SMOOTHING").toInt();
-        iPressureSmoothing  = GetConfigValue(sConfig,"PRESSURE_SMOOTHING").toInt();
-        iMuteAudioUnderIAS  = GetConfigValue(sConfig,"MUTE_AUDIO_UNDER_IAS").toInt();
+        loadConfigFieldsV1(Xml, s_aConfigFields, CONFIG_FIELD_COUNT, *this);
+        fPStaticBias = -fPStaticBias;
 
-        sDataSource  = GetConfigValue(sConfig,"DATASOURCE");
-        suDataSrc.fromStrSet(sDataSource);
+        // Items added after the V1 format
+        iLoopRateHz  = kReferenceLoopHz;
+        iAoaFilter   = int(AoaFilterKind::Ema);
 
-        sReplayLogFileName  = GetConfigValue(sConfig,"REPLAYLOGFILENAME");
+        suDataSrc.fromStrSet(GetConfigValue(Xml, "DATASOURCE"));
 
         // Flap position related values
-        aiValues = ParseIntCSV(GetConfigValue(sConfig,"FLAPDEGREES"));
+        aiValues = ParseIntCSV(GetConfigValue(Xml, "FLAPDEGREES"));
         iFlapsArraySize = aiValues.Count;
         aFlaps.resize(iFlapsArraySize);
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].iDegrees = aiValues.Items[iIdx];
 
-        aiValues = ParseIntCSV(GetConfigValue(sConfig,"FLAPPOTPOSITIONS"));
+        aiValues = ParseIntCSV(GetConfigValue(Xml, "FLAPPOTPOSITIONS"));
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].iPotPosition = aiValues.Items[iIdx];
 
-        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_LDMAXAOA"));
+        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_LDMAXAOA"));
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fLDMAXAOA = afValues.Items[iIdx];
 
-        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_ONSPEEDFASTAOA"));
+        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_ONSPEEDFASTAOA"));
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fONSPEEDFASTAOA = afValues.Items[iIdx];
 
-        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_ONSPEEDSLOWAOA"));
+        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_ONSPEEDSLOWAOA"));
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fONSPEEDSLOWAOA = afValues.Items[iIdx];
 
-        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_STALLWARNAOA"));
+        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_STALLWARNAOA"));
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fSTALLWARNAOA = afValues.Items[iIdx];
 
-        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_STALLAOA"),iFlapsArraySize); // STALLAOA is only availabel after calibration wizard run
+        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_STALLAOA"),iFlapsArraySize); // STALLAOA is only availabel after calibration wizard run
         for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fSTALLAOA = afValues.Items[iIdx];
 
-//        afValues = ParseFloatCSV(GetConfigValue(sConfig,"SETPOINT_MANAOA"),iFlapsArraySize); // MANAOA is only availabel after calibration wizard run
+//        afValues = ParseFloatCSV(GetConfigValue(Xml, "SETPOINT_MANAOA"),iFlapsArraySize); // MANAOA is only availabel after calibration wizard run
 //        for (iIdx=0; (iIdx<aiValues.Count) && (iIdx<iFlapsArraySize); iIdx++) aFlaps[iIdx].fMANAOA = afValues.Items[iIdx];
 
         // aoa curves: AOA_CURVE_FLAPS0, AOA_CURVE_FLAPS1,...
         for (iIdx=0; iIdx<iFlapsArraySize; iIdx++)
             {
             SuCalibrationCurve  aAoaCurve;
-            aAoaCurve = ParseCurveCSV(GetConfigValue(sConfig,"AOA_CURVE_FLAPS"+String(iIdx)));
+            String              sCurveName = "AOA_CURVE_FLAPS" + String(iIdx);
+            aAoaCurve = ParseCurveCSV(GetConfigValue(Xml, sCurveName.c_str()));
             aFlaps[iIdx].AoaCurve.iCurveType = aAoaCurve.iCurveType;
             for (int iIdxCoeff=0; iIdxCoeff<MAX_CURVE_COEFF; iIdxCoeff++)
                 aFlaps[iIdx].AoaCurve.afCoeff[iIdxCoeff] = aAoaCurve.afCoeff[iIdxCoeff];
@@ -522,69 +694,10 @@ bool FOSConfig::LoadConfigFromString(String sConfig)
         std::sort(aFlaps.begin(), aFlaps.end(),
                 [](SuFlaps a, SuFlaps b) { return a.iDegrees < b.iDegrees; } );
 
-
-        // Volume
-        bVolumeControl      = ToBoolean(GetConfigValue(sConfig,"VOLUMECONTROL"));
-        iVolumeHighAnalog   = GetConfigValue(sConfig,"VOLUME_HIGH_ANALOG").toInt();
-        iVolumeLowAnalog    = GetConfigValue(sConfig,"VOLUME_LOW_ANALOG").toInt();
-        iDefaultVolume      = GetConfigValue(sConfig,"VOLUME_DEFAULT").toInt();
-        if (!bVolumeControl)
-            g_AudioPlay.SetVolume(iDefaultVolume);
-
-        bAudio3D            = ToBoolean(GetConfigValue(sConfig,"3DAUDIO"));
-        bOverGWarning       = ToBoolean(GetConfigValue(sConfig,"OVERGWARNING"));
-
         //CAS curve
-        CasCurve            = ParseCurveCSV(GetConfigValue(sConfig,"CAS_CURVE"));
-        bCasCurveEnabled    = ToBoolean(GetConfigValue(sConfig,"CAS_ENABLED"));
-
-        sPortsOrientation   = GetConfigValue(sConfig,"PORTS_ORIENTATION");
-        sBoxtopOrientation  = GetConfigValue(sConfig,"BOX_TOP_ORIENTATION");
-        sEfisType           = GetConfigValue(sConfig,"EFISTYPE");
-        if      (sEfisType=="VN-300")    g_EfisSerial.enType = EfisSerialIO::EnVN300;        // iEfisID = 1;
-        else if (sEfisType=="ADVANCED")  g_EfisSerial.enType = EfisSerialIO::EnDynonSkyview; // iEfisID = 2;
-        else if (sEfisType=="DYNOND10")  g_EfisSerial.enType = EfisSerialIO::EnDynonD10;     // iEfisID = 3;
-        else if (sEfisType=="GARMING5")  g_EfisSerial.enType = EfisSerialIO::EnGarminG5;     // iEfisID = 4;
-        else if (sEfisType=="GARMING3X") g_EfisSerial.enType = EfisSerialIO::EnGarminG3X;    // iEfisID = 5;
-        else if (sEfisType=="MGL")       g_EfisSerial.enType = EfisSerialIO::EnMglBinary;    // iEfisID = 6;
-        else                             g_EfisSerial.enType = EfisSerialIO::EnNone;         // iEfisID = 0;
-
-        // Calibration data source
-        sCalSource           = GetConfigValue(sConfig,"CALWIZ_SOURCE");
-
-        // Biases
-        iPFwdBias           =  GetConfigValue(sConfig,"PFWD_BIAS").toInt();
-        iP45Bias            =  GetConfigValue(sConfig,"P45_BIAS").toInt();
-        fPStaticBias        = -ToFloat(GetConfigValue(sConfig,"PSTATIC_BIAS"));
-        fGxBias             =  ToFloat(GetConfigValue(sConfig,"GX_BIAS"));
-        fGyBias             =  ToFloat(GetConfigValue(sConfig,"GY_BIAS"));
-        fGzBias             =  ToFloat(GetConfigValue(sConfig,"GZ_BIAS"));
-        fPitchBias          =  ToFloat(GetConfigValue(sConfig,"PITCH_BIAS"));
-        fRollBias           =  ToFloat(GetConfigValue(sConfig,"ROLL_BIAS"));
-
-        // serial inputs
-        bReadBoom           = ToBoolean(GetConfigValue(sConfig,"BOOM"));
-        bReadEfisData       = ToBoolean(GetConfigValue(sConfig,"SERIALEFISDATA"));
-
-        // serial output
-        sSerialOutFormat    = GetConfigValue(sConfig,"SERIALOUTFORMAT");
-//        sSerialOutPort      = GetConfigValue(sConfig,"SERIALOUTPORT");
-
-        // Load limit
-        fLoadLimitPositive  = GetConfigValue(sConfig,"LOADLIMITPOSITIVE").toFloat();
-        fLoadLimitNegative  = GetConfigValue(sConfig,"LOADLIMITNEGATIVE").toFloat();
-
-        // Vno chime
-        iVno                = GetConfigValue(sConfig,"VNO").toInt();
-        uVnoChimeInterval   = GetConfigValue(sConfig,"VNO_CHIME_INTERVAL").toInt();
-        bVnoChimeEnabled    = ToBoolean(GetConfigValue(sConfig,"VNO_CHIME_ENABLED"));
-
-        // SD card logging
-        bSdLogging          = ToBoolean(GetConfigValue(sConfig,"SDLOGGING"));
-
-        g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Decoded V1 config string");
-
-        return true;
+        CasCurve            = ParseCurveCSV(GetConfigValue(Xml, "CAS_CURVE"));
+
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Decoded V1 config string in %lu us\n", micros() - uStartUs);
 #else
         return false;
 #endif
@@ -596,68 +709,36 @@ bool FOSConfig::LoadConfigFromString(String sConfig)
 #define XML_GET_INT(root, name, value)                          \
     {                                                           \
     int          iTemp;                                         \
-    XMLElement * XmlElement = root->FirstChildElement(name);    \
-    if ((XmlElement                       != nullptr) &&        \
-        (XmlElement->QueryIntText(&iTemp) == XML_SUCCESS))      \
+    if (Xml.getInt(Xml.firstChild(root, name), iTemp))          \
         value = iTemp;                                          \
     }
 
 #define XML_GET_FLOAT(root, name, value)                        \
     {                                                           \
     float        fTemp;                                         \
-    XMLElement * XmlElement = root->FirstChildElement(name);    \
-    if ((XmlElement                         != nullptr) &&      \
-        (XmlElement->QueryFloatText(&fTemp) == XML_SUCCESS))    \
+    if (Xml.getFloat(Xml.firstChild(root, name), fTemp))        \
         value = fTemp;                                          \
     }
 
-#define XML_GET_BOOL(root, name, value)                         \
-    {                                                           \
-    bool         bTemp;                                         \
-    XMLElement * XmlElement = root->FirstChildElement(name);    \
-    if ((XmlElement                        != nullptr) &&       \
-        (XmlElement->QueryBoolText(&bTemp) == XML_SUCCESS))     \
-        value = bTemp;                                          \
-    }
-
-#define XML_GET_STR(root, name, value)                          \
-    {                                                           \
-    const char * szTemp;                                        \
-    XMLElement * XmlElement = root->FirstChildElement(name);    \
-    if ((XmlElement                       != nullptr) &&        \
-        ((szTemp = XmlElement->GetText()) != nullptr))          \
-        value = szTemp;                                         \
-    }
-
-    else if (sConfig.indexOf("<CONFIG2>" ) >= 0 && sConfig.indexOf("</CONFIG2>" ) >= 0)
+    else if (XmlRootName.equals("CONFIG2"))
         {
-        XMLDocument     XmlDoc;
-        XMLNode       * XmlRootNode;
-        String          sDataSource;
-
-        if(XmlDoc.Parse(sConfig.c_str()) != XML_SUCCESS)
-            return false;
-
-        XmlRootNode = XmlDoc.FirstChild();
-        String     sConfigRoot = XmlRootNode->Value();
+        const int16_t   XmlRootNode = Xml.root();
+        char            szDataSource[kConfigMaxString];
 
-        XML_GET_INT(XmlRootNode, "AOA_SMOOTHING",      iAoaSmoothing)
-        XML_GET_INT(XmlRootNode, "PRESSURE_SMOOTHING", iPressureSmoothing)
+        loadConfigFields(Xml, s_aConfigFields, CONFIG_FIELD_COUNT, *this);
 
-        XML_GET_STR(XmlRootNode, "DATASOURCE",         sDataSource)
-        suDataSrc.fromStrSet(sDataSource);
+        if (Xml.copyText(Xml.firstChild(XmlRootNode, "DATASOURCE"), szDataSource, sizeof(szDataSource)) > 0)
+            suDataSrc.fromStrSet(szDataSource);
 
-        XML_GET_STR(XmlRootNode, "REPLAYLOGFILENAME", sReplayLogFileName)
-
-        int          iFlapIdx  = -1;
-        XMLElement * pXmlFlaps = XmlRootNode->FirstChildElement("FLAP_POSITION");
+        int     iFlapIdx  = -1;
+        int16_t pXmlFlaps = Xml.firstChild(XmlRootNode, "FLAP_POSITION");
 
         // If there is flaps info in the config string then clear out any previous
         // flaps information.
-        if (pXmlFlaps != NULL)
+        if (pXmlFlaps != ConfigXml::kNone)
             aFlaps.clear();
 
-        while (pXmlFlaps != NULL)
+        while (pXmlFlaps != ConfigXml::kNone)
             {
             iFlapIdx++;
 
@@ -672,8 +753,8 @@ bool FOSConfig::LoadConfigFromString(String sConfig)
             XML_GET_FLOAT(pXmlFlaps, "STALLAOA",       suFlaps.fSTALLAOA)
             XML_GET_FLOAT(pXmlFlaps, "MANAOA",         suFlaps.fMANAOA)
 
-            XMLElement * pXmlAoaCurve = pXmlFlaps->FirstChildElement("AOA_CURVE");
-            if (pXmlAoaCurve != NULL)
+            int16_t pXmlAoaCurve = Xml.firstChild(pXmlFlaps, "AOA_CURVE");
+            if (pXmlAoaCurve != ConfigXml::kNone)
                 {
                 XML_GET_INT  (pXmlAoaCurve, "TYPE",       suFlaps.AoaCurve.iCurveType)
                 XML_GET_FLOAT(pXmlAoaCurve, "X3",         suFlaps.AoaCurve.afCoeff[0])
@@ -686,7 +767,7 @@ bool FOSConfig::LoadConfigFromString(String sConfig)
             if (iFlapIdx < aFlaps.size())   aFlaps[iFlapIdx] = suFlaps;
             else                            aFlaps.push_back(suFlaps);
 
-            pXmlFlaps = pXmlFlaps->NextSiblingElement("FLAP_POSITION");
+            pXmlFlaps = Xml.nextSibling(pXmlFlaps, "FLAP_POSITION");
             } // end for each FLAP_POSITION section
 
         // This is in case the new set of flaps data is smaller
@@ -696,108 +777,249 @@ bool FOSConfig::LoadConfigFromString(String sConfig)
         std::sort(aFlaps.begin(), aFlaps.end(),
                 [](SuFlaps a, SuFlaps b) { return a.iDegrees < b.iDegrees; } );
 
-        XMLElement * pXmlVolume = XmlRootNode->FirstChildElement("VOLUME");
-        if (pXmlVolume != NULL)
-            {
-            XML_GET_BOOL (pXmlVolume, "ENABLED",        bVolumeControl)
-            XML_GET_INT  (pXmlVolume, "HIGH_ANALOG",    iVolumeHighAnalog)
-            XML_GET_INT  (pXmlVolume, "LOW_ANALOG",     iVolumeLowAnalog)
-            XML_GET_INT  (pXmlVolume, "DEFAULT",        iDefaultVolume)
-            XML_GET_BOOL (pXmlVolume, "ENABLE_3DAUDIO", bAudio3D)
-            XML_GET_INT  (pXmlVolume, "MUTE_UNDER_IAS", iMuteAudioUnderIAS)
-            }
-        if (!bVolumeControl)
-            g_AudioPlay.SetVolume(iDefaultVolume);
-
-        XML_GET_BOOL (XmlRootNode, "OVERGWARNING", bOverGWarning)
-
-        XMLElement * pXmlCasCurve = XmlRootNode->FirstChildElement("CAS_CURVE");
-        if (pXmlCasCurve != NULL)
+        int16_t pXmlCasCurve = Xml.firstChild(XmlRootNode, "CAS_CURVE");
+        if (pXmlCasCurve != ConfigXml::kNone)
             {
             XML_GET_INT  (pXmlCasCurve, "TYPE",       CasCurve.iCurveType)
             XML_GET_FLOAT(pXmlCasCurve, "X3",         CasCurve.afCoeff[0])
             XML_GET_FLOAT(pXmlCasCurve, "X2",         CasCurve.afCoeff[1])
             XML_GET_FLOAT(pXmlCasCurve, "X1",         CasCurve.afCoeff[2])
             XML_GET_FLOAT(pXmlCasCurve, "X0",         CasCurve.afCoeff[3])
-            XML_GET_BOOL (pXmlCasCurve, "ENABLED",    bCasCurveEnabled)
             }
 
-        XMLElement * pXmlOrientation = XmlRootNode->FirstChildElement("ORIENTATION");
-        if (pXmlOrientation != NULL)
-            {
-            XML_GET_STR(pXmlOrientation, "PORTS",     sPortsOrientation)
-            XML_GET_STR(pXmlOrientation, "BOX_TOP",   sBoxtopOrientation)
-            }
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Decoded V2 config string in %lu us\n", micros() - uStartUs);
+        }
 
-        // Serial inputs
-        XML_GET_BOOL(XmlRootNode, "BOOM",             bReadBoom)
-        XML_GET_BOOL(XmlRootNode, "SERIALEFISDATA",   bReadEfisData)
-        XML_GET_STR(XmlRootNode,  "EFISTYPE",         sEfisType)
-        if      (sEfisType=="VN-300")    g_EfisSerial.enType = EfisSerialIO::EnVN300;        // iEfisID = 1;
-        else if (sEfisType=="ADVANCED")  g_EfisSerial.enType = EfisSerialIO::EnDynonSkyview; // iEfisID = 2;
-        else if (sEfisType=="DYNOND10")  g_EfisSerial.enType = EfisSerialIO::EnDynonD10;     // iEfisID = 3;
-        else if (sEfisType=="GARMING5")  g_EfisSerial.enType = EfisSerialIO::EnGarminG5;     // iEfisID = 4;
-        else if (sEfisType=="GARMING3X") g_EfisSerial.enType = EfisSerialIO::EnGarminG3X;    // iEfisID = 5;
-        else if (sEfisType=="MGL")       g_EfisSerial.enType = EfisSerialIO::EnMglBinary;    // iEfisID = 6;
-        else                             g_EfisSerial.enType = EfisSerialIO::EnNone;         // iEfisID = 0;
-
-        // Serial output
-        XML_GET_STR(XmlRootNode, "SERIALOUTFORMAT",   sSerialOutFormat)
-//        XML_GET_STR(XmlRootNode, "SERIALOUTPORT",     sSerialOutPort)
-
-        XML_GET_STR(XmlRootNode, "CALWIZ_SOURCE",         sCalSource)
-
-        XMLElement * pXmlBias = XmlRootNode->FirstChildElement("BIAS");
-        if (pXmlBias != NULL)
-            {
-            XML_GET_INT  (pXmlBias, "PFWD",     iPFwdBias)
-            XML_GET_INT  (pXmlBias, "P45",      iP45Bias)
-            XML_GET_FLOAT(pXmlBias, "PSTATIC",  fPStaticBias)
-            XML_GET_FLOAT(pXmlBias, "GX",       fGxBias)
-            XML_GET_FLOAT(pXmlBias, "GY",       fGyBias)
-            XML_GET_FLOAT(pXmlBias, "GZ",       fGzBias)
-            XML_GET_FLOAT(pXmlBias, "PITCH",    fPitchBias)
-            XML_GET_FLOAT(pXmlBias, "ROLL",     fRollBias)
-            }
+    // Unknown or bad format string
+    // ----------------------------
+    else
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnWarning, "Unknow config string format");
+        return false;
+        }
 
-        XMLElement * pXmlLoad = XmlRootNode->FirstChildElement("LOAD_LIMIT");
-        if (pXmlLoad != NULL)
-            {
-            XML_GET_FLOAT(pXmlLoad, "POSITIVE",  fLoadLimitPositive)
-            XML_GET_FLOAT(pXmlLoad, "NEGATIVE",  fLoadLimitNegative)
-            }
+    ApplyLoadedConfig();
+    return true;
+}
 
-        XMLElement * pXmlVno = XmlRootNode->FirstChildElement("VNO");
-        if (pXmlVno != NULL)
-            {
-            XML_GET_INT  (pXmlVno, "SPEED",           iVno)
-            XML_GET_INT  (pXmlVno, "CHIME_INTERVAL",  uVnoChimeInterval)
-            XML_GET_BOOL (pXmlVno, "CHIME_ENABLED",   bVnoChimeEnabled)
-            }
+// ----------------------------------------------------------------------------
 
-        XML_GET_BOOL(XmlRootNode, "SDLOGGING",        bSdLogging)
+// Configure anything that needs to be configured based on new config settings
 
-        g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Decoded V2 config string");
+void FOSConfig::ApplyLoadedConfig()
+{
+    if (!isValidLoopRate(iLoopRateHz))
+        {
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnWarning, "LOOP_RATE %d not supported, using %d Hz\n",
+            iLoopRateHz, kReferenceLoopHz);
+        iLoopRateHz = kReferenceLoopHz;
+        }
 
-        return true;
+    if (iAoaFilter != int(AoaFilterKind::Ema) && iAoaFilter != int(AoaFilterKind::AlphaBeta))
+        {
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnWarning, "AOA_FILTER %d not supported, using EMA\n", iAoaFilter);
+        iAoaFilter = int(AoaFilterKind::Ema);
         }
 
-    // Unknown or bad format string
-    // ----------------------------
-    else
+    if (!bVolumeControl)
+        g_AudioPlay.SetVolume(iDefaultVolume);
+
+    if      (sEfisType=="VN-300")    g_EfisSerial.enType = EfisSerialIO::EnVN300;        // iEfisID = 1;
+    else if (sEfisType=="ADVANCED")  g_EfisSerial.enType = EfisSerialIO::EnDynonSkyview; // iEfisID = 2;
+    else if (sEfisType=="DYNOND10")  g_EfisSerial.enType = EfisSerialIO::EnDynonD10;     // iEfisID = 3;
+    else if (sEfisType=="GARMING5")  g_EfisSerial.enType = EfisSerialIO::EnGarminG5;     // iEfisID = 4;
+    else if (sEfisType=="GARMING3X") g_EfisSerial.enType = EfisSerialIO::EnGarminG3X;    // iEfisID = 5;
+    else if (sEfisType=="MGL")       g_EfisSerial.enType = EfisSerialIO::EnMglBinary;    // iEfisID = 6;
+    else                             g_EfisSerial.enType = EfisSerialIO::EnNone;         // iEfisID = 0;
+
+    PublishRuntimeConfig();
+}
+
+// ----------------------------------------------------------------------------
+// Binary config cache
+// ----------------------------------------------------------------------------
+
+#ifdef SUPPORT_LITTLEFS
+
+// Identifies the text config a cache was made from. Nothing is parsed, so
+// this costs one pass over the file bytes. The firmware version is included
+// so a new build never trusts a cache from an old one.
+
+uint32_t FOSConfig::ConfigSourceStamp(const String & sFlashConfig, const String & sSdConfig)
+    {
+    uint32_t    uCrc;
+    uint32_t    uLen;
+
+    uCrc = crc32((const uint8_t *)VERSION, strlen(VERSION));
+
+    uLen = sFlashConfig.length();
+    uCrc = crc32((const uint8_t *)&uLen, sizeof(uLen), uCrc);
+    uCrc = crc32((const uint8_t *)sFlashConfig.c_str(), uLen, uCrc);
+
+    uLen = sSdConfig.length();
+    uCrc = crc32((const uint8_t *)&uLen, sizeof(uLen), uCrc);
+    uCrc = crc32((const uint8_t *)sSdConfig.c_str(), uLen, uCrc);
+
+    return uCrc;
+    }
+
+// ----------------------------------------------------------------------------
+
+// Write the current config as a binary blob. The table items go first, then
+// the items that aren't a single member, in table order.
+
+bool FOSConfig::SaveConfigCache(uint32_t uSourceStamp)
+    {
+    if (!g_bFlashFS)
+        return false;
+
+    std::unique_ptr<uint8_t[]>  pBlob(new uint8_t[CONFIG_CACHE_MAX]);
+    BlobWriter                  Out(pBlob.get() + kConfigBlobHeaderLen, CONFIG_CACHE_MAX - kConfigBlobHeaderLen);
+
+    saveConfigFieldsBinary(s_aConfigFields, CONFIG_FIELD_COUNT, *this, Out);
+
+    Out.putU8(uint8_t(suDataSrc.enSrc));
+
+    Out.putU16(uint16_t(aFlaps.size()));
+    for (const SuFlaps & suFlaps : aFlaps)
         {
-        g_Log.println(MsgLog::EnConfig, MsgLog::EnWarning, "Unknow config string format");
+        Out.putI32  (suFlaps.iDegrees);
+        Out.putI32  (suFlaps.iPotPosition);
+        Out.putFloat(suFlaps.fLDMAXAOA);
+        Out.putFloat(suFlaps.fONSPEEDFASTAOA);
+        Out.putFloat(suFlaps.fONSPEEDSLOWAOA);
+        Out.putFloat(suFlaps.fSTALLWARNAOA);
+        Out.putFloat(suFlaps.fSTALLAOA);
+        Out.putFloat(suFlaps.fMANAOA);
+        Out.putU8   (suFlaps.AoaCurve.iCurveType);
+        for (int iCoeffIdx = 0; iCoeffIdx < MAX_CURVE_COEFF; iCoeffIdx++)
+            Out.putFloat(suFlaps.AoaCurve.afCoeff[iCoeffIdx]);
+        }
+
+    Out.putU8(CasCurve.iCurveType);
+    for (int iCoeffIdx = 0; iCoeffIdx < MAX_CURVE_COEFF; iCoeffIdx++)
+        Out.putFloat(CasCurve.afCoeff[iCoeffIdx]);
+
+    if (!Out.ok())
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnError, "Config too big for the flash cache");
         return false;
         }
 
-    // Configure anything that needs to be configured based on new config settings
-    // ---------------------------------------------------------------------------
+    size_t  uBlobLen = sealConfigBlob(pBlob.get(), Out.size(), CONFIG_CACHE_VERSION,
+                                      configFieldsLayout(s_aConfigFields, CONFIG_FIELD_COUNT), uSourceStamp);
 
-    // Configure accelerometer axes
-    g_pIMU->ConfigAxes();
-    g_AHRS.Init(IMU_SAMPLE_RATE);
+    File hFlashFile = LittleFS.open(CONFIG_CACHE_FILENAME, "w");
+    if (!hFlashFile)
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnError, "Could not save config cache to flash");
+        return false;
+        }
 
-}
+    size_t  uWritten = hFlashFile.write(pBlob.get(), uBlobLen);
+    hFlashFile.close();
+
+    if (uWritten != uBlobLen)
+        {
+        // Don't leave a partial file to be read back at boot
+        LittleFS.remove(CONFIG_CACHE_FILENAME);
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnError, "Could not save config cache to flash");
+        return false;
+        }
+
+    g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Saved %u byte config cache to flash\n", unsigned(uBlobLen));
+    return true;
+    }
+
+// ----------------------------------------------------------------------------
+
+// Load the config from the flash cache if it is intact and was made from the
+// text config identified by uSourceStamp. On false the caller parses the text.
+
+bool FOSConfig::LoadConfigCache(uint32_t uSourceStamp)
+    {
+    unsigned long   uStartUs = micros();
+
+    if (!g_bFlashFS || !LittleFS.exists(CONFIG_CACHE_FILENAME))
+        return false;
+
+    File hFlashFile = LittleFS.open(CONFIG_CACHE_FILENAME, "r");
+    if (!hFlashFile)
+        return false;
+
+    size_t  uFileLen = hFlashFile.size();
+    if (uFileLen > CONFIG_CACHE_MAX)
+        {
+        hFlashFile.close();
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnWarning, "Config cache is too big, ignoring it");
+        return false;
+        }
+
+    std::unique_ptr<uint8_t[]>  pBlob(new uint8_t[CONFIG_CACHE_MAX]);
+    size_t  uRead = hFlashFile.read(pBlob.get(), uFileLen);
+    hFlashFile.close();
+
+    ConfigBlobInfo      suInfo;
+    ConfigBlobResult    enResult = openConfigBlob(pBlob.get(), uRead, CONFIG_CACHE_VERSION,
+                                                  configFieldsLayout(s_aConfigFields, CONFIG_FIELD_COUNT), suInfo);
+    if (enResult != ConfigBlobResult::Ok)
+        {
+        g_Log.printf(MsgLog::EnConfig, MsgLog::EnWarning, "Config cache not usable (%d), parsing config file\n", int(enResult));
+        return false;
+        }
+
+    if (suInfo.uSourceStamp != uSourceStamp)
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnDebug, "Config file changed since the cache was made");
+        return false;
+        }
+
+    BlobReader  In(suInfo.pPayload, suInfo.uPayloadLen);
+
+    loadConfigFieldsBinary(s_aConfigFields, CONFIG_FIELD_COUNT, *this, In);
+
+    suDataSrc.enSrc = SuDataSource::EnDataSource(In.getU8());
+
+    // Each flap takes 49 bytes, so a count the payload can't hold is junk
+    unsigned    uFlapCount = In.getU16();
+    if (uFlapCount > suInfo.uPayloadLen / 49)
+        uFlapCount = 0;
+    aFlaps.resize(uFlapCount);
+    for (SuFlaps & suFlaps : aFlaps)
+        {
+        suFlaps.iDegrees        = In.getI32();
+        suFlaps.iPotPosition    = In.getI32();
+        suFlaps.fLDMAXAOA       = In.getFloat();
+        suFlaps.fONSPEEDFASTAOA = In.getFloat();
+        suFlaps.fONSPEEDSLOWAOA = In.getFloat();
+        suFlaps.fSTALLWARNAOA   = In.getFloat();
+        suFlaps.fSTALLAOA       = In.getFloat();
+        suFlaps.fMANAOA         = In.getFloat();
+        suFlaps.AoaCurve.iCurveType = In.getU8();
+        for (int iCoeffIdx = 0; iCoeffIdx < MAX_CURVE_COEFF; iCoeffIdx++)
+            suFlaps.AoaCurve.afCoeff[iCoeffIdx] = In.getFloat();
+        }
+
+    CasCurve.iCurveType = In.getU8();
+    for (int iCoeffIdx = 0; iCoeffIdx < MAX_CURVE_COEFF; iCoeffIdx++)
+        CasCurve.afCoeff[iCoeffIdx] = In.getFloat();
+
+    // The CRC matched so this only happens if the encoding changed without a
+    // version bump. Don't run with a half loaded config.
+    if (!In.ok() || !In.atEnd() || uFlapCount == 0)
+        {
+        g_Log.println(MsgLog::EnConfig, MsgLog::EnWarning, "Config cache doesn't decode, parsing config file");
+        LoadDefaultConfiguration();
+        return false;
+        }
+
+    ApplyLoadedConfig();
+
+    g_Log.printf(MsgLog::EnConfig, MsgLog::EnDebug, "Loaded config from cache in %lu us\n", micros() - uStartUs);
+    return true;
+    }
+
+#endif // SUPPORT_LITTLEFS
 
 
 // ----------------------------------------------------------------------------
@@ -919,19 +1141,13 @@ SuCalibrationCurve FOSConfig::ParseCurveCSV(String sConfig)
 
 // ----------------------------------------------------------------------------
 
-String FOSConfig::GetConfigValue(String sConfig,String configName)
+String FOSConfig::GetConfigValue(const ConfigXml & Xml, const char * szConfigName)
 {
-    // parse a config value from config string
-    int     iStartIndex;
-    int     iEndIndex;
-
-    iStartIndex = sConfig.indexOf("<"+configName+">");
-    iEndIndex   = sConfig.indexOf("</"+configName+">");
-
-    if (iStartIndex < 0 || iEndIndex < 0)
-        return ""; // value not found in config
+    // Text of a top level element, empty if the element isn't there
+    char    szValue[kConfigMaxString];
 
-    return sConfig.substring(iStartIndex+configName.length()+2, iEndIndex);
+    Xml.copyText(Xml.firstChild(Xml.root(), szConfigName), szValue, sizeof(szValue));
+    return String(szValue);
 }
 
 // ----------------------------------------------------------------------------
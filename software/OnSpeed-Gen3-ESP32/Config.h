@@ -5,6 +5,8 @@
 
 #include <vector>
 #include <OnSpeedTypes.h>  // Core types: SuCalibrationCurve, MAX_CURVE_COEFF, etc.
+#include <RuntimeConfig.h> // Snapshot of config values read by the real-time tasks
+#include <ConfigXml.h>     // One-pass index of a config string
 
 // #include "Globals.h"
 
@@ -83,8 +85,10 @@ public:
     // -----------
 public:
     // These are the config items that are saved to persistent memory and/or disk
-    int             iAoaSmoothing;
-    int             iPressureSmoothing;
+    int             iAoaSmoothing;      // Samples at 50 Hz, whatever the loop rate
+    int             iPressureSmoothing; // Samples at 50 Hz, whatever the loop rate
+    int             iLoopRateHz;        // Sensor loop rate, 50, 100 or 200 Hz. Takes a reboot.
+    int             iAoaFilter;         // AoaFilterKind, 0 = EMA, 1 = alpha-beta. Takes a reboot.
     int             iMuteAudioUnderIAS;
     SuDataSource    suDataSrc;
     String          sReplayLogFileName;
@@ -173,21 +177,35 @@ public:
     char            szDefaultConfigFilename[14] = "onspeed2.cfg";
     bool            bConfigLoaded;
 
+    // Published copy of the values above that the sensor, audio, display, and
+    // data server tasks use every cycle. Web handlers edit the fields above in
+    // place; nothing real-time sees those edits until PublishRuntimeConfig().
+    // Readers take a RuntimeConfigSnapshot::ReadGuard once per cycle.
+    RuntimeConfigSnapshot   Runtime;
+
   // Methods
   // -------
 public:
     bool                LoadConfigurationFile(char* szFilename);
+    bool                ReadConfigurationFile(char* szFilename, String & sConfig);
     bool                SaveConfigurationToFile();
     bool                SaveConfigurationToFile(char* szFilename);
 
 #ifdef SUPPORT_LITTLEFS
     bool                LoadConfigurationFileFromFlash(char* szFilename);
+    bool                ReadConfigurationFileFromFlash(char* szFilename, String & sConfig);
     bool                SaveConfigurationToFlash();
     bool                SaveConfigurationToFlash(char* szFilename);
+
+    // Binary cache of the parsed config
+    uint32_t            ConfigSourceStamp(const String & sFlashConfig, const String & sSdConfig);
+    bool                SaveConfigCache(uint32_t uSourceStamp);
+    bool                LoadConfigCache(uint32_t uSourceStamp);
 #endif
 
     bool                LoadDefaultConfiguration();
     void                LoadConfig();
+    void                PublishRuntimeConfig();
 
     bool                ToBoolean(String sBool);
     float               ToFloat(String sFloat);
@@ -196,7 +214,7 @@ public:
   SuIntArray          ParseIntCSV(String sConfig);
   SuFloatArray        ParseFloatCSV(String sConfig, int limit=MAX_AOA_CURVES);
   SuCalibrationCurve  ParseCurveCSV(String sConfig);
-  String              GetConfigValue(String sConfig,String configName);
+  String              GetConfigValue(const ConfigXml & Xml, const char * szConfigName);
   String              MakeConfig(String configName, String configValue);
   String              Curve2String(SuCalibrationCurve  sConfig);
   String              Array2String(SuFloatArray       afConfig);
@@ -204,7 +222,8 @@ public:
 #endif
 
   String              ConfigurationToString();
-  bool                LoadConfigFromString(String sConfig);
+  bool                LoadConfigFromString(const String & sConfig);
+  void                ApplyLoadedConfig();
   //void                AddCRC(String &sConfig);
 
   //float               array2float(byte buffer[], int startIndex);
@@ -7,6 +7,7 @@
 // OnSpeed Wifi - Wifi file server, config manager and debug display for ONSPEED Gen 2 v2,v3 boxes.
 
 #include <cstring>
+#include <memory>
 
 #include <Arduino.h>
 
@@ -89,6 +90,7 @@ void HandleIndex();
 void HandleFavicon();
 void HandleReboot();
 void HandleLive();
+void HandleBootTime();
 void HandleConfig();
 void HandleConfigSave();
 void HandleDefaultConfig();
@@ -168,6 +170,7 @@ void CfgWebServerInit()
     CfgServer.on("/favicon.ico",     HTTP_GET,  HandleFavicon);
     CfgServer.on("/reboot",          HTTP_GET,  HandleReboot);
     CfgServer.on("/live",            HTTP_GET,  HandleLive);
+    CfgServer.on("/boottime",        HTTP_GET,  HandleBootTime);
     CfgServer.on("/aoaconfig",       HTTP_GET,  HandleConfig);
     CfgServer.on("/aoaconfigsave",   HTTP_POST, HandleConfigSave);
     CfgServer.on("/defaultconfig",   HTTP_GET,  HandleDefaultConfig);
@@ -358,6 +361,28 @@ void HandleLive()
 
 // ----------------------------------------------------------------------------
 
+// How long each startup phase took on this boot
+
+void HandleBootTime()
+    {
+    String                      sPage;
+    std::unique_ptr<char[]>     pText(new char[BootTimeline::kFormatMax]);
+
+    g_BootTimeline.format(pText.get(), BootTimeline::kFormatMax, micros());
+
+    UpdateHeader();
+    sPage.reserve(pageHeader.length() + BootTimeline::kFormatMax + pageFooter.length() + 128);
+    sPage += pageHeader;
+    sPage += "<br><br>\n<strong>Boot timeline</strong><br>\n<pre>";
+    sPage += pText.get();
+    sPage += "</pre>\n";
+    sPage += pageFooter;
+
+    CfgServer.send(200, "text/html", sPage);
+    }
+
+// ----------------------------------------------------------------------------
+
 void HandleConfig()
     {
     String sPage;
@@ -635,6 +660,27 @@ window.addEventListener('load', function()
             <input id="id_pressureSmoothing" name="pressureSmoothing" type="text" value=")#" + String(g_Config.iPressureSmoothing) + R"#(" />
         </div>)#";
 
+    // loopRate
+    sPage += R"#(
+        <div class="form-divs flex-col-12">
+            <label for="id_loopRate">Sensor Loop Rate (smoothing is in 50 Hz samples at any rate)</label>
+            <select id="id_loopRate" name="loopRate">
+            <option value="50")#";    if (g_Config.iLoopRateHz ==  50) sPage += " selected"; sPage += R"#(>50 Hz (default)</option>
+            <option value="100")#";   if (g_Config.iLoopRateHz == 100) sPage += " selected"; sPage += R"#(>100 Hz</option>
+            <option value="200")#";   if (g_Config.iLoopRateHz == 200) sPage += " selected"; sPage += R"#(>200 Hz</option>
+            </select>
+        </div>)#";
+
+    // aoaFilter
+    sPage += R"#(
+        <div class="form-divs flex-col-12">
+            <label for="id_aoaFilter">AOA Filter (alpha-beta has less lag, same noise)</label>
+            <select id="id_aoaFilter" name="aoaFilter">
+            <option value="0")#";     if (g_Config.iAoaFilter == 0) sPage += " selected"; sPage += R"#(>EMA (default)</option>
+            <option value="1")#";     if (g_Config.iAoaFilter == 1) sPage += " selected"; sPage += R"#(>Alpha-beta</option>
+            </select>
+        </div>)#";
+
     // dataSource
     sPage += R"#(
         <div class="form-divs flex-col-12">
@@ -1107,6 +1153,7 @@ R"#(        </section>)#" "\n";
             <select id="id_serialOutFormat" name="serialOutFormat">
                 <option value="G3X")#";     if (g_Config.sSerialOutFormat == "G3X")                                        sPage += " selected"; sPage += R"#(>Garmin G3X</option>
                 <option value="ONSPEED")#"; if (g_Config.sSerialOutFormat == "ONSPEED" || g_Config.sSerialOutFormat == "") sPage += " selected"; sPage += R"#(>OnSpeed</option>
+                <option value="BINARY")#";  if (g_Config.sSerialOutFormat == "BINARY")                                     sPage += " selected"; sPage += R"#(>OnSpeed binary (20 Hz)</option>
             </select>
         </div>)#";
 
@@ -1373,6 +1420,22 @@ void HandleConfigSave()
     if (CfgServer.hasArg("pressureSmoothing"))
         g_Config.iPressureSmoothing = CfgServer.arg("pressureSmoothing").toInt();
 
+    if (CfgServer.hasArg("loopRate"))
+        {
+        int iLoopRateHz = validLoopRate(CfgServer.arg("loopRate").toInt());
+        if (g_Config.iLoopRateHz != iLoopRateHz)
+            rebootRequired = true;
+        g_Config.iLoopRateHz = iLoopRateHz;
+        }
+
+    if (CfgServer.hasArg("aoaFilter"))
+        {
+        int iAoaFilter = CfgServer.arg("aoaFilter").toInt() == 1 ? 1 : 0;
+        if (g_Config.iAoaFilter != iAoaFilter)
+            rebootRequired = true;
+        g_Config.iAoaFilter = iAoaFilter;
+        }
+
     if (CfgServer.hasArg("dataSource"))
         {
 //        if (g_Config.sDataSource != CfgServer.arg("dataSource"))
@@ -1553,9 +1616,12 @@ void HandleConfigSave()
 
     // Configure anything that needs to be configured based on new config settings
 
+    // Make the new flap setpoints, curves, etc. visible to the sensor and audio tasks
+    g_Config.PublishRuntimeConfig();
+
     // Configure accelerometer axes
     g_pIMU->ConfigAxes();
-    g_AHRS.Init(IMU_SAMPLE_RATE);
+    g_AHRS.Init(g_Sensors.Smoothing);
 
     } // end HandleConfigSave()
 
@@ -1825,6 +1891,7 @@ sPage += R"#(
         g_Config.fGyBias = -fGyroYTotal / sensorReadCount;
         g_Config.fGzBias = -fGyroZTotal / sensorReadCount;
 
+        g_Config.PublishRuntimeConfig();
         g_Config.SaveConfigurationToFile();
 
         // Get update IMU
@@ -2227,7 +2294,7 @@ Enter the following aircraft parameters:<br><br>
         //+"&OSFastSetpoint="+CfgServer.arg("OSFastSetpoint")+"&OSSlowSetpoint="+CfgServer.arg("OSSlowSetpoint")+"&StallWarnSetpoint="+CfgServer.arg("StallWarnSetpoint")//
         //+"&ManeuveringSetpoint="+CfgServer.arg("ManeuveringSetpoint")+"&StallSetpoint="+CfgServer.arg("StallSetpoint");
         // find iFlapIdx
-        for (int iFlapIdx=0; iFlapIdx< MAX_AOA_CURVES; iFlapIdx++)
+        for (int iFlapIdx=0; iFlapIdx< (int)g_Config.aFlaps.size(); iFlapIdx++)
             {
             if (g_Config.aFlaps[iFlapIdx].iDegrees == CfgServer.arg("flapsPos").toInt())
                 {
@@ -2244,7 +2311,8 @@ Enter the following aircraft parameters:<br><br>
                 g_Config.aFlaps[iFlapIdx].AoaCurve.afCoeff[3] = g_Config.ToFloat(CfgServer.arg("curve2"));
                 g_Config.aFlaps[iFlapIdx].AoaCurve.iCurveType = 1; // polynomial
 
-                // Save configuration
+                // Publish and save configuration
+                g_Config.PublishRuntimeConfig();
                 g_Config.SaveConfigurationToFile();
                 CfgServer.send(200, "text/html", "SUCCESS: Configuration was saved!");
                 return;
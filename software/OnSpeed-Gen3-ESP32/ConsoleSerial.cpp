@@ -16,6 +16,10 @@
 #include "Helpers.h"
 #include "ConsoleSerial.h"
 
+#include <Atmosphere.h>
+#include <CurveCalc.h>
+#include <CurveTable.h>
+
 
 std::string Base64_Decode(std::string sEncodedString);
 
@@ -84,6 +88,9 @@ void ConsoleSerialIO::DisplayConsoleHelp()
         pSerial->println("CONFIG               - Show current configuration values");
         pSerial->println("AUDIOTEST            - Left & right audio test");
         pSerial->println("TASKS                - Show info about running tasks");
+        pSerial->println("EFIS                 - Show EFIS serial frame counters");
+        pSerial->println("BOOM                 - Show boom serial line counters");
+        pSerial->println("BENCH                - Time pressure altitude and the AOA curve evaluators");
         pSerial->println("COOKIE");
         pSerial->println("");
 
@@ -528,8 +535,90 @@ void ConsoleSerialIO::Read()
                 PrintTaskInfo(xTaskLogReplay);
                 PrintTaskInfo(xTaskTestPot);
                 PrintTaskInfo(xTaskRangeSweep);
+                PrintTaskInfo(xTaskSerialIngest);
+                PrintTaskInfo(xTaskPressureSample);
                 } // end TASKS
 
+            // EFIS
+            // ----
+            else if (strncasecmp(szCmdToken, "EFIS", 4) == 0)
+                {
+                const SerialFramerStats & suStats = g_EfisSerial.ActiveFramer()->stats();
+
+                g_Log.printf("EFIS type %d\n", g_EfisSerial.enType);
+                g_Log.printf("Bytes      : %lu\n", (unsigned long)suStats.uBytes);
+                g_Log.printf("Frames     : %lu\n", (unsigned long)suStats.uFrames);
+                g_Log.printf("Discarded  : %lu bytes\n", (unsigned long)suStats.uDiscarded);
+                g_Log.printf("Overflows  : %lu\n", (unsigned long)suStats.uOverflows);
+                g_Log.printf("Rejected   : %lu\n", (unsigned long)suStats.uRejected);
+                g_Log.printf("Bad frames : %lu\n", (unsigned long)g_EfisSerial.uBadFrames);
+                } // end EFIS
+
+            // BOOM
+            // ----
+            else if (strncasecmp(szCmdToken, "BOOM", 4) == 0)
+                {
+                g_Log.printf("Good lines    : %lu\n", (unsigned long)g_BoomSerial.uGoodLines);
+                g_Log.printf("CRC errors    : %lu\n", (unsigned long)g_BoomSerial.uCrcErrors);
+                g_Log.printf("Format errors : %lu\n", (unsigned long)g_BoomSerial.uFormatErrors);
+                g_Log.printf("Overflows     : %lu\n", (unsigned long)g_BoomSerial.framerBoom.stats().uOverflows);
+                } // end BOOM
+
+            // BENCH
+            // -----
+            else if (strncasecmp(szCmdToken, "BENCH", 5) == 0)
+                {
+                const int       iReps = 1000;
+                volatile float  fSink = 0.0;
+                uint32_t        uStartUs;
+                uint32_t        uPowUs, uPowfUs, uFastUs;
+
+                uStartUs = micros();
+                for (int i = 0; i < iReps; i++)
+                    fSink = fSink + 145366.45 * (1 - pow((300.0 + i) / 1013.25, 0.190284));
+                uPowUs   = micros() - uStartUs;
+
+                uStartUs = micros();
+                for (int i = 0; i < iReps; i++)
+                    fSink = fSink + pressureAltitudeFt(300.0f + i);
+                uPowfUs  = micros() - uStartUs;
+
+                g_Log.printf("Pressure altitude, usec per call\n");
+                g_Log.printf("  pow      : %6.3f\n", uPowUs  / float(iReps));
+                g_Log.printf("  powf     : %6.3f\n", uPowfUs / float(iReps));
+
+                // AOA curve for the current flaps: generic, bound evaluator and table
+                {
+                RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+                const SuFlapSetpoints & flap  = cfg->flap(g_Flaps.iIndex);
+                SuCurveTable            table;
+                buildCurveTable(flap.AoaCurve, table);
+                const float             fLo   = table.bValid ? table.fMin : 0.0f;
+                const float             fSpan = table.bValid ? table.fMax - fLo : 1.0f;
+                unsigned long           uEvalUs;
+
+                uStartUs = micros();
+                for (int i = 0; i < iReps; i++)
+                    fSink = fSink + CurveCalc(fLo + fSpan * i / iReps, flap.AoaCurve);
+                uPowUs   = micros() - uStartUs;
+
+                uStartUs = micros();
+                for (int i = 0; i < iReps; i++)
+                    fSink = fSink + flap.AoaCompiled.Eval(fLo + fSpan * i / iReps);
+                uEvalUs  = micros() - uStartUs;
+
+                uStartUs = micros();
+                for (int i = 0; i < iReps; i++)
+                    fSink = fSink + curveTableEval(table, flap.AoaCurve, fLo + fSpan * i / iReps);
+                uFastUs  = micros() - uStartUs;
+
+                g_Log.printf("AOA curve type %d, usec per call\n", flap.AoaCurve.iCurveType);
+                g_Log.printf("  curve    : %6.3f\n", uPowUs  / float(iReps));
+                g_Log.printf("  bound    : %6.3f\n", uEvalUs / float(iReps));
+                g_Log.printf("  table    : %6.3f%s\n", uFastUs / float(iReps), table.bValid ? "" : " (no table, curve used)");
+                }
+                } // end BENCH
+
             // HELP
             // ----
             else if (strncasecmp(szCmdToken, "HELP", 4) == 0)
@@ -145,7 +145,10 @@ size_t UpdateLiveDataJson(char * pOut, size_t uOutSize)
     if (g_pIMU->Az < 0)
         fVerticalGload *= -1;
 
-    if (isnan(g_Sensors.AOA) || g_Sensors.IAS < g_Config.iMuteAudioUnderIAS)
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    const SuFlapSetpoints & suFlap = cfg->flap(g_Flaps.iIndex);
+
+    if (isnan(g_Sensors.AOA) || g_Sensors.IAS < cfg->iMuteAudioUnderIAS)
     {
         fWifiAOA = -100;
     }
@@ -284,10 +287,10 @@ size_t UpdateLiveDataJson(char * pOut, size_t uOutSize)
         fPAltFt,
         fVerticalGload,
         fLatG,
-        SafeJsonFloat(g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA, 0.0f),
-        SafeJsonFloat(g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA, 0.0f),
-        SafeJsonFloat(g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA, 0.0f),
-        SafeJsonFloat(g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA, 0.0f),
+        SafeJsonFloat(suFlap.fLDMAXAOA, 0.0f),
+        SafeJsonFloat(suFlap.fONSPEEDFASTAOA, 0.0f),
+        SafeJsonFloat(suFlap.fONSPEEDSLOWAOA, 0.0f),
+        SafeJsonFloat(suFlap.fSTALLWARNAOA, 0.0f),
         g_Flaps.iPosition,
         g_Flaps.iIndex,
         fCoeffP,
@@ -11,6 +11,10 @@
 const int   serialDisplaySmoothingLat  = 50;    // smoothing serial display data (LateralG)  10hz data.
 const int   serialDisplaySmoothingVert = 20;    // smoothing serial display data (VertG)  10hz data.
 
+#define DISPLAY_TEXT_PERIOD_MS      100     // Text sentences, 10 Hz
+#define DISPLAY_BINARY_PERIOD_MS    50      // Binary frames, 20 Hz
+#define DISPLAY_SETPOINT_MS         1000    // Resend binary setpoints at least this often
+
 static inline bool IsFiniteFloat(float v)
 {
     return !isnan(v) && !isinf(v);
@@ -72,14 +76,17 @@ void WriteDisplayDataTask(void * pvParams)
 
     while (true)
         {
+        // 100 msec for the text formats, faster for binary
+        const int iPeriodMs = g_DisplaySerial.PeriodMs();
+
         // No delay happening is a design error so flag it if it happens
-        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(100));  // 100 msec
+        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(iPeriodMs));
         if (xWasDelayed == pdFALSE)
             {
             // If this task runs late, don't "catch up" by running back-to-back and
             // bursting serial data at the display. Re-align to the current tick
             // period instead.
-            xLastWakeTime = xLAST_TICK_TIME(100);
+            xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
             unsigned long uNow = millis();
             if ((uNow - uLastLateLogMs) > 1000)
                 {
@@ -116,23 +123,37 @@ void DisplaySerial::Init(Stream * pDispSerial)
 
     pSerial = pDispSerial;
 
+    uBinarySeq        = 0;
+    uLastSetpointMs   = 0;
+    memset(&suSentSetpoints, 0, sizeof(suSentSetpoints));
+}
+
+// ----------------------------------------------------------------------------
+
+int DisplaySerial::PeriodMs()
+{
+    if (g_Config.sSerialOutFormat == "BINARY")
+        return DISPLAY_BINARY_PERIOD_MS;
+    return DISPLAY_TEXT_PERIOD_MS;
 }
 
 // ----------------------------------------------------------------------------
 
 void DisplaySerial::Write()
     {
-    byte            SerialCRC = 0;
-
 //    if (serialOutPort!="NONE" && millis()-serialoutLastUpdate>100) // update every 100ms, 10Hz
 
-    char    serialOutString[200];
+    DisplayData suData;
 
     int     iPercentLift;
     float   fDisplayAOA;
     float   fDisplayIAS;
-    float   smoothingAlphaLat  = 2.0 / (serialDisplaySmoothingLat  + 1);
-    float   smoothingAlphaVert = 2.0 / (serialDisplaySmoothingVert + 1);
+
+    // Smoothing constants are in 10 Hz samples, keep the same time constant
+    // at faster update rates
+    const int   iRateScale         = DISPLAY_TEXT_PERIOD_MS / PeriodMs();
+    float   smoothingAlphaLat  = 2.0 / (serialDisplaySmoothingLat  * iRateScale + 1);
+    float   smoothingAlphaVert = 2.0 / (serialDisplaySmoothingVert * iRateScale + 1);
     int     iDisplayVerticalG;
 
 #ifdef SPHERICAL_PROBE
@@ -140,7 +161,10 @@ void DisplaySerial::Write()
 #else
     fDisplayIAS = g_Sensors.IAS;
 #endif
-    const bool bIasValidForOutput = (fDisplayIAS >= g_Config.iMuteAudioUnderIAS);
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    const SuFlapSetpoints & suFlap = cfg->flap(g_Flaps.iIndex);
+
+    const bool bIasValidForOutput = (fDisplayIAS >= cfg->iMuteAudioUnderIAS);
     const float fIasForOutput = bIasValidForOutput ? fDisplayIAS : 0.0f;
     if (fPAltSmoothed == 0.0)
         fPAltSmoothed = m2ft(g_AHRS.KalmanAlt);
@@ -160,19 +184,19 @@ void DisplaySerial::Write()
         {
         fDisplayAOA = g_Sensors.AOA;
         // Scale percent lift
-        if       (g_Sensors.AOA <  g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA)          // LDmaxAOA
-            iPercentLift = map(g_Sensors.AOA, 0, g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA,         0, 50);
-        else if ((g_Sensors.AOA >= g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA)       && // LDmaxAOA
-                 (g_Sensors.AOA <= g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA))   // onSpeedAOAfast
-            iPercentLift = map(g_Sensors.AOA, g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA, g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA,  50, 55);
-        else if ((g_Sensors.AOA >  g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA) &&
-                 (g_Sensors.AOA <= g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA))   // onSpeedAOAslow
-            iPercentLift = map(g_Sensors.AOA, g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA,  g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA,  55, 66);
-        else if ((g_Sensors.AOA >  g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA) &&
-                 (g_Sensors.AOA <= g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA))     // stallWarningAOA
-            iPercentLift = map(g_Sensors.AOA, g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA,  g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA, 66, 90);
+        if       (g_Sensors.AOA <  suFlap.fLDMAXAOA)          // LDmaxAOA
+            iPercentLift = map(g_Sensors.AOA, 0, suFlap.fLDMAXAOA,         0, 50);
+        else if ((g_Sensors.AOA >= suFlap.fLDMAXAOA)       && // LDmaxAOA
+                 (g_Sensors.AOA <= suFlap.fONSPEEDFASTAOA))   // onSpeedAOAfast
+            iPercentLift = map(g_Sensors.AOA, suFlap.fLDMAXAOA, suFlap.fONSPEEDFASTAOA,  50, 55);
+        else if ((g_Sensors.AOA >  suFlap.fONSPEEDFASTAOA) &&
+                 (g_Sensors.AOA <= suFlap.fONSPEEDSLOWAOA))   // onSpeedAOAslow
+            iPercentLift = map(g_Sensors.AOA, suFlap.fONSPEEDFASTAOA,  suFlap.fONSPEEDSLOWAOA,  55, 66);
+        else if ((g_Sensors.AOA >  suFlap.fONSPEEDSLOWAOA) &&
+                 (g_Sensors.AOA <= suFlap.fSTALLWARNAOA))     // stallWarningAOA
+            iPercentLift = map(g_Sensors.AOA, suFlap.fONSPEEDSLOWAOA,  suFlap.fSTALLWARNAOA, 66, 90);
         else
-            iPercentLift = map(g_Sensors.AOA, g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA, g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA*100/90,90,100);
+            iPercentLift = map(g_Sensors.AOA, suFlap.fSTALLWARNAOA, suFlap.fSTALLWARNAOA*100/90,90,100);
         iPercentLift = constrain(iPercentLift,0,99);
         }
     else
@@ -181,136 +205,74 @@ void DisplaySerial::Write()
         fDisplayAOA  = 0;
         }
 
-    // Output the data in the appropriate format
-
-    if (g_Config.sSerialOutFormat == "G3X")
-        {
-        // Clamp to fixed-width protocol fields to prevent buffer overruns and
-        // malformed output when values go out of range.
-        const int      iPitch10   = SafeScaledInt(g_AHRS.SmoothedPitch, 10.0f, -999,    999);
-        const int      iRoll10    = SafeScaledInt(g_AHRS.SmoothedRoll,  10.0f, -9999,  9999);
-        const unsigned uIas10     = SafeScaledUInt(fIasForOutput,       10.0f, 0,      9999);
-        const int      iPaltFt    = SafeScaledInt(fPAltSmoothed,         1.0f, -99999, 99999);
-        const int      iLatG100   = SafeScaledInt(-fLateralGSmoothed,  100.0f, -99,      99);
-        const int      iVertG10   = ClampInt(iDisplayVerticalG,                -99,      99);
-        const unsigned uPctLift   = ClampUInt((unsigned)iPercentLift,           0,       99);
-
-        const int iChars = snprintf(
-            serialOutString,
-            sizeof(serialOutString),
-            "=1100000000%+04i%+05i___%04u%+06i____%+03i%+03i%02u__________",
-            iPitch10,
-            iRoll10,
-            uIas10,
-            iPaltFt,
-            iLatG100,
-            iVertG10,
-            uPctLift);
-
-        // Expected fixed-length payload is 55 bytes.
-        if (iChars != 55)
-            return;
-
-        SerialCRC = 0x00;
-        for (int i = 0; i < 55; i++)
-            SerialCRC += (byte)serialOutString[i];
-        } // end if G3X
+    // Scale and clamp everything to the fixed-width text fields. The binary
+    // frames carry the same values. Field layout is in onspeed_core
+    // DisplayProtocol.cpp.
 
-    else if (g_Config.sSerialOutFormat == "ONSPEED")
-        {
-        //  0 - #                         Escape character  '#'
-        //  1 - 1                         Sentence ID '1'
-        //  2 - %+04i  Pitch              Pitch, 4 bytes, 0.1 degree, positive = up
-        //  6 - %+05i  Roll               Roll, 5 bytes, 0.1 degree, positive = right
-        // 11 - %04u   IAS                IAS, 4 bytes, 0.1 kts
-        // 15 - %+06i  PALT               PALT, 6 bytes, 1 ft
-        // 21 - %+05i  Rate of Turn       Rate of Turn,  5 bytes, .1 deg/sec, positive = right
-        // 26 - %+03i  LateralG           Lateral G, 3 bytes , 0.01g, positive = leftward
-        // 29 - %+03i  VerticalG          VerticalG, 3 bytes, 0.1g, positive = upward
-        // 32 - %02i   Percent Lift       Percent Lift, 2 bytes, 00-99%
-        // 34 - %+04i  AOA Degrees        AOA Degrees, 4 bytes, 0.1 degree
-        // 38 - %+04i  iVSI               iVSI, 4 bytes, 10 fpm, positive up [-999;999]
-        // 42 - %+03i  OAT                OAT, 3 bytes, 1 deg C
-        // 45 - %+04i  FlightPath         FlightPath angle, 4 bytes, 0.1 degree
-        // 49 - %+03i  Flaps              Flaps Pos, 3 bytes, 1 degree, with +/-sign
-        // 52 - %+04i  StallWarn          StallWarn AOA, 4 bytes, 0.1 degrees
-        // 56 - %+04i  OnSpeedSlow        OnSpeedSlow AOA, 4 bytes, 0.1 degrees
-        // 60 - %+04i  OnSpeedFast        OnSpeedFast AOA, 4 bytes, 0.1 degrees
-        // 64 - %+04i  Tones On           Tones On AOA, 4 bytes, 0.1 degrees
-        // 68 - %+04i  G onset rate       G onset rate, 4 bytes, 0.01 G/sec
-        // 72 - %+02i  Spin Recovery Cue  Spin Recovery Cue, 2 bytes, -1/0/+1
-        // 74 - %02u   DataMark           DataMark, 2 bytes
-        // 76 -                           Checksum, 2 bytes, ASCII HEX, sum of all previous bytes
-        // 78 -                           CR/LF,2 bytes, 0x0D 0x0A
-
-// Actual...
-// #1+2147483647+21474836470000+2147483647+0001+02-0900+000+000-127+000+40+145+124+086+047+000+000A5
-
-        int gOnsetRate      = 0;
-        int spinRecoveryCue = 0;
+    int gOnsetRate      = 0;
+    int spinRecoveryCue = 0;
 #ifdef OAT_AVAILABLE
-        int iOATc           = int(g_Sensors.OatC);
+    int iOATc           = int(g_Sensors.OatC);
 #else
-        int iOATc           = 0;
+    int iOATc           = 0;
 #endif
 
-        const int      iPitch10    = SafeScaledInt(g_AHRS.SmoothedPitch, 10.0f, -999,    999);
-        const int      iRoll10     = SafeScaledInt(g_AHRS.SmoothedRoll,  10.0f, -9999,  9999);
-        const unsigned uIas10      = SafeScaledUInt(fIasForOutput,       10.0f, 0,      9999);
-        const int      iPaltFt     = SafeScaledInt(fPAltSmoothed,         1.0f, -99999, 99999);
-        const int      iYaw10      = SafeScaledInt(g_AHRS.gYaw,          10.0f, -9999,  9999);
-        const int      iLatG100    = SafeScaledInt(-fLateralGSmoothed,  100.0f, -99,      99);
-        const int      iVertG10    = ClampInt(iDisplayVerticalG,                -99,      99);
-        const unsigned uPctLift    = ClampUInt((unsigned)iPercentLift,           0,       99);
-        const int      iAoa10      = SafeScaledInt(fDisplayAOA,          10.0f, -999,    999);
-        const int      iVsi10Fpm   = ClampInt((int)floor(mps2fpm(g_AHRS.KalmanVSI) / 10.0f), -999, 999);
-        const int      iOatC       = ClampInt(iOATc,                              -99,      99);
-        const int      iFpa10      = SafeScaledInt(g_AHRS.FlightPath,    10.0f, -999,    999);
-        const int      iFlapsDeg   = ClampInt((int)g_Flaps.iPosition,             -99,      99);
-        const int      iStall10    = SafeScaledInt(g_Config.aFlaps[g_Flaps.iIndex].fSTALLWARNAOA,  10.0f, -999, 999);
-        const int      iSlow10     = SafeScaledInt(g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDSLOWAOA, 10.0f, -999, 999);
-        const int      iFast10     = SafeScaledInt(g_Config.aFlaps[g_Flaps.iIndex].fONSPEEDFASTAOA, 10.0f, -999, 999);
-        const int      iLdMax10    = SafeScaledInt(g_Config.aFlaps[g_Flaps.iIndex].fLDMAXAOA,       10.0f, -999, 999);
-        const int      iOnset100   = ClampInt((int)(gOnsetRate * 100),            -999,    999);
-        const int      iSpinCue    = ClampInt((int)spinRecoveryCue,                 -9,      9);
-        const unsigned uDataMark2  = WrapUInt((unsigned)g_iDataMark,               100);
-
-        const int iChars = snprintf(
-            serialOutString,
-            sizeof(serialOutString),
-            "#1%+04i%+05i%04u%+06i%+05i%+03i%+03i%02u%+04i%+04i%+03i%+04i%+03i%+04i%+04i%+04i%+04i%+04i%+02i%02u",
-            iPitch10,
-            iRoll10,
-            uIas10,
-            iPaltFt,
-            iYaw10,
-            iLatG100,
-            iVertG10,
-            uPctLift,
-            iAoa10,
-            iVsi10Fpm,
-            iOatC,
-            iFpa10,
-            iFlapsDeg,
-            iStall10,
-            iSlow10,
-            iFast10,
-            iLdMax10,
-            iOnset100,
-            iSpinCue,
-            uDataMark2);
-
-        // Expected fixed-length payload is 76 bytes.
-        if (iChars != 76)
-            return;
-
-        SerialCRC = 0x00;
-        for (int i = 0; i < 76; i++)
-            SerialCRC += (byte)serialOutString[i];
-        } // end if ONSPEED
+    suData.iPitch10    = SafeScaledInt(g_AHRS.SmoothedPitch, 10.0f, -999,    999);
+    suData.iRoll10     = SafeScaledInt(g_AHRS.SmoothedRoll,  10.0f, -9999,  9999);
+    suData.uIas10      = SafeScaledUInt(fIasForOutput,       10.0f, 0,      9999);
+    suData.iPaltFt     = SafeScaledInt(fPAltSmoothed,         1.0f, -99999, 99999);
+    suData.iYawRate10  = SafeScaledInt(g_AHRS.gYaw,          10.0f, -9999,  9999);
+    suData.iLatG100    = SafeScaledInt(-fLateralGSmoothed,  100.0f, -99,      99);
+    suData.iVertG10    = ClampInt(iDisplayVerticalG,                -99,      99);
+    suData.uPctLift    = ClampUInt((unsigned)iPercentLift,           0,       99);
+    suData.iAoa10      = SafeScaledInt(fDisplayAOA,          10.0f, -999,    999);
+    suData.iVsi10Fpm   = ClampInt((int)floor(mps2fpm(g_AHRS.KalmanVSI) / 10.0f), -999, 999);
+    suData.iOatC       = ClampInt(iOATc,                              -99,      99);
+    suData.iFpa10      = SafeScaledInt(g_AHRS.FlightPath,    10.0f, -999,    999);
+    suData.iFlapsDeg   = ClampInt((int)g_Flaps.iPosition,             -99,      99);
+    suData.iStall10    = SafeScaledInt(suFlap.fSTALLWARNAOA,  10.0f, -999, 999);
+    suData.iSlow10     = SafeScaledInt(suFlap.fONSPEEDSLOWAOA, 10.0f, -999, 999);
+    suData.iFast10     = SafeScaledInt(suFlap.fONSPEEDFASTAOA, 10.0f, -999, 999);
+    suData.iLdMax10    = SafeScaledInt(suFlap.fLDMAXAOA,       10.0f, -999, 999);
+    suData.iOnset100   = ClampInt((int)(gOnsetRate * 100),            -999,    999);
+    suData.iSpinCue    = ClampInt((int)spinRecoveryCue,                 -9,      9);
+    suData.uDataMark   = WrapUInt((unsigned)g_iDataMark,               100);
+
+    // Output the data in the appropriate format
+
+    if (g_Config.sSerialOutFormat == "BINARY")
+        {
+        uint8_t     aFrame[kDisplayFlightFrameLen];
+        size_t      uLen;
+
+        // Setpoints only change with flaps or config, send them then and
+        // once a second for a display that was just powered up
+        const bool bSetpointsChanged = (suData.iStall10 != suSentSetpoints.iStall10) ||
+                                       (suData.iSlow10  != suSentSetpoints.iSlow10)  ||
+                                       (suData.iFast10  != suSentSetpoints.iFast10)  ||
+                                       (suData.iLdMax10 != suSentSetpoints.iLdMax10);
+        if (bSetpointsChanged || (millis() - uLastSetpointMs) >= DISPLAY_SETPOINT_MS)
+            {
+            uLen = encodeDisplaySetpoints(suData, uBinarySeq++, aFrame, sizeof(aFrame));
+            pSerial->write(aFrame, uLen);
+            suSentSetpoints = suData;
+            uLastSetpointMs = millis();
+            }
+
+        uLen = encodeDisplayFlight(suData, uBinarySeq++, aFrame, sizeof(aFrame));
+        pSerial->write(aFrame, uLen);
+        return;
+        } // end if BINARY
+
+    char    serialOutString[kOnSpeedSentenceLen + 1];
+    size_t  uLen = 0;
+
+    if      (g_Config.sSerialOutFormat == "G3X")
+        uLen = formatG3xSentence(suData, serialOutString, sizeof(serialOutString));
+    else if (g_Config.sSerialOutFormat == "ONSPEED")
+        uLen = formatOnSpeedSentence(suData, serialOutString, sizeof(serialOutString));
 
     // Send data out the appropriate serial port
-    pSerial->print(serialOutString);
-    pSerial->printf("%02X",SerialCRC);
-    pSerial->println();
+    if (uLen > 0)
+        pSerial->write((const uint8_t *)serialOutString, uLen);
     } // end Write()
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <DisplayProtocol.h>
+
 #include "Globals.h"
 
 
@@ -26,9 +28,15 @@ public:
     // serial port a pointer to the Stream base object.
     Stream    * pSerial;
 
+    // Binary format state
+    uint8_t         uBinarySeq;
+    DisplayData     suSentSetpoints;    // Setpoints the display last got
+    unsigned long   uLastSetpointMs;
+
     // Methods
 public:
     void Init(Stream * pDispSerial);
     void Write();
+    int  PeriodMs();            // Update period for the selected format
 
 };
\ No newline at end of file
@@ -4,9 +4,17 @@
 //#include <SoftwareSerial.h>
 #include <HardwareSerial.h>
 
+#include <EfisTextParser.h>
+#include <SampleHistory.h>
+#include <SerialFramer.h>
+#include <Vn300Packet.h>
+
 #include "Globals.h"
+#include "SerialIngest.h"
+
+#define EFIS_HISTORY_SIZE   12      // Decoded samples kept for time alignment
 
-class EfisSerialIO
+class EfisSerialIO : public SerialFrameSink
 {
 public:
     EfisSerialIO();
@@ -23,91 +31,62 @@ public:
         EnMglBinary     = 6,
     };
 
-    // Decoded EFIS data
-    struct SuEfisData
-    {
-        float   DecelRate;
-        float   IAS;
-        float   Pitch;
-        float   Roll;
-        float   LateralG;
-        float   VerticalG;
-        int     PercentLift;
-        int     Palt;
-        int     VSI;
-        float   TAS;
-        float   OAT;
-        float   FuelRemaining;
-        float   FuelFlow;
-        float   MAP;
-        int     RPM;
-        int     PercentPower;
-        int     Heading;
-        String  Time;
-    };
+    // Decoded EFIS data. Text sentences are decoded by the onspeed_core
+    // EFIS parsers directly into this structure.
+    typedef EfisData SuEfisData;
 
-    // Decoded VN-300 data
-    struct SuVN300Data
+    // Decoded VN-300 data. Binary packets are decoded by the onspeed_core
+    // VN-300 decoder, the time string is built here.
+    struct SuVN300Data : public Vn300Data
     {
-        float   AngularRateRoll;
-        float   AngularRatePitch;
-        float   AngularRateYaw;
-        float   VelNedNorth;
-        float   VelNedEast;
-        float   VelNedDown;
-        float   AccelFwd;
-        float   AccelLat;
-        float   AccelVert;
-        float   Yaw;
-        float   Pitch;
-        float   Roll;
-        float   LinAccFwd;
-        float   LinAccLat;
-        float   LinAccVert;
-        float   YawSigma;
-        float   RollSigma;
-        float   PitchSigma;
-        float   GnssVelNedNorth;
-        float   GnssVelNedEast;
-        float   GnssVelNedDown;
-        byte    GPSFix;
-        double  GnssLat;
-        double  GnssLon;
-        String  TimeUTC;
+        char    szTimeUTC[16];  // "H:M:S.FF", FF from the local clock
     };
 
     // Data
 public:
     HardwareSerial    * pSerial;
+    UartByteSource      srcUart;    // RX event timestamps for the framers
 //    bool                bEnabled;
     EnEfisType          enType;
     SuEfisData          suEfis;
     SuVN300Data         suVN300;
 
-    // Two different input buffers are provided. Buffer[] is for
-    // incoming binary data. BufferString is for incoming text
-    // style data.
-    byte                Buffer[127];    // Binary buffer
-    byte                BufferIndex;
-    byte                PrevInByte;
+    // One framer per protocol family. Read() pumps UART bytes into the one
+    // matching enType and decoding happens in onFrame().
+    VN300Framer         framerVN300;
+    MglFramer           framerMgl;
+    LineFramer<231>     framerText;     // Longest sentence is 225
 
-    String              BufferString;   // Text buffer
-    char                PrevInChar;
-
-    bool                efisPacketInProgress = false;
     unsigned long       lastReceivedEfisTime;
-
-    int                 mglMsgLen;
+    uint32_t            uBadFrames;     // Frames dropped for bad header, length or checksum
 
     unsigned long       uTimestamp; // Millisecond timestamp of decoded data
-
-#ifdef EFISDATADEBUG
-    int                 MaxAvailable;
-#endif
+    uint32_t            uFrameUs;   // Microsecond receive time of the last byte of that data
 
     // Methods
 public:
     void Init(EnEfisType enEfisType, HardwareSerial * pEfisSerial);
     void Enable(bool bEnable);
     void Read();
+
+    // SerialFrameSink
+    void onFrame(const SerialFrame & frame) override;
+
+    SerialFramer * ActiveFramer();
+
+    // EFIS / VN-300 values at a sensor sample time, interpolated from the
+    // history. iAgeUs is how old the earlier of the two samples used is.
+    SampleFit SampleEfisAt (uint32_t uTimeUs, SuEfisData  & suOut, int32_t & iAgeUs);
+    SampleFit SampleVN300At(uint32_t uTimeUs, SuVN300Data & suOut, int32_t & iAgeUs);
+
+protected:
+    void Stamp(uint32_t uEndUs);
+
+    SampleHistory<SuEfisData,  EFIS_HISTORY_SIZE>  EfisHistory;
+    SampleHistory<SuVN300Data, EFIS_HISTORY_SIZE>  VN300History;
+    portMUX_TYPE        xHistoryMux;
+
+    void DecodeVN300(const SerialFrame & frame);
+    void DecodeMgl(const SerialFrame & frame);
+    void ParseTextLine(const SerialFrame & frame);
 };
\ No newline at end of file
@@ -37,9 +37,12 @@ void Flaps::Update()
     // Read the analog value
     uValue = Read();
 
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    const int iFlapCount = cfg->iFlapCount;
+
     // If there are no flap definitions then set the position to -1. That
     // should get someone's attention.
-    if (g_Config.aFlaps.size() == 0)
+    if (iFlapCount == 0)
     {
         iPosition = -1;
         return;
@@ -49,19 +52,19 @@ void Flaps::Update()
     iIndex = 0;
 
     // Figure out where this value is in the array of flap position values
-    if (g_Config.aFlaps.size() > 1)
+    if (iFlapCount > 1)
     {
         int     iPotRangeMidpoint;
         bool    bDecendingOrder = false;
 
         // If the first flap pot position is greater than the last flap pot position then
         // the pot positions must be in decending order.
-        if (g_Config.aFlaps[0].iPotPosition > g_Config.aFlaps[g_Config.aFlaps.size()-1].iPotPosition)
+        if (cfg->aFlaps[0].iPotPosition > cfg->aFlaps[iFlapCount-1].iPotPosition)
             bDecendingOrder = true;
 
-        for (int iFlapIdx = 1; iFlapIdx < g_Config.aFlaps.size(); iFlapIdx++)
+        for (int iFlapIdx = 1; iFlapIdx < iFlapCount; iFlapIdx++)
         {
-            iPotRangeMidpoint = (g_Config.aFlaps[iFlapIdx].iPotPosition + g_Config.aFlaps[iFlapIdx-1].iPotPosition) / 2;
+            iPotRangeMidpoint = (cfg->aFlaps[iFlapIdx].iPotPosition + cfg->aFlaps[iFlapIdx-1].iPotPosition) / 2;
 
             // Not decending order
             if (!bDecendingOrder)
@@ -90,7 +93,9 @@ void Flaps::Update()
 
 void Flaps::Update(int iFlapsIndex)
 {
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+
     iIndex    = iFlapsIndex;
-    iPosition = g_Config.aFlaps[iIndex].iDegrees;
+    iPosition = cfg->flap(iIndex).iDegrees;
 }
 
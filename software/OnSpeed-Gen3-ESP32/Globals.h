@@ -85,9 +85,41 @@
 //boom type
 //#define NOBOOMCHECKSUM    // for booms that don't have a checksum byte in their data stream uncomment this line.
 
+//MGL EFIS
+//#define MGLCHECKSUM       // reject MGL messages with a bad CRC-32. Not yet checked against a captured MGL stream.
+
 // OAT sensor available
 // #define OAT_AVAILABLE  // DS18B20 sensor
 
+// Sample the pitot and AOA pressure sensors at this rate (500 or 1000 Hz)
+// and decimate them to the sensor loop rate, instead of one sample per
+// cycle followed by median and average smoothing. Must be a multiple of
+// twice the loop rate, so 1000 Hz covers 50 and 100 Hz loops.
+//#define PRESSURE_OVERSAMPLE_HZ  1000
+
+// Read the pitot, AOA and IMU one at a time instead of as one planned SPI
+// transaction. Only for timing the two against each other with the sensor
+// bus figures in the sensors debug output.
+//#define SENSOR_BUS_UNBATCHED
+
+// Evaluate the AOA curves from tables built when the config is published,
+// falling back to the bound curve outside the table or if the table can't
+// get within 0.01 degrees of it. Off until a BENCH run on the target shows
+// the table beating the bound curve.
+//#define AOA_CURVE_TABLE
+
+// Once the altitude/VSI Kalman filter has settled after power up, run it
+// with the fixed gains it converges to instead of updating its covariance
+// every cycle. Comment out to always run the full filter.
+#define KALMAN_STEADY_STATE
+
+// Drive the audio tones from the AOA with its smoothing lag made up from the
+// IMU pitch rate and accelerations, instead of the smoothed pressure AOA
+// alone. The fused AOA is computed either way, and log replay prints both
+// with replay debug on; leave this commented out until the fused AOA has
+// been checked against logged flights.
+//#define AOA_INERTIAL_FUSION
+
 #define SUPPORT_LITTLEFS
 
 // Includes
@@ -112,6 +144,9 @@
 #include <OneButton.h>            // button click/double click detection https://github.com/mathertel/OneButton
 #include "SPI.h"
 
+// OnSpeed core
+#include <BootTimeline.h>
+
 // OnSpeed modules
 #include "ErrorLogger.h"
 #include "Config.h"
@@ -124,6 +159,7 @@
 #include "LogReplay.h"
 #include "AHRS.h"
 #include "ConsoleSerial.h"
+#include "SerialIngest.h"
 #include "EfisSerial.h"
 #include "BoomSerial.h"
 #include "DisplaySerial.h"
@@ -204,7 +240,7 @@
 #define DISPLAY_SER_RX      11  // Normally not used
 
 // Data logging frequency
-#define LOGDATA_PRESSURE_RATE   // Log at pressure read rate (50 Hz)
+#define LOGDATA_PRESSURE_RATE   // Log at pressure read rate (the sensor loop rate)
 //#define LOGDATA_IMU_RATE      // Log at the IMU read rate
 
 #ifdef SPHERICAL_PROBE
@@ -214,9 +250,7 @@
 // Serial baud rates
 #define BAUDRATE_CONSOLE       921600
 
-#define IMU_SAMPLE_RATE       50
-
-#define GYRO_SMOOTHING        30
+// The sensor and IMU loop rate is LOOP_RATE in the config, see SensorIO::Init()
 
 // RTOS Stuff
 // ----------
@@ -234,6 +268,8 @@ EXTERN_INIT(TaskHandle_t             xTaskHeartbeat,     NULL)
 EXTERN_INIT(TaskHandle_t             xTaskLogReplay,     NULL)
 EXTERN_INIT(TaskHandle_t             xTaskTestPot,       NULL)
 EXTERN_INIT(TaskHandle_t             xTaskRangeSweep,    NULL)
+EXTERN_INIT(TaskHandle_t             xTaskSerialIngest,  NULL)
+EXTERN_INIT(TaskHandle_t             xTaskPressureSample, NULL)
 
 EXTERN RingbufHandle_t          xLoggingRingBuffer;
 
@@ -267,7 +303,7 @@ EXTERN HscPressureSensor      * g_pStatic;  // Static pressure
 EXTERN  SensorIO                g_Sensors;
 EXTERN  LogSensor               g_LogSensor;
 
-EXTERN_CLASS(AHRS               g_AHRS, GYRO_SMOOTHING)
+EXTERN  AHRS                    g_AHRS;
 
 EXTERN ConsoleSerialIO          g_ConsoleSerial;
 EXTERN EfisSerialIO             g_EfisSerial;
@@ -280,6 +316,8 @@ EXTERN_CLASS(OneButton          g_Switch, SWITCH_PIN, true)
 
 EXTERN AudioPlay                g_AudioPlay;
 
+EXTERN BootTimeline             g_BootTimeline; // Startup phase times, see /boottime
+
 EXTERN_INIT(bool g_bFlashFS, false)     // One of the on-board flash file systems (e.g. LittleFS) ready
 EXTERN_INIT(bool g_bPause,   false)
 
@@ -66,11 +66,35 @@ HscPressureSensor::HscPressureSensor(SpiIO * pSensorSPI, int CsPort, EnPressureS
 // ----------------------------------------------------------------------------
 
 uint16_t  HscPressureSensor::ReadPressureCounts()
+{
+    return AcceptCounts(ReadStatusCounts());
+}
+
+// ----------------------------------------------------------------------------
+
+// Counts from the two bytes the sensor returned in a batched bus read
+
+uint16_t  HscPressureSensor::DecodePressureCounts(const uint8_t * pRaw)
 {
     UnHSC   uStatusCounts;
 
-    uStatusCounts = ReadStatusCounts();
+    uStatusCounts.uStatusCounts = (pRaw[0] << 8) | pRaw[1];
+    return AcceptCounts(uStatusCounts);
+}
+
+// ----------------------------------------------------------------------------
+
+// The sensor has no command byte, a read is two bytes clocked out
+
+int HscPressureSensor::AddToBusPlan(SensorBusPlan & Plan)
+{
+    return Plan.addRead(uChipSel, 2);
+}
+
+// ----------------------------------------------------------------------------
 
+uint16_t  HscPressureSensor::AcceptCounts(UnHSC uStatusCounts)
+{
     // Honeywell HSC sensors include a 2-bit status field. Only accept samples
     // with normal status; otherwise, reuse the last good sample to avoid
     // injecting spikes/glitches into downstream filters.
@@ -95,21 +119,7 @@ float HscPressureSensor::ReadPressurePSI()
     uint16_t uCounts;
 
     uStatusCounts = ReadStatusCounts();
-
-    if (uStatusCounts.suHSC.uStatus == 0)
-        {
-        uCounts            = uStatusCounts.suHSC.uCounts;
-        uLastGoodCounts    = uCounts;
-        bHasLastGoodCounts = true;
-        }
-    else if (bHasLastGoodCounts)
-        {
-        uCounts = uLastGoodCounts;
-        }
-    else
-        {
-        uCounts = uStatusCounts.suHSC.uCounts;
-        }
+    uCounts       = AcceptCounts(uStatusCounts);
 
     g_Log.printf(MsgLog::EnPressure, MsgLog::EnDebug, "Status 0x%2.2x  Counts %5u\n",
         uStatusCounts.suHSC.uStatus, (unsigned)uCounts);
@@ -6,6 +6,7 @@
 #include <Arduino.h>
 
 #include "SPI_IO.h"
+#include <SensorBus.h>
 
   enum EnPressureSensorType
   {
@@ -47,6 +48,8 @@ public:
   // Methods
 public:
   uint16_t ReadPressureCounts();
+  uint16_t DecodePressureCounts(const uint8_t * pRaw);
+  int      AddToBusPlan(SensorBusPlan & Plan);
 
   float    ReadPressurePSI();
   float    ReadPressurePSI(uint16_t uCounts);
@@ -56,6 +59,9 @@ public:
 
   UnHSC    ReadStatusCounts();
 
+protected:
+  uint16_t AcceptCounts(UnHSC uStatusCounts);
+
 };
 
 #endif
@@ -6,7 +6,8 @@
 #include "IMU330.h"
 
 // define ISM330 registers
-#define FIFO_CTRL4          0x0A
+#define FIFO_CTRL3          0x09  // FIFO batch data rates
+#define FIFO_CTRL4          0x0A  // FIFO mode
 #define WHO_AM_I            0x0F  // Who Am I value = 0x6B
 #define CTRL1_XL            0x10  // accelerometer control register
 #define CTRL2_G             0x11  // gyro control register
@@ -15,10 +16,13 @@
 #define CTRL6_C             0x15
 #define CTRL7_G             0x16
 #define CTRL9_XL            0x18
+#define STATUS_REG          0x1E  // data ready flags
 #define ISM330_OUT_TEMP_L   0x20  // temp output register
 #define ISM330_OUT_TEMP_H   0x21
 #define OUTX_L_G            0x22  // start of gyro output address
 #define OUTX_L_A            0x28  // start of accelerometer output address
+#define FIFO_STATUS1        0x3A  // unread FIFO words, low byte
+#define FIFO_DATA_OUT_TAG   0x78  // start of FIFO output, tag then 6 data bytes
 
 #define IMU_WRITE_ADDR(addr)  (uint8_t)(0x7F & addr)
 #define IMU_READ_ADDR(addr)   (uint8_t)(0x80 | addr)
@@ -26,6 +30,20 @@
 #define ACCEL_RES      8.0 / 32768.0     // full scale /resolution (8G)
 #define GYRO_RES     245.0 / 32768.0     // full scale / resolution (245 dps)
 
+#define WHO_AM_I_VALUE      0x6B
+#define CTRL3_C_SW_RESET    0x01
+#define STATUS_XLDA_GDA     0x03  // accel and gyro data ready
+
+#define FIFO_BDR_208HZ      0b01010101  // gyro and accel both batched at 208 Hz
+#define FIFO_MODE_BYPASS    0b00000000  // fifo disabled, clears its contents
+#define FIFO_MODE_CONTINUOUS 0b00000110 // newest data overwrites the oldest when full
+
+// The old code slept between every register write. The part doesn't need
+// that; these are the times it does need, polled instead of slept.
+#define IMU_BOOT_TIMEOUT_MS   100   // power on to SPI answering, 10 msec typical
+#define IMU_RESET_TIMEOUT_MS  100   // software reset, 50 usec typical
+#define IMU_SETTLE_MS          70   // gyro turn-on time after setting the ODR
+
 #define ISM330_TEMP_SCALE   256.0
 #define ISM330_TEMP_BIAS     25.0
 
@@ -38,6 +56,7 @@ IMU330::IMU330(SpiIO * pSensorSPI, int CsPort)
 //    Config    = pConfig;
 
     lLastImuTempUpdate = millis();
+    uSettleStartMs     = millis();
 
     // Set up chip select pins as outputs
     pinMode(uChipSel, OUTPUT);
@@ -51,43 +70,50 @@ IMU330::IMU330(SpiIO * pSensorSPI, int CsPort)
     Gy = 0.0;     // Pitch rate
     Gz = 0.0;     // Yaw rate
 
+    iFifoSamples  = 0;
+    uFifoOverruns = 0;
+
 } // end contructor
 
 // ----------------------------------------------------------------------------
 
 void IMU330::Init()
 {
+  // Wait for the part to finish its own boot after power on
+  unsigned long uStartMs = millis();
+  while (WhoAmI() != WHO_AM_I_VALUE && millis() - uStartMs < IMU_BOOT_TIMEOUT_MS)
+    delay(1);
+
   Reset();
 
   // SPI interface: I2C_disable = 1 in CTRL4_C (13h) and DEVICE_CONF = 1 in CTRL9_XL (18h).
 
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL9_XL), 0b11100010);
-  delay(50);
 
   // enable accelerometer
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL1_XL), 0b01011100); // 208hz ODR, +/-8G, LPF2 disabled
-  delay(50);
 
   // enable gyroscope
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL2_G), 0b01010000); // 208 hz, 250dps
-  delay(50);
 
   // disable gyroscope hi-pass filter
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL7_G), 0b00000000); // high performance mode, disable high pass filter
-  delay(50);
 
   // disable LPF1, disable I2C
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL4_C), 0b00000100); // disable low pass filter 1, LPF2 is still on at 67hz bandwidth
-  delay(50);
 
-  // set fifo
-  SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(FIFO_CTRL4), 0b00010000); // bypass mode, fifo disabled
-  delay(50);
+  // set fifo to queue every gyro and accel sample so none are lost between
+  // sensor loop reads
+  SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(FIFO_CTRL3), FIFO_BDR_208HZ);
+  SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(FIFO_CTRL4), FIFO_MODE_CONTINUOUS);
 
   SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL9_XL), 0b11100000);
-  delay(50);
 
-  g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug, "IMU Who Am I : 0x%2.2X\n", g_pIMU->WhoAmI());
+  // Sensors are running from here. WaitReady() holds off the first read
+  // until they have settled, so other startup can happen in the meantime.
+  uSettleStartMs = millis();
+
+  g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug, "IMU Who Am I : 0x%2.2X\n", WhoAmI());
 
 }
 
@@ -97,28 +123,171 @@ void IMU330::Reset()
 {
     // soft reset accelerometer/gyro
     SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL3_C),  0b00000101);
-    delay(100);
+
+    // The reset bit clears itself when the reset is done
+    unsigned long uStartMs = millis();
+    while ((SensorSPI->ReadRegByte(uChipSel, IMU_READ_ADDR(CTRL3_C)) & CTRL3_C_SW_RESET) &&
+           (millis() - uStartMs < IMU_RESET_TIMEOUT_MS))
+        delay(1);
+
     SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(CTRL3_C),  0b00000100);
-    delay(100);
 }
 
 // ----------------------------------------------------------------------------
 
-// Read IMU and process AHRS
+// Wait until the accel and gyro have settled after Init() and both have new
+// data. Returns right away if they settled while something else was running.
+
+bool IMU330::WaitReady(unsigned uTimeoutMs)
+{
+    unsigned long uStartMs = millis();
+
+    while (millis() - uStartMs < uTimeoutMs)
+        {
+        if (millis() - uSettleStartMs >= IMU_SETTLE_MS)
+            {
+            uint8_t uStatus = SensorSPI->ReadRegByte(uChipSel, IMU_READ_ADDR(STATUS_REG));
+            if ((uStatus & STATUS_XLDA_GDA) == STATUS_XLDA_GDA)
+                {
+                // Throw away what queued up while the sensors were settling
+                FlushFifo();
+                return true;
+                }
+            }
+        delay(1);
+        }
+
+    g_Log.println(MsgLog::EnIMU, MsgLog::EnWarning, "IMU data not ready");
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+
+// Read everything queued in the FIFO, and the temperature every 100 msec
 
 void IMU330::Read()
 {
-    bool bTempUpdate = false;
-    // heartbeat
+    Read(TempUpdateDue());
+}
+
+// ----------------------------------------------------------------------------
+
+// Read everything queued in the FIFO. The sensor task updates the
+// temperature from its own 10 Hz rate group.
+
+void IMU330::Read(bool bTempUpdate)
+{
+    uint8_t     aFifoStatus[2];
+
+    SensorSPI->ReadRegBytes(uChipSel, IMU_READ_ADDR(FIFO_STATUS1), aFifoStatus, 2);
+    ReadFifo(aFifoStatus, bTempUpdate);
+}
+
+// ----------------------------------------------------------------------------
+
+// Same as Read(false) but with the FIFO status bytes from a batched bus read
+// planned by AddToBusPlan()
+
+void IMU330::Read(const uint8_t * pFifoStatus)
+{
+    ReadFifo(pFifoStatus, false);
+}
+
+// ----------------------------------------------------------------------------
+
+// The batched read gets the FIFO status. How many words to read from the FIFO
+// isn't known until then, so that's a second burst in ReadFifo().
 
+int IMU330::AddToBusPlan(SensorBusPlan & Plan)
+{
+    return Plan.addRegisterRead(uChipSel, FIFO_STATUS1, 2, IMU_READ_ADDR(0));
+}
+
+// ----------------------------------------------------------------------------
+
+// Burst read the queued FIFO words and decode them into asuFifo[]. The FIFO
+// output registers roll back from the last data byte to the tag, so every
+// word comes out of one read.
+
+void IMU330::ReadFifo(const uint8_t * pFifoStatus, bool bTempUpdate)
+{
+    uint8_t         aFifoData[IMU_FIFO_MAX_WORDS * kImuFifoWordBytes];
+    ImuRawSample    asuRaw[IMU_FIFO_MAX_SAMPLES];
+    ImuFifoStatus   suStatus = ImuFifoStatus::decode(pFifoStatus);
+
+    iFifoSamples = 0;
+
+    if (suStatus.bOverrun)
+        uFifoOverruns++;
+
+    if (suStatus.iWords > IMU_FIFO_MAX_WORDS)
+        {
+        // Too far behind, like after the task was held up by a calibration.
+        // Start again from now rather than replay stale motion.
+        uFifoOverruns++;
+        FlushFifo();
+        g_Log.printf(MsgLog::EnIMU, MsgLog::EnWarning, "IMU FIFO backlog %d words flushed\n", suStatus.iWords);
+        }
+
+    else if (suStatus.iWords > 0)
+        {
+        SensorSPI->ReadRegBytes(uChipSel, IMU_READ_ADDR(FIFO_DATA_OUT_TAG), aFifoData, suStatus.iWords * int(kImuFifoWordBytes));
+        int iRaw = FifoDecoder.decode(aFifoData, suStatus.iWords, asuRaw, IMU_FIFO_MAX_SAMPLES);
+
+        for (int i = 0; i < iRaw; i++)
+            {
+            gxRaw = asuRaw[i].aiGyro[0];
+            gyRaw = asuRaw[i].aiGyro[1];
+            gzRaw = asuRaw[i].aiGyro[2];
+            axRaw = asuRaw[i].aiAccel[0];
+            ayRaw = asuRaw[i].aiAccel[1];
+            azRaw = asuRaw[i].aiAccel[2];
+            ScaleRaw();
+            MapAircraftAxes();
+
+            asuFifo[iFifoSamples++] = { Ax, Ay, Az, Gx, Gy, Gz };
+            }
+        }
+
+    // Nothing new queued (the loop can outrun the IMU) or just flushed. Keep
+    // the current values fresh from the output registers; there are no new
+    // samples for the AHRS to integrate.
+    if (iFifoSamples == 0)
+        ReadAccelGyro(false);
+
+    if (bTempUpdate)
+        UpdateTemp();
+
+    UpdateAircraftAxes();
+}
+
+// ----------------------------------------------------------------------------
+
+// Empty the FIFO by dropping to bypass mode and back
+
+void IMU330::FlushFifo()
+{
+    SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(FIFO_CTRL4), FIFO_MODE_BYPASS);
+    SensorSPI->WriteRegByte(uChipSel, IMU_WRITE_ADDR(FIFO_CTRL4), FIFO_MODE_CONTINUOUS);
+    FifoDecoder.reset();
+}
+
+// ----------------------------------------------------------------------------
+
+bool IMU330::TempUpdateDue()
+{
     if (millis() - lLastImuTempUpdate > 100)
     {
         lLastImuTempUpdate = millis();
-        bTempUpdate = true;
+        return true;
     }
+    return false;
+}
 
-    ReadAccelGyro(bTempUpdate); // read accelerometers
+// ----------------------------------------------------------------------------
 
+void IMU330::MapAircraftAxes()
+{
     // Get IMU values in aircraft orientation
 #if 0
     Az = GetAccelForAxis(sVerticalGloadAxis);
@@ -135,6 +304,13 @@ void IMU330::Read()
     Gy = *pfGy * fGySign;
     Gz = *pfGz * fGzSign;
 #endif
+}
+
+// ----------------------------------------------------------------------------
+
+void IMU330::UpdateAircraftAxes()
+{
+    MapAircraftAxes();
 
     g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug,
         "Ax %.3f, Ay %.3f, Az %.3f, Gx %.4f, Gy %.4f, Gz %.4f, Temp %.2fC\n",
@@ -148,25 +324,50 @@ void IMU330::Read()
 
 // ----------------------------------------------------------------------------
 
+// Read the output registers directly, bypassing the FIFO. Gives the current
+// values but no samples for the AHRS to integrate.
+
 void IMU330::ReadAccelGyro(bool bTempUpdate)
 {
-    uint8_t     aAccelData[6]; // Six bytes from the accelerometer
-    uint8_t     aGyroData[6];  // Six bytes from the gyro
-//    int16_t     axRaw,ayRaw,azRaw;
-//    int16_t     gxRaw,gyRaw,gzRaw;
+    uint8_t     aGyroAccelData[12]; // Six bytes from the gyro then six from the accelerometer
 
-    // Read accelerometer output
-    SensorSPI->ReadRegBytes(uChipSel, IMU_READ_ADDR(OUTX_L_A), aAccelData, 6); // Read 6 bytes, beginning at OUTX_L_A
-    axRaw = (aAccelData[1] << 8) | aAccelData[0]; // Store x-axis values into ax
-    ayRaw = (aAccelData[3] << 8) | aAccelData[2]; // Store y-axis values into ay
-    azRaw = (aAccelData[5] << 8) | aAccelData[4]; // Store z-axis values into az
+    iFifoSamples = 0;
+
+    SensorSPI->ReadRegBytes(uChipSel, IMU_READ_ADDR(OUTX_L_G), aGyroAccelData, 12); // Read 12 bytes, beginning at OUTX_L_G
+    DecodeAccelGyro(aGyroAccelData, bTempUpdate);
+}
+
+// ----------------------------------------------------------------------------
+
+void IMU330::DecodeAccelGyro(const uint8_t * pGyroAccel, bool bTempUpdate)
+{
+    const uint8_t * aGyroData  = pGyroAccel;
+    const uint8_t * aAccelData = pGyroAccel + 6;
 
-    // Read gyro output
-    SensorSPI->ReadRegBytes(uChipSel, IMU_READ_ADDR(OUTX_L_G), aGyroData, 6);  // Read the six raw data registers sequentially into data array
     gxRaw = (aGyroData[1] << 8) | aGyroData[0]; // Store x-axis values into gx
     gyRaw = (aGyroData[3] << 8) | aGyroData[2]; // Store y-axis values into gy
     gzRaw = (aGyroData[5] << 8) | aGyroData[4]; // Store z-axis values into gz
 
+    axRaw = (aAccelData[1] << 8) | aAccelData[0]; // Store x-axis values into ax
+    ayRaw = (aAccelData[3] << 8) | aAccelData[2]; // Store y-axis values into ay
+    azRaw = (aAccelData[5] << 8) | aAccelData[4]; // Store z-axis values into az
+
+    ScaleRaw();
+
+    if (g_Log.Test(MsgLog::EnIMU, MsgLog::EnDebug))
+        g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug, "fAccelX %.3f, fAccelY %.3f, fAccelZ %.3f, fGyroX %.4f, fGyroY %.4f, fGyroZ %.4f\n",
+            fAccelX, fAccelY, fAccelZ, fGyroX, fGyroY, fGyroZ);
+
+    if (bTempUpdate)
+        UpdateTemp();
+}
+
+// ----------------------------------------------------------------------------
+
+// Raw counts to G and deg/sec, in IMU orientation
+
+void IMU330::ScaleRaw()
+{
     fAccelX     = axRaw * ACCEL_RES;
     fAccelY     = ayRaw * ACCEL_RES;
     fAccelZ     = azRaw * ACCEL_RES;
@@ -176,26 +377,20 @@ void IMU330::ReadAccelGyro(bool bTempUpdate)
     fGyroXwBias = fGyroX + g_Config.fGxBias;
     fGyroYwBias = fGyroY + g_Config.fGyBias;
     fGyroZwBias = fGyroZ + g_Config.fGzBias;
+}
 
-    if (g_Log.Test(MsgLog::EnIMU, MsgLog::EnDebug))
-        g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug, "fAccelX %.3f, fAccelY %.3f, fAccelZ %.3f, fGyroX %.4f, fGyroY %.4f, fGyroZ %.4f\n",
-            fAccelX, fAccelY, fAccelZ, fGyroX, fGyroY, fGyroZ);
+// ----------------------------------------------------------------------------
 
-#if 1
+void IMU330::UpdateTemp()
+{
     // read IMU temperature output
-    if (bTempUpdate)
-        {
-        ReadTempC();
+    ReadTempC();
 
-        pTempAvg->addValue(fTempC);
-        fTempC = pTempAvg->getFastAverage();
-        //imuTempDerivativeInput=imuTempRaw;
-        //imuTempRateAvg.addValue(-imuTempDerivative.Compute()*10.0); //10Hz sample rate on imuTemp, SavGolay derivative filter takes 20-25uSec
-        //imuTempRate=imuTempRateAvg.getFastAverage();
-
-//        g_Log.printf(MsgLog::EnIMU, MsgLog::EnDebug, "Temp: %.1fC\n",fTempC);
-        }
-#endif
+    pTempAvg->addValue(fTempC);
+    fTempC = pTempAvg->getFastAverage();
+    //imuTempDerivativeInput=imuTempRaw;
+    //imuTempRateAvg.addValue(-imuTempDerivative.Compute()*10.0); //10Hz sample rate on imuTemp, SavGolay derivative filter takes 20-25uSec
+    //imuTempRate=imuTempRateAvg.getFastAverage();
 }
 
 // ----------------------------------------------------------------------------
@@ -6,6 +6,18 @@
 #include "RunningAverage.h"
 
 #include "SPI_IO.h"
+#include <SensorBus.h>
+#include <ImuFifo.h>
+
+#define IMU_FIFO_MAX_SAMPLES    16          // Per read, about 75 msec at 208 Hz
+#define IMU_FIFO_MAX_WORDS      (2 * IMU_FIFO_MAX_SAMPLES)
+
+// One FIFO sample in aircraft orientation, same units as Ax..Gz below
+struct SuImuSample
+{
+    float       Ax, Ay, Az;
+    float       Gx, Gy, Gz;
+};
 
 // IMU functions
 
@@ -39,6 +51,7 @@ public:
 
     float       fTempC;                     // IMU temperature
     long        lLastImuTempUpdate;
+    unsigned long uSettleStartMs;           // When Init() turned the sensors on
 
     // Pointers to IMU orientation values and sign for a particular aircraft orientation
     float     * pfAx, fAxSign;
@@ -56,18 +69,38 @@ public:
     float       Gy;     // Pitch rate
     float       Gz;     // Yaw rate
 
+    // Every sample the FIFO has queued since the last read, oldest first,
+    // 1/208 sec apart. The newest is also in Ax..Gz above. Can be zero
+    // samples if the loop runs faster than the IMU.
+    SuImuSample     asuFifo[IMU_FIFO_MAX_SAMPLES];
+    int             iFifoSamples;
+    uint32_t        uFifoOverruns;          // Times data was lost or flushed
+    ImuFifoDecoder  FifoDecoder;
+
     RunningAverage  * pTempAvg;
 //    RunningAverage TempAvg(20);
 //    RunningAverage TempAvg(ImuTempSmoothing);
 
   // Methods
 protected:
+    bool        TempUpdateDue();
+    void        ScaleRaw();
+    void        MapAircraftAxes();
+    void        UpdateAircraftAxes();
 
 public:
     void        Init();
     void        Reset();
+    bool        WaitReady(unsigned uTimeoutMs);
     void        ReadAccelGyro(bool bTempUpdate);
+    void        DecodeAccelGyro(const uint8_t * pGyroAccel, bool bTempUpdate);
+    void        UpdateTemp();
     void        Read();
+    void        Read(bool bTempUpdate);
+    void        Read(const uint8_t * pFifoStatus);
+    void        ReadFifo(const uint8_t * pFifoStatus, bool bTempUpdate);
+    void        FlushFifo();
+    int         AddToBusPlan(SensorBusPlan & Plan);
     float       ReadTempC();
     uint8_t     WhoAmI();
     void        ConfigAxes();
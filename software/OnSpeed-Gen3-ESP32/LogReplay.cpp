@@ -52,13 +52,17 @@ void LogReplayTask(void *pvParams)
     if (!bReadStatus)
         g_Log.println(MsgLog::EnReplay, MsgLog::EnError, "Unable to read and replay file.");
 
-    xLastWakeTime = xLAST_TICK_TIME(20);
+    // Replay at the sensor loop rate, with the AOA fusion starting over
+    const int   iPeriodMs = g_Sensors.LoopPeriodMs();
+    g_Sensors.AoaFuse.reset();
+
+    xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
 
     while (bReadStatus == true)
     {
         // No delay happening is a design flaw so flag it if it happens, or
         // rather doesn't happen.
-        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(20));
+        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(iPeriodMs));
 
         // If this task wasn't delayed before it ran again it means it
         // it ran long for some reason (like the CPU is overloaded) or
@@ -68,7 +72,7 @@ void LogReplayTask(void *pvParams)
         // the data.
         if (xWasDelayed == pdFALSE)
         {
-            xLastWakeTime = xLAST_TICK_TIME(20);
+            xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
             g_Log.println(MsgLog::EnReplay, MsgLog::EnWarning, "LogReplayTask Late");
         }
 
@@ -220,10 +224,12 @@ bool ReadLogLine()
 
     g_fCoeffP = pressureCoeff(g_Sensors.PfwdSmoothed, g_Sensors.P45Smoothed);
 
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+
     // Find the flap index from flap degrees
-    for (int iFlapsIdx = 0; iFlapsIdx < g_Config.aFlaps.size(); iFlapsIdx++)
+    for (int iFlapsIdx = 0; iFlapsIdx < cfg->iFlapCount; iFlapsIdx++)
         {
-        if (g_Flaps.iPosition == g_Config.aFlaps[iFlapsIdx].iDegrees)
+        if (g_Flaps.iPosition == cfg->aFlaps[iFlapsIdx].iDegrees)
             {
             g_Flaps.iIndex = iFlapsIdx;
             break;
@@ -247,8 +253,8 @@ bool ReadLogLine()
     // AOA is recalculated, which I think is kind of stinky. I'd rather display the AOA
     // that was calculated during the recording.
 //  SetAOApoints(g_Flaps.iIndex);
-    const SuCalibrationCurve& curve = g_Config.aFlaps[g_Flaps.iIndex].AoaCurve;
-    AOACalculatorResult result = g_Sensors.AoaCalc.calculate(g_Sensors.PfwdSmoothed, g_Sensors.P45Smoothed, curve);
+    const SuFlapSetpoints& flap = cfg->flap(g_Flaps.iIndex);
+    AOACalculatorResult result = g_Sensors.AoaCalc.calculate(g_Sensors.PfwdSmoothed, g_Sensors.P45Smoothed, flap.AoaCurve, &flap.AoaCompiled);
     g_Sensors.AOA = result.aoa;
     g_fCoeffP = result.coeffP;
 
@@ -264,6 +270,19 @@ bool ReadLogLine()
     g_AHRS.AccelLatCorr   = g_pIMU->Ay;
     g_AHRS.AccelVertCorr  = g_pIMU->Az;
 
+    // Fused AOA from the logged rates and accelerations, for tuning it
+    // against recorded flights. The logged values are already smoothed
+    // some, so this is a little behind what it would be live.
+    AoaInertialInput suImu;
+    suImu.fPitchRateDps = -g_pIMU->Gy;
+    suImu.fFwdG         =  g_pIMU->Ax;
+    suImu.fVertG        =  g_pIMU->Az;
+    suImu.fPitchDeg     =  g_AHRS.SmoothedPitch;
+    suImu.fRollDeg      =  g_AHRS.SmoothedRoll;
+    suImu.fTasMps       =  kts2mps(g_Sensors.IAS * (1 + g_Sensors.Palt / 1000 * 0.02));
+    g_Sensors.FusedAOA  =  g_Sensors.AoaFuse.update(g_Sensors.AOA, suImu);
+    g_Log.printf(MsgLog::EnReplay, MsgLog::EnDebug, "AOA: %.2f, FusedAOA: %.2f\n", g_Sensors.AOA, g_Sensors.FusedAOA);
+
     g_AudioPlay.UpdateTones();
 
     //Serial.printf("Time:%ld", lTimestamp);
@@ -329,17 +348,19 @@ void TestPotTask(void *pvParams)
     // Get the passed parameters
 //    SuParamsReplay    * psuParamsReplay = (SuParamsReplay *)pvParams;
 
-    xLastWakeTime = xLAST_TICK_TIME(20);
+    const int   iPeriodMs = g_Sensors.LoopPeriodMs();
+
+    xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
 
     while (true)
     {
         // No delay happening is a design flaw so flag it if it happens, or
         // rather doesn't happen.
-        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(20));
+        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(iPeriodMs));
 
         if (xWasDelayed == pdFALSE)
         {
-            xLastWakeTime = xLAST_TICK_TIME(20);
+            xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
             g_Log.println(MsgLog::EnReplay, MsgLog::EnWarning, "TestPotTask Late");
         }
 
@@ -368,10 +389,11 @@ void ReadTestPot()
     fFlapRawValue = fFlapRawValue / 5.0;
 
     // Map the flap pot raw value onto the flap pot raw value limits
-    if (g_Config.aFlaps.size() > 1)
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
+    if (cfg->iFlapCount > 1)
         {
         // Convert raw flap pot postion into an AOA between 0 and 20
-        fReadAOA = mapfloat(fFlapRawValue, g_Config.aFlaps[0].iPotPosition, g_Config.aFlaps.back().iPotPosition, 0.0, 20.0);
+        fReadAOA = mapfloat(fFlapRawValue, cfg->aFlaps[0].iPotPosition, cfg->aFlaps[cfg->iFlapCount-1].iPotPosition, 0.0, 20.0);
         fReadAOA = constrain(fReadAOA, 0.0, 20.0);
         }
 
@@ -381,6 +403,7 @@ void ReadTestPot()
 
     // Smooth potentiometer AOA (using flap pot input)
     g_Sensors.AOA = fReadAOA * smoothingAlpha + g_Sensors.AOA * (1 - smoothingAlpha);
+    g_Sensors.FusedAOA = g_Sensors.AOA;
 
     // Just make sure g_Flaps.iIndex is set and good things will happen
     g_Flaps.iIndex = 0; // flaps up
@@ -461,6 +484,7 @@ void RangeSweepTask(void *pvParams)
         }
 
         g_Sensors.AOA = fCurrentRangeSweepValue;
+        g_Sensors.FusedAOA = g_Sensors.AOA;
     //    setAOApoints(0); // flaps down (up?)
         g_Sensors.IAS = 50; // to turn on the tones
         g_AudioPlay.UpdateTones();
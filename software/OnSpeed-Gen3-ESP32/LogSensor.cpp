@@ -4,8 +4,10 @@
 #endif
 #include "SdFat.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 
 #include "Globals.h"
 
@@ -24,6 +26,28 @@ static FsFile       m_hLogFile;
 // non-blocking so SD-card stalls can't backpressure critical tasks.
 static uint32_t      s_uRingDropCount = 0;
 
+// Sensor log lines waiting for external data to catch up. See Write().
+#define LOG_ALIGN_MS                100                 // Hold each line this long
+#define LOG_PENDING_MAX             (LOG_ALIGN_MS * 200 / 1000 + 1)    // Slots at the fastest loop rate
+
+struct SuPendingLine
+{
+    uint32_t    uSampleUs;          // Sensor sample time
+    uint32_t    uTimeStamp;         // Sensor sample time in msec, the timeStamp column
+    bool        bOk;                // Sensor columns formatted without truncation
+    int         iHeadLen;
+    char        szHead[384];        // Columns before the boom / EFIS ones
+    int         iTailLen;
+    char        szTail[96];         // Columns after them
+};
+
+static SuPendingLine s_asuPending[LOG_PENDING_MAX];
+static int           s_iPendingSlots = 0;   // Slots in use at the loop rate, set on first Write()
+static int           s_iPendingNext  = 0;
+static int           s_iPendingCount = 0;
+
+static uint32_t      s_uLoggedStaticSeq = 0;    // g_Sensors.uStaticSeq on the last line written
+
 static bool Appendf(char * pBuf, size_t uBufSize, int & iLen, const char * szFmt, ...)
     {
     if (pBuf == nullptr || uBufSize == 0)
@@ -57,6 +81,76 @@ static bool Appendf(char * pBuf, size_t uBufSize, int & iLen, const char * szFmt
 
 // ----------------------------------------------------------------------------
 
+// Complete a held sensor line with the boom and EFIS columns interpolated to
+// its sample time. Returns false if the line was truncated.
+
+static bool FinishPendingLine(const SuPendingLine & suLine, char * szLogLine, size_t uLineSize, int & iLineLen)
+{
+    bool    bOk     = suLine.bOk;
+    int     BoomAge = 0;
+    int     EfisAge = 0;
+    int32_t iAgeUs;
+
+    memcpy(szLogLine, suLine.szHead, suLine.iHeadLen + 1);
+    iLineLen = suLine.iHeadLen;
+
+    if (g_Config.bReadBoom)
+    {
+        BoomSerialIO::SuBoomSample  suBoom;
+
+        g_BoomSerial.SampleAt(suLine.uSampleUs, suBoom, iAgeUs);
+        BoomAge = iAgeUs / 1000;
+        bOk &= Appendf(szLogLine, uLineSize, iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%i",
+            suBoom.Static, suBoom.Dynamic,
+            suBoom.Alpha,  suBoom.Beta,
+            suBoom.IAS, BoomAge);
+    } // end boom data
+
+    if (g_Config.bReadEfisData)
+    {
+        if (g_EfisSerial.enType == EfisSerialIO::EnVN300) // VN-300 type data
+        {
+            static EfisSerialIO::SuVN300Data    suVN300;
+
+            g_EfisSerial.SampleVN300At(suLine.uSampleUs, suVN300, iAgeUs);
+            EfisAge = iAgeUs / 1000;
+            bOk &= Appendf(szLogLine, uLineSize, iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.6f,%.6f,%i,%i,%s",
+                suVN300.AngularRateRoll, suVN300.AngularRatePitch, suVN300.AngularRateYaw,
+                suVN300.VelNedNorth,     suVN300.VelNedEast,       suVN300.VelNedDown,
+                suVN300.AccelFwd,        suVN300.AccelLat,         suVN300.AccelVert,
+                suVN300.Yaw,             suVN300.Pitch,            suVN300.Roll,
+                suVN300.LinAccFwd,       suVN300.LinAccLat,        suVN300.LinAccVert,
+                suVN300.YawSigma,        suVN300.RollSigma,        suVN300.PitchSigma,
+                suVN300.GnssVelNedNorth, suVN300.GnssVelNedEast,   suVN300.GnssVelNedDown,
+                suVN300.GnssLat,         suVN300.GnssLon,          suVN300.GPSFix,
+                EfisAge, suVN300.szTimeUTC);
+        } // end if VN-300
+
+        // Other EFIS data sources
+        else
+        {
+            static EfisSerialIO::SuEfisData     suEfis;
+
+            g_EfisSerial.SampleEfisAt(suLine.uSampleUs, suEfis, iAgeUs);
+            EfisAge = iAgeUs / 1000;
+            bOk &= Appendf(szLogLine, uLineSize, iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i,%i,%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i,%i,%i,%lu",
+                suEfis.IAS,           suEfis.Pitch,        suEfis.Roll,
+                suEfis.LateralG,      suEfis.VerticalG,
+                suEfis.PercentLift,   suEfis.Palt,         suEfis.VSI,
+                suEfis.TAS,           suEfis.OAT,
+                suEfis.FuelRemaining, suEfis.FuelFlow,     suEfis.MAP,
+                suEfis.RPM,           suEfis.PercentPower, suEfis.Heading,
+                EfisAge,              (unsigned long)(suLine.uTimeStamp - EfisAge));
+        }
+    } // end EFIS data
+
+    bOk &= Appendf(szLogLine, uLineSize, iLineLen, "%s\n", suLine.szTail);
+
+    return bOk;
+}
+
+// ----------------------------------------------------------------------------
+
 // FreeRTOS task to write sensor log data to disk
 // Previously formatted strings with log data to be written to disk are sent
 // to a ring buffer. This task reads them out of the ring buffer and writes them
@@ -234,6 +328,11 @@ void LogSensor::Open()
 
         m_hLogFile = g_SdFileSys.open(szSensorLogFilename, O_RDWR | O_CREAT | O_TRUNC);
 
+        // Don't carry samples from before the file was opened into it, and
+        // mark the first line's static pressure as new
+        s_iPendingCount    = 0;
+        s_uLoggedStaticSeq = g_Sensors.uStaticSeq - 1;
+
         if (m_hLogFile.isOpen())
         {
             // Write the CSV header line
@@ -254,7 +353,7 @@ void LogSensor::Open()
                     m_hLogFile.write(",efisIAS,efisPitch,efisRoll,efisLateralG,efisVerticalG,efisPercentLift,efisPalt,efisVSI,efisTAS,efisOAT,efisFuelRemaining,efisFuelFlow,efisMAP,efisRPM,efisPercentPower,efisMagHeading,efisAge,efisTime");
             } // end if EFIS data
 
-            m_hLogFile.write(",EarthVerticalG, FlightPath, VSI, Altitude");
+            m_hLogFile.write(",EarthVerticalG, FlightPath, VSI, Altitude,StaticNew");
             m_hLogFile.write("\n");
 
             m_hLogFile.sync();
@@ -278,20 +377,55 @@ void LogSensor::Open()
 
 void LogSensor::Close()
 {
+    // Write out the lines still queued for the commit task and the ones held
+    // for alignment, oldest first, so the end of the log isn't lost. Callers
+    // hold xWriteMutex.
+    if (m_hLogFile.isOpen())
+    {
+        static char     szLogLine[2048];
+        size_t          uItemLen;
+        char          * pchItem;
+
+        if (xLoggingRingBuffer != nullptr)
+            while ((pchItem = (char *)xRingbufferReceive(xLoggingRingBuffer, &uItemLen, 0)) != NULL)
+            {
+                m_hLogFile.write(pchItem, uItemLen);
+                vRingbufferReturnItem(xLoggingRingBuffer, pchItem);
+            }
+
+        // Once the delay line is full, the slot at s_iPendingNext has already been written
+        const int iHeld = s_iPendingCount < s_iPendingSlots ? s_iPendingCount : s_iPendingSlots - 1;
+        for (int iLine = 0; iLine < iHeld; iLine++)
+        {
+            const SuPendingLine & suLine = s_asuPending[(s_iPendingNext - iHeld + iLine + s_iPendingSlots) % s_iPendingSlots];
+            int iLineLen = 0;
+
+            if (FinishPendingLine(suLine, szLogLine, sizeof(szLogLine), iLineLen))
+                m_hLogFile.write(szLogLine, iLineLen);
+        }
+        s_iPendingCount = 0;
+    }
+
     m_hLogFile.close();
 }
 
 // ----------------------------------------------------------------------------
 
 // Generate a formatted line of sensor data and send it to the ring queue
+//
+// The sensor columns are formatted when the sample is taken, then held for
+// LOG_ALIGN_MS. By the time the line is written the boom and EFIS
+// data from around the sample time has arrived and their columns are
+// interpolated to the sample time instead of being whatever was decoded
+// last. The age columns are the time from the earlier external sample used
+// to the sensor sample, in msec. efisTime is the time of that EFIS sample on
+// the same millis() clock as timeStamp.
 
 void LogSensor::Write()
 {
     static char     szLogLine[2048];   // Too big for the stack
     unsigned long   uTimeStamp = millis(); // save timestamp for logging
     int             iLineLen   = 0;
-    int             BoomAge    = 0;
-    int             EfisAge    = 0;
 
     // Used during SD file downloads (and other future pause cases).
     // Avoid queuing data while the writer task is paused.
@@ -300,68 +434,54 @@ void LogSensor::Write()
 
     if (g_Config.bSdLogging)
     {
+        if (s_iPendingSlots == 0)
+            s_iPendingSlots = std::min(LOG_PENDING_MAX, LOG_ALIGN_MS * g_Sensors.Smoothing.iHz / 1000 + 1);
+
+        // Format the sensor columns into the next pending slot
+        SuPendingLine & suNew = s_asuPending[s_iPendingNext];
         bool bOk = true;
-        szLogLine[0] = '\0';
 
-        bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, "%lu,%i,%.2f,%i,%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i",
+        suNew.uSampleUs  = g_Sensors.uSampleUs;
+        suNew.uTimeStamp = uTimeStamp;
+        suNew.iHeadLen   = 0;
+        suNew.iTailLen   = 0;
+
+        bOk &= Appendf(suNew.szHead, sizeof(suNew.szHead), suNew.iHeadLen, "%lu,%i,%.2f,%i,%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i",
             uTimeStamp, g_Sensors.iPfwd, g_Sensors.PfwdSmoothed, g_Sensors.iP45,g_Sensors.P45Smoothed,
             g_Sensors.PStatic, g_Sensors.Palt, g_Sensors.IAS, g_Sensors.AOA,
             g_Flaps.iPosition, g_iDataMark);
         //charsAdded+=sprintf(logLine, "%lu,%i,%.2f,%i,%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i",timeStamp,124,124.56,145,145.00,1013.00,5600.00,110.58,10.25,2,0);
 #ifdef OAT_AVAILABLE
-        bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.2f", g_Sensors.OatC, mps2kts(g_AHRS.TAS));
+        bOk &= Appendf(suNew.szHead, sizeof(suNew.szHead), suNew.iHeadLen, ",%.2f,%.2f", g_Sensors.OatC, mps2kts(g_AHRS.TAS));
 #endif
 
-        bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.2f,%.2f",
+        bOk &= Appendf(suNew.szHead, sizeof(suNew.szHead), suNew.iHeadLen, ",%.2f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.2f,%.2f",
             g_pIMU->fTempC,
             g_pIMU->Az,  g_pIMU->Ay, g_pIMU->Ax,
             g_pIMU->Gx, -g_pIMU->Gy, g_pIMU->Gz,
             g_AHRS.SmoothedPitch, g_AHRS.SmoothedRoll);
 
-        if (g_Config.bReadBoom)
-        {
-            BoomAge     = millis() - g_BoomSerial.uTimestamp;
-            bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%i",
-                g_BoomSerial.Static, g_BoomSerial.Dynamic,
-                g_BoomSerial.Alpha,  g_BoomSerial.Beta,
-                g_BoomSerial.IAS, BoomAge);
-        } // end boom data
-
-        if (g_Config.bReadEfisData)
-        {
-            EfisAge = millis() - g_EfisSerial.uTimestamp;
-            if (g_EfisSerial.enType == EfisSerialIO::EnVN300) // VN-300 type data
-            {
-                bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.6f,%.6f,%i,%i,%s",
-                    g_EfisSerial.suVN300.AngularRateRoll, g_EfisSerial.suVN300.AngularRatePitch, g_EfisSerial.suVN300.AngularRateYaw,
-                    g_EfisSerial.suVN300.VelNedNorth,     g_EfisSerial.suVN300.VelNedEast,       g_EfisSerial.suVN300.VelNedDown,
-                    g_EfisSerial.suVN300.AccelFwd,        g_EfisSerial.suVN300.AccelLat,         g_EfisSerial.suVN300.AccelVert,
-                    g_EfisSerial.suVN300.Yaw,             g_EfisSerial.suVN300.Pitch,            g_EfisSerial.suVN300.Roll,
-                    g_EfisSerial.suVN300.LinAccFwd,       g_EfisSerial.suVN300.LinAccLat,        g_EfisSerial.suVN300.LinAccVert,
-                    g_EfisSerial.suVN300.YawSigma,        g_EfisSerial.suVN300.RollSigma,        g_EfisSerial.suVN300.PitchSigma,
-                    g_EfisSerial.suVN300.GnssVelNedNorth, g_EfisSerial.suVN300.GnssVelNedEast,   g_EfisSerial.suVN300.GnssVelNedDown,
-                    g_EfisSerial.suVN300.GnssLat,         g_EfisSerial.suVN300.GnssLon,          g_EfisSerial.suVN300.GPSFix,
-                    EfisAge, g_EfisSerial.suVN300.TimeUTC.c_str());
-            } // end if VN-300
-
-            // Other EFIS data sources
-            else
-            {
-                bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i,%i,%.2f,%.2f,%.2f,%.2f,%.2f,%i,%i,%i,%i,%lu",
-                    g_EfisSerial.suEfis.IAS,           g_EfisSerial.suEfis.Pitch,        g_EfisSerial.suEfis.Roll,
-                    g_EfisSerial.suEfis.LateralG,      g_EfisSerial.suEfis.VerticalG,
-                    g_EfisSerial.suEfis.PercentLift,   g_EfisSerial.suEfis.Palt,         g_EfisSerial.suEfis.VSI,
-                    g_EfisSerial.suEfis.TAS,           g_EfisSerial.suEfis.OAT,
-                    g_EfisSerial.suEfis.FuelRemaining, g_EfisSerial.suEfis.FuelFlow,     g_EfisSerial.suEfis.MAP,
-                    g_EfisSerial.suEfis.RPM,           g_EfisSerial.suEfis.PercentPower, g_EfisSerial.suEfis.Heading,
-                    EfisAge,                           (unsigned long)g_EfisSerial.uTimestamp);
-            }
-        } // end EFIS data
+        // PStatic and Palt are read at STATIC_RATE_HZ and held in between.
+        // StaticNew is 1 on the first line after a read.
+        const bool bStaticNew = g_Sensors.uStaticSeq != s_uLoggedStaticSeq;
+        s_uLoggedStaticSeq = g_Sensors.uStaticSeq;
+
+        bOk &= Appendf(suNew.szTail, sizeof(suNew.szTail), suNew.iTailLen, ",%.2f,%.2f,%.2f,%.2f,%i",
+            g_AHRS.EarthVertG, g_AHRS.FlightPath, mps2fpm(g_AHRS.KalmanVSI), m2ft(g_AHRS.KalmanAlt), bStaticNew ? 1 : 0);
+
+        suNew.bOk = bOk;
+
+        // Wait until the delay line is full, then write out the oldest sample
+        s_iPendingNext = (s_iPendingNext + 1) % s_iPendingSlots;
+        if (s_iPendingCount < s_iPendingSlots)
+            s_iPendingCount++;
+        if (s_iPendingCount < s_iPendingSlots)
+            return;
 
-        bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, ",%.2f,%.2f,%.2f,%.2f",
-            g_AHRS.EarthVertG, g_AHRS.FlightPath, mps2fpm(g_AHRS.KalmanVSI), m2ft(g_AHRS.KalmanAlt));
+        const SuPendingLine & suLine = s_asuPending[s_iPendingNext];
 
-        bOk &= Appendf(szLogLine, sizeof(szLogLine), iLineLen, "\n");
+        iLineLen = 0;
+        bOk = FinishPendingLine(suLine, szLogLine, sizeof(szLogLine), iLineLen);
 
         if (!bOk)
         {
@@ -14,6 +14,8 @@ Do a text search for comments starting with "////"
 #include "soc/soc.h"
 #include "soc/rtc_cntl_reg.h"
 
+#include <memory>
+
 #include <HardwareSerial.h>
 //#include <SoftwareSerial.h>
 
@@ -59,23 +61,117 @@ void DataServerTask(void * pvParams)
     }
 }
 
+static TaskHandle_t xTaskNetworkInit = NULL;
+
+// One shot task that brings up the WiFi access point and the web and data
+// servers on core 0 while setup() carries on with the sensors and audio.
+// Nothing in flight depends on WiFi so it shouldn't hold up the first tone.
+void NetworkInitTask(void * pvParams)
+{
+    int     iBootPhase = g_BootTimeline.begin("WiFi AP and servers", micros());
+
+    // Configuration web server
+    CfgWebServerInit();
+
+    // Live data server
+    DataServerInit();
+
+    g_BootTimeline.end(iBootPhase, micros());
+
+    // Handlers read the sensor objects, so don't serve requests until
+    // setup() has created them
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Create a task for the websocket server on Core 0
+    xTaskCreatePinnedToCore(
+        DataServerTask,     // Function to call
+        "DataServer",       // Name of task
+        8000,               // Stack size
+        NULL,               // Parameter
+        2,                  // Priority
+        NULL,               // Task handle
+        0                   // Core ID (0)
+    );
+
+    // Create a task for the Web Server on Core 0 to prevent blocking other tasks
+    xTaskCreatePinnedToCore(
+        WebServerTask,      // Function to call
+        "WebServer",        // Name of task
+        10000,              // Stack size
+        NULL,               // Parameter
+        1,                  // Priority
+        NULL,               // Task handle
+        0                   // Core ID (0)
+    );
+
+    vTaskDelete(NULL);
+}
+
 // ----------------------------------------------------------------------------
 
-void setup()
+void PrintBootTimeline()
 {
+    std::unique_ptr<char[]>     pText(new char[BootTimeline::kFormatMax]);
 
-    delay(1000);
+    g_BootTimeline.format(pText.get(), BootTimeline::kFormatMax, micros());
+    g_Log.println("Boot timeline:");
+    g_Log.print(pText.get());
+}
+
+// ----------------------------------------------------------------------------
+
+// Startup order matters after an in-flight brownout, when the time to the
+// first tone is what counts. Fixed sleeps are replaced by polling the
+// hardware, and phases that don't depend on each other overlap: the IMU
+// settles while the SD card mounts and the config loads, and WiFi comes up
+// on core 0 while the sensors and audio start on core 1. Each phase is
+// recorded in g_BootTimeline, printed at the end of setup() and served at
+// /boottime.
+
+void setup()
+{
+    int     iBootPhase;
 
     //Serial.begin(115200);
     Serial.begin(921600);
     Serial.print("\nOnSpeed Gen3 ");
     Serial.println(VERSION);
 
+    g_BootTimeline.mark("Setup start", micros());
+
     // Setup FreeRTOS semaphores and error logging
     xWriteMutex     = xSemaphoreCreateMutex();
     xSensorMutex    = xSemaphoreCreateMutex();
     xSerialLogMutex = xSemaphoreCreateMutex();
 
+    // Get all the chip select pins in the proper state before starting
+    // ----------------------------------------------------------------
+    pinMode(CS_IMU,    OUTPUT); digitalWrite(CS_IMU,    HIGH);
+    pinMode(CS_STATIC, OUTPUT); digitalWrite(CS_STATIC, HIGH);
+    pinMode(CS_AOA,    OUTPUT); digitalWrite(CS_AOA,    HIGH);
+    pinMode(CS_PITOT,  OUTPUT); digitalWrite(CS_PITOT,  HIGH);
+#ifdef HW_V4P
+    pinMode(CS_ADC,    OUTPUT); digitalWrite(CS_ADC,    HIGH);
+#endif
+    pinMode(SD_CS,     OUTPUT); digitalWrite(SD_CS,     HIGH);
+
+    // Init sensor SPI interface
+    //  ------------------------
+//  pinMode(SENSOR_SCLK, OUTPUT); digitalWrite(CS_AOA, LOW);
+//  pinMode(SENSOR_MOSI, OUTPUT); digitalWrite(CS_AOA, LOW);
+//  pinMode(SENSOR_MISO, INPUT);
+    g_pSensorSPI = new SpiIO(FSPI, SENSOR_SCLK, SENSOR_MISO, SENSOR_MOSI, CS_IMU);
+//  g_pSensorSPI = new SpiIO(HSPI, SENSOR_SCLK, SENSOR_MISO, SENSOR_MOSI, CS_IMU);
+
+    // Initialize IMU class
+    // --------------------
+    // Started first so it settles while the SD card and config load. The
+    // SD card is on its own SPI bus.
+    iBootPhase = g_BootTimeline.begin("IMU init", micros());
+    g_pIMU = new IMU330(g_pSensorSPI, CS_IMU);
+    g_pIMU->Init();
+    g_BootTimeline.end(iBootPhase, micros());
+
     // Initialize SD card
     // ------------------
     /*  Need to look into something called dedicated SPI.
@@ -98,12 +194,15 @@ void setup()
     while powered up then good things would happen.
     */
 
+    iBootPhase = g_BootTimeline.begin("SD mount", micros());
     g_SdFileSys.Init();
+    g_BootTimeline.end(iBootPhase, micros());
 
     if (g_SdFileSys.bSdAvailable == false)
         g_Log.println(MsgLog::EnMain, MsgLog::EnError, "Mount SD card failed");
 
 #ifdef SUPPORT_LITTLEFS
+    iBootPhase = g_BootTimeline.begin("LittleFS mount", micros());
     // Try mounting the LittleFS file system in flash
 #if 0
     g_bFlashFS = false;
@@ -136,15 +235,23 @@ void setup()
     if (LittleFS.begin(true))
         g_bFlashFS = true;
 #endif
+    g_BootTimeline.end(iBootPhase, micros());
 #endif // SUPPORT_LITTLEFS
 
     // Load configuration
     // ------------------
+    iBootPhase = g_BootTimeline.begin("Config load", micros());
     g_Config.LoadConfig();
+    g_BootTimeline.end(iBootPhase, micros());
+
+    // WiFi and the web servers come up on core 0 from here on
+    xTaskCreatePinnedToCore(NetworkInitTask,  "Network Init",   8000,  NULL, 1, &xTaskNetworkInit,   0);
 
     // Init the various serial interfaces
     // ----------------------------------
 
+    iBootPhase = g_BootTimeline.begin("Serial init", micros());
+
     // Console is over the USB port
     g_ConsoleSerial.Init();
 
@@ -172,31 +279,7 @@ void setup()
     // Init display output serial
     g_DisplaySerial.Init(&Serial1);
 
-
-    // Get all the chip select pins in the proper state before starting
-    // ----------------------------------------------------------------
-    pinMode(CS_IMU,    OUTPUT); digitalWrite(CS_IMU,    HIGH);
-    pinMode(CS_STATIC, OUTPUT); digitalWrite(CS_STATIC, HIGH);
-    pinMode(CS_AOA,    OUTPUT); digitalWrite(CS_AOA,    HIGH);
-    pinMode(CS_PITOT,  OUTPUT); digitalWrite(CS_PITOT,  HIGH);
-#ifdef HW_V4P
-    pinMode(CS_ADC,    OUTPUT); digitalWrite(CS_ADC,    HIGH);
-#endif
-    pinMode(SD_CS,     OUTPUT); digitalWrite(SD_CS,     HIGH);
-
-    // Init sensor SPI interface
-    //  ------------------------
-//  pinMode(SENSOR_SCLK, OUTPUT); digitalWrite(CS_AOA, LOW);
-//  pinMode(SENSOR_MOSI, OUTPUT); digitalWrite(CS_AOA, LOW);
-//  pinMode(SENSOR_MISO, INPUT);
-    g_pSensorSPI = new SpiIO(FSPI, SENSOR_SCLK, SENSOR_MISO, SENSOR_MOSI, CS_IMU);
-//  g_pSensorSPI = new SpiIO(HSPI, SENSOR_SCLK, SENSOR_MISO, SENSOR_MOSI, CS_IMU);
-
-    // Initialize IMU class
-    // --------------------
-    g_pIMU = new IMU330(g_pSensorSPI, CS_IMU);
-    delay(100);
-    g_pIMU->Init();
+    g_BootTimeline.end(iBootPhase, micros());
 
     // Configure accelerometer axes
     g_pIMU->ConfigAxes();
@@ -213,25 +296,33 @@ void setup()
     }
 #endif
 
-    // Initialize pitch and roll
-    g_pIMU->Read();
-
-    g_AHRS.Init(IMU_SAMPLE_RATE);
-
     // Init pressure sensor classes
     // ----------------------------
+    iBootPhase = g_BootTimeline.begin("Sensor init", micros());
     g_pPitot  = new HscPressureSensor(g_pSensorSPI, CS_PITOT,  HSCDRNN1_6BASA3);
     g_pAOA    = new HscPressureSensor(g_pSensorSPI, CS_AOA,    HSCDRNN1_6BASA3);
     g_pStatic = new HscPressureSensor(g_pSensorSPI, CS_STATIC, HSCDRRN100MDSA3);
 
     // Init Sensors
     g_Sensors.Init();
+    g_BootTimeline.end(iBootPhase, micros());
 
     // Init audio system
+    iBootPhase = g_BootTimeline.begin("Audio init", micros());
     g_AudioPlay.Init();
 
     // Play the startup prompt.
     g_AudioPlay.SetVoice(enVoiceEnabled);
+    g_BootTimeline.end(iBootPhase, micros());
+
+    // Initialize pitch and roll. By now the IMU has usually settled and
+    // this doesn't wait at all.
+    iBootPhase = g_BootTimeline.begin("IMU settle wait", micros());
+    g_pIMU->WaitReady(500);
+    g_pIMU->Read();
+
+    g_AHRS.Init(g_Sensors.Smoothing);
+    g_BootTimeline.end(iBootPhase, micros());
 
     // Setup FreeRTOS tasks
     // --------------------
@@ -254,11 +345,14 @@ void setup()
                 xSemaphoreGive(xWriteMutex);
                 }
 
+#ifdef PRESSURE_OVERSAMPLE_HZ
+        xTaskCreatePinnedToCore(PressureSampleTask,   "Sample Pressure", 3000, NULL, 7, &xTaskPressureSample, 1);
+#endif
         xTaskCreatePinnedToCore(SensorReadTask,       "Read Sensors",   5000, NULL, 5, &xTaskReadSensors, 1);
         if (bLoggingRingBufferOk)
             xTaskCreatePinnedToCore(LogSensorCommitTask,  "Write Data",     5000, NULL, 0, &xTaskWriteLog,     1);
 #ifdef LOGDATA_PRESSURE_RATE  // sd card write rate
-        g_Log.println("Logging at 50Hz");
+        g_Log.printf("Logging at %dHz\n", g_Sensors.Smoothing.iHz);
 #else
         Serial.printf("Logging at %iHz\n",int(g_AHRS.fImuSampleRate));
 #endif
@@ -295,40 +389,20 @@ void setup()
     xTaskCreatePinnedToCore(Check3DAudioTask,     "Check 3D Audio", 2000,  NULL, 0, &xTask3dAudio,       1); // Stack size 2000
     xTaskCreatePinnedToCore(HeartbeatLedTask,     "Heartbeat",      4000,  NULL, 0, &xTaskHeartbeat,     1); // Increased stack size
 
+    // EFIS and boom input, woken by UART RX events rather than polled from loop()
+    xTaskCreatePinnedToCore(SerialIngestTask,     "Serial Ingest",  5000,  NULL, 3, &xTaskSerialIngest,  0);
+
     //xTaskCreatePinnedToCore(TaskDummy,     "Dummy",     10000, NULL,              5, &xTaskDummy,     0);
 
-    delay(100);
+    g_BootTimeline.mark("Tasks started", micros());
 
-    // Configuration web server
-    CfgWebServerInit();
-
-    // Live data server
-    DataServerInit();
-
-    // Create a task for the websocket server on Core 0
-    xTaskCreatePinnedToCore(
-        DataServerTask,     // Function to call
-        "DataServer",       // Name of task
-        8000,               // Stack size
-        NULL,               // Parameter
-        2,                  // Priority
-        NULL,               // Task handle
-        0                   // Core ID (0)
-    );
-
-    // Create a task for the Web Server on Core 0 to prevent blocking other tasks
-    xTaskCreatePinnedToCore(
-        WebServerTask,      // Function to call
-        "WebServer",        // Name of task
-        10000,              // Stack size
-        NULL,               // Parameter
-        1,                  // Priority
-        NULL,               // Task handle
-        0                   // Core ID (0)
-    );
+    // Let the web and data servers start answering
+    xTaskNotifyGive(xTaskNetworkInit);
 
     g_ConsoleSerial.DisplayConsoleHelp();
 
+    PrintBootTimeline();
+
     g_Log.println("System ready.");
     g_Log.print("# ");
     }
@@ -344,17 +418,13 @@ void loop()
     {
 //    uLoopStartTime = uMilliSeconds;
 
-    // FreeRTOS doesn't really have very good support for serial port I/O. The
-    // problem is that there is no way to block reading from a serial port in
-    // an RTOS friendly way. If you use available() then the task just constantly
-    // spins, doing nothing. If you do a read() it spins internal to the read
-    // function, again doing nothing. So do serial I/O the old fashioned way.
-    // That is, in line with everything else that needs a chance to run.
+    // The console is still polled from here. EFIS and boom input are read by
+    // SerialIngestTask, which blocks until the UART driver signals an RX event
+    // (FIFO threshold or line idle) and so gets an accurate receive time
+    // instead of one quantized to this loop's 10 msec delay.
 
 //    readWifiSerial();
     g_ConsoleSerial.Read();
-    g_EfisSerial.Read();
-    g_BoomSerial.Read();
 
 #if 0
 
@@ -52,12 +52,17 @@ void SpiIO::WriteWord(unsigned uChipSel, uint16_t iData)
 }
 #endif
 
+// Multi byte reads go through transferBytes(), which fills the SPI FIFO in
+// one go, rather than one transfer() call per byte. The zeros clocked out are
+// read back in place.
+
 void SpiIO::ReadBytes( unsigned uChipSel, uint8_t * paiData, int iBytes)
 {
+    memset(paiData, 0, iBytes);
+
     pSPI->beginTransaction(SPISettings(SPI_CLK, MSBFIRST, SPI_MODE));
     digitalWrite(uChipSel, LOW);
-    for (int iIdx = 0; iIdx < iBytes; iIdx++)
-      paiData[iIdx] = pSPI->transfer(0x00);
+    pSPI->transferBytes(paiData, paiData, iBytes);
     digitalWrite(uChipSel, HIGH);
     pSPI->endTransaction();
 }
@@ -95,11 +100,12 @@ void SpiIO::WriteRegByte(unsigned uChipSel, uint8_t iAddr, byte iData)
 
 void SpiIO::ReadRegBytes(unsigned uChipSel, uint8_t iAddr, uint8_t * paiData, int iBytes)
     {
+    memset(paiData, 0, iBytes);
+
     pSPI->beginTransaction(SPISettings(SPI_CLK, MSBFIRST, SPI_MODE));
     digitalWrite(uChipSel, LOW);
     pSPI->transfer(iAddr);
-    for (int iIdx = 0; iIdx < iBytes; iIdx++)
-        paiData[iIdx] = pSPI->transfer(0x00);
+    pSPI->transferBytes(paiData, paiData, iBytes);
     digitalWrite(uChipSel, HIGH);
     pSPI->endTransaction();
     }
@@ -117,3 +123,22 @@ void SpiIO::WriteRegBytes(unsigned uChipSel, uint8_t iAddr, uint8_t * paiData, i
     pSPI->endTransaction();
     }
 
+// ----------------------------------------------------------------------------
+
+// Run a planned list of reads under one transaction. Each segment gets its
+// own chip select and one transferBytes() call.
+
+void SpiIO::transfer(const SensorBusSegment * pSegments, size_t uCount,
+                     const uint8_t * pTx, uint8_t * pRx)
+    {
+    pSPI->beginTransaction(SPISettings(SPI_CLK, MSBFIRST, SPI_MODE));
+    for (size_t iSeg = 0; iSeg < uCount; iSeg++)
+        {
+        const SensorBusSegment & suSeg = pSegments[iSeg];
+
+        digitalWrite(suSeg.uChipSel, LOW);
+        pSPI->transferBytes(pTx + suSeg.uOffset, pRx + suSeg.uOffset, suSeg.uLen);
+        digitalWrite(suSeg.uChipSel, HIGH);
+        }
+    pSPI->endTransaction();
+    }
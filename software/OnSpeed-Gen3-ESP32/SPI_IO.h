@@ -2,10 +2,15 @@
 #include <Arduino.h>
 #include <SPI.h>
 
+#include <SensorBus.h>
+
 #ifndef SPI_IO_H
 #define SPI_IO_H
 
-class SpiIO
+// Sensor SPI port. Also runs the batched per-cycle read plan (SensorBusPlan)
+// as one transaction.
+
+class SpiIO : public SensorBus
 {
 public:
     SpiIO(int SPINum, int ClkPin, int MisoPin, int MosiPin, unsigned DummyCS);
@@ -27,6 +32,10 @@ public:
     void      ReadRegBytes( unsigned uChipSel, uint8_t bAddr, uint8_t * paiData, int iBytes);
     void      WriteRegBytes(unsigned uChipSel, uint8_t bAddr, uint8_t * paiData, int iBytes);
 
+    // SensorBus
+    void      transfer(const SensorBusSegment * pSegments, size_t uCount,
+                       const uint8_t * pTx, uint8_t * pRx) override;
+
 };
 
 #endif
\ No newline at end of file
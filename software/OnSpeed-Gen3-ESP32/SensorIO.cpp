@@ -1,24 +1,48 @@
 
 
 #include <OneWire.h>
-#include <DallasTemperature.h>
-
-#include "RunningAverage.h"
-#include "RunningMedian.h"
 
 #include "Globals.h"
 #include "Config.h"
 #include "Flaps.h"
 #include "SensorIO.h"
 
+#include <Atmosphere.h>
+#include <FilterAnalysis.h>
+
 // These from config
 //int     aoaSmoothing      = 20; // AOA smoothing window (number of samples to lag)
 //int     pressureSmoothing = 15; // median filter window for pressure smoothing/despiking
 
-// Timers to reduce read frequency for less critical sensors
-static uint32_t uLastFlapsReadMs = 0;
+// ----------------------------------------------------------------------------
+
+// Rate group tasks. The sensor task runs these from SensorIO::Schedule at
+// whole fractions of the loop rate, staggered so they don't pile up on one
+// cycle. Costs are rough usec, only used to spread them out.
+
+static void ReadStaticTask(void *)  { g_Sensors.ReadPressureAltMbars(); }
+static void ImuTempTask(void *)     { g_pIMU->UpdateTemp(); }
+
+static void FlapsTask(void *)
+{
+    if (g_Config.suDataSrc.enSrc != SuDataSource::EnTestPot)
+        g_Flaps.Update();
+    else
+        g_Flaps.Update(0);
+}
+
 #ifdef OAT_AVAILABLE
-static uint32_t uLastOatReadMs = 0;
+// Steps the OAT state machine, which converts about once per second and
+// never waits on the sensor. Each step is at most a few bytes of bus time.
+static void OatTask(void *)
+{
+    g_Sensors.OatSensor.update(millis());
+    if (g_Sensors.OatSensor.valid())
+    {
+        g_Sensors.OatC      = g_Sensors.OatSensor.tempC();
+        g_Sensors.bOatValid = true;
+    }
+}
 #endif
 
 
@@ -36,13 +60,15 @@ void SensorReadTask(void *pvParams)
 //    static unsigned uLoops = 0;
 //    static bool     bSendOK;
 
-    xLastWakeTime = xLAST_TICK_TIME(20);
+    const int       iPeriodMs = g_Sensors.LoopPeriodMs();
+
+    xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
 
     while (true)
     {
         // No delay happening is a design flaw so flag it if it happens, or
         // rather doesn't happen.
-        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(20));
+        xWasDelayed = xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(iPeriodMs));
 
         // If this task wasn't delayed before it ran again it means it
         // it ran long for some reason (like the CPU is overloaded) or
@@ -52,7 +78,7 @@ void SensorReadTask(void *pvParams)
         // the data.
         if (xWasDelayed == pdFALSE)
         {
-            xLastWakeTime = xLAST_TICK_TIME(20);
+            xLastWakeTime = xLAST_TICK_TIME(iPeriodMs);
             unsigned long uNow = millis();
             if ((uNow - uLastLateLogMs) > 1000)
             {
@@ -80,37 +106,163 @@ void SensorReadTask(void *pvParams)
 } // end SensorReadTask
 
 
+// ----------------------------------------------------------------------------
+
+#ifdef PRESSURE_OVERSAMPLE_HZ
+
+#if (1000 % PRESSURE_OVERSAMPLE_HZ) != 0
+#error PRESSURE_OVERSAMPLE_HZ must be a whole number of ticks
+#endif
+
+// FreeRTOS task for oversampling the pitot and AOA sensors at
+// PRESSURE_OVERSAMPLE_HZ. Each pass is one short SPI transaction; the
+// decimators hand SensorIO::Read() a new value each sensor loop period.
+
+void PressureSampleTask(void *pvParams)
+{
+    TickType_t      xLastWakeTime = xTaskGetTickCount();
+
+    while (true)
+    {
+        xTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000 / PRESSURE_OVERSAMPLE_HZ));
+        g_Sensors.SamplePressures();
+    }
+
+} // end PressureSampleTask
+
+#endif
+
+
 
 // ============================================================================
 
 SensorIO::SensorIO()
-    : PfwdMedian(g_Config.iPressureSmoothing),
-      PfwdAvg(10),
-      P45Median(g_Config.iPressureSmoothing),
-      P45Avg(10),
-      IasDerivative(&fIasDerInput, 1, 15),
-      OneWireBus(OAT_PIN),
-      OatSensor(&OneWireBus)
+    : OneWireBus(OAT_PIN),
+      OatBus(&OneWireBus),
+      OatSensor(&OatBus)
 {
+    Smoothing  = SmoothingParams::forRate(SmoothingTimes::fromConfig(20, 15), kReferenceLoopHz);
     Palt       = 0.00;
+    uStaticSeq = 0;
     fDecelRate = 0.0;
+    uSampleUs  = 0;
+    OatC       = 0.0;
+    bOatValid  = false;
+    uBusUs     = 0;
+    uBusMaxUs  = 0;
+    FusedAOA   = 0.0;
+    iBusPitot  = iBusAoa = iBusImu = SensorBusPlan::kNone;
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    iFastPitot     = iFastAoa = SensorBusPlan::kNone;
+    xDecimMux      = portMUX_INITIALIZER_UNLOCKED;
+    fPfwdDecimated = 0.0;
+    fP45Decimated  = 0.0;
+    bDecimReady    = false;
+#endif
 }
 
 // ----------------------------------------------------------------------------
 
 void SensorIO::Init()
 {
+    // Everything downstream is sized from the loop rate. The smoothing config
+    // items are in 50 Hz samples and become time spans and time constants
+    // here, so the response is the same at any rate.
+    Smoothing = SmoothingParams::forRate(
+        SmoothingTimes::fromConfig(g_Config.iAoaSmoothing, g_Config.iPressureSmoothing), g_Config.iLoopRateHz);
+    PfwdSmoother.configure(Smoothing);
+    P45Smoother.configure(Smoothing);
+    IasDerivative.configure(Smoothing.iDecelWindow, Smoothing.iHz);
+    g_Log.printf(MsgLog::EnSensors, MsgLog::EnDebug, "Loop %d Hz, pressure median %d avg %d, AOA alpha %.4f\n",
+        Smoothing.iHz, Smoothing.iPressureMedian, Smoothing.iPressureAverage, Smoothing.fAoaAlpha);
+
 #ifdef OAT_AVAILABLE
+    // Start the first conversion. The result turns up in Read() about 750 msec later.
     pinMode(OAT_PIN,INPUT_PULLUP);
-    OatSensor.begin();  // initialize the DS18B20 sensor
-    ReadOatC();
+    OatSensor.update(millis());
 #endif
 
-    // Get initial pressure altitude
+    // Get initial pressure altitude and flaps position, then hand both to the
+    // rate groups. Static pressure and altitude only need 10 Hz, which saves
+    // a sensor read and a pow() most cycles.
     ReadPressureAltMbars();
+    FlapsTask(nullptr);
 
-    // Configure AOA calculator smoothing
-    AoaCalc.setSamples(g_Config.iAoaSmoothing);
+    Schedule.configure(Smoothing.iHz);
+    Schedule.add("static",  STATIC_RATE_HZ, ReadStaticTask, nullptr, 60);
+    Schedule.add("imutemp", 10, ImuTempTask,    nullptr, 20);
+#ifdef OAT_AVAILABLE
+    Schedule.add("oat",     10, OatTask,        nullptr, 250);
+#endif
+    Schedule.add("flaps",   1,  FlapsTask,      nullptr, 30);
+    Schedule.plan();
+    for (int i = 0; i < Schedule.taskCount(); i++)
+        g_Log.printf(MsgLog::EnSensors, MsgLog::EnDebug, "Rate group %-8s %5.1f Hz phase %u of %u\n",
+            Schedule.name(i), Schedule.rateHz(i), unsigned(Schedule.phase(i)), unsigned(Schedule.divisor(i)));
+
+    // Plan the per-cycle sensor reads as one SPI transaction. If it somehow
+    // doesn't fit, or isn't compiled, Read() falls back to reading each
+    // sensor on its own.
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    // Pitot and AOA have their own faster plan
+    iFastPitot = g_pPitot->AddToBusPlan(FastBusPlan);
+    iFastAoa   = g_pAOA->AddToBusPlan(FastBusPlan);
+#ifndef SENSOR_BUS_UNBATCHED
+    FastBusPlan.compile();
+#endif
+    if (!PfwdDecim.configure(PRESSURE_OVERSAMPLE_HZ, Smoothing.iHz) || !P45Decim.configure(PRESSURE_OVERSAMPLE_HZ, Smoothing.iHz))
+        g_Log.println(MsgLog::EnSensors, MsgLog::EnError, "Pressure decimator rejected PRESSURE_OVERSAMPLE_HZ");
+    else
+        g_Log.printf(MsgLog::EnSensors, MsgLog::EnDebug, "Pressure oversampling %d Hz, %.1f ms delay\n",
+            PRESSURE_OVERSAMPLE_HZ, PfwdDecim.groupDelayMs());
+#else
+    iBusPitot  = g_pPitot->AddToBusPlan(BusPlan);
+    iBusAoa    = g_pAOA->AddToBusPlan(BusPlan);
+#endif
+    iBusImu    = g_pIMU->AddToBusPlan(BusPlan);
+#ifdef SENSOR_BUS_UNBATCHED
+    g_Log.println(MsgLog::EnSensors, MsgLog::EnDebug, "SENSOR_BUS_UNBATCHED, reading sensors one at a time");
+#else
+    if (!BusPlan.compile())
+        g_Log.println(MsgLog::EnSensors, MsgLog::EnError, "Sensor bus plan does not fit, reading sensors one at a time");
+    else
+        g_Log.printf(MsgLog::EnSensors, MsgLog::EnDebug, "Sensor bus plan %u segments %u bytes\n",
+            unsigned(BusPlan.segmentCount()), unsigned(BusPlan.totalBytes()));
+#endif
+
+    // Configure AOA calculator smoothing. Alpha-beta gets the memory that
+    // gives the same noise as the EMA it replaces, which takes some msec of
+    // simulation, so only when it is selected.
+    float   fTheta = 0.0f;
+    AoaCalc.setAlpha(Smoothing.fAoaAlpha);
+    if (g_Config.iAoaFilter == int(AoaFilterKind::AlphaBeta))
+        {
+        fTheta = matchAlphaBetaTheta(Smoothing);
+        AoaCalc.setTheta(fTheta);
+        AoaCalc.setFilter(AoaFilterKind::AlphaBeta);
+        }
+    else
+        AoaCalc.setFilter(AoaFilterKind::Ema);
+
+    // Log what the AOA smoothing costs in lag
+    {
+    AoaFilterChain  AoaChain;
+    AoaChain.configure(Smoothing, AoaCalc.filter(), fTheta);
+    FilterFigures   suFig = measureFilter(AoaChain, Smoothing.iHz);
+    g_Log.printf(MsgLog::EnSensors, MsgLog::EnDebug, "AOA %s filter theta %.4f: ramp lag %.0f ms, step 90%% %.0f ms, overshoot %.0f%%, noise gain %.3f\n",
+        AoaCalc.filter() == AoaFilterKind::AlphaBeta ? "alpha-beta" : "EMA", fTheta,
+        suFig.fRampLagSec * 1000.0f, suFig.fStep90Sec * 1000.0f, suFig.fOvershoot * 100.0f, suFig.fNoiseGain);
+    }
+
+    // The AOA fusion needs a copy of the AOA smoothing. The pressure
+    // decimator stands in for the median and average, so give the copy a
+    // moving average with the same delay.
+    SmoothingParams FuseSmoothing = Smoothing;
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    FuseSmoothing.iPressureMedian  = 1;
+    FuseSmoothing.iPressureAverage = 2 * lroundf(PfwdDecim.groupDelayMs() * Smoothing.iHz / 1000.0f) + 1;
+#endif
+    AoaFuse.configure(FuseSmoothing, AoaCalc.filter(), fTheta);
 }
 
 // ----------------------------------------------------------------------------
@@ -121,31 +273,37 @@ void SensorIO::Read()
 {
     float           PfwdPascal;
 
-    // Read pressure sensors
-    iPfwd   = g_pPitot->ReadPressureCounts() - g_Config.iPFwdBias;
-    iP45    = g_pAOA->ReadPressureCounts()   - g_Config.iP45Bias;
-    ReadPressureAltMbars();
-
-    // Read IMU
-    g_pIMU->Read();
+    // One consistent config snapshot for the whole cycle
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
 
-    // Update flaps position about once per second
-    if (millis() - uLastFlapsReadMs > 1000)
+    // Read pressure sensors and IMU. External data is logged as of this time.
+    uSampleUs = micros();
+    if (BusPlan.compiled())
     {
-        if (g_Config.suDataSrc.enSrc != SuDataSource::EnTestPot)
-            g_Flaps.Update();
-        else
-            g_Flaps.Update(0);
-        uLastFlapsReadMs = millis();
-    }
-
-    // Update the OAT about once per second
-#ifdef OAT_AVAILABLE
-    if (millis() - uLastOatReadMs > 1000) {
-        ReadOatC();
-        uLastOatReadMs = millis();
+        BusPlan.run(*g_pSensorSPI);
+#ifndef PRESSURE_OVERSAMPLE_HZ
+        iPfwd   = g_pPitot->DecodePressureCounts(BusPlan.data(iBusPitot)) - cfg->iPFwdBias;
+        iP45    = g_pAOA->DecodePressureCounts(BusPlan.data(iBusAoa))     - cfg->iP45Bias;
+#endif
+        g_pIMU->Read(BusPlan.data(iBusImu));
     }
+    else
+    {
+#ifndef PRESSURE_OVERSAMPLE_HZ
+        iPfwd   = g_pPitot->ReadPressureCounts() - cfg->iPFwdBias;
+        iP45    = g_pAOA->ReadPressureCounts()   - cfg->iP45Bias;
 #endif
+        g_pIMU->Read(false);
+    }
+
+    // Timed the same way either way, including any second IMU FIFO burst
+    uBusUs = micros() - uSampleUs;
+    if (uBusUs > uBusMaxUs)
+        uBusMaxUs = uBusUs;
+
+    // Slower sensors and derived values (static pressure and altitude,
+    // flaps, OAT, IMU temperature), whichever are due this cycle
+    Schedule.tick();
 
     // Process AHRS now
     g_AHRS.Process();
@@ -153,21 +311,48 @@ void SensorIO::Read()
     // Get AOA speed set points for the current flap position.
 //  SetAOApoints(g_Flaps.iIndex);
 
-    // Median filter pressure then a simple moving average
-    PfwdMedian.add(iPfwd);
-    PfwdAvg.addValue(PfwdMedian.getMedian());
-    PfwdSmoothed = PfwdAvg.getFastAverage();
+    bool    bDecimated = false;
+
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    // Pitot and AOA come already decimated from PressureSampleTask, which
+    // replaces the median and average smoothing. Until the decimators have
+    // filled, or if they couldn't be set up for this loop rate, read the
+    // sensors directly and smooth them as usual.
+    float   fPfwdDecim, fP45Decim;
 
-    P45Median.add(iP45);
-    P45Avg.addValue(P45Median.getMedian());
-    P45Smoothed = P45Avg.getFastAverage();
+    portENTER_CRITICAL(&xDecimMux);
+    fPfwdDecim = fPfwdDecimated;
+    fP45Decim  = fP45Decimated;
+    bDecimated = bDecimReady;
+    portEXIT_CRITICAL(&xDecimMux);
+
+    if (bDecimated)
+    {
+        PfwdSmoothed = fPfwdDecim - cfg->iPFwdBias;
+        P45Smoothed  = fP45Decim  - cfg->iP45Bias;
+        iPfwd        = lroundf(PfwdSmoothed);
+        iP45         = lroundf(P45Smoothed);
+    }
+    else
+    {
+        iPfwd = g_pPitot->ReadPressureCounts() - cfg->iPFwdBias;
+        iP45  = g_pAOA->ReadPressureCounts()   - cfg->iP45Bias;
+    }
+#endif
+
+    // Median filter pressure then a simple moving average
+    if (!bDecimated)
+    {
+        PfwdSmoothed = PfwdSmoother.add(iPfwd);
+        P45Smoothed  = P45Smoother.add(iP45);
+    }
 
     // Calculate AOA based on Pfwd/P45;
     if ((g_Config.suDataSrc.enSrc != SuDataSource::EnTestPot) &&
         (g_Config.suDataSrc.enSrc != SuDataSource::EnRangeSweep))
     {
-        const SuCalibrationCurve& curve = g_Config.aFlaps[g_Flaps.iIndex].AoaCurve;
-        AOACalculatorResult result = AoaCalc.calculate(PfwdSmoothed, P45Smoothed, curve);
+        const SuFlapSetpoints& flap = cfg->flap(g_Flaps.iIndex);
+        AOACalculatorResult result = AoaCalc.calculate(PfwdSmoothed, P45Smoothed, flap.AoaCurve, &flap.AoaCompiled);
         AOA = result.aoa;
         g_fCoeffP = result.coeffP;
 
@@ -176,16 +361,16 @@ void SensorIO::Read()
 
         // Calculate airspeed from smoothed dynamic pressure
         // The smoothed value is without bias, so we add it back for the PSI conversion.
-        float PfwdPSI = g_pPitot->ReadPressurePSI(PfwdSmoothed + g_Config.iPFwdBias);
+        float PfwdPSI = g_pPitot->ReadPressurePSI(PfwdSmoothed + cfg->iPFwdBias);
         PfwdPascal = psi2mb(PfwdPSI) * 100; // Convert PSI to Pascals
         if (PfwdPascal > 0)
         {
-            IAS = sqrt(2*PfwdPascal/1.225)* 1.94384; // knots // physics based calculation
+            IAS = iasFromDynamicPressureKts(PfwdPascal); // knots // physics based calculation
 #ifdef SPHERICAL_PROBE
             IAS = IASCURVE(IAS); // for now use a hardcoded IAS curve for a spherical probe. CAS curve parameters can only take 4 decimals. Not accurate enough.
 #else
-            if (g_Config.bCasCurveEnabled)
-                IAS = CurveCalc(g_Sensors.IAS,g_Config.CasCurve);  // use CAS correction curve if enabled
+            if (cfg->bCasCurveEnabled)
+                IAS = cfg->CasEval(g_Sensors.IAS);  // use CAS correction curve if enabled
 #endif
         }
 
@@ -194,16 +379,32 @@ void SensorIO::Read()
             IAS = 0;
     } // end if not in test pot or range sweep mode
 
-    // Take derivative of airspeed for decelaration calc
+    // Make up the AOA smoothing lag from the pitch rate and accelerations.
+    // Test pot and range sweep set AOA directly, so pass it through.
+    if ((g_Config.suDataSrc.enSrc != SuDataSource::EnTestPot) &&
+        (g_Config.suDataSrc.enSrc != SuDataSource::EnRangeSweep))
+    {
+        AoaInertialInput suImu;
+        suImu.fPitchRateDps = g_AHRS.CyclePitchRate;
+        suImu.fFwdG         = g_AHRS.AccelFwdCorr;
+        suImu.fVertG        = g_AHRS.AccelVertCorr;
+        suImu.fPitchDeg     = g_AHRS.SmoothedPitch;
+        suImu.fRollDeg      = g_AHRS.SmoothedRoll;
+        suImu.fTasMps       = g_AHRS.fTAS;
+        FusedAOA = AoaFuse.update(AOA, suImu);
+    }
+    else
+    {
+        AoaFuse.reset();
+        FusedAOA = AOA;
+    }
+
+    // Take derivative of airspeed for decelaration calc, already in kts/sec
 #ifdef SPHERICAL_PROBE
-    fIasDerInput = g_EfisSerial.suEfis.IAS;
+    fDecelRate = -IasDerivative.add(g_EfisSerial.suEfis.IAS);
 #else
-    fIasDerInput = IAS;
+    fDecelRate = -IasDerivative.add(IAS);
 #endif
-    //// This logic seems suspect but this is the way it is done in the original code
-    // SavLayFilter returns derivative per sample; convert to kts/sec for the 20ms sensor task period.
-    const float fSensorSampleHz = 50.0f;
-    fDecelRate = -IasDerivative.Compute() * fSensorSampleHz;
 
 #ifdef LOGDATA_PRESSURE_RATE
     g_LogSensor.Write();
@@ -220,8 +421,9 @@ void SensorIO::Read()
                 millis(), iPfwd, PfwdSmoothed, iP45, P45Smoothed, PStatic, Palt, IAS, AOA, g_Flaps.iPosition,
                 g_AHRS.AccelVertComp, g_AHRS.AccelLatComp, g_AHRS.AccelFwdComp,
                 g_AHRS.gRoll, g_AHRS.gPitch, g_AHRS.gYaw, g_AHRS.SmoothedPitch);
+            g_Log.printf("Sensor bus %lu us, max %lu us\n", (unsigned long)uBusUs, (unsigned long)uBusMaxUs);
 
-            iDecimate = 50;
+            iDecimate = Smoothing.iHz;
         }
         else
             iDecimate--;
@@ -232,30 +434,61 @@ void SensorIO::Read()
 
 // ----------------------------------------------------------------------------
 
-// Get pressure altitude. Pstatic in milliBars, Palt in feet.
+#ifdef PRESSURE_OVERSAMPLE_HZ
 
-float SensorIO::ReadPressureAltMbars()
+// One oversampled read of the pitot and AOA sensors, called from
+// PressureSampleTask
+
+void SensorIO::SamplePressures()
 {
+    bool bPfwd, bP45;
+    if (FastBusPlan.compiled())
+    {
+        FastBusPlan.run(*g_pSensorSPI);
+        bPfwd = PfwdDecim.push(g_pPitot->DecodePressureCounts(FastBusPlan.data(iFastPitot)));
+        bP45  = P45Decim.push(g_pAOA->DecodePressureCounts(FastBusPlan.data(iFastAoa)));
+    }
+    else
+    {
+        bPfwd = PfwdDecim.push(g_pPitot->ReadPressureCounts());
+        bP45  = P45Decim.push(g_pAOA->ReadPressureCounts());
+    }
 
-    // Calculate pressure altitude. Pstatic in milliBars, Palt in feet.
-    PStatic = g_pStatic->ReadPressureMillibars();
-    Palt    = 145366.45 * (1 - pow((PStatic - g_Config.fPStaticBias) / 1013.25, 0.190284));
+    if (bPfwd && bP45)
+    {
+        portENTER_CRITICAL(&xDecimMux);
+        fPfwdDecimated = PfwdDecim.output();
+        fP45Decimated  = P45Decim.output();
+        bDecimReady    = true;
+        portEXIT_CRITICAL(&xDecimMux);
+    }
+}
 
-    g_Log.printf(MsgLog::EnPressure, MsgLog::EnDebug, "pStatic %8.3f mb Bias %6.3f mb Palt %5.0f\n", PStatic, g_Config.fPStaticBias, Palt);
+#endif
 
-    return Palt;
-}
+// ----------------------------------------------------------------------------
 
+// Get pressure altitude. Pstatic in milliBars, Palt in feet.
+
+float SensorIO::ReadPressureAltMbars()
+{
+    return UpdatePressureAlt(g_pStatic->ReadPressureMillibars());
+}
 
 // ----------------------------------------------------------------------------
 
-// Return the OAT in degrees C
-// OAT is so simple I just stuck it in this class for convenience.
+// Calculate pressure altitude from a static pressure already read
 
-float SensorIO::ReadOatC()
+float SensorIO::UpdatePressureAlt(float fPStaticMbars)
 {
-    OatSensor.requestTemperatures();      // Send the command to get temperatures
-    OatC = OatSensor.getTempCByIndex(0);  // Read temperature in �C
+    // Calculate pressure altitude. Pstatic in milliBars, Palt in feet.
+    RuntimeConfigSnapshot::ReadGuard cfg(g_Config.Runtime);
 
-    return OatC;
+    PStatic = fPStaticMbars;
+    Palt    = pressureAltitudeFt(PStatic - cfg->fPStaticBias);
+    uStaticSeq++;
+
+    g_Log.printf(MsgLog::EnPressure, MsgLog::EnDebug, "pStatic %8.3f mb Bias %6.3f mb Palt %5.0f\n", PStatic, cfg->fPStaticBias, Palt);
+
+    return Palt;
 }
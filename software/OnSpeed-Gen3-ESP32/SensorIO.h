@@ -3,21 +3,48 @@
 
 // For OAT OneWire
 #include <OneWire.h>            //https://github.com/PaulStoffregen/OneWire
-#include <DallasTemperature.h>  //https://github.com/milesburton/Arduino-Temperature-Control-Library
 
 #include "Globals.h"
 
-#include "RunningAverage.h"
-#include "RunningMedian.h"
-#include <SavLayFilter.h>
 #include <AOACalculator.h>
+#include <AoaFusion.h>
+#include <RateFilters.h>
+#include <SensorBus.h>
+#include <Decimator.h>
+#include <Ds18b20.h>
+#include <RateScheduler.h>
 
 
 // FreeRTOS task for reading sensors
 void SensorReadTask(void *pvParams);
 
+#ifdef PRESSURE_OVERSAMPLE_HZ
+// FreeRTOS task for oversampling the pitot and AOA sensors
+void PressureSampleTask(void *pvParams);
+#endif
+
 // ============================================================================
 
+// OneWire library behind the onspeed_core 1-Wire port, for the OAT sensor
+
+class OneWireIO : public OneWirePort
+{
+public:
+    OneWireIO(OneWire * pBus) : pBus(pBus) {}
+
+    bool      reset() override              { return pBus->reset() == 1; }
+    void      write(uint8_t uByte) override { pBus->write(uByte); }
+    uint8_t   read() override               { return pBus->read(); }
+
+private:
+    OneWire * pBus;
+};
+
+// ============================================================================
+
+// Static pressure and pressure altitude are read in a rate group at this rate
+#define STATIC_RATE_HZ          10
+
 class SensorIO
 {
 public:
@@ -27,38 +54,68 @@ public:
 public:
 
     // Data
+    SmoothingParams     Smoothing;      // Loop rate and filter sizes, fixed at Init()
+
     int                 iPfwd;          // Pressure in counts
     float               PfwdSmoothed;
-    RunningMedian       PfwdMedian;
-    RunningAverage      PfwdAvg;
+    PressureSmoother    PfwdSmoother;   // Median then moving average
 
     int                 iP45;           // Pressure in counts
     float               P45Smoothed;
-    RunningMedian       P45Median;
-    RunningAverage      P45Avg;
+    PressureSmoother    P45Smoother;
 
-    SavLayFilter        IasDerivative;  // Computes the first derivative
+    SlopeFilter         IasDerivative;  // Least squares slope of IAS in kts/sec
     float               fDecelRate;     // Deceleration rate derived from IAS
 
     AOACalculator       AoaCalc;        // AOA calculation with smoothing
+    AoaFusion           AoaFuse;        // AOA with the smoothing lag made up from the IMU
 
     OneWire             OneWireBus;
-    DallasTemperature   OatSensor;
+    OneWireIO           OatBus;
+    Ds18b20Reader       OatSensor;      // Non-blocking, stepped from the 10 Hz rate group
 
     float               PStatic;        // Static pressure in millibars
     float               Palt;           // Pressure altitude in feet, corrected for bias
-    float               OatC;           // OAT in degrees C
+    uint32_t            uStaticSeq;     // Counts PStatic / Palt updates, to tell a new value from a held one
+    float               OatC;           // Last good OAT in degrees C
+    bool                bOatValid;      // OatC has been read at least once
     float               IAS;
     float               AOA;            // Averaged AOA
-
-    double              fIasDerInput;   // Source for IAS for deceleration calc
+    float               FusedAOA;       // Inertially aided AOA, AOA when the fusion is inactive
+
+    uint32_t            uSampleUs;      // micros() when the pressure sensors were read
+
+    RateScheduler       Schedule;       // Slower sensors in 10 and 1 Hz rate groups, run from Read()
+
+    SensorBusPlan       BusPlan;        // Pitot, AOA and IMU as one SPI transaction
+    int                 iBusPitot;      // BusPlan handles for each sensor's bytes
+    int                 iBusAoa;
+    int                 iBusImu;
+    uint32_t            uBusUs;         // Time for the last per-cycle pitot, AOA and IMU reads
+    uint32_t            uBusMaxUs;      // Longest per-cycle sensor reads
+
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    SensorBusPlan       FastBusPlan;    // Pitot and AOA, read at PRESSURE_OVERSAMPLE_HZ
+    int                 iFastPitot;
+    int                 iFastAoa;
+    PressureDecimator   PfwdDecim;
+    PressureDecimator   P45Decim;
+    portMUX_TYPE        xDecimMux;      // Guards the decimated outputs below
+    float               fPfwdDecimated; // Latest decimated pressures in counts, with bias
+    float               fP45Decimated;
+    bool                bDecimReady;
+#endif
 
     // Methods
 public:
     void    Init();
+    int     LoopPeriodMs()      { return 1000 / Smoothing.iHz; }
     void    Read();
-    float   ReadOatC();
+#ifdef PRESSURE_OVERSAMPLE_HZ
+    void    SamplePressures();
+#endif
     float   ReadPressureAltMbars();
+    float   UpdatePressureAlt(float fPStaticMbars);
 //  float   GetPressureAltMbars();
 
 };
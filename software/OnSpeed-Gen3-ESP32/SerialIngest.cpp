@@ -0,0 +1,99 @@
+
+#include "Globals.h"
+#include "Helpers.h"
+#include "SerialIngest.h"
+
+// RX event thresholds. 120 is the driver default and leaves room in the
+// 128 byte hardware FIFO. Two idle characters ends a frame quickly without
+// splitting on inter-byte gaps.
+#define RX_FIFO_FULL            120
+#define RX_TIMEOUT_SYMBOLS      2
+
+// Wake up anyway if no event shows up, so a missed notification can't stall
+// the framers.
+#define INGEST_IDLE_WAIT_MS     50
+
+// ----------------------------------------------------------------------------
+
+UartByteSource::UartByteSource(uint32_t uByteTimeUs)
+{
+    pSerial         = NULL;
+    MaxAvailable    = 0;
+    uEvents         = 0;
+
+    suRxCfg.uFifoFull       = RX_FIFO_FULL;
+    suRxCfg.uTimeoutSymbols = RX_TIMEOUT_SYMBOLS;
+    suRxCfg.uByteTimeUs     = uByteTimeUs;
+
+    xMux            = portMUX_INITIALIZER_UNLOCKED;
+    uNewestUs       = 0;
+    uBaseline       = 0;
+    uLastUs         = 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void UartByteSource::Begin(HardwareSerial * pHwSerial)
+{
+    pSerial   = pHwSerial;
+    uBaseline = 0;
+
+    pSerial->setRxFIFOFull(RX_FIFO_FULL);
+    pSerial->setRxTimeout(RX_TIMEOUT_SYMBOLS);
+    pSerial->onReceive([this]() { OnReceive(); }, false);
+}
+
+// ----------------------------------------------------------------------------
+
+// Runs in the UART driver's event task for both FIFO full and RX timeout.
+
+void UartByteSource::OnReceive()
+{
+    uint32_t    uNowUs = micros();
+    size_t      uAvail = pSerial->available();
+
+    taskENTER_CRITICAL(&xMux);
+    size_t      uNew   = uAvail > uBaseline ? uAvail - uBaseline : uAvail;
+    uNewestUs = estimateLastByteUs(uNowUs, uNew, suRxCfg);
+    uBaseline = uAvail;
+    uEvents++;
+    taskEXIT_CRITICAL(&xMux);
+
+    if (xTaskSerialIngest != NULL)
+        xTaskNotifyGive(xTaskSerialIngest);
+}
+
+// ----------------------------------------------------------------------------
+
+size_t UartByteSource::read(uint8_t * pBuf, size_t uMax)
+{
+    int     iAvailable = pSerial->available();
+
+    MaxAvailable = MAX(iAvailable, MaxAvailable);
+    if (iAvailable <= 0)
+        return 0;
+
+    size_t  uRead = pSerial->read(pBuf, MIN((size_t)iAvailable, uMax));
+    size_t  uLeft = pSerial->available();
+
+    // Whatever is still buffered arrived after the bytes just read
+    taskENTER_CRITICAL(&xMux);
+    uLastUs   = uNewestUs - (uint32_t)uLeft * suRxCfg.uByteTimeUs;
+    uBaseline = uLeft;
+    taskEXIT_CRITICAL(&xMux);
+
+    return uRead;
+}
+
+// ----------------------------------------------------------------------------
+
+void SerialIngestTask(void * pvParams)
+{
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(INGEST_IDLE_WAIT_MS));
+
+        g_EfisSerial.Read();
+        g_BoomSerial.Read();
+    }
+}
@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <HardwareSerial.h>
+
+#include <SerialByteSource.h>
+
+// A hardware UART as a byte source for the onspeed_core framers.
+//
+// The UART driver's RX events (FIFO threshold reached, or the line went idle
+// for a few character times) wake the serial ingest task, and the event time
+// becomes the receive time of the newest byte. That replaces the old scheme
+// of polling from loop() every 10 msec and stamping bytes with the poll time.
+
+class UartByteSource : public SerialByteSource
+{
+public:
+    UartByteSource(uint32_t uByteTimeUs);
+
+    // Data
+public:
+    HardwareSerial    * pSerial;
+    int                 MaxAvailable;   // A debug value
+    uint32_t            uEvents;        // RX events seen
+
+    // Methods
+public:
+    // Call after pSerial->begin(). Hooks the RX event and sets the thresholds.
+    void Begin(HardwareSerial * pHwSerial);
+
+    // SerialByteSource
+    size_t   read(uint8_t * pBuf, size_t uMax) override;
+    uint32_t lastByteUs() const override { return uLastUs; }
+
+protected:
+    void OnReceive();
+
+    UartRxEventConfig   suRxCfg;
+    portMUX_TYPE        xMux;
+    uint32_t            uNewestUs;      // Estimated arrival of the newest buffered byte
+    size_t              uBaseline;      // Bytes buffered as of the last event or read
+    uint32_t            uLastUs;
+};
+
+// Waits for RX events on the EFIS and boom UARTs and runs their framers.
+void SerialIngestTask(void * pvParams);
@@ -0,0 +1,323 @@
+// test_aoa_fusion.cpp - Unit tests for the inertially aided AOA
+//
+// A simple longitudinal flight model gives the true AOA and flight path,
+// and from them the pitch rate and accelerations an IMU would see. The
+// pressure AOA is the true AOA through the same smoothing SensorIO uses.
+
+#include <unity.h>
+#include <AoaFusion.h>
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Flight model
+// ============================================================================
+
+struct SuSim {
+    int     iHz           = 50;
+    float   fTasMps       = 35.0f;
+    float   fGyroBiasDps  = 0.0f;
+    float   fGyroNoiseDps = 0.0f;
+    float   fAccelNoiseG  = 0.0f;
+    float   fAoaNoiseDeg  = 0.0f;
+    float   fLeakTauSec   = AoaFusion::kDefaultLeakTauSec;
+};
+
+struct SuTrace {
+    std::vector<float>  afTrue;
+    std::vector<float>  afPressure;
+    std::vector<float>  afFused;
+};
+
+/// Repeatable Gaussian-ish noise, sum of four uniforms
+class TestNoise {
+public:
+    float next()
+    {
+        float fSum = 0.0f;
+        for (int i = 0; i < 4; i++) {
+            _uState = _uState * 1664525u + 1013904223u;
+            fSum += float(_uState >> 8) * (1.0f / 16777216.0f);
+        }
+        return (fSum - 2.0f) * 1.7320508f;
+    }
+private:
+    uint32_t _uState = 12345u;
+};
+
+/// Fly fSec seconds of wings level flight at constant speed with the true
+/// AOA and flight path angle (degrees) from the two functions of time.
+template <class AoaFn, class GammaFn>
+static SuTrace fly(const SuSim & sim, float fSec, AoaFn aoa, GammaFn gamma)
+{
+    constexpr float kG = 9.80665f;
+
+    const SmoothingParams params = SmoothingParams::forRate(SmoothingTimes::fromConfig(20, 15), sim.iHz);
+    const float           fDt    = 1.0f / float(sim.iHz);
+    const float           fH     = 1e-3f;
+
+    AoaFilterChain  pressure;
+    AoaFusion       fusion;
+    TestNoise       noise;
+    SuTrace         trace;
+
+    pressure.configure(params, AoaFilterKind::Ema);
+    fusion.configure(params, AoaFilterKind::Ema, 0.0f, sim.fLeakTauSec);
+
+    const int iSamples = int(fSec * sim.iHz);
+    for (int k = 0; k < iSamples; k++) {
+        const float t      = k * fDt;
+        const float fA     = aoa(t);
+        const float fAdot  = (aoa(t + fH)   - aoa(t - fH))   / (2.0f * fH);
+        const float fGdot  = (gamma(t + fH) - gamma(t - fH)) / (2.0f * fH);
+        const float fTheta = fA + gamma(t);
+
+        // Acceleration at right angles to the flight path, in body axes,
+        // plus the specific force that holds the aircraft against gravity
+        const float fAccN  = sim.fTasMps * deg2rad(fGdot) / kG;
+        const float fAr    = deg2rad(fA), fTr = deg2rad(fTheta);
+
+        AoaInertialInput imu;
+        imu.fPitchRateDps = fAdot + fGdot + sim.fGyroBiasDps + sim.fGyroNoiseDps * noise.next();
+        imu.fFwdG         = fAccN * std::sin(fAr) + std::sin(fTr) + sim.fAccelNoiseG * noise.next();
+        imu.fVertG        = fAccN * std::cos(fAr) + std::cos(fTr) + sim.fAccelNoiseG * noise.next();
+        imu.fPitchDeg     = fTheta;
+        imu.fRollDeg      = 0.0f;
+        imu.fTasMps       = sim.fTasMps;
+
+        const float fPressure = pressure.update(fA + sim.fAoaNoiseDeg * noise.next());
+        trace.afTrue.push_back(fA);
+        trace.afPressure.push_back(fPressure);
+        trace.afFused.push_back(fusion.update(fPressure, imu));
+    }
+    return trace;
+}
+
+/// Mean of true minus estimate over samples [iFrom, iTo)
+static float meanError(const SuTrace & trace, const std::vector<float> & afEst, int iFrom, int iTo)
+{
+    double dSum = 0.0;
+    for (int k = iFrom; k < iTo; k++)
+        dSum += trace.afTrue[k] - afEst[k];
+    return float(dSum / (iTo - iFrom));
+}
+
+static float maxAbsError(const SuTrace & trace, const std::vector<float> & afEst, int iFrom, int iTo)
+{
+    float fMax = 0.0f;
+    for (int k = iFrom; k < iTo; k++)
+        fMax = std::max(fMax, std::fabs(trace.afTrue[k] - afEst[k]));
+    return fMax;
+}
+
+static float rmsAbout(const std::vector<float> & afEst, const SuTrace & trace, int iFrom, int iTo)
+{
+    double dSq = 0.0;
+    for (int k = iFrom; k < iTo; k++)
+        dSq += double(afEst[k] - trace.afTrue[k]) * (afEst[k] - trace.afTrue[k]);
+    return float(std::sqrt(dSq / (iTo - iFrom)));
+}
+
+/// First time the estimate reaches fLevel, seconds
+static float crossingSec(const std::vector<float> & afEst, float fLevel, int iHz)
+{
+    for (size_t k = 0; k < afEst.size(); k++)
+        if (afEst[k] >= fLevel)
+            return float(k) / float(iHz);
+    return -1.0f;
+}
+
+// ============================================================================
+// AOA rate
+// ============================================================================
+
+void test_rate_is_pitch_rate_in_straight_flight()
+{
+    // Level, 1 g: all of the pitch rate is AOA rate
+    AoaInertialInput imu = { 2.0f, std::sin(deg2rad(5.0f)), std::cos(deg2rad(5.0f)), 5.0f, 0.0f, 40.0f };
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 2.0f, aoaRateDps(imu, 5.0f));
+}
+
+void test_rate_is_zero_in_level_turn()
+{
+    // 45 deg bank level turn at 4 deg AOA. Pitch rate is turn rate times
+    // sin(bank) and the load factor 1 / cos(bank) along the lift
+    const float kG  = 9.80665f, fV = 40.0f, fPhi = deg2rad(45.0f), fA = deg2rad(4.0f);
+    const float fN  = 1.0f / std::cos(fPhi);
+
+    // Level flight path, so pitch is the AOA seen through the bank
+    const float fTheta = std::asin(std::sin(fA) * std::cos(fPhi));
+
+    AoaInertialInput imu;
+    imu.fPitchRateDps = rad2deg(kG * std::tan(fPhi) / fV * std::sin(fPhi));
+    imu.fFwdG         = fN * std::sin(fA);
+    imu.fVertG        = fN * std::cos(fA);
+    imu.fPitchDeg     = rad2deg(fTheta);
+    imu.fRollDeg      = rad2deg(fPhi);
+    imu.fTasMps       = fV;
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, aoaRateDps(imu, 4.0f));
+}
+
+// ============================================================================
+// Fusion
+// ============================================================================
+
+void test_ramp_has_no_lag()
+{
+    // 1 deg/sec AOA ramp at constant flight path, the pitch up to a stall
+    SuSim   sim;
+    SuTrace trace = fly(sim, 20.0f, [](float t) { return 4.0f + 0.5f * t; }, [](float) { return 0.0f; });
+
+    const int   n        = int(trace.afTrue.size());
+    const float fLagP    = meanError(trace, trace.afPressure, n - 50, n) / 0.5f;
+    const float fLagF    = meanError(trace, trace.afFused,    n - 50, n) / 0.5f;
+
+    char szMsg[120];
+    std::snprintf(szMsg, sizeof(szMsg), "Ramp lag: pressure %.3f s, fused %.4f s", fLagP, fLagF);
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.61f, fLagP);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f,  fLagF);
+}
+
+void test_pullup_at_constant_aoa()
+{
+    // Flight path up 10 deg over 2 sec and back, AOA steady: the pitch rate
+    // is all flight path, and the fused AOA must not move with it
+    SuSim   sim;
+    auto    gamma = [](float t) { return (t > 5.0f && t < 9.0f) ? 5.0f * (1.0f - std::cos(1.5707963f * (t - 5.0f))) : 0.0f; };
+    SuTrace trace = fly(sim, 15.0f, [](float) { return 6.0f; }, gamma);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, maxAbsError(trace, trace.afFused, 0, int(trace.afTrue.size())));
+}
+
+void test_gyro_bias_has_no_steady_error()
+{
+    // 0.5 deg/sec pitch gyro bias at a steady AOA
+    SuSim sim;
+    sim.fGyroBiasDps = 0.5f;
+    SuTrace trace = fly(sim, 120.0f, [](float) { return 5.0f; }, [](float) { return 0.0f; });
+
+    const int   n    = int(trace.afTrue.size());
+    const float fMax = maxAbsError(trace, trace.afFused, 0, n);
+
+    char szMsg[120];
+    std::snprintf(szMsg, sizeof(szMsg), "0.5 deg/s gyro bias: worst %.3f deg, after 2 min %.4f deg", fMax, meanError(trace, trace.afFused, n - 50, n));
+    TEST_MESSAGE(szMsg);
+
+    // Bounded by bias x smoothing lag, and gone in the steady state
+    TEST_ASSERT_TRUE(fMax < 0.5f * 0.62f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, meanError(trace, trace.afFused, n - 50, n));
+}
+
+void test_stall_entry_warning_time_with_noise()
+{
+    // Slow down into a stall: AOA from 5 deg rising 1 deg/sec after 2 sec,
+    // level at 16. Noisy sensors, biased gyro. Stall warning at 14 deg.
+    SuSim sim;
+    sim.fGyroBiasDps  = 0.3f;
+    sim.fGyroNoiseDps = 0.5f;
+    sim.fAccelNoiseG  = 0.02f;
+    sim.fAoaNoiseDeg  = 0.3f;
+
+    auto    aoa   = [](float t) { return std::min(16.0f, 5.0f + std::max(0.0f, t - 2.0f)); };
+    SuTrace trace = fly(sim, 25.0f, aoa, [](float) { return 0.0f; });
+
+    const float tTrue = crossingSec(trace.afTrue,     14.0f, sim.iHz);
+    const float tP    = crossingSec(trace.afPressure, 14.0f, sim.iHz);
+    const float tF    = crossingSec(trace.afFused,    14.0f, sim.iHz);
+
+    // Error while the AOA holds at 16. The fused AOA lets through IMU noise
+    // the smoothing would have taken out, so it is noisier than the pressure
+    // AOA, but well inside a tone band.
+    const float fNoiseP = rmsAbout(trace.afPressure, trace, 20 * sim.iHz, 25 * sim.iHz);
+    const float fNoiseF = rmsAbout(trace.afFused,    trace, 20 * sim.iHz, 25 * sim.iHz);
+    const float fHoldF  = maxAbsError(trace, trace.afFused, 20 * sim.iHz, 25 * sim.iHz);
+
+    char szMsg[200];
+    std::snprintf(szMsg, sizeof(szMsg),
+        "14 deg reached: true %.2f s, pressure %.2f s, fused %.2f s. Held at 16: RMS error pressure %.3f fused %.3f deg, fused worst %.3f deg",
+        tTrue, tP, tF, fNoiseP, fNoiseF, fHoldF);
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_TRUE(tP - tTrue > 0.5f);
+    TEST_ASSERT_FLOAT_WITHIN(0.15f, tTrue, tF);
+    TEST_ASSERT_TRUE(fNoiseF < 0.2f);
+    TEST_ASSERT_TRUE(fHoldF  < 0.5f);
+}
+
+void test_leak_time_constant_tradeoff()
+{
+    // Longer leak: less stall entry overshoot, slower to shed a bias step.
+    // Reported for tuning; the default only has to do well on both.
+    char szMsg[300];
+    int  iLen = std::snprintf(szMsg, sizeof(szMsg), "Leak tau: stall entry worst error / bias error at 30 s:");
+    auto aoa  = [](float t) { return std::min(16.0f, 5.0f + std::max(0.0f, t - 2.0f)); };
+
+    for (float fTau : { 3.0f, 10.0f, 30.0f }) {
+        SuSim sim;
+        sim.fLeakTauSec = fTau;
+        SuTrace entry = fly(sim, 25.0f, aoa, [](float) { return 0.0f; });
+        sim.fGyroBiasDps = 0.5f;
+        SuTrace bias  = fly(sim, 30.0f, [](float) { return 5.0f; }, [](float) { return 0.0f; });
+
+        const int nE = int(entry.afTrue.size()), nB = int(bias.afTrue.size());
+        const float fEntry = maxAbsError(entry, entry.afFused, 0, nE);
+        const float fBias  = std::fabs(meanError(bias, bias.afFused, nB - 50, nB));
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %.0f s %.3f / %.3f;", fTau, fEntry, fBias);
+
+        if (fTau == AoaFusion::kDefaultLeakTauSec) {
+            TEST_ASSERT_TRUE(fEntry < 0.1f);
+            TEST_ASSERT_TRUE(fBias  < 0.1f);
+        }
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+void test_low_speed_passes_pressure_through()
+{
+    AoaFusion        fusion;
+    AoaInertialInput slow = { 5.0f, 0.0f, 1.0f, 0.0f, 0.0f, 10.0f };
+    AoaInertialInput fast = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 40.0f };
+
+    fusion.configure(SmoothingParams::forRate(SmoothingTimes::fromConfig(20, 15), 50), AoaFilterKind::Ema);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, fusion.update(3.0f, slow));
+    TEST_ASSERT_FALSE(fusion.active());
+
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, fusion.update(3.0f, fast));
+    TEST_ASSERT_TRUE(fusion.active());
+
+    // NaN from the IMU falls back too
+    fast.fPitchRateDps = NAN;
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, fusion.update(4.0f, fast));
+    TEST_ASSERT_FALSE(fusion.active());
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // AOA rate
+    RUN_TEST(test_rate_is_pitch_rate_in_straight_flight);
+    RUN_TEST(test_rate_is_zero_in_level_turn);
+
+    // Fusion
+    RUN_TEST(test_ramp_has_no_lag);
+    RUN_TEST(test_pullup_at_constant_aoa);
+    RUN_TEST(test_gyro_bias_has_no_steady_error);
+    RUN_TEST(test_stall_entry_warning_time_with_noise);
+    RUN_TEST(test_leak_time_constant_tradeoff);
+    RUN_TEST(test_low_speed_passes_pressure_through);
+
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+// test_atmosphere.cpp - Error bounds and speed of the single precision atmosphere functions
+
+#include <unity.h>
+#include <Atmosphere.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Reference formulas, double precision libm, as the firmware had them
+// ============================================================================
+
+static double refPaltFt(double fStaticMb)
+{
+    return 145366.45 * (1.0 - std::pow(fStaticMb / 1013.25, 0.190284));
+}
+
+static double refDensityAltFt(double fPaltFt, double fOatC)
+{
+    const double Kelvin    = 273.15;
+    const double Temp_rate = 0.00198119993;
+    const double fIsaK     = 15 - Temp_rate * fPaltFt + Kelvin;
+
+    return fPaltFt + (fIsaK / Temp_rate) * (1 - std::pow(fIsaK / (fOatC + Kelvin), 0.2349690));
+}
+
+static double refTas(double fIas, double fDensityAltFt)
+{
+    return fIas / std::pow(1 - 6.8755856e-6 * fDensityAltFt, 2.12794);
+}
+
+// ============================================================================
+// Atmosphere error bounds over the documented envelopes
+// ============================================================================
+
+void test_pressure_altitude_within_bound()
+{
+    double fWorst = 0.0;
+
+    for (double fMb = 150.0; fMb <= 1100.0; fMb += 0.01) {
+        const double fErr = std::fabs(pressureAltitudeFt(float(fMb)) - refPaltFt(float(fMb)));
+        if (fErr > fWorst)
+            fWorst = fErr;
+    }
+
+    char szMsg[80];
+    std::snprintf(szMsg, sizeof(szMsg), "Pressure altitude worst error %.4f ft", fWorst);
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(fWorst < 0.05);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, pressureAltitudeFt(kStdPressureMb));
+}
+
+void test_density_altitude_within_bound()
+{
+    double fWorst = 0.0;
+
+    for (double fPalt = -2000.0; fPalt <= 45000.0; fPalt += 97.0) {
+        for (double fOat = -70.0; fOat <= 55.0; fOat += 0.37) {
+            const double fErr = std::fabs(densityAltitudeFt(float(fPalt), float(fOat)) - refDensityAltFt(fPalt, float(fOat)));
+            if (fErr > fWorst)
+                fWorst = fErr;
+        }
+    }
+
+    char szMsg[80];
+    std::snprintf(szMsg, sizeof(szMsg), "Density altitude worst error %.4f ft", fWorst);
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(fWorst < 0.1);
+
+    // ISA day: density altitude is pressure altitude
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 5000.0f, densityAltitudeFt(5000.0f, 15.0f - 0.00198119993f * 5000.0f));
+}
+
+void test_tas_within_bound()
+{
+    double fWorst = 0.0;
+
+    for (double fDa = -10000.0; fDa <= 50000.0; fDa += 1.3) {
+        const double fErr = std::fabs(trueAirspeed(100.0f, float(fDa)) - refTas(100.0, float(fDa))) / refTas(100.0, float(fDa));
+        if (fErr > fWorst)
+            fWorst = fErr;
+    }
+
+    char szMsg[80];
+    std::snprintf(szMsg, sizeof(szMsg), "TAS worst relative error %.2e", fWorst);
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(fWorst < 1e-6);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 100.0f, trueAirspeed(100.0f, 0.0f));
+}
+
+void test_ias_from_dynamic_pressure()
+{
+    // 1 kPa of dynamic pressure is about 78.5 kts at sea level
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, float(std::sqrt(2.0 * 1000.0 / 1.225) * 1.94384), iasFromDynamicPressureKts(1000.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, iasFromDynamicPressureKts(0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, iasFromDynamicPressureKts(-50.0f));
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_against_libm()
+{
+    const int       kReps = 2000000;
+    volatile float  fSink = 0.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kReps; i++)
+        fSink = fSink + float(145366.45 * (1 - pow((300.0f + (i & 1023)) / 1013.25, 0.190284)));
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kReps; i++)
+        fSink = fSink + pressureAltitudeFt(300.0f + (i & 1023));
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / kReps; };
+    char szMsg[160];
+    std::snprintf(szMsg, sizeof(szMsg), "Pressure altitude: double pow %.1f ns, powf %.1f ns",
+                  ns(t0, t1), ns(t1, t2));
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(fSink != 0.0f);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Error bounds
+    RUN_TEST(test_pressure_altitude_within_bound);
+    RUN_TEST(test_density_altitude_within_bound);
+    RUN_TEST(test_tas_within_bound);
+    RUN_TEST(test_ias_from_dynamic_pressure);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_against_libm);
+#endif
+
+    return UNITY_END();
+}
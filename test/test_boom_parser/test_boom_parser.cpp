@@ -0,0 +1,309 @@
+// test_boom_parser.cpp - Unit tests for the flight test boom sentence decoder
+
+#include <unity.h>
+#include <BoomParser.h>
+#include <SerialFramer.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// 21 characters, the fixed field offset the legacy decode assumes
+static const char * kHeader = "$BOOM,00001,12:34:56,";
+
+static std::string makeBoomLine(int iStatic, int iDynamic, int iAlpha, int iBeta, bool bChecksum = true,
+                                const char * szHeader = kHeader)
+{
+    char szBody[96];
+    snprintf(szBody, sizeof(szBody), "%s%d,%d,%d,%d", szHeader, iStatic, iDynamic, iAlpha, iBeta);
+    std::string s = szBody;
+    if (bChecksum) {
+        unsigned uSum = 0;
+        for (char c : s) uSum += static_cast<uint8_t>(c);
+        char szCrc[8];
+        snprintf(szCrc, sizeof(szCrc), "*%02X", uSum & 0xFF);
+        s += szCrc;
+    }
+    return s + "\r";
+}
+
+// The strtok/atoi decode BoomSerialIO used before, for equivalence checks
+static bool legacyParse(const std::string & s, int aiOut[4])
+{
+    char    Buffer[127];
+    int     BufferIndex = static_cast<int>(s.size());
+    memcpy(Buffer, s.data(), s.size());
+    Buffer[BufferIndex] = '\0';
+
+    int calcCRC = 0;
+    for (int i = 0; i < BufferIndex - 4; i++) calcCRC += Buffer[i];
+    calcCRC &= 0xFF;
+    char hexCRC[3] = { Buffer[BufferIndex - 3], Buffer[BufferIndex - 2], 0 };
+    if (calcCRC != (int)strtol(hexCRC, NULL, 16))
+        return false;
+
+    aiOut[0] = aiOut[1] = aiOut[2] = aiOut[3] = 0;
+    char * token = strtok(Buffer + 21, ",");
+    int    i     = 0;
+    while (token != NULL && i < 4) {
+        aiOut[i++] = atoi(token);
+        token = strtok(NULL, ",");
+    }
+    return true;
+}
+
+static BoomParseResult parse(const std::string & s, BoomData & d, bool bChecksum = true)
+{
+    return parseBoomLine(s.data(), s.size(), d, bChecksum);
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+void test_valid_sentence_decodes()
+{
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(makeBoomLine(8123, 1650, 2980, -42), d));
+    TEST_ASSERT_EQUAL_INT32(8123, d.iStatic);
+    TEST_ASSERT_EQUAL_INT32(1650, d.iDynamic);
+    TEST_ASSERT_EQUAL_INT32(2980, d.iAlpha);
+    TEST_ASSERT_EQUAL_INT32(-42,  d.iBeta);
+}
+
+void test_without_trailing_cr()
+{
+    std::string s = makeBoomLine(1, 2, 3, 4);
+    s.pop_back();
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(s, d));
+    TEST_ASSERT_EQUAL_INT32(4, d.iBeta);
+}
+
+void test_no_checksum_mode()
+{
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(makeBoomLine(10, 20, 30, 40, false), d, false));
+    TEST_ASSERT_EQUAL_INT32(40, d.iBeta);
+}
+
+void test_extra_fields_ignored()
+{
+    std::string s = std::string(kHeader) + "1,2,3,4,99\r";
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(s, d, false));
+    TEST_ASSERT_EQUAL_INT32(4, d.iBeta);
+}
+
+void test_header_length_doesnt_matter()
+{
+    const char * aszHeader[] = { "$B,1,1:02:03,", "$BOOM2,0001234567,12:34:56.789,", "$,,," };
+    for (const char * szHeader : aszHeader) {
+        BoomData d = {};
+        TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(makeBoomLine(8123, 1650, 2980, -42, true, szHeader), d));
+        TEST_ASSERT_EQUAL_INT32(8123, d.iStatic);
+        TEST_ASSERT_EQUAL_INT32(1650, d.iDynamic);
+        TEST_ASSERT_EQUAL_INT32(2980, d.iAlpha);
+        TEST_ASSERT_EQUAL_INT32(-42,  d.iBeta);
+    }
+}
+
+void test_matches_legacy_decode()
+{
+    std::mt19937 rng(11);
+    for (int i = 0; i < 2000; i++) {
+        int a = rng() % 16384, b = rng() % 16384, c = int(rng() % 8000) - 4000, e = int(rng() % 8000) - 4000;
+        std::string s = makeBoomLine(a, b, c, e);
+
+        int      aiLegacy[4];
+        BoomData d = {};
+        TEST_ASSERT_TRUE(legacyParse(s, aiLegacy));
+        TEST_ASSERT_EQUAL(BoomParseResult::Ok, parse(s, d));
+        TEST_ASSERT_EQUAL_INT32(aiLegacy[0], d.iStatic);
+        TEST_ASSERT_EQUAL_INT32(aiLegacy[1], d.iDynamic);
+        TEST_ASSERT_EQUAL_INT32(aiLegacy[2], d.iAlpha);
+        TEST_ASSERT_EQUAL_INT32(aiLegacy[3], d.iBeta);
+    }
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+void test_bad_checksum_leaves_data_alone()
+{
+    std::string s = makeBoomLine(100, 200, 300, 400);
+    s[22] = (s[22] == '9') ? '8' : '9';
+
+    BoomData d = { 1, 2, 3, 4 };
+    TEST_ASSERT_EQUAL(BoomParseResult::BadChecksum, parse(s, d));
+    TEST_ASSERT_EQUAL_INT32(1, d.iStatic);
+}
+
+void test_non_hex_checksum_rejected()
+{
+    std::string s = makeBoomLine(100, 200, 300, 400);
+    s[s.size() - 2] = 'Z';
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::BadChecksum, parse(s, d));
+}
+
+void test_short_or_foreign_lines_ignored()
+{
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::Ignored, parse("$BOOM\r", d));
+    TEST_ASSERT_EQUAL(BoomParseResult::Ignored, parse("$BOOM,00001\r", d, false));
+    TEST_ASSERT_EQUAL(BoomParseResult::Ignored, parse("", d));
+    std::string s = makeBoomLine(1, 2, 3, 4);
+    s[0] = '!';
+    TEST_ASSERT_EQUAL(BoomParseResult::Ignored, parse(s, d));
+}
+
+void test_missing_or_garbled_fields_rejected()
+{
+    BoomData d = {};
+    TEST_ASSERT_EQUAL(BoomParseResult::BadFormat, parse(std::string(kHeader) + "1,2,3\r", d, false));
+    TEST_ASSERT_EQUAL(BoomParseResult::BadFormat, parse(std::string(kHeader) + "1,2,,4\r", d, false));
+    TEST_ASSERT_EQUAL(BoomParseResult::BadFormat, parse(std::string(kHeader) + "1,2,x3,4\r", d, false));
+    TEST_ASSERT_EQUAL(BoomParseResult::BadFormat, parse(std::string(kHeader) + "1,2,3,4.5\r", d, false));
+}
+
+// ============================================================================
+// Stream
+// ============================================================================
+
+class BoomSink : public SerialFrameSink {
+public:
+    void onFrame(const SerialFrame & frame) override
+    {
+        BoomParseResult r = parseBoomLine(reinterpret_cast<const char *>(frame.pData), frame.uLen, data);
+        if (r == BoomParseResult::Ok)               uGood++;
+        else if (r == BoomParseResult::BadChecksum) uBadCrc++;
+        else                                        uOther++;
+    }
+
+    BoomData data   = {};
+    uint32_t uGood  = 0;
+    uint32_t uBadCrc = 0;
+    uint32_t uOther = 0;
+};
+
+// 100 Hz boom for the given number of seconds, one corrupted line in 50
+static std::string makeStream(int iSeconds)
+{
+    std::string s = "3,4*1F\r\n";      // tail of a line we joined in the middle of
+    for (int i = 0; i < iSeconds * 100; i++) {
+        std::string line = makeBoomLine(8000 + i % 50, 1600 + i % 7, 3000 - i % 90, i % 11 - 5);
+        if (i % 50 == 49) line[25] ^= 0x01;
+        s += line + "\n";
+    }
+    return s;
+}
+
+void test_stream_counts_crc_failures()
+{
+    std::string stream = makeStream(10);
+
+    LineFramer<126> framer(87, '$', false);
+    BoomSink        sink;
+    for (size_t i = 0; i < stream.size(); i += 50)
+        framer.push(reinterpret_cast<const uint8_t *>(stream.data()) + i,
+                    std::min<size_t>(50, stream.size() - i), 0, sink);
+
+    TEST_ASSERT_EQUAL_UINT32(980, sink.uGood);
+    TEST_ASSERT_EQUAL_UINT32(20,  sink.uBadCrc);
+    TEST_ASSERT_EQUAL_UINT32(0,   sink.uOther);
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_100hz_stream()
+{
+    std::string stream = makeStream(60);    // one minute of boom data
+    const int   kReps  = 20;
+
+    std::vector<std::string> lines;
+    for (int i = 0; i < 6000; i++)
+        lines.push_back(makeBoomLine(8000 + i % 50, 1600 + i % 7, 3000 - i % 90, i % 11 - 5));
+
+    // Framing and decoding the whole stream
+    auto t0 = std::chrono::steady_clock::now();
+    BoomSink sink;
+    for (int r = 0; r < kReps; r++) {
+        LineFramer<126> framer(87, '$', false);
+        for (size_t i = 0; i < stream.size(); i += 50)
+            framer.push(reinterpret_cast<const uint8_t *>(stream.data()) + i,
+                        std::min<size_t>(50, stream.size() - i), 0, sink);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Decode only, new vs strtok
+    BoomData d = {};
+    int64_t  iSink = 0;
+    for (int r = 0; r < kReps; r++)
+        for (auto & line : lines)
+            if (parseBoomLine(line.data(), line.size(), d) == BoomParseResult::Ok) iSink += d.iBeta;
+    auto t2 = std::chrono::steady_clock::now();
+
+    int aiOut[4];
+    for (int r = 0; r < kReps; r++)
+        for (auto & line : lines)
+            if (legacyParse(line, aiOut)) iSink += aiOut[3];
+    auto t3 = std::chrono::steady_clock::now();
+
+    double dLines  = 6000.0 * kReps;
+    auto   ns      = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / dLines; };
+    double dStream = ns(t0, t1);
+
+    char szMsg[200];
+    snprintf(szMsg, sizeof(szMsg), "100 Hz boom: frame+parse %.0f ns/line (%.4f%% of a core); decode only %.0f ns/line vs strtok %.0f ns/line",
+             dStream, dStream * 100.0 / 1e9 * 100.0, ns(t1, t2), ns(t2, t3));
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(sink.uGood > 0 && iSink != 1);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Decoding
+    RUN_TEST(test_valid_sentence_decodes);
+    RUN_TEST(test_without_trailing_cr);
+    RUN_TEST(test_no_checksum_mode);
+    RUN_TEST(test_extra_fields_ignored);
+    RUN_TEST(test_header_length_doesnt_matter);
+    RUN_TEST(test_matches_legacy_decode);
+
+    // Validation
+    RUN_TEST(test_bad_checksum_leaves_data_alone);
+    RUN_TEST(test_non_hex_checksum_rejected);
+    RUN_TEST(test_short_or_foreign_lines_ignored);
+    RUN_TEST(test_missing_or_garbled_fields_rejected);
+
+    // Stream
+    RUN_TEST(test_stream_counts_crc_failures);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_100hz_stream);
+#endif
+
+    return UNITY_END();
+}
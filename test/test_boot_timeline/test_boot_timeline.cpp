@@ -0,0 +1,185 @@
+// test_boot_timeline.cpp - Unit tests for the boot phase recorder
+
+#include <unity.h>
+#include <BootTimeline.h>
+
+#include <cstring>
+#include <thread>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+void test_begin_end_records_duration()
+{
+    BootTimeline timeline;
+
+    int iSd = timeline.begin("SD mount", 1000);
+    timeline.end(iSd, 4500);
+
+    TEST_ASSERT_EQUAL_size_t(1, timeline.size());
+    TEST_ASSERT_EQUAL_STRING("SD mount", timeline.phase(0).szName);
+    TEST_ASSERT_EQUAL_UINT32(1000, timeline.phase(0).uStartUs);
+    TEST_ASSERT_EQUAL_UINT32(3500, timeline.durationUs(0, 9999));
+}
+
+void test_overlapping_phases()
+{
+    BootTimeline timeline;
+
+    int iWifi = timeline.begin("WiFi AP", 100);
+    int iImu  = timeline.begin("IMU settle", 200);
+    timeline.end(iImu,  900);
+    timeline.end(iWifi, 5000);
+
+    TEST_ASSERT_EQUAL_UINT32(4900, timeline.durationUs(0, 0));
+    TEST_ASSERT_EQUAL_UINT32(700,  timeline.durationUs(1, 0));
+}
+
+void test_open_phase_uses_now()
+{
+    BootTimeline timeline;
+
+    timeline.begin("Config load", 1000);
+    TEST_ASSERT_EQUAL_UINT32(BootTimeline::kOpen, timeline.phase(0).uEndUs);
+    TEST_ASSERT_EQUAL_UINT32(250, timeline.durationUs(0, 1250));
+}
+
+void test_end_is_idempotent()
+{
+    BootTimeline timeline;
+
+    int iPhase = timeline.begin("Audio", 10);
+    timeline.end(iPhase, 20);
+    timeline.end(iPhase, 90);
+    timeline.end(BootTimeline::kNone, 90);
+    timeline.end(99, 90);
+
+    TEST_ASSERT_EQUAL_UINT32(10, timeline.durationUs(0, 1000));
+}
+
+void test_mark_has_no_duration()
+{
+    BootTimeline timeline;
+
+    timeline.mark("First tone", 123456);
+
+    TEST_ASSERT_TRUE(timeline.phase(0).bMark);
+    TEST_ASSERT_EQUAL_UINT32(0, timeline.durationUs(0, 999999));
+}
+
+void test_micros_wrap()
+{
+    BootTimeline timeline;
+
+    int iPhase = timeline.begin("Wrap", 0xFFFFFF00u);
+    timeline.end(iPhase, 0x00000100u);
+
+    TEST_ASSERT_EQUAL_UINT32(0x200, timeline.durationUs(0, 0));
+}
+
+void test_full_table_drops_and_counts()
+{
+    BootTimeline timeline;
+
+    for (size_t i = 0; i < BootTimeline::kMaxPhases; i++)
+        TEST_ASSERT_NOT_EQUAL(BootTimeline::kNone, timeline.begin("x", uint32_t(i)));
+
+    TEST_ASSERT_EQUAL(BootTimeline::kNone, timeline.begin("late", 0));
+    timeline.mark("late mark", 0);
+    timeline.end(BootTimeline::kNone, 0);
+
+    TEST_ASSERT_EQUAL_size_t(BootTimeline::kMaxPhases, timeline.size());
+    TEST_ASSERT_EQUAL_UINT(2, timeline.dropped());
+}
+
+void test_phases_from_two_threads()
+{
+    BootTimeline timeline;
+    const int    kEach = 12;
+
+    auto worker = [&](const char * szName) {
+        for (int i = 0; i < kEach; i++)
+            timeline.end(timeline.begin(szName, uint32_t(i)), uint32_t(i + 1));
+    };
+    std::thread a(worker, "a");
+    std::thread b(worker, "b");
+    a.join();
+    b.join();
+
+    int iA = 0, iB = 0;
+    TEST_ASSERT_EQUAL_size_t(2 * kEach, timeline.size());
+    for (size_t i = 0; i < timeline.size(); i++) {
+        TEST_ASSERT_NOT_NULL(timeline.phase(i).szName);
+        TEST_ASSERT_EQUAL_UINT32(1, timeline.durationUs(i, 0));
+        if (timeline.phase(i).szName[0] == 'a') iA++;
+        else                                    iB++;
+    }
+    TEST_ASSERT_EQUAL_INT(kEach, iA);
+    TEST_ASSERT_EQUAL_INT(kEach, iB);
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+void test_format_table()
+{
+    BootTimeline timeline;
+    char         szOut[512];
+
+    timeline.end(timeline.begin("SD mount", 1000), 3000);
+    timeline.begin("WiFi AP", 2000);
+    timeline.mark("First tone", 8000);
+
+    size_t uLen = timeline.format(szOut, sizeof(szOut), 10000);
+
+    TEST_ASSERT_EQUAL_size_t(std::strlen(szOut), uLen);
+    TEST_ASSERT_NOT_NULL(std::strstr(szOut, "      1000       2000   SD mount\n"));
+    TEST_ASSERT_NOT_NULL(std::strstr(szOut, "      2000       8000+  WiFi AP (running)\n"));
+    TEST_ASSERT_NOT_NULL(std::strstr(szOut, "      8000           *  First tone\n"));
+}
+
+void test_format_truncates_safely()
+{
+    BootTimeline timeline;
+    char         szOut[40];
+
+    for (int i = 0; i < 10; i++)
+        timeline.end(timeline.begin("A rather long phase name", 0), 1);
+
+    std::memset(szOut, 'x', sizeof(szOut));
+    size_t uLen = timeline.format(szOut, sizeof(szOut), 0);
+
+    TEST_ASSERT_EQUAL_size_t(sizeof(szOut) - 1, uLen);
+    TEST_ASSERT_EQUAL_INT(0, szOut[sizeof(szOut) - 1]);
+    TEST_ASSERT_EQUAL_size_t(0, timeline.format(szOut, 0, 0));
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Recording
+    RUN_TEST(test_begin_end_records_duration);
+    RUN_TEST(test_overlapping_phases);
+    RUN_TEST(test_open_phase_uses_now);
+    RUN_TEST(test_end_is_idempotent);
+    RUN_TEST(test_mark_has_no_duration);
+    RUN_TEST(test_micros_wrap);
+    RUN_TEST(test_full_table_drops_and_counts);
+    RUN_TEST(test_phases_from_two_threads);
+
+    // Reporting
+    RUN_TEST(test_format_table);
+    RUN_TEST(test_format_truncates_safely);
+
+    return UNITY_END();
+}
@@ -0,0 +1,203 @@
+// test_checksum.cpp - Unit tests for the shared checksum module
+
+#include <unity.h>
+#include <Checksum.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint8_t * bytes(const char * sz)
+{
+    return reinterpret_cast<const uint8_t *>(sz);
+}
+
+// Bit-at-a-time CRC-32, straight from the definition
+static uint32_t referenceCrc32(const uint8_t * p, size_t uLen)
+{
+    uint32_t uCrc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < uLen; i++) {
+        uCrc ^= p[i];
+        for (int iBit = 0; iBit < 8; iBit++)
+            uCrc = (uCrc & 1) ? (uCrc >> 1) ^ 0xEDB88320u : (uCrc >> 1);
+    }
+    return ~uCrc;
+}
+
+// ============================================================================
+// Known vectors
+// ============================================================================
+
+void test_crc32_check_value()
+{
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926u, crc32(bytes("123456789"), 9));
+}
+
+void test_crc32_empty_and_fox()
+{
+    const char * szFox = "The quick brown fox jumps over the lazy dog";
+    TEST_ASSERT_EQUAL_HEX32(0x00000000u, crc32(nullptr, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x414FA339u, crc32(bytes(szFox), strlen(szFox)));
+}
+
+void test_crc16_check_value()
+{
+    TEST_ASSERT_EQUAL_HEX16(0x31C3, crc16Ccitt(bytes("123456789"), 9));
+}
+
+void test_crc8_maxim_check_value()
+{
+    TEST_ASSERT_EQUAL_HEX8(0xA1, crc8Maxim(bytes("123456789"), 9));
+
+    // DS18B20 scratchpad at 25.0625 C, datasheet power-on config
+    const uint8_t aScratch[9] = { 0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0x00 };
+    uint8_t aGood[9];
+    memcpy(aGood, aScratch, 8);
+    aGood[8] = crc8Maxim(aScratch, 8);
+    TEST_ASSERT_EQUAL_HEX8(0x00, crc8Maxim(aGood, 9));
+}
+
+void test_sum8_wraps_to_low_byte()
+{
+    TEST_ASSERT_EQUAL_HEX8(0xC6, sum8("ABC", 3));
+
+    const uint8_t a[] = { 0xFF, 0x02, 0x10 };
+    TEST_ASSERT_EQUAL_HEX8(0x11, sum8(a, 3));
+    TEST_ASSERT_EQUAL_HEX8(0x00, sum8(a, 0));
+}
+
+void test_sum8_char_overload_treats_bytes_unsigned()
+{
+    // High-bit chars must add as 128..255, not as negative values
+    const char   sz[] = { '\xF0', '\x20' };
+    const uint8_t a[] = { 0xF0,    0x20    };
+    TEST_ASSERT_EQUAL_HEX8(sum8(a, 2), sum8(sz, 2));
+    TEST_ASSERT_EQUAL_HEX8(0x10, sum8(sz, 2));
+}
+
+// ============================================================================
+// Slicing-by-4 vs reference
+// ============================================================================
+
+void test_crc32_matches_reference_all_lengths_and_offsets()
+{
+    std::mt19937 rng(3);
+    std::vector<uint8_t> buf(600);
+    for (auto & b : buf) b = static_cast<uint8_t>(rng());
+
+    for (size_t uOffset = 0; uOffset < 4; uOffset++)
+        for (size_t uLen = 0; uLen < 300; uLen++)
+            TEST_ASSERT_EQUAL_HEX32(referenceCrc32(buf.data() + uOffset, uLen),
+                                    crc32(buf.data() + uOffset, uLen));
+}
+
+void test_crc32_continues_across_calls()
+{
+    std::vector<uint8_t> buf(257);
+    for (size_t i = 0; i < buf.size(); i++) buf[i] = static_cast<uint8_t>(i * 31);
+
+    uint32_t uWhole = crc32(buf.data(), buf.size());
+    for (size_t uSplit = 0; uSplit <= buf.size(); uSplit += 7)
+        TEST_ASSERT_EQUAL_HEX32(uWhole, crc32(buf.data() + uSplit, buf.size() - uSplit,
+                                              crc32(buf.data(), uSplit)));
+}
+
+void test_crc32_detects_single_bit_errors()
+{
+    std::vector<uint8_t> msg(40, 0x5A);
+    uint32_t uGood = crc32(msg.data(), msg.size());
+
+    for (size_t i = 0; i < msg.size() * 8; i++) {
+        msg[i / 8] ^= static_cast<uint8_t>(1 << (i % 8));
+        TEST_ASSERT_NOT_EQUAL(uGood, crc32(msg.data(), msg.size()));
+        msg[i / 8] ^= static_cast<uint8_t>(1 << (i % 8));
+    }
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+// Classic one-table, one-byte-per-step CRC-32 for the benchmark
+static uint32_t bytewiseCrc32(const uint8_t * p, size_t uLen)
+{
+    static uint32_t aTable[256];
+    if (aTable[1] == 0)
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : (c >> 1);
+            aTable[i] = c;
+        }
+
+    uint32_t uCrc = 0xFFFFFFFFu;
+    while (uLen--)
+        uCrc = (uCrc >> 8) ^ aTable[(uCrc ^ *p++) & 0xFF];
+    return ~uCrc;
+}
+
+void test_benchmark_throughput()
+{
+    std::vector<uint8_t> buf(4096);
+    for (size_t i = 0; i < buf.size(); i++) buf[i] = static_cast<uint8_t>(i * 7 + 3);
+
+    const int kReps = 2000;
+    volatile uint32_t uSink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++) uSink = uSink + bytewiseCrc32(buf.data(), buf.size());
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++) uSink = uSink + crc32(buf.data(), buf.size());
+    auto t2 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++) uSink = uSink + crc16Ccitt(buf.data(), buf.size());
+    auto t3 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++) uSink = uSink + sum8(buf.data(), buf.size());
+    auto t4 = std::chrono::steady_clock::now();
+
+    auto mbs = [&](auto a, auto b) {
+        return buf.size() * kReps / std::chrono::duration<double>(b - a).count() / 1e6;
+    };
+    char szMsg[160];
+    snprintf(szMsg, sizeof(szMsg), "CRC-32 bytewise %.0f MB/s, slicing-by-4 %.0f MB/s; CRC-16 %.0f MB/s; sum8 %.0f MB/s",
+             mbs(t0, t1), mbs(t1, t2), mbs(t2, t3), mbs(t3, t4));
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(uSink != 0);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Known vectors
+    RUN_TEST(test_crc32_check_value);
+    RUN_TEST(test_crc32_empty_and_fox);
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_crc8_maxim_check_value);
+    RUN_TEST(test_sum8_wraps_to_low_byte);
+    RUN_TEST(test_sum8_char_overload_treats_bytes_unsigned);
+
+    // Slicing-by-4 vs reference
+    RUN_TEST(test_crc32_matches_reference_all_lengths_and_offsets);
+    RUN_TEST(test_crc32_continues_across_calls);
+    RUN_TEST(test_crc32_detects_single_bit_errors);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_throughput);
+#endif
+
+    return UNITY_END();
+}
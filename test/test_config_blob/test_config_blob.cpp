@@ -0,0 +1,269 @@
+// test_config_blob.cpp - Unit tests for the binary config cache format
+
+#include <unity.h>
+#include <ConfigBlob.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct TestConfig {
+    int             iAoaSmoothing;
+    unsigned        uVnoChimeInterval;
+    float           fPStaticBias;
+    bool            bSdLogging;
+    std::string     sEfisType;
+    std::string     sReplayLogFileName;
+};
+
+using Field = ConfigField<TestConfig, std::string>;
+
+static const Field kFields[] = {
+    Field::Int   (nullptr, "AOA_SMOOTHING",     "AOA_SMOOTHING",      &TestConfig::iAoaSmoothing),
+    Field::Custom(nullptr, "FLAP_POSITION"),
+    Field::UInt  ("VNO",   "CHIME_INTERVAL",    "VNO_CHIME_INTERVAL", &TestConfig::uVnoChimeInterval),
+    Field::Float ("BIAS",  "PSTATIC",           "PSTATIC_BIAS",       &TestConfig::fPStaticBias),
+    Field::Bool  (nullptr, "SDLOGGING",         "SDLOGGING",          &TestConfig::bSdLogging),
+    Field::Str   (nullptr, "EFISTYPE",          "EFISTYPE",           &TestConfig::sEfisType),
+    Field::Str   (nullptr, "REPLAYLOGFILENAME", "REPLAYLOGFILENAME",  &TestConfig::sReplayLogFileName),
+};
+static const size_t kFieldCount = sizeof(kFields) / sizeof(kFields[0]);
+
+static const uint16_t kVersion = 3;
+
+static TestConfig sample()
+{
+    TestConfig cfg;
+    cfg.iAoaSmoothing      = -15;
+    cfg.uVnoChimeInterval  = 180;
+    cfg.fPStaticBias       = -0.7496f;
+    cfg.bSdLogging         = true;
+    cfg.sEfisType          = "ADVANCED";
+    cfg.sReplayLogFileName = "";
+    return cfg;
+}
+
+// Blob of cfg with a custom section (flap count and degrees) after the table items
+static std::vector<uint8_t> makeBlob(const TestConfig & cfg, uint32_t uStamp)
+{
+    std::vector<uint8_t> blob(512);
+    BlobWriter out(blob.data() + kConfigBlobHeaderLen, blob.size() - kConfigBlobHeaderLen);
+    saveConfigFieldsBinary(kFields, kFieldCount, cfg, out);
+    out.putU8(2);
+    out.putI32(0);
+    out.putI32(20);
+    TEST_ASSERT_TRUE(out.ok());
+
+    blob.resize(sealConfigBlob(blob.data(), out.size(), kVersion,
+                               configFieldsLayout(kFields, kFieldCount), uStamp));
+    return blob;
+}
+
+// ============================================================================
+// Writer / reader
+// ============================================================================
+
+void test_writer_reader_round_trip()
+{
+    uint8_t    aBuf[64];
+    BlobWriter out(aBuf, sizeof(aBuf));
+    out.putU8(0xAB);
+    out.putU16(0x1234);
+    out.putU32(0xDEADBEEF);
+    out.putI32(-5);
+    out.putFloat(3.25f);
+    out.putBool(true);
+    out.putString("VN-300");
+    TEST_ASSERT_TRUE(out.ok());
+    TEST_ASSERT_EQUAL_size_t(1 + 2 + 4 + 4 + 4 + 1 + 2 + 6, out.size());
+
+    // Little-endian on the wire regardless of host
+    TEST_ASSERT_EQUAL_HEX8(0x34, aBuf[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, aBuf[3]);
+
+    BlobReader in(aBuf, out.size());
+    char       sz[16];
+    TEST_ASSERT_EQUAL_HEX8(0xAB, in.getU8());
+    TEST_ASSERT_EQUAL_HEX16(0x1234, in.getU16());
+    TEST_ASSERT_EQUAL_HEX32(0xDEADBEEF, in.getU32());
+    TEST_ASSERT_EQUAL_INT32(-5, in.getI32());
+    TEST_ASSERT_TRUE(in.getFloat() == 3.25f);
+    TEST_ASSERT_TRUE(in.getBool());
+    TEST_ASSERT_EQUAL_size_t(6, in.getString(sz, sizeof(sz)));
+    TEST_ASSERT_EQUAL_STRING("VN-300", sz);
+    TEST_ASSERT_TRUE(in.ok());
+    TEST_ASSERT_TRUE(in.atEnd());
+
+    // Past the end
+    TEST_ASSERT_EQUAL_UINT32(0, in.getU32());
+    TEST_ASSERT_FALSE(in.ok());
+}
+
+void test_writer_overflow_and_long_string()
+{
+    uint8_t    aBuf[8];
+    BlobWriter out(aBuf, sizeof(aBuf));
+    out.putU32(1);
+    out.putString("too long");
+    TEST_ASSERT_FALSE(out.ok());
+    out.putU8(1);                           // Stays failed, writes nothing
+    TEST_ASSERT_FALSE(out.ok());
+    TEST_ASSERT_TRUE(out.size() <= sizeof(aBuf));
+
+    // String longer than the reader's buffer
+    uint8_t    aBig[32];
+    BlobWriter big(aBig, sizeof(aBig));
+    big.putString("0123456789");
+    BlobReader in(aBig, big.size());
+    char       sz[8];
+    TEST_ASSERT_EQUAL_size_t(0, in.getString(sz, sizeof(sz)));
+    TEST_ASSERT_FALSE(in.ok());
+    TEST_ASSERT_EQUAL_STRING("", sz);
+}
+
+// ============================================================================
+// Blob
+// ============================================================================
+
+void test_blob_round_trip()
+{
+    const TestConfig            src  = sample();
+    const std::vector<uint8_t>  blob = makeBlob(src, 0x12345678);
+
+    ConfigBlobInfo info;
+    TEST_ASSERT_EQUAL(ConfigBlobResult::Ok,
+        openConfigBlob(blob.data(), blob.size(), kVersion, configFieldsLayout(kFields, kFieldCount), info));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, info.uSourceStamp);
+    TEST_ASSERT_EQUAL_size_t(blob.size() - kConfigBlobHeaderLen, info.uPayloadLen);
+
+    TestConfig dst = {};
+    dst.sReplayLogFileName = "stale";
+    BlobReader in(info.pPayload, info.uPayloadLen);
+    loadConfigFieldsBinary(kFields, kFieldCount, dst, in);
+    TEST_ASSERT_TRUE(in.ok());
+    TEST_ASSERT_EQUAL_INT(-15, dst.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_UINT(180, dst.uVnoChimeInterval);
+    TEST_ASSERT_TRUE(dst.fPStaticBias == src.fPStaticBias);   // Bit exact
+    TEST_ASSERT_TRUE(dst.bSdLogging);
+    TEST_ASSERT_EQUAL_STRING("ADVANCED", dst.sEfisType.c_str());
+    TEST_ASSERT_EQUAL_STRING("", dst.sReplayLogFileName.c_str());
+
+    // Custom section follows
+    TEST_ASSERT_EQUAL_UINT8(2, in.getU8());
+    TEST_ASSERT_EQUAL_INT32(0, in.getI32());
+    TEST_ASSERT_EQUAL_INT32(20, in.getI32());
+    TEST_ASSERT_TRUE(in.ok());
+    TEST_ASSERT_TRUE(in.atEnd());
+}
+
+void test_every_single_byte_corruption_detected()
+{
+    const std::vector<uint8_t> good   = makeBlob(sample(), 7);
+    const uint32_t             uLayout = configFieldsLayout(kFields, kFieldCount);
+
+    for (size_t i = 0; i < good.size(); i++) {
+        for (uint8_t uFlip : { uint8_t(0x01), uint8_t(0x80), uint8_t(0xFF) }) {
+            std::vector<uint8_t> bad = good;
+            bad[i] ^= uFlip;
+            ConfigBlobInfo info;
+            TEST_ASSERT_TRUE(openConfigBlob(bad.data(), bad.size(), kVersion, uLayout, info) != ConfigBlobResult::Ok);
+        }
+    }
+}
+
+void test_truncated_and_foreign_rejected()
+{
+    const std::vector<uint8_t> good    = makeBlob(sample(), 7);
+    const uint32_t             uLayout = configFieldsLayout(kFields, kFieldCount);
+    ConfigBlobInfo             info;
+
+    TEST_ASSERT_EQUAL(ConfigBlobResult::TooShort, openConfigBlob(good.data(), 0, kVersion, uLayout, info));
+    TEST_ASSERT_EQUAL(ConfigBlobResult::TooShort, openConfigBlob(good.data(), kConfigBlobHeaderLen - 1, kVersion, uLayout, info));
+    TEST_ASSERT_EQUAL(ConfigBlobResult::TooShort, openConfigBlob(good.data(), good.size() - 1, kVersion, uLayout, info));
+
+    // Trailing junk after a good blob is ignored (file written over a longer one)
+    std::vector<uint8_t> longer = good;
+    longer.push_back(0x55);
+    TEST_ASSERT_EQUAL(ConfigBlobResult::Ok, openConfigBlob(longer.data(), longer.size(), kVersion, uLayout, info));
+
+    // Text config where a blob should be
+    const char * szText = "<CONFIG2><VNO><SPEED>158</SPEED></VNO></CONFIG2>";
+    TEST_ASSERT_EQUAL(ConfigBlobResult::BadMagic,
+        openConfigBlob(reinterpret_cast<const uint8_t *>(szText), std::strlen(szText), kVersion, uLayout, info));
+
+    // Erased flash
+    std::vector<uint8_t> erased(64, 0xFF);
+    TEST_ASSERT_EQUAL(ConfigBlobResult::BadMagic, openConfigBlob(erased.data(), erased.size(), kVersion, uLayout, info));
+}
+
+void test_version_and_layout_checked()
+{
+    const std::vector<uint8_t> good    = makeBlob(sample(), 7);
+    const uint32_t             uLayout = configFieldsLayout(kFields, kFieldCount);
+    ConfigBlobInfo             info;
+
+    TEST_ASSERT_EQUAL(ConfigBlobResult::WrongVersion, openConfigBlob(good.data(), good.size(), kVersion + 1, uLayout, info));
+    TEST_ASSERT_EQUAL(ConfigBlobResult::WrongLayout,  openConfigBlob(good.data(), good.size(), kVersion, uLayout ^ 1, info));
+
+    // Any table change moves the layout hash: retype, rename, reorder, add
+    Field aRetyped[kFieldCount];
+    std::memcpy(static_cast<void *>(aRetyped), kFields, sizeof(kFields));
+    aRetyped[2] = Field::Int("VNO", "CHIME_INTERVAL", "VNO_CHIME_INTERVAL", &TestConfig::iAoaSmoothing);
+    TEST_ASSERT_NOT_EQUAL(uLayout, configFieldsLayout(aRetyped, kFieldCount));
+
+    Field aRenamed[kFieldCount];
+    std::memcpy(static_cast<void *>(aRenamed), kFields, sizeof(kFields));
+    aRenamed[4] = Field::Bool(nullptr, "SD_LOGGING", "SDLOGGING", &TestConfig::bSdLogging);
+    TEST_ASSERT_NOT_EQUAL(uLayout, configFieldsLayout(aRenamed, kFieldCount));
+
+    Field aMoved[kFieldCount];
+    std::memcpy(static_cast<void *>(aMoved), kFields, sizeof(kFields));
+    aMoved[3] = Field::Float("LOAD_LIMIT", "PSTATIC", "PSTATIC_BIAS", &TestConfig::fPStaticBias);
+    TEST_ASSERT_NOT_EQUAL(uLayout, configFieldsLayout(aMoved, kFieldCount));
+
+    TEST_ASSERT_NOT_EQUAL(uLayout, configFieldsLayout(kFields, kFieldCount - 1));
+}
+
+void test_short_payload_leaves_config_untouched()
+{
+    const TestConfig            src  = sample();
+    const std::vector<uint8_t>  blob = makeBlob(src, 7);
+    ConfigBlobInfo              info;
+    TEST_ASSERT_EQUAL(ConfigBlobResult::Ok,
+        openConfigBlob(blob.data(), blob.size(), kVersion, configFieldsLayout(kFields, kFieldCount), info));
+
+    // Payload cut inside the last string
+    TestConfig dst = {};
+    dst.iAoaSmoothing = 99;
+    dst.sEfisType     = "VN-300";
+    BlobReader in(info.pPayload, 4 + 4 + 4 + 1 + 2 + 3);
+    loadConfigFieldsBinary(kFields, kFieldCount, dst, in);
+    TEST_ASSERT_FALSE(in.ok());
+    TEST_ASSERT_EQUAL_INT(99, dst.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_STRING("VN-300", dst.sEfisType.c_str());
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Writer / reader
+    RUN_TEST(test_writer_reader_round_trip);
+    RUN_TEST(test_writer_overflow_and_long_string);
+
+    // Blob
+    RUN_TEST(test_blob_round_trip);
+    RUN_TEST(test_every_single_byte_corruption_detected);
+    RUN_TEST(test_truncated_and_foreign_rejected);
+    RUN_TEST(test_version_and_layout_checked);
+    RUN_TEST(test_short_payload_leaves_config_untouched);
+
+    return UNITY_END();
+}
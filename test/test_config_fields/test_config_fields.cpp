@@ -0,0 +1,513 @@
+// test_config_fields.cpp - Unit tests for the config XML index and field table
+
+#include <unity.h>
+#include <ConfigFields.h>
+#include <ConfigXml.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// software/OnSpeed-Gen3-ESP32/onspeed.cfg.txt
+static const char kOnSpeedCfg[] = R"=====(<CONFIG>
+<AOA_SMOOTHING>15</AOA_SMOOTHING>
+<PRESSURE_SMOOTHING>15</PRESSURE_SMOOTHING>
+<DATASOURCE>SENSORS</DATASOURCE>
+<REPLAYLOGFILENAME>log.csv</REPLAYLOGFILENAME>
+<FLAPDEGREES>0,15,30</FLAPDEGREES>
+<FLAPPOTPOSITIONS>675,391,191</FLAPPOTPOSITIONS>
+<VOLUMECONTROL>0</VOLUMECONTROL>
+<VOLUME_HIGH_ANALOG>1023</VOLUME_HIGH_ANALOG>
+<VOLUME_LOW_ANALOG>1</VOLUME_LOW_ANALOG>
+<VOLUME_DEFAULT>100</VOLUME_DEFAULT>
+<3DAUDIO>0</3DAUDIO>
+<MUTE_AUDIO_UNDER_IAS>35</MUTE_AUDIO_UNDER_IAS>
+<OVERGWARNING>1</OVERGWARNING>
+<SETPOINT_LDMAXAOA>4.7000,2.0100,0.1100</SETPOINT_LDMAXAOA>
+<SETPOINT_ONSPEEDFASTAOA>5.0800,4.6700,2.4300</SETPOINT_ONSPEEDFASTAOA>
+<SETPOINT_ONSPEEDSLOWAOA>6.6000,5.8700,4.0600</SETPOINT_ONSPEEDSLOWAOA>
+<SETPOINT_STALLWARNAOA>9.3000,8.9100,9.6000</SETPOINT_STALLWARNAOA>
+<SETPOINT_STALLAOA>0.0000,0.0000,0.0000</SETPOINT_STALLAOA>
+<SETPOINT_MANAOA>0.0000,0.0000,0.0000</SETPOINT_MANAOA>
+<AOA_CURVE_FLAPS0>0.0000,16.6730,24.0610,3.6653,1</AOA_CURVE_FLAPS0>
+<AOA_CURVE_FLAPS1>0.0000,-21.7420,30.7340,2.5950,1</AOA_CURVE_FLAPS1>
+<AOA_CURVE_FLAPS2>0.0000,-16.3760,38.3270,-0.8061,1</AOA_CURVE_FLAPS2>
+<CAS_CURVE>0.0000,0.0000,0.9697,4.6449,1</CAS_CURVE>
+<CAS_ENABLED>1</CAS_ENABLED>
+<PORTS_ORIENTATION>DOWN</PORTS_ORIENTATION>
+<BOX_TOP_ORIENTATION>AFT</BOX_TOP_ORIENTATION>
+<EFISTYPE>ADVANCED</EFISTYPE>
+<CALWIZ_SOURCE>EFIS</CALWIZ_SOURCE>
+<PFWD_BIAS>8131</PFWD_BIAS>
+<P45_BIAS>8141</P45_BIAS>
+<PSTATIC_BIAS>-0.7496</PSTATIC_BIAS>
+<GX_BIAS>0.0744</GX_BIAS>
+<GY_BIAS>-0.5889</GY_BIAS>
+<GZ_BIAS>1.5668</GZ_BIAS>
+<PITCH_BIAS>6.7665</PITCH_BIAS>
+<ROLL_BIAS>0.3815</ROLL_BIAS>
+<BOOM>0</BOOM>
+<SERIALEFISDATA>0</SERIALEFISDATA>
+<LOADLIMITPOSITIVE>2.50</LOADLIMITPOSITIVE>
+<LOADLIMITNEGATIVE>-1.00</LOADLIMITNEGATIVE>
+<VNO>158</VNO>
+<VNO_CHIME_INTERVAL>180</VNO_CHIME_INTERVAL>
+<VNO_CHIME_ENABLED>1</VNO_CHIME_ENABLED>
+<SERIALOUTFORMAT>ONSPEED</SERIALOUTFORMAT>
+<SERIALOUTPORT>Serial1</SERIALOUTPORT>
+<SDLOGGING>1</SDLOGGING>
+</CONFIG>)=====";
+
+// The same aircraft as ConfigurationToString() writes it (tinyxml2 printer)
+static const char kOnSpeedCfg2[] = R"=====(<CONFIG2>
+    <AOA_SMOOTHING>15</AOA_SMOOTHING>
+    <PRESSURE_SMOOTHING>15</PRESSURE_SMOOTHING>
+    <LOOP_RATE>100</LOOP_RATE>
+    <DATASOURCE>SENSORS</DATASOURCE>
+    <REPLAYLOGFILENAME>log.csv</REPLAYLOGFILENAME>
+    <FLAP_POSITION>
+        <DEGREES>0</DEGREES>
+        <POT_VALUE>675</POT_VALUE>
+        <LDMAXAOA>4.6999998</LDMAXAOA>
+        <AOA_CURVE>
+            <TYPE>1</TYPE>
+            <X3>0</X3>
+        </AOA_CURVE>
+    </FLAP_POSITION>
+    <FLAP_POSITION>
+        <DEGREES>15</DEGREES>
+        <POT_VALUE>391</POT_VALUE>
+        <LDMAXAOA>2.01</LDMAXAOA>
+        <AOA_CURVE>
+            <TYPE>1</TYPE>
+            <X3>0</X3>
+        </AOA_CURVE>
+    </FLAP_POSITION>
+    <VOLUME>
+        <ENABLED>false</ENABLED>
+        <HIGH_ANALOG>1023</HIGH_ANALOG>
+        <MUTE_UNDER_IAS>35</MUTE_UNDER_IAS>
+    </VOLUME>
+    <OVERGWARNING>true</OVERGWARNING>
+    <CAS_CURVE>
+        <TYPE>1</TYPE>
+        <ENABLED>true</ENABLED>
+    </CAS_CURVE>
+    <ORIENTATION>
+        <PORTS>DOWN</PORTS>
+        <BOX_TOP>AFT</BOX_TOP>
+    </ORIENTATION>
+    <EFISTYPE>ADVANCED</EFISTYPE>
+    <BIAS>
+        <PFWD>8131</PFWD>
+        <PSTATIC>0.74959999</PSTATIC>
+    </BIAS>
+    <LOAD_LIMIT>
+        <POSITIVE>2.5</POSITIVE>
+    </LOAD_LIMIT>
+    <VNO>
+        <SPEED>158</SPEED>
+        <CHIME_INTERVAL>180</CHIME_INTERVAL>
+        <CHIME_ENABLED>true</CHIME_ENABLED>
+    </VNO>
+    <SDLOGGING>true</SDLOGGING>
+</CONFIG2>
+)=====";
+
+// A cut-down FOSConfig
+struct TestConfig {
+    int             iAoaSmoothing;
+    int             iLoopRateHz;
+    int             iMuteAudioUnderIAS;
+    std::string     sReplayLogFileName;
+    bool            bVolumeControl;
+    int             iVolumeHighAnalog;
+    bool            bOverGWarning;
+    bool            bCasCurveEnabled;
+    std::string     sPortsOrientation;
+    std::string     sEfisType;
+    int             iPFwdBias;
+    float           fPStaticBias;
+    float           fLoadLimitPositive;
+    int             iVno;
+    unsigned        uVnoChimeInterval;
+    bool            bVnoChimeEnabled;
+    bool            bSdLogging;
+};
+
+using Field = ConfigField<TestConfig, std::string>;
+
+static const Field kFields[] = {
+    Field::Int   (nullptr,       "AOA_SMOOTHING",     "AOA_SMOOTHING",        &TestConfig::iAoaSmoothing),
+    Field::Int   (nullptr,       "LOOP_RATE",         nullptr,                &TestConfig::iLoopRateHz),     // CONFIG2 only
+    Field::Custom(nullptr,       "DATASOURCE"),
+    Field::Str   (nullptr,       "REPLAYLOGFILENAME", "REPLAYLOGFILENAME",    &TestConfig::sReplayLogFileName),
+    Field::Custom(nullptr,       "FLAP_POSITION"),
+    Field::Bool  ("VOLUME",      "ENABLED",           "VOLUMECONTROL",        &TestConfig::bVolumeControl),
+    Field::Int   ("VOLUME",      "HIGH_ANALOG",       "VOLUME_HIGH_ANALOG",   &TestConfig::iVolumeHighAnalog),
+    Field::Int   ("VOLUME",      "MUTE_UNDER_IAS",    "MUTE_AUDIO_UNDER_IAS", &TestConfig::iMuteAudioUnderIAS),
+    Field::Bool  (nullptr,       "OVERGWARNING",      "OVERGWARNING",         &TestConfig::bOverGWarning),
+    Field::Bool  ("CAS_CURVE",   "ENABLED",           "CAS_ENABLED",          &TestConfig::bCasCurveEnabled),
+    Field::Str   ("ORIENTATION", "PORTS",             "PORTS_ORIENTATION",    &TestConfig::sPortsOrientation),
+    Field::Str   (nullptr,       "EFISTYPE",          "EFISTYPE",             &TestConfig::sEfisType),
+    Field::Int   ("BIAS",        "PFWD",              "PFWD_BIAS",            &TestConfig::iPFwdBias),
+    Field::Float ("BIAS",        "PSTATIC",           "PSTATIC_BIAS",         &TestConfig::fPStaticBias),
+    Field::Float ("LOAD_LIMIT",  "POSITIVE",          "LOADLIMITPOSITIVE",    &TestConfig::fLoadLimitPositive),
+    Field::Int   ("VNO",         "SPEED",             "VNO",                  &TestConfig::iVno),
+    Field::UInt  ("VNO",         "CHIME_INTERVAL",    "VNO_CHIME_INTERVAL",   &TestConfig::uVnoChimeInterval),
+    Field::Bool  ("VNO",         "CHIME_ENABLED",     "VNO_CHIME_ENABLED",    &TestConfig::bVnoChimeEnabled),
+    Field::Bool  (nullptr,       "SDLOGGING",         "SDLOGGING",            &TestConfig::bSdLogging),
+};
+static const size_t kFieldCount = sizeof(kFields) / sizeof(kFields[0]);
+
+static TestConfig defaults()
+{
+    TestConfig cfg;
+    cfg.iAoaSmoothing      = 20;
+    cfg.iLoopRateHz        = 50;
+    cfg.iMuteAudioUnderIAS = 30;
+    cfg.sReplayLogFileName = "";
+    cfg.bVolumeControl     = true;
+    cfg.iVolumeHighAnalog  = 4095;
+    cfg.bOverGWarning      = false;
+    cfg.bCasCurveEnabled   = false;
+    cfg.sPortsOrientation  = "FORWARD";
+    cfg.sEfisType          = "VN-300";
+    cfg.iPFwdBias          = 2048;
+    cfg.fPStaticBias       = 0.0f;
+    cfg.fLoadLimitPositive = 4.0f;
+    cfg.iVno               = 150;
+    cfg.uVnoChimeInterval  = 3;
+    cfg.bVnoChimeEnabled   = false;
+    cfg.bSdLogging         = false;
+    return cfg;
+}
+
+static bool parse(ConfigXml & xml, const char * sz)
+{
+    return xml.parse(sz, std::strlen(sz));
+}
+
+static std::string textOf(const ConfigXml & xml, int16_t iElem)
+{
+    char sz[kConfigMaxString];
+    xml.copyText(iElem, sz, sizeof(sz));
+    return sz;
+}
+
+// ============================================================================
+// Index
+// ============================================================================
+
+void test_v1_file_indexed_flat()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml, kOnSpeedCfg));
+
+    // Root plus one element per line
+    TEST_ASSERT_EQUAL_UINT16(47, xml.size());
+    TEST_ASSERT_TRUE(xml.name(xml.root()).equals("CONFIG"));
+
+    TEST_ASSERT_EQUAL_STRING("0,15,30", textOf(xml, xml.firstChild(xml.root(), "FLAPDEGREES")).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.0000,-16.3760,38.3270,-0.8061,1",
+                             textOf(xml, xml.firstChild(xml.root(), "AOA_CURVE_FLAPS2")).c_str());
+    TEST_ASSERT_EQUAL_STRING("1", textOf(xml, xml.firstChild(xml.root(), "SDLOGGING")).c_str());
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.firstChild(xml.root(), "FLAPDEGREE"));
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.firstChild(xml.root(), "NOT_THERE"));
+}
+
+void test_config2_sections_and_repeats()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml, kOnSpeedCfg2));
+    TEST_ASSERT_TRUE(xml.name(xml.root()).equals("CONFIG2"));
+
+    // FLAP_POSITION blocks in file order, each with its own AOA_CURVE
+    int16_t iFlap = xml.firstChild(xml.root(), "FLAP_POSITION");
+    int     iDeg  = -1;
+    TEST_ASSERT_TRUE(xml.getInt(xml.firstChild(iFlap, "DEGREES"), iDeg));
+    TEST_ASSERT_EQUAL_INT(0, iDeg);
+
+    iFlap = xml.nextSibling(iFlap, "FLAP_POSITION");
+    TEST_ASSERT_TRUE(xml.getInt(xml.firstChild(iFlap, "DEGREES"), iDeg));
+    TEST_ASSERT_EQUAL_INT(15, iDeg);
+    int iType = 0;
+    TEST_ASSERT_TRUE(xml.getInt(xml.firstChild(xml.firstChild(iFlap, "AOA_CURVE"), "TYPE"), iType));
+    TEST_ASSERT_EQUAL_INT(1, iType);
+
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.nextSibling(iFlap, "FLAP_POSITION"));
+
+    // A section's children don't leak into the root
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.firstChild(xml.root(), "DEGREES"));
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.firstChild(xml.root(), "ENABLED"));
+}
+
+void test_markup_skipped_and_entities_decoded()
+{
+    static ConfigXml xml;
+    const char * sz =
+        "<?xml version=\"1.0\"?>\n"
+        "<!-- saved by hand -->\n"
+        "<CONFIG2 version=\"2\">\n"
+        "  <!-- <AOA_SMOOTHING>99</AOA_SMOOTHING> -->\n"
+        "  <AOA_SMOOTHING> 12 </AOA_SMOOTHING>\n"
+        "  <REPLAYLOGFILENAME>a&amp;b &lt;1&gt; &quot;x&apos; &bogus;</REPLAYLOGFILENAME>\n"
+        "  <EMPTY/>\n"
+        "  <BIAS><PSTATIC>-1.25</PSTATIC></BIAS>\n"
+        "</CONFIG2>\n";
+    TEST_ASSERT_TRUE(parse(xml, sz));
+
+    int iValue = 0;
+    TEST_ASSERT_TRUE(xml.getInt(xml.firstChild(xml.root(), "AOA_SMOOTHING"), iValue));
+    TEST_ASSERT_EQUAL_INT(12, iValue);
+    TEST_ASSERT_EQUAL_STRING("a&b <1> \"x' &bogus;",
+                             textOf(xml, xml.firstChild(xml.root(), "REPLAYLOGFILENAME")).c_str());
+
+    const int16_t iEmpty = xml.firstChild(xml.root(), "EMPTY");
+    TEST_ASSERT_NOT_EQUAL(ConfigXml::kNone, iEmpty);
+    TEST_ASSERT_EQUAL_UINT16(0, xml.text(iEmpty).uLen);
+    TEST_ASSERT_FALSE(xml.getInt(iEmpty, iValue));
+
+    float fValue = 0.0f;
+    TEST_ASSERT_TRUE(xml.getFloat(xml.firstChild(xml.firstChild(xml.root(), "BIAS"), "PSTATIC"), fValue));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -1.25f, fValue);
+
+    // Truncation keeps the output terminated
+    char szShort[4];
+    TEST_ASSERT_EQUAL_size_t(3, xml.copyText(xml.firstChild(xml.root(), "REPLAYLOGFILENAME"), szShort, sizeof(szShort)));
+    TEST_ASSERT_EQUAL_STRING("a&b", szShort);
+}
+
+void test_malformed_rejected()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_FALSE(parse(xml, ""));
+    TEST_ASSERT_FALSE(parse(xml, "no markup at all"));
+    TEST_ASSERT_FALSE(parse(xml, "<CONFIG><VNO>158</VN0></CONFIG>"));
+    TEST_ASSERT_FALSE(parse(xml, "<CONFIG><VNO>158</VNO>"));
+    TEST_ASSERT_FALSE(parse(xml, "<CONFIG></CONFIG><CONFIG2></CONFIG2>"));
+    TEST_ASSERT_FALSE(parse(xml, "<CONFIG><VNO>158</VNO></CONFIG></CONFIG>"));
+    TEST_ASSERT_EQUAL_UINT16(0, xml.size());
+    TEST_ASSERT_EQUAL_INT16(ConfigXml::kNone, xml.root());
+
+    // Too deep
+    TEST_ASSERT_FALSE(parse(xml, "<a><b><c><d><e><f><g><h><i>1</i></h></g></f></e></d></c></b></a>"));
+
+    // Too many elements
+    std::string sBig = "<CONFIG2>";
+    for (int i = 0; i < ConfigXml::kMaxElements; i++)
+        sBig += "<X>1</X>";
+    sBig += "</CONFIG2>";
+    TEST_ASSERT_FALSE(xml.parse(sBig.data(), sBig.size()));
+
+    // Trailing whitespace after the root is fine
+    TEST_ASSERT_TRUE(parse(xml, "<CONFIG><VNO>158</VNO></CONFIG>\r\n\r\n"));
+}
+
+void test_value_conversions()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml,
+        "<R><A>true</A><B>FALSE</B><C>0</C><D>7</D><E>yes</E><F>-3</F><G>abc</G><H>2.5e1</H></R>"));
+    const int16_t r = xml.root();
+
+    bool b = false;
+    TEST_ASSERT_TRUE(xml.getBool(xml.firstChild(r, "A"), b));  TEST_ASSERT_TRUE(b);
+    TEST_ASSERT_TRUE(xml.getBool(xml.firstChild(r, "B"), b));  TEST_ASSERT_FALSE(b);
+    TEST_ASSERT_TRUE(xml.getBool(xml.firstChild(r, "D"), b));  TEST_ASSERT_TRUE(b);
+    TEST_ASSERT_TRUE(xml.getBool(xml.firstChild(r, "C"), b));  TEST_ASSERT_FALSE(b);
+    b = true;
+    TEST_ASSERT_FALSE(xml.getBool(xml.firstChild(r, "E"), b)); TEST_ASSERT_TRUE(b);
+
+    unsigned u = 99;
+    TEST_ASSERT_FALSE(xml.getUnsigned(xml.firstChild(r, "F"), u));
+    TEST_ASSERT_EQUAL_UINT(99, u);
+
+    int i = 99;
+    TEST_ASSERT_FALSE(xml.getInt(xml.firstChild(r, "G"), i));
+    TEST_ASSERT_FALSE(xml.getInt(xml.firstChild(r, "MISSING"), i));
+    TEST_ASSERT_EQUAL_INT(99, i);
+
+    float f = 0.0f;
+    TEST_ASSERT_TRUE(xml.getFloat(xml.firstChild(r, "H"), f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 25.0f, f);
+}
+
+// ============================================================================
+// Field table
+// ============================================================================
+
+void test_load_v1_onspeed_cfg()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml, kOnSpeedCfg));
+
+    TestConfig cfg = defaults();
+    TEST_ASSERT_EQUAL_size_t(kFieldCount - 3, loadConfigFieldsV1(xml, kFields, kFieldCount, cfg));
+
+    TEST_ASSERT_EQUAL_INT(15, cfg.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_INT(35, cfg.iMuteAudioUnderIAS);
+    TEST_ASSERT_EQUAL_STRING("log.csv", cfg.sReplayLogFileName.c_str());
+    TEST_ASSERT_FALSE(cfg.bVolumeControl);
+    TEST_ASSERT_EQUAL_INT(1023, cfg.iVolumeHighAnalog);
+    TEST_ASSERT_TRUE(cfg.bOverGWarning);
+    TEST_ASSERT_TRUE(cfg.bCasCurveEnabled);
+    TEST_ASSERT_EQUAL_STRING("DOWN", cfg.sPortsOrientation.c_str());
+    TEST_ASSERT_EQUAL_STRING("ADVANCED", cfg.sEfisType.c_str());
+    TEST_ASSERT_EQUAL_INT(8131, cfg.iPFwdBias);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, -0.7496f, cfg.fPStaticBias);  // Firmware negates this for V1
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.5f, cfg.fLoadLimitPositive);
+    TEST_ASSERT_EQUAL_INT(158, cfg.iVno);
+    TEST_ASSERT_EQUAL_UINT(180, cfg.uVnoChimeInterval);
+    TEST_ASSERT_TRUE(cfg.bVnoChimeEnabled);
+    TEST_ASSERT_TRUE(cfg.bSdLogging);
+}
+
+void test_load_v1_missing_items_zeroed()
+{
+    // The old reader set anything missing from a V1 file to 0 / "" / false
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml, "<CONFIG>\n<VNO>140</VNO>\n<SDLOGGING>YES</SDLOGGING>\n</CONFIG>"));
+
+    TestConfig cfg = defaults();
+    TEST_ASSERT_EQUAL_size_t(2, loadConfigFieldsV1(xml, kFields, kFieldCount, cfg));
+    TEST_ASSERT_EQUAL_INT(140, cfg.iVno);
+    TEST_ASSERT_TRUE(cfg.bSdLogging);
+    TEST_ASSERT_EQUAL_INT(0, cfg.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_UINT(0, cfg.uVnoChimeInterval);
+    TEST_ASSERT_EQUAL_STRING("", cfg.sEfisType.c_str());
+    TEST_ASSERT_FALSE(cfg.bVolumeControl);
+
+    // Items with no V1 name keep their defaults
+    TEST_ASSERT_EQUAL_INT(50, cfg.iLoopRateHz);
+}
+
+void test_load_config2()
+{
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml, kOnSpeedCfg2));
+
+    TestConfig cfg = defaults();
+    const size_t uSet = loadConfigFields(xml, kFields, kFieldCount, cfg);
+
+    TEST_ASSERT_EQUAL_size_t(17, uSet);
+    TEST_ASSERT_EQUAL_INT(15, cfg.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_INT(100, cfg.iLoopRateHz);
+    TEST_ASSERT_EQUAL_INT(35, cfg.iMuteAudioUnderIAS);
+    TEST_ASSERT_FALSE(cfg.bVolumeControl);                  // VOLUME/ENABLED
+    TEST_ASSERT_TRUE(cfg.bCasCurveEnabled);                 // CAS_CURVE/ENABLED
+    TEST_ASSERT_EQUAL_STRING("DOWN", cfg.sPortsOrientation.c_str());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.7496f, cfg.fPStaticBias);
+    TEST_ASSERT_EQUAL_UINT(180, cfg.uVnoChimeInterval);
+    TEST_ASSERT_TRUE(cfg.bSdLogging);
+}
+
+void test_load_config2_keeps_defaults()
+{
+    // Missing section, missing item, and an item that doesn't parse
+    static ConfigXml xml;
+    TEST_ASSERT_TRUE(parse(xml,
+        "<CONFIG2><AOA_SMOOTHING>x</AOA_SMOOTHING><VNO><SPEED>140</SPEED></VNO></CONFIG2>"));
+
+    TestConfig cfg = defaults();
+    TEST_ASSERT_EQUAL_size_t(1, loadConfigFields(xml, kFields, kFieldCount, cfg));
+    TEST_ASSERT_EQUAL_INT(140, cfg.iVno);
+    TEST_ASSERT_EQUAL_INT(20, cfg.iAoaSmoothing);
+    TEST_ASSERT_EQUAL_UINT(3, cfg.uVnoChimeInterval);
+    TEST_ASSERT_EQUAL_INT(2048, cfg.iPFwdBias);
+    TEST_ASSERT_EQUAL_STRING("VN-300", cfg.sEfisType.c_str());
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+// What LoadConfigFromString() did for a V1 file: one String copy and a full
+// indexOf scan per item
+static std::string legacyGetConfigValue(std::string sConfig, std::string configName)
+{
+    const size_t uStart = sConfig.find("<"  + configName + ">");
+    const size_t uEnd   = sConfig.find("</" + configName + ">");
+    if (uStart == std::string::npos || uEnd == std::string::npos)
+        return "";
+    return sConfig.substr(uStart + configName.length() + 2, uEnd - uStart - configName.length() - 2);
+}
+
+void test_benchmark_v1_load()
+{
+    static const char * aszV1Names[] = {
+        "AOA_SMOOTHING", "PRESSURE_SMOOTHING", "MUTE_AUDIO_UNDER_IAS", "DATASOURCE", "REPLAYLOGFILENAME",
+        "FLAPDEGREES", "FLAPPOTPOSITIONS", "SETPOINT_LDMAXAOA", "SETPOINT_ONSPEEDFASTAOA",
+        "SETPOINT_ONSPEEDSLOWAOA", "SETPOINT_STALLWARNAOA", "SETPOINT_STALLAOA", "AOA_CURVE_FLAPS0",
+        "AOA_CURVE_FLAPS1", "AOA_CURVE_FLAPS2", "VOLUMECONTROL", "VOLUME_HIGH_ANALOG", "VOLUME_LOW_ANALOG",
+        "VOLUME_DEFAULT", "3DAUDIO", "OVERGWARNING", "CAS_CURVE", "CAS_ENABLED", "PORTS_ORIENTATION",
+        "BOX_TOP_ORIENTATION", "EFISTYPE", "CALWIZ_SOURCE", "PFWD_BIAS", "P45_BIAS", "PSTATIC_BIAS",
+        "GX_BIAS", "GY_BIAS", "GZ_BIAS", "PITCH_BIAS", "ROLL_BIAS", "BOOM", "SERIALEFISDATA",
+        "SERIALOUTFORMAT", "LOADLIMITPOSITIVE", "LOADLIMITNEGATIVE", "VNO", "VNO_CHIME_INTERVAL",
+        "VNO_CHIME_ENABLED", "SDLOGGING",
+    };
+    const size_t    uNames = sizeof(aszV1Names) / sizeof(aszV1Names[0]);
+    const int       kReps  = 2000;
+    const std::string sCfg = kOnSpeedCfg;
+
+    size_t uSink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++)
+        for (size_t i = 0; i < uNames; i++)
+            uSink += legacyGetConfigValue(sCfg, aszV1Names[i]).size();
+    auto t1 = std::chrono::steady_clock::now();
+
+    static ConfigXml xml;
+    for (int r = 0; r < kReps; r++) {
+        xml.parse(sCfg.data(), sCfg.size());
+        for (size_t i = 0; i < uNames; i++) {
+            char sz[kConfigMaxString];
+            uSink += xml.copyText(xml.firstChild(xml.root(), aszV1Names[i]), sz, sizeof(sz));
+        }
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto us = [&](auto a, auto b) { return std::chrono::duration<double, std::micro>(b - a).count() / kReps; };
+
+    char szMsg[200];
+    snprintf(szMsg, sizeof(szMsg), "onspeed.cfg.txt (%zu items): indexOf per item %.1f us, one-pass index %.1f us (%.1fx) [%zu]",
+             uNames, us(t0, t1), us(t1, t2), us(t0, t1) / us(t1, t2), uSink % 10);
+    TEST_MESSAGE(szMsg);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Index
+    RUN_TEST(test_v1_file_indexed_flat);
+    RUN_TEST(test_config2_sections_and_repeats);
+    RUN_TEST(test_markup_skipped_and_entities_decoded);
+    RUN_TEST(test_malformed_rejected);
+    RUN_TEST(test_value_conversions);
+
+    // Field table
+    RUN_TEST(test_load_v1_onspeed_cfg);
+    RUN_TEST(test_load_v1_missing_items_zeroed);
+    RUN_TEST(test_load_config2);
+    RUN_TEST(test_load_config2_keeps_defaults);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_v1_load);
+#endif
+
+    return UNITY_END();
+}
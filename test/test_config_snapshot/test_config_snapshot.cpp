@@ -0,0 +1,250 @@
+// test_config_snapshot.cpp - Unit tests for ConfigSnapshot and RuntimeConfig
+
+#include <unity.h>
+#include <ConfigSnapshot.h>
+#include <RuntimeConfig.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Every field carries the same stamp so a torn (half-written) read is visible
+struct Stamped {
+    uint32_t a[32];
+
+    void fill(uint32_t v)
+    {
+        for (auto& x : a) x = v;
+    }
+
+    bool consistent() const
+    {
+        for (auto x : a)
+            if (x != a[0]) return false;
+        return true;
+    }
+};
+
+// ============================================================================
+// Single-threaded protocol
+// ============================================================================
+
+void test_initial_value_visible()
+{
+    Stamped init;
+    init.fill(7);
+    ConfigSnapshot<Stamped> snap(init);
+
+    ConfigSnapshot<Stamped>::ReadGuard g(snap);
+    TEST_ASSERT_EQUAL_UINT32(7, g->a[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, g.version());
+    TEST_ASSERT_EQUAL_UINT32(0, snap.publishCount());
+}
+
+void test_publish_replaces_value()
+{
+    ConfigSnapshot<Stamped> snap;
+    Stamped v;
+    v.fill(42);
+
+    TEST_ASSERT_TRUE(snap.tryPublish(v));
+
+    ConfigSnapshot<Stamped>::ReadGuard g(snap);
+    TEST_ASSERT_EQUAL_UINT32(42, g->a[31]);
+    TEST_ASSERT_EQUAL_UINT32(1, g.version());
+}
+
+void test_guard_pins_old_value()
+{
+    ConfigSnapshot<Stamped> snap;
+    Stamped v;
+
+    v.fill(1);
+    snap.tryPublish(v);
+
+    ConfigSnapshot<Stamped>::ReadGuard g(snap);
+
+    // First publish goes to the other slot: allowed, reader keeps its view
+    v.fill(2);
+    TEST_ASSERT_TRUE(snap.tryPublish(v));
+    TEST_ASSERT_EQUAL_UINT32(1, g->a[0]);
+
+    // Second publish would overwrite the slot the guard is on: refused
+    v.fill(3);
+    TEST_ASSERT_FALSE(snap.tryPublish(v));
+    TEST_ASSERT_EQUAL_UINT32(1, g->a[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, snap.load().a[0]);
+}
+
+void test_publish_succeeds_after_guard_released()
+{
+    ConfigSnapshot<Stamped> snap;
+    Stamped v;
+
+    v.fill(1);
+    snap.tryPublish(v);
+    {
+        ConfigSnapshot<Stamped>::ReadGuard g(snap);
+        v.fill(2);
+        snap.tryPublish(v);
+        v.fill(3);
+        TEST_ASSERT_FALSE(snap.tryPublish(v));
+    }
+    TEST_ASSERT_TRUE(snap.tryPublish(v));
+    TEST_ASSERT_EQUAL_UINT32(3, snap.load().a[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, snap.readers(0));
+    TEST_ASSERT_EQUAL_UINT32(0, snap.readers(1));
+}
+
+void test_publish_calls_wait_until_grace_period()
+{
+    ConfigSnapshot<Stamped> snap;
+    Stamped v;
+    v.fill(1);
+    snap.tryPublish(v);
+
+    auto* pGuard = new ConfigSnapshot<Stamped>::ReadGuard(snap);
+    v.fill(2);
+    snap.tryPublish(v);
+
+    // Wait function releases the reader on its third call
+    int iCalls = 0;
+    v.fill(3);
+    uint32_t uWaits = snap.publish(v, [&] {
+        if (++iCalls == 3) {
+            delete pGuard;
+            pGuard = nullptr;
+        }
+    });
+
+    TEST_ASSERT_EQUAL_UINT32(3, uWaits);
+    TEST_ASSERT_EQUAL_UINT32(3, snap.load().a[0]);
+}
+
+// ============================================================================
+// Concurrent readers vs. writer
+// ============================================================================
+
+void test_concurrent_readers_never_see_torn_snapshot()
+{
+    ConfigSnapshot<Stamped> snap;
+    std::atomic<bool>       bStop{false};
+    std::atomic<uint32_t>   uTorn{0};
+    std::atomic<uint32_t>   uBackwards{0};
+    std::atomic<uint64_t>   uReads{0};
+
+    auto reader = [&] {
+        uint32_t uLastVersion = 0;
+        while (!bStop.load()) {
+            ConfigSnapshot<Stamped>::ReadGuard g(snap);
+            if (!g->consistent()) uTorn++;
+            // Stamp equals version, and a reader never goes back in time
+            if (g->a[0] != g.version()) uTorn++;
+            if (g.version() < uLastVersion) uBackwards++;
+            uLastVersion = g.version();
+            uReads++;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++)
+        readers.emplace_back(reader);
+
+    // Don't let the writer finish before the readers are scheduled
+    while (uReads.load() < 4)
+        std::this_thread::yield();
+
+    Stamped v;
+    for (uint32_t uVer = 1; uVer <= 20000; uVer++) {
+        v.fill(uVer);
+        snap.publish(v, [] { std::this_thread::yield(); });
+    }
+
+    bStop = true;
+    for (auto& t : readers) t.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, uTorn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, uBackwards.load());
+    TEST_ASSERT_EQUAL_UINT32(20000, snap.publishCount());
+    TEST_ASSERT_EQUAL_UINT32(20000, snap.load().a[0]);
+    TEST_ASSERT_TRUE(uReads.load() > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, snap.readers(0));
+    TEST_ASSERT_EQUAL_UINT32(0, snap.readers(1));
+}
+
+// ============================================================================
+// RuntimeConfig
+// ============================================================================
+
+void test_runtime_flap_index_clamped()
+{
+    RuntimeConfig cfg = {};
+    cfg.iFlapCount = 2;
+    cfg.aFlaps[0].iDegrees = 0;
+    cfg.aFlaps[1].iDegrees = 20;
+
+    TEST_ASSERT_EQUAL_INT(0,  cfg.flap(0).iDegrees);
+    TEST_ASSERT_EQUAL_INT(20, cfg.flap(1).iDegrees);
+    TEST_ASSERT_EQUAL_INT(20, cfg.flap(4).iDegrees);   // stale index from a bigger config
+    TEST_ASSERT_EQUAL_INT(0,  cfg.flap(-1).iDegrees);
+}
+
+void test_runtime_flap_empty_returns_zeroed_entry()
+{
+    RuntimeConfig cfg = {};
+    cfg.aFlaps[0].fSTALLWARNAOA = 0.0f;
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, cfg.flap(3).fSTALLWARNAOA);
+}
+
+void test_runtime_flap_removed_while_reader_holds_old()
+{
+    RuntimeConfigSnapshot snap;
+    RuntimeConfig cfg = {};
+
+    cfg.iFlapCount = 3;
+    cfg.aFlaps[2].fSTALLWARNAOA = 18.0f;
+    snap.tryPublish(cfg);
+
+    RuntimeConfigSnapshot::ReadGuard g(snap);
+
+    // Web handler deletes a flap position; reader finishes its cycle on the old set
+    cfg.iFlapCount = 2;
+    cfg.aFlaps[2].fSTALLWARNAOA = 0.0f;
+    snap.tryPublish(cfg);
+
+    TEST_ASSERT_EQUAL_INT(3, g->iFlapCount);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 18.0f, g->flap(2).fSTALLWARNAOA);
+
+    RuntimeConfigSnapshot::ReadGuard gNew(snap);
+    TEST_ASSERT_EQUAL_INT(2, gNew->iFlapCount);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Single-threaded protocol
+    RUN_TEST(test_initial_value_visible);
+    RUN_TEST(test_publish_replaces_value);
+    RUN_TEST(test_guard_pins_old_value);
+    RUN_TEST(test_publish_succeeds_after_guard_released);
+    RUN_TEST(test_publish_calls_wait_until_grace_period);
+
+    // Concurrency
+    RUN_TEST(test_concurrent_readers_never_see_torn_snapshot);
+
+    // RuntimeConfig
+    RUN_TEST(test_runtime_flap_index_clamped);
+    RUN_TEST(test_runtime_flap_empty_returns_zeroed_entry);
+    RUN_TEST(test_runtime_flap_removed_while_reader_holds_old);
+
+    return UNITY_END();
+}
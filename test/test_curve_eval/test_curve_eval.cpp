@@ -0,0 +1,197 @@
+// test_curve_eval.cpp - Unit tests for the specialized curve evaluators
+//
+// The bound evaluator has to give exactly what CurveCalc gives, so the
+// comparisons here are on the bits, not within a tolerance.
+
+#include <unity.h>
+#include <CurveCalc.h>
+#include <CurveTable.h>
+#include <AOACalculator.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// One curve per specialization, the polynomials from the sample onspeed.cfg
+// where there is one
+static const SuCalibrationCurve kPoly1 = { { 0.0f,   0.0f,      0.0f,     5.25f   }, 1 };
+static const SuCalibrationCurve kPoly2 = { { 0.0f,   0.0f,     30.7340f,  2.5950f }, 1 };
+static const SuCalibrationCurve kPoly3 = { { 0.0f, -16.3760f,  38.3270f, -0.8061f }, 1 };
+static const SuCalibrationCurve kPoly4 = { { 4.0f,  -9.0f,     30.0f,     1.0f    }, 1 };
+static const SuCalibrationCurve kLog   = { { 0.0f,   0.0f,    -30.0f,    10.0f    }, 2 };
+static const SuCalibrationCurve kExp   = { { 0.0f,   0.0f,      3.0f,     1.5f    }, 3 };
+
+struct SuCase {
+    const char *                name;
+    const SuCalibrationCurve *  pCurve;
+    CurveEvaluator::Kind        enKind;
+};
+
+static const SuCase kCases[] = {
+    { "poly1", &kPoly1, CurveEvaluator::Kind::Poly1 },
+    { "poly2", &kPoly2, CurveEvaluator::Kind::Poly2 },
+    { "poly3", &kPoly3, CurveEvaluator::Kind::Poly3 },
+    { "poly4", &kPoly4, CurveEvaluator::Kind::Poly4 },
+    { "log",   &kLog,   CurveEvaluator::Kind::Log   },
+    { "exp",   &kExp,   CurveEvaluator::Kind::Exp   },
+};
+
+static bool sameBits(float a, float b)
+{
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+/// x from -2 to 2 in small steps, plus some large and tiny values
+static int forEachX(const SuCalibrationCurve & curve, const CurveEvaluator & eval)
+{
+    int iMismatch = 0;
+    for (int n = -20000; n <= 20000; n++) {
+        const float x = n * 1.0e-4f;
+        const float a = CurveCalc(x, curve);
+        const float b = eval(x);
+        // 0 * x dropped from a polynomial can only flip the sign of a zero
+        if (!sameBits(a, b) && !(a == 0.0f && b == 0.0f) && !(std::isnan(a) && std::isnan(b)))
+            iMismatch++;
+    }
+    const float afOdd[] = { 1e-30f, -1e-30f, 1e-6f, 123.456f, -987.5f, 3.0e4f, 1.0e10f };
+    for (float x : afOdd) {
+        const float a = CurveCalc(x, curve);
+        const float b = eval(x);
+        if (!sameBits(a, b) && !(a == 0.0f && b == 0.0f) && !(std::isnan(a) && std::isnan(b)))
+            iMismatch++;
+    }
+    return iMismatch;
+}
+
+// ============================================================================
+// Binding
+// ============================================================================
+
+void test_bind_picks_kind()
+{
+    for (const SuCase & c : kCases)
+        TEST_ASSERT_EQUAL_INT_MESSAGE(int(c.enKind), int(CurveEvaluator::bind(*c.pCurve).kind()), c.name);
+}
+
+void test_all_zero_polynomial_is_constant()
+{
+    SuCalibrationCurve zero = { { 0.0f, 0.0f, 0.0f, 0.0f }, 1 };
+    CurveEvaluator     eval = CurveEvaluator::bind(zero);
+
+    TEST_ASSERT_EQUAL(int(CurveEvaluator::Kind::Poly1), int(eval.kind()));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, eval(3.0f));
+}
+
+void test_unknown_type_and_zeroed_evaluator_give_zero()
+{
+    SuCalibrationCurve bad    = { { 1.0f, 2.0f, 3.0f, 4.0f }, 7 };
+    CurveEvaluator     eval   = CurveEvaluator::bind(bad);
+    CurveEvaluator     zeroed = {};
+
+    TEST_ASSERT_EQUAL(int(CurveEvaluator::Kind::None), int(eval.kind()));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, eval(2.0f));
+    TEST_ASSERT_EQUAL(int(CurveEvaluator::Kind::None), int(zeroed.kind()));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, zeroed(2.0f));
+}
+
+// ============================================================================
+// Bit exact against CurveCalc
+// ============================================================================
+
+void test_each_kind_matches_curvecalc_bits()
+{
+    for (const SuCase & c : kCases)
+        TEST_ASSERT_EQUAL_INT_MESSAGE(0, forEachX(*c.pCurve, CurveEvaluator::bind(*c.pCurve)), c.name);
+}
+
+void test_templates_match_curvecalc_bits()
+{
+    // Full four term polynomial straight through the template
+    for (int n = -1000; n <= 1000; n++) {
+        const float x = n * 3.1e-3f;
+        TEST_ASSERT_TRUE(sameBits(CurveCalc(x, kPoly4), curvePoly<4>(x, kPoly4.afCoeff)));
+        TEST_ASSERT_TRUE(sameBits(CurveCalc(x, kExp),   curveExp(x, kExp.afCoeff)));
+        if (x > 0.0f)
+            TEST_ASSERT_TRUE(sameBits(CurveCalc(x, kLog), curveLog(x, kLog.afCoeff)));
+    }
+}
+
+void test_calculator_with_compiled_curve_matches_bits()
+{
+    SuCompiledCurve compiled;
+    compileCurve(kPoly3, compiled, false);
+    TEST_ASSERT_FALSE(compiled.Table.bValid);
+
+    AOACalculator withEval(0);
+    AOACalculator withCurve(0);
+
+    for (float p45 = -200.0f; p45 <= 900.0f; p45 += 3.7f) {
+        AOACalculatorResult a = withEval.calculate(1000.0f, p45, kPoly3, &compiled);
+        AOACalculatorResult b = withCurve.calculate(1000.0f, p45, kPoly3);
+        TEST_ASSERT_EQUAL(b.valid, a.valid);
+        TEST_ASSERT_TRUE(sameBits(b.aoa, a.aoa));
+    }
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_against_curvecalc()
+{
+    const int       kReps = 2000000;
+    char            szMsg[300];
+    int             iLen  = std::snprintf(szMsg, sizeof(szMsg), "ns per eval, CurveCalc vs bound:");
+
+    for (const SuCase & c : kCases) {
+        const CurveEvaluator eval  = CurveEvaluator::bind(*c.pCurve);
+        volatile float       fSink = 0.0f;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; i++)
+            fSink = fSink + CurveCalc(0.05f + float(i & 1023) / 1024.0f, *c.pCurve);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; i++)
+            fSink = fSink + eval(0.05f + float(i & 1023) / 1024.0f);
+        auto t2 = std::chrono::steady_clock::now();
+
+        auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / kReps; };
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %s %.1f / %.1f;", c.name, ns(t0, t1), ns(t1, t2));
+        TEST_ASSERT_TRUE(fSink == fSink);
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Binding
+    RUN_TEST(test_bind_picks_kind);
+    RUN_TEST(test_all_zero_polynomial_is_constant);
+    RUN_TEST(test_unknown_type_and_zeroed_evaluator_give_zero);
+
+    // Bit exact against CurveCalc
+    RUN_TEST(test_each_kind_matches_curvecalc_bits);
+    RUN_TEST(test_templates_match_curvecalc_bits);
+    RUN_TEST(test_calculator_with_compiled_curve_matches_bits);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_against_curvecalc);
+#endif
+
+    return UNITY_END();
+}
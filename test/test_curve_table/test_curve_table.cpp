@@ -0,0 +1,190 @@
+// test_curve_table.cpp - Unit tests for calibration curve tables
+
+#include <unity.h>
+#include <CurveTable.h>
+#include <CurveCalc.h>
+#include <AOACalculator.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// The curves from the sample onspeed.cfg plus a log and an exp curve
+static const SuCalibrationCurve kFlaps0 = { { 0.0f,  16.6730f, 24.0610f,  3.6653f }, 1 };
+static const SuCalibrationCurve kFlaps1 = { { 0.0f, -21.7420f, 30.7340f,  2.5950f }, 1 };
+static const SuCalibrationCurve kFlaps2 = { { 0.0f, -16.3760f, 38.3270f, -0.8061f }, 1 };
+static const SuCalibrationCurve kCubic  = { { 4.0f,  -9.0f,    30.0f,     1.0f    }, 1 };
+static const SuCalibrationCurve kLog    = { { 0.0f,   0.0f,   -30.0f,    10.0f    }, 2 };
+static const SuCalibrationCurve kExp    = { { 0.0f,   0.0f,     3.0f,     1.5f    }, 3 };
+
+static const SuCalibrationCurve * const kCurves[] = { &kFlaps0, &kFlaps1, &kFlaps2, &kCubic, &kLog, &kExp };
+
+/// Worst |table - curve| at 256 points per knot interval, finer than the
+/// builder checks, so the reported bound is tested rather than trusted
+static float denseError(const SuCurveTable & table, const SuCalibrationCurve & curve)
+{
+    float fWorst = 0.0f;
+    for (int n = 0; n <= (SuCurveTable::kKnots - 1) * 256; n++) {
+        const float x = table.fMin + (table.fMax - table.fMin) * n / ((SuCurveTable::kKnots - 1) * 256);
+        float       y;
+        if (curveTableLookup(table, x, y))
+            fWorst = std::fmax(fWorst, std::fabs(y - CurveCalc(x, curve)));
+    }
+    return fWorst;
+}
+
+// ============================================================================
+// Build and error bound
+// ============================================================================
+
+void test_tables_meet_error_bound()
+{
+    char szMsg[200];
+    int  iLen = std::snprintf(szMsg, sizeof(szMsg), "Cubic table max error, deg:");
+
+    for (const SuCalibrationCurve * pCurve : kCurves) {
+        SuCurveTable table;
+
+        TEST_ASSERT_TRUE(buildCurveTable(*pCurve, table));
+        TEST_ASSERT_TRUE(table.fMaxError <= kCurveTableMaxErrorDeg);
+
+        // The reported bound holds between the points it was measured at
+        const float fDense = denseError(table, *pCurve);
+        TEST_ASSERT_TRUE(fDense <= table.fMaxError * 1.05f + 1e-5f);
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %.5f", table.fMaxError);
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+void test_cubic_beats_linear()
+{
+    SuCurveTable cubic, linear;
+
+    buildCurveTable(kExp, cubic, CurveInterp::Cubic);
+    buildCurveTable(kExp, linear, CurveInterp::Linear);
+
+    TEST_ASSERT_TRUE(cubic.fMaxError < linear.fMaxError / 4.0f);
+}
+
+void test_range_covers_aoa_limits()
+{
+    SuCurveTable table;
+    buildCurveTable(kFlaps0, table);
+
+    // Both ends inside the AOA limits, and just past the top end is out
+    TEST_ASSERT_TRUE(CurveCalc(table.fMin, kFlaps0) >= AOA_MIN_VALUE);
+    TEST_ASSERT_TRUE(CurveCalc(table.fMax, kFlaps0) <= AOA_MAX_VALUE);
+    TEST_ASSERT_TRUE(CurveCalc(table.fMax + 0.01f, kFlaps0) > AOA_MAX_VALUE);
+
+    // Log curve only exists for x > 0
+    buildCurveTable(kLog, table);
+    TEST_ASSERT_TRUE(table.fMin > 0.0f);
+}
+
+void test_outside_range_uses_curve()
+{
+    SuCurveTable table;
+    buildCurveTable(kFlaps1, table);
+
+    float y;
+    TEST_ASSERT_FALSE(curveTableLookup(table, table.fMax + 0.5f, y));
+    TEST_ASSERT_EQUAL_FLOAT(CurveCalc(table.fMax + 0.5f, kFlaps1), curveTableEval(table, kFlaps1, table.fMax + 0.5f));
+    TEST_ASSERT_TRUE(std::isnan(curveTableEval(table, kFlaps1, NAN)));
+}
+
+void test_unusable_curves_give_invalid_table()
+{
+    SuCurveTable              table;
+    const SuCalibrationCurve  unknown = { { 1.0f, 2.0f, 3.0f, 4.0f }, 7 };
+    const SuCalibrationCurve  tooHigh = { { 0.0f, 0.0f, 0.0f, 90.0f }, 1 };
+    const SuCalibrationCurve  steep   = { { 0.0f, 0.0f, 12.0f, 8.0f }, 2 };     // runs down to x = 0.1
+
+    TEST_ASSERT_FALSE(buildCurveTable(unknown, table));
+    TEST_ASSERT_FALSE(buildCurveTable(tooHigh, table));
+    TEST_ASSERT_FALSE(table.bValid);
+
+    // Too curved near 0 for uniform knots; the curve is used instead
+    TEST_ASSERT_FALSE(buildCurveTable(steep, table));
+    TEST_ASSERT_TRUE(table.fMaxError > kCurveTableMaxErrorDeg);
+    TEST_ASSERT_EQUAL_FLOAT(CurveCalc(0.5f, steep), curveTableEval(table, steep, 0.5f));
+}
+
+void test_calculator_with_table_matches_curve()
+{
+    SuCompiledCurve compiled;
+    TEST_ASSERT_TRUE(compileCurve(kFlaps2, compiled, true));
+
+    AOACalculator withTable(0);
+    AOACalculator withCurve(0);
+
+    for (float p45 = -200.0f; p45 <= 900.0f; p45 += 3.7f) {
+        AOACalculatorResult a = withTable.calculate(1000.0f, p45, kFlaps2, &compiled);
+        AOACalculatorResult b = withCurve.calculate(1000.0f, p45, kFlaps2);
+        TEST_ASSERT_EQUAL(b.valid, a.valid);
+        TEST_ASSERT_FLOAT_WITHIN(compiled.Table.fMaxError + 1e-5f, b.aoa, a.aoa);
+    }
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_against_curvecalc()
+{
+    const int       kReps = 2000000;
+    char            szMsg[200];
+    int             iLen  = std::snprintf(szMsg, sizeof(szMsg), "ns per eval, CurveCalc vs table:");
+    const char *    aszName[] = { "poly", "log", "exp" };
+    const SuCalibrationCurve * apCurve[] = { &kFlaps0, &kLog, &kExp };
+
+    for (int c = 0; c < 3; c++) {
+        SuCurveTable   table;
+        volatile float fSink = 0.0f;
+        buildCurveTable(*apCurve[c], table);
+        const float    fSpan = table.fMax - table.fMin;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; i++)
+            fSink = fSink + CurveCalc(table.fMin + fSpan * float(i & 1023) / 1024.0f, *apCurve[c]);
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < kReps; i++)
+            fSink = fSink + curveTableEval(table, *apCurve[c], table.fMin + fSpan * float(i & 1023) / 1024.0f);
+        auto t2 = std::chrono::steady_clock::now();
+
+        auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / kReps; };
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %s %.1f / %.1f;", aszName[c], ns(t0, t1), ns(t1, t2));
+        TEST_ASSERT_TRUE(fSink != 0.0f);
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Build and error bound
+    RUN_TEST(test_tables_meet_error_bound);
+    RUN_TEST(test_cubic_beats_linear);
+    RUN_TEST(test_range_covers_aoa_limits);
+    RUN_TEST(test_outside_range_uses_curve);
+    RUN_TEST(test_unusable_curves_give_invalid_table);
+    RUN_TEST(test_calculator_with_table_matches_curve);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_against_curvecalc);
+#endif
+
+    return UNITY_END();
+}
@@ -0,0 +1,363 @@
+// test_decimator.cpp - Unit and frequency response tests for the pressure decimators
+
+#include <unity.h>
+#include <Decimator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const double kPi = 3.14159265358979323846;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+/// Amplitude of the fHz component of a signal sampled at fRateHz, by
+/// projecting onto sin and cos. Callers pass a whole number of cycles.
+static double amplitudeAt(const std::vector<double> & aSamples, double fHz, double fRateHz)
+{
+    double fRe = 0.0, fIm = 0.0, fMean = 0.0;
+    for (double f : aSamples)
+        fMean += f;
+    fMean /= double(aSamples.size());
+
+    for (size_t i = 0; i < aSamples.size(); i++) {
+        const double fPhase = 2.0 * kPi * fHz * double(i) / fRateHz;
+        fRe += (aSamples[i] - fMean) * std::cos(fPhase);
+        fIm += (aSamples[i] - fMean) * std::sin(fPhase);
+    }
+    return 2.0 * std::sqrt(fRe * fRe + fIm * fIm) / double(aSamples.size());
+}
+
+static double stdDev(const std::vector<double> & aSamples)
+{
+    double fMean = 0.0, fVar = 0.0;
+    for (double f : aSamples)
+        fMean += f;
+    fMean /= double(aSamples.size());
+    for (double f : aSamples)
+        fVar += (f - fMean) * (f - fMean);
+    return std::sqrt(fVar / double(aSamples.size()));
+}
+
+/// Run a sine of fHz and amplitude 1000 counts around 8000 through a
+/// PressureDecimator-like push(), skipping the first iSettle outputs.
+template <typename Decim>
+static std::vector<double> runSine(Decim & decim, double fHz, double fInHz, int iOutputs, int iSettle)
+{
+    std::vector<double> aOut;
+    for (int n = 0; aOut.size() < size_t(iOutputs); n++) {
+        const double fIn = 8000.0 + 1000.0 * std::sin(2.0 * kPi * fHz * double(n) / fInHz);
+        if (decim.push(int32_t(std::lround(fIn))) && iSettle-- <= 0)
+            aOut.push_back(decim.output());
+    }
+    return aOut;
+}
+
+/// Deterministic uniform noise in [-1, 1)
+static double noise(uint32_t & uSeed)
+{
+    uSeed = uSeed * 1664525u + 1013904223u;
+    return double(uSeed >> 8) / double(1u << 23) - 1.0;
+}
+
+// ============================================================================
+// CIC
+// ============================================================================
+
+void test_cic_rate_and_unity_dc_gain()
+{
+    CicDecimator cic;
+    TEST_ASSERT_TRUE(cic.configure(3, 10));
+
+    int iOutputs = 0;
+    for (int n = 0; n < 1000; n++) {
+        if (cic.push(5000)) {
+            TEST_ASSERT_EQUAL_FLOAT(5000.0f, cic.output());
+            iOutputs++;
+        }
+    }
+
+    // 100 output slots, the first 2 swallowed while the sums fill
+    TEST_ASSERT_EQUAL_INT(98, iOutputs);
+}
+
+void test_cic_response_matches_theory()
+{
+    const double afHz[] = { 2.0, 10.0, 25.0, 40.0 };
+
+    for (double fHz : afHz) {
+        CicDecimator cic;
+        cic.configure(3, 10);
+        std::vector<double> aOut = runSine(cic, fHz, 1000.0, 400, 5);
+
+        const double fMeasured = amplitudeAt(aOut, fHz, 100.0) / 1000.0;
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, cic.response(float(fHz / 1000.0)), float(fMeasured));
+    }
+}
+
+void test_cic_nulls_the_output_rate()
+{
+    CicDecimator cic;
+    cic.configure(3, 10);
+
+    // A 100 Hz tone would alias straight down to DC at 100 Hz out
+    std::vector<double> aOut = runSine(cic, 100.0, 1000.0, 200, 2);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.0f, cic.response(0.1f));
+    TEST_ASSERT_TRUE(stdDev(aOut) < 1e-3);
+}
+
+void test_cic_wraps_exactly_near_bit_limit()
+{
+    // 3 * 5 + 16 = 31 bits of growth, the integrators wrap many times
+    CicDecimator cic;
+    TEST_ASSERT_TRUE(cic.configure(3, 32));
+
+    float fLast = 0.0f;
+    for (int n = 0; n < 200000; n++)
+        if (cic.push(16383))
+            fLast = cic.output();
+
+    TEST_ASSERT_EQUAL_FLOAT(16383.0f, fLast);
+}
+
+void test_cic_rejects_bad_settings()
+{
+    CicDecimator cic;
+
+    TEST_ASSERT_FALSE(cic.configure(0, 10));
+    TEST_ASSERT_FALSE(cic.configure(CicDecimator::kMaxOrder + 1, 10));
+    TEST_ASSERT_FALSE(cic.configure(3, 0));
+    TEST_ASSERT_FALSE(cic.configure(5, 64));       // 5 * 6 + 16 bits
+
+    // Left as a pass-through
+    TEST_ASSERT_TRUE(cic.push(1234));
+    TEST_ASSERT_EQUAL_FLOAT(1234.0f, cic.output());
+}
+
+// ============================================================================
+// FIR
+// ============================================================================
+
+void test_fir_design_is_symmetric_unity_gain()
+{
+    FirDecimator fir;
+    TEST_ASSERT_TRUE(fir.designLowpass(9, 0.2f, 2));
+
+    float fSum = 0.0f;
+    for (int i = 0; i < fir.tapCount(); i++) {
+        fSum += fir.tap(i);
+        TEST_ASSERT_FLOAT_WITHIN(1e-6f, fir.tap(i), fir.tap(fir.tapCount() - 1 - i));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, fSum);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, fir.response(0.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.5f, fir.response(0.2f));
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, fir.groupDelay());
+}
+
+void test_fir_response_matches_theory()
+{
+    const double afNorm[] = { 0.02, 0.1, 0.2, 0.3 };
+
+    for (double fNorm : afNorm) {
+        FirDecimator fir;
+        fir.designLowpass(15, 0.15f, 1);
+
+        std::vector<double> aOut;
+        for (int n = 0; n < 1100; n++) {
+            fir.push(float(std::sin(2.0 * kPi * fNorm * double(n))));
+            if (n >= 100)
+                aOut.push_back(fir.output());
+        }
+
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, fir.response(float(fNorm)), float(amplitudeAt(aOut, fNorm, 1.0)));
+    }
+}
+
+void test_fir_decimates_and_starts_at_first_sample()
+{
+    FirDecimator fir;
+    fir.designLowpass(9, 0.2f, 2);
+
+    TEST_ASSERT_FALSE(fir.push(700.0f));
+    TEST_ASSERT_TRUE(fir.push(700.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 700.0f, fir.output());
+    TEST_ASSERT_FALSE(fir.push(700.0f));
+}
+
+void test_fir_rejects_bad_settings()
+{
+    FirDecimator fir;
+    const float  afTaps[2] = { 0.5f, 0.5f };
+
+    TEST_ASSERT_FALSE(fir.designLowpass(FirDecimator::kMaxTaps + 1, 0.2f, 2));
+    TEST_ASSERT_FALSE(fir.designLowpass(9, 0.5f, 2));
+    TEST_ASSERT_FALSE(fir.designLowpass(9, 0.0f, 2));
+    TEST_ASSERT_FALSE(fir.configure(nullptr, 2, 1));
+    TEST_ASSERT_FALSE(fir.configure(afTaps, 2, 0));
+    TEST_ASSERT_TRUE(fir.configure(afTaps, 2, 1));
+}
+
+// ============================================================================
+// Pressure chain
+// ============================================================================
+
+void test_pressure_configure()
+{
+    PressureDecimator decim;
+
+    TEST_ASSERT_FALSE(decim.configure(1000, 30));
+    TEST_ASSERT_FALSE(decim.configure(50, 50));
+    TEST_ASSERT_TRUE(decim.configure(500, 50));
+    TEST_ASSERT_EQUAL_INT(5, decim.cic().rate());
+    TEST_ASSERT_TRUE(decim.configure(1000, 50));
+    TEST_ASSERT_EQUAL_INT(10, decim.cic().rate());
+    TEST_ASSERT_EQUAL_INT(2, decim.fir().rate());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 53.5f, decim.groupDelayMs());
+}
+
+void test_pressure_output_rate()
+{
+    PressureDecimator decim;
+    decim.configure(1000, 50);
+
+    int iOutputs = 0;
+    for (int n = 0; n < 2000; n++)
+        if (decim.push(4000))
+            iOutputs++;
+
+    TEST_ASSERT_EQUAL_INT(99, iOutputs);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 4000.0f, decim.output());
+}
+
+void test_pressure_passband_and_alias_rejection()
+{
+    PressureDecimator decim;
+    decim.configure(1000, 50);
+
+    // Passband: what the AOA tones care about
+    TEST_ASSERT_TRUE(decim.response(2.0f) > 0.97f);
+
+    // Measured response follows the model in the passband
+    std::vector<double> aOut = runSine(decim, 5.0, 1000.0, 400, 10);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, decim.response(5.0f), float(amplitudeAt(aOut, 5.0, 50.0) / 1000.0));
+
+    // Everything that would alias onto 0-10 Hz at 50 Hz out is well down
+    for (float fHz = 40.0f; fHz <= 500.0f; fHz += 1.0f) {
+        const float fAlias = std::fmod(fHz, 50.0f);
+        if (fAlias <= 10.0f || fAlias >= 40.0f)
+            TEST_ASSERT_TRUE(decim.response(fHz) < 0.1f);
+    }
+}
+
+void test_pressure_step_crosses_half_at_group_delay()
+{
+    PressureDecimator decim;
+    decim.configure(1000, 50);
+
+    for (int n = 0; n < 1000; n++)
+        decim.push(1000);
+
+    // Step at input sample 0, outputs are 20 ms apart
+    float fCrossMs = -1.0f;
+    for (int n = 0; n < 1000 && fCrossMs < 0.0f; n++)
+        if (decim.push(2000) && decim.output() >= 1500.0f)
+            fCrossMs = float(n);
+
+    TEST_ASSERT_TRUE(fCrossMs >= 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(20.0f, decim.groupDelayMs(), fCrossMs);
+}
+
+// ============================================================================
+// Comparison with today's 50 Hz chain
+// ============================================================================
+
+// Today: one sample per 20 ms, a 15 sample running median then a 10 sample
+// running average (iPressureSmoothing default and PfwdAvg). Compare noise
+// and group delay with the 1 kHz oversampled chain on the same white noise.
+void test_report_noise_and_delay()
+{
+    const int   kOutputs  = 2000;
+    const int   kMedian   = 15;
+    const int   kAverage  = 10;
+    uint32_t    uSeed     = 12345;
+
+    // Old chain, 50 Hz
+    std::vector<double> aOld;
+    std::deque<double>  qMedian, qAverage;
+    for (int n = 0; n < kOutputs + 50; n++) {
+        qMedian.push_back(8000.0 + 20.0 * noise(uSeed));
+        if (int(qMedian.size()) > kMedian) qMedian.pop_front();
+        std::vector<double> aSorted(qMedian.begin(), qMedian.end());
+        std::nth_element(aSorted.begin(), aSorted.begin() + aSorted.size() / 2, aSorted.end());
+        qAverage.push_back(aSorted[aSorted.size() / 2]);
+        if (int(qAverage.size()) > kAverage) qAverage.pop_front();
+        double fSum = 0.0;
+        for (double f : qAverage) fSum += f;
+        if (n >= 50)
+            aOld.push_back(fSum / double(qAverage.size()));
+    }
+
+    // Oversampled chain, 1 kHz in
+    PressureDecimator   decim;
+    std::vector<double> aNew;
+    decim.configure(1000, 50);
+    while (aNew.size() < size_t(kOutputs))
+        if (decim.push(int32_t(std::lround(8000.0 + 20.0 * noise(uSeed)))))
+            aNew.push_back(decim.output());
+
+    const double fInStd  = 20.0 / std::sqrt(3.0);
+    const double fOldStd = stdDev(aOld);
+    const double fNewStd = stdDev(aNew);
+    const double fOldMs  = 1000.0 * (0.5 * (kMedian - 1) + 0.5 * (kAverage - 1)) / 50.0;
+
+    TEST_ASSERT_TRUE(fNewStd < fInStd / 3.0);
+    TEST_ASSERT_TRUE(decim.groupDelayMs() < fOldMs / 2.0);
+
+    char szMsg[200];
+    std::snprintf(szMsg, sizeof(szMsg),
+        "Noise %.2f counts in: 50 Hz median+average %.2f counts, %.0f ms delay; "
+        "1 kHz CIC+FIR %.2f counts, %.1f ms delay",
+        fInStd, fOldStd, fOldMs, fNewStd, double(decim.groupDelayMs()));
+    TEST_MESSAGE(szMsg);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // CIC
+    RUN_TEST(test_cic_rate_and_unity_dc_gain);
+    RUN_TEST(test_cic_response_matches_theory);
+    RUN_TEST(test_cic_nulls_the_output_rate);
+    RUN_TEST(test_cic_wraps_exactly_near_bit_limit);
+    RUN_TEST(test_cic_rejects_bad_settings);
+
+    // FIR
+    RUN_TEST(test_fir_design_is_symmetric_unity_gain);
+    RUN_TEST(test_fir_response_matches_theory);
+    RUN_TEST(test_fir_decimates_and_starts_at_first_sample);
+    RUN_TEST(test_fir_rejects_bad_settings);
+
+    // Pressure chain
+    RUN_TEST(test_pressure_configure);
+    RUN_TEST(test_pressure_output_rate);
+    RUN_TEST(test_pressure_passband_and_alias_rejection);
+    RUN_TEST(test_pressure_step_crosses_half_at_group_delay);
+
+    // Comparison
+    RUN_TEST(test_report_noise_and_delay);
+
+    return UNITY_END();
+}
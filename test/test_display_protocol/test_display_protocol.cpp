@@ -0,0 +1,330 @@
+// test_display_protocol.cpp - Unit tests for the display serial link encoders and decoder
+
+#include <unity.h>
+#include <Checksum.h>
+#include <DisplayProtocol.h>
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static DisplayData sample()
+{
+    DisplayData d = {};
+    d.iPitch10   = 52;
+    d.iRoll10    = -153;
+    d.uIas10     = 1234;
+    d.iPaltFt    = 5600;
+    d.iYawRate10 = -31;
+    d.iLatG100   = 4;
+    d.iVertG10   = 12;
+    d.uPctLift   = 47;
+    d.iAoa10     = 86;
+    d.iVsi10Fpm  = -45;
+    d.iOatC      = 15;
+    d.iFpa10     = -20;
+    d.iFlapsDeg  = 10;
+    d.iStall10   = 145;
+    d.iSlow10    = 124;
+    d.iFast10    = 86;
+    d.iLdMax10   = 47;
+    d.iOnset100  = 0;
+    d.iSpinCue   = 0;
+    d.uDataMark  = 3;
+    return d;
+}
+
+// The firmware's original formatting, kept here as the byte-for-byte reference
+static std::string legacyOnSpeed(const DisplayData & d)
+{
+    char sz[200];
+    int  n = snprintf(sz, sizeof(sz),
+        "#1%+04i%+05i%04u%+06i%+05i%+03i%+03i%02u%+04i%+04i%+03i%+04i%+03i%+04i%+04i%+04i%+04i%+04i%+02i%02u",
+        int(d.iPitch10), int(d.iRoll10), unsigned(d.uIas10), int(d.iPaltFt), int(d.iYawRate10),
+        int(d.iLatG100), int(d.iVertG10), unsigned(d.uPctLift), int(d.iAoa10), int(d.iVsi10Fpm),
+        int(d.iOatC), int(d.iFpa10), int(d.iFlapsDeg), int(d.iStall10), int(d.iSlow10),
+        int(d.iFast10), int(d.iLdMax10), int(d.iOnset100), int(d.iSpinCue), unsigned(d.uDataMark));
+    if (n != 76) return "";
+    uint8_t uCrc = 0;
+    for (int i = 0; i < 76; i++) uCrc += uint8_t(sz[i]);
+    char szCrc[8];
+    snprintf(szCrc, sizeof(szCrc), "%02X", uCrc);
+    return std::string(sz) + szCrc + "\r\n";
+}
+
+static std::string legacyG3x(const DisplayData & d)
+{
+    char sz[200];
+    int  n = snprintf(sz, sizeof(sz),
+        "=1100000000%+04i%+05i___%04u%+06i____%+03i%+03i%02u__________",
+        int(d.iPitch10), int(d.iRoll10), unsigned(d.uIas10), int(d.iPaltFt),
+        int(d.iLatG100), int(d.iVertG10), unsigned(d.uPctLift));
+    if (n != 55) return "";
+    uint8_t uCrc = 0;
+    for (int i = 0; i < 55; i++) uCrc += uint8_t(sz[i]);
+    char szCrc[8];
+    snprintf(szCrc, sizeof(szCrc), "%02X", uCrc);
+    return std::string(sz) + szCrc + "\r\n";
+}
+
+// Random values inside the clamp ranges the firmware applies
+static DisplayData randomData(std::mt19937 & rng)
+{
+    auto r = [&](int lo, int hi) { return lo + int(rng() % unsigned(hi - lo + 1)); };
+    DisplayData d;
+    d.iPitch10   = int16_t(r(-999, 999));
+    d.iRoll10    = int16_t(r(-9999, 9999));
+    d.uIas10     = uint16_t(r(0, 9999));
+    d.iPaltFt    = r(-99999, 99999);
+    d.iYawRate10 = int16_t(r(-9999, 9999));
+    d.iLatG100   = int8_t(r(-99, 99));
+    d.iVertG10   = int8_t(r(-99, 99));
+    d.uPctLift   = uint8_t(r(0, 99));
+    d.iAoa10     = int16_t(r(-999, 999));
+    d.iVsi10Fpm  = int16_t(r(-999, 999));
+    d.iOatC      = int8_t(r(-99, 99));
+    d.iFpa10     = int16_t(r(-999, 999));
+    d.iFlapsDeg  = int8_t(r(-99, 99));
+    d.iStall10   = int16_t(r(-999, 999));
+    d.iSlow10    = int16_t(r(-999, 999));
+    d.iFast10    = int16_t(r(-999, 999));
+    d.iLdMax10   = int16_t(r(-999, 999));
+    d.iOnset100  = int16_t(r(-999, 999));
+    d.iSpinCue   = int8_t(r(-1, 1));
+    d.uDataMark  = uint8_t(r(0, 99));
+    return d;
+}
+
+static bool sameData(const DisplayData & a, const DisplayData & b)
+{
+    return a.iPitch10 == b.iPitch10 && a.iRoll10 == b.iRoll10 && a.uIas10 == b.uIas10
+        && a.iPaltFt == b.iPaltFt && a.iYawRate10 == b.iYawRate10 && a.iLatG100 == b.iLatG100
+        && a.iVertG10 == b.iVertG10 && a.uPctLift == b.uPctLift && a.iAoa10 == b.iAoa10
+        && a.iVsi10Fpm == b.iVsi10Fpm && a.iOatC == b.iOatC && a.iFpa10 == b.iFpa10
+        && a.iFlapsDeg == b.iFlapsDeg && a.iStall10 == b.iStall10 && a.iSlow10 == b.iSlow10
+        && a.iFast10 == b.iFast10 && a.iLdMax10 == b.iLdMax10 && a.iOnset100 == b.iOnset100
+        && a.iSpinCue == b.iSpinCue && a.uDataMark == b.uDataMark;
+}
+
+// ============================================================================
+// Text sentences
+// ============================================================================
+
+void test_onspeed_sentence_known_value()
+{
+    char   sz[100];
+    size_t n = formatOnSpeedSentence(sample(), sz, sizeof(sz));
+
+    TEST_ASSERT_EQUAL(kOnSpeedSentenceLen, n);
+    TEST_ASSERT_EQUAL_STRING(legacyOnSpeed(sample()).c_str(), sz);
+    TEST_ASSERT_EQUAL_STRING("#1+052-01531234+05600-0031+04+1247+086-045+15-020+10+145+124+086+047+000+0036F\r\n", sz);
+}
+
+void test_g3x_sentence_known_value()
+{
+    char   sz[100];
+    size_t n = formatG3xSentence(sample(), sz, sizeof(sz));
+
+    TEST_ASSERT_EQUAL(kG3xSentenceLen, n);
+    TEST_ASSERT_EQUAL_STRING(legacyG3x(sample()).c_str(), sz);
+    TEST_ASSERT_EQUAL_STRING("=1100000000+052-0153___1234+05600____+04+1247__________9E\r\n", sz);
+}
+
+void test_text_matches_legacy_over_full_range()
+{
+    std::mt19937 rng(3);
+    char sz[100];
+
+    for (int i = 0; i < 20000; i++) {
+        const DisplayData d = randomData(rng);
+
+        size_t n = formatOnSpeedSentence(d, sz, sizeof(sz));
+        TEST_ASSERT_EQUAL(kOnSpeedSentenceLen, n);
+        TEST_ASSERT_EQUAL_STRING(legacyOnSpeed(d).c_str(), sz);
+
+        n = formatG3xSentence(d, sz, sizeof(sz));
+        TEST_ASSERT_EQUAL(kG3xSentenceLen, n);
+        TEST_ASSERT_EQUAL_STRING(legacyG3x(d).c_str(), sz);
+    }
+}
+
+void test_text_refuses_small_buffer()
+{
+    char sz[60];
+    TEST_ASSERT_EQUAL(0, formatOnSpeedSentence(sample(), sz, sizeof(sz)));
+    TEST_ASSERT_EQUAL(0, formatG3xSentence(sample(), sz, 59));
+    TEST_ASSERT_EQUAL(kG3xSentenceLen, formatG3xSentence(sample(), sz, 60));
+}
+
+// ============================================================================
+// Binary frames
+// ============================================================================
+
+void test_binary_round_trip()
+{
+    std::mt19937 rng(9);
+    uint8_t aFrame[64];
+
+    for (int i = 0; i < 5000; i++) {
+        const DisplayData d = randomData(rng);
+        DisplayData out = {};
+        uint8_t     uSeq = 0;
+
+        size_t n = encodeDisplayFlight(d, uint8_t(i), aFrame, sizeof(aFrame));
+        TEST_ASSERT_EQUAL(kDisplayFlightFrameLen, n);
+        TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out, &uSeq) == DisplayDecodeResult::Ok);
+        TEST_ASSERT_EQUAL_UINT8(uint8_t(i), uSeq);
+
+        n = encodeDisplaySetpoints(d, uint8_t(i), aFrame, sizeof(aFrame));
+        TEST_ASSERT_EQUAL(kDisplaySetpointFrameLen, n);
+        TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out) == DisplayDecodeResult::Ok);
+
+        TEST_ASSERT_TRUE(sameData(d, out));
+    }
+}
+
+void test_binary_setpoints_leave_flight_fields()
+{
+    DisplayData d   = sample();
+    DisplayData out = sample();
+    uint8_t     aFrame[64];
+
+    out.iPitch10 = 1;
+    d.iStall10   = 160;
+    size_t n = encodeDisplaySetpoints(d, 0, aFrame, sizeof(aFrame));
+    TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out) == DisplayDecodeResult::Ok);
+    TEST_ASSERT_EQUAL_INT16(1,   out.iPitch10);
+    TEST_ASSERT_EQUAL_INT16(160, out.iStall10);
+}
+
+void test_binary_rejects_damage()
+{
+    DisplayData out = {};
+    uint8_t     aFrame[64];
+    size_t      n = encodeDisplayFlight(sample(), 7, aFrame, sizeof(aFrame));
+
+    TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n - 1, out) == DisplayDecodeResult::BadLength);
+
+    aFrame[10] ^= 0x01;
+    TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out) == DisplayDecodeResult::BadCrc);
+    aFrame[10] ^= 0x01;
+
+    aFrame[0] = 0x00;
+    TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out) == DisplayDecodeResult::BadHeader);
+    aFrame[0] = kDisplaySync1;
+
+    TEST_ASSERT_EQUAL(0, encodeDisplayFlight(sample(), 0, aFrame, kDisplayFlightFrameLen - 1));
+}
+
+void test_binary_unknown_type_is_skippable()
+{
+    // A well-formed frame of a future message type
+    uint8_t aFrame[64];
+    size_t  n = encodeDisplaySetpoints(sample(), 0, aFrame, sizeof(aFrame));
+    aFrame[2] = 0x7F;
+    uint16_t uCrc = crc16Ccitt(aFrame + 2, n - 4);
+    aFrame[n - 2] = uint8_t(uCrc);
+    aFrame[n - 1] = uint8_t(uCrc >> 8);
+
+    DisplayData out = sample();
+    TEST_ASSERT_TRUE(decodeDisplayFrame(aFrame, n, out) == DisplayDecodeResult::UnknownType);
+}
+
+// ============================================================================
+// Stream framing
+// ============================================================================
+
+class CollectSink : public SerialFrameSink {
+public:
+    void onFrame(const SerialFrame & frame) override
+    {
+        DisplayData d = {};
+        uint8_t     uSeq;
+        if (decodeDisplayFrame(frame.pData, frame.uLen, d, &uSeq) == DisplayDecodeResult::Ok)
+            seqs.push_back(uSeq);
+    }
+    std::vector<uint8_t> seqs;
+};
+
+void test_framer_finds_frames_in_noisy_stream()
+{
+    std::vector<uint8_t> stream = { 0x00, kDisplaySync1, 0x13, kDisplaySync1 };  // Junk and a false start
+    uint8_t aFrame[64];
+
+    for (uint8_t uSeq = 0; uSeq < 10; uSeq++) {
+        size_t n = encodeDisplayFlight(sample(), uSeq, aFrame, sizeof(aFrame));
+        if (uSeq == 4)
+            aFrame[12] ^= 0x40;                     // Corrupted on the wire
+        stream.insert(stream.end(), aFrame, aFrame + n);
+        if (uSeq == 6)
+            stream.push_back(0x55);                 // Stray byte between frames
+    }
+
+    DisplayFramer framer(87);
+    CollectSink   sink;
+    for (size_t i = 0; i < stream.size(); i += 5)
+        framer.push(&stream[i], std::min<size_t>(5, stream.size() - i), 0, sink);
+
+    TEST_ASSERT_EQUAL(9, sink.seqs.size());
+    TEST_ASSERT_EQUAL_UINT8(3, sink.seqs[3]);
+    TEST_ASSERT_EQUAL_UINT8(5, sink.seqs[4]);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.stats().uRejected);
+}
+
+// ============================================================================
+// Wire budget
+// ============================================================================
+
+void test_bytes_on_the_wire()
+{
+    // Setpoints once a second at a 20 Hz flight rate
+    const double dText   = double(kOnSpeedSentenceLen);
+    const double dBinary = kDisplayFlightFrameLen + kDisplaySetpointFrameLen / 20.0;
+
+    // 10 bits per byte at 115200 baud
+    const double dLinkBytesPerSec = 11520.0;
+
+    char szMsg[200];
+    snprintf(szMsg, sizeof(szMsg),
+             "ONSPEED text %.0f bytes/update, binary %.1f bytes/update (%.1fx); 50 Hz uses %.0f%% of the link (text %.0f%%)",
+             dText, dBinary, dText / dBinary,
+             100.0 * dBinary * 50 / dLinkBytesPerSec, 100.0 * dText * 50 / dLinkBytesPerSec);
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_TRUE(dText / dBinary > 2.0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Text sentences
+    RUN_TEST(test_onspeed_sentence_known_value);
+    RUN_TEST(test_g3x_sentence_known_value);
+    RUN_TEST(test_text_matches_legacy_over_full_range);
+    RUN_TEST(test_text_refuses_small_buffer);
+
+    // Binary frames
+    RUN_TEST(test_binary_round_trip);
+    RUN_TEST(test_binary_setpoints_leave_flight_fields);
+    RUN_TEST(test_binary_rejects_damage);
+    RUN_TEST(test_binary_unknown_type_is_skippable);
+
+    // Stream framing
+    RUN_TEST(test_framer_finds_frames_in_noisy_stream);
+
+    // Wire budget
+    RUN_TEST(test_bytes_on_the_wire);
+
+    return UNITY_END();
+}
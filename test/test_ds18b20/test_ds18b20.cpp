@@ -0,0 +1,255 @@
+// test_ds18b20.cpp - Unit tests for the non-blocking DS18B20 reader
+
+#include <unity.h>
+#include <Ds18b20.h>
+#include <Checksum.h>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Fake sensor
+// ============================================================================
+
+/// A single DS18B20 behind skip ROM. Serves a scratchpad built from
+/// iCounts (1/16 C), and counts bus operations so tests can check that no
+/// single update() does much work.
+class FakeDs18b20 : public OneWirePort {
+public:
+    bool        bPresent    = true;
+    bool        bCorruptCrc = false;
+    bool        bSkipConvert = false;   ///< Ignore Convert T
+    int16_t     iCounts     = 0;
+    int         iConversions = 0;
+    int         iOps        = 0;        ///< reset, write or read calls
+
+    bool reset() override
+    {
+        iOps++;
+        _iCmdBytes  = 0;
+        _iReadIndex = -1;
+        return bPresent;
+    }
+
+    void write(uint8_t uByte) override
+    {
+        iOps++;
+        if (_iCmdBytes++ == 0)
+            return;                         // ROM command
+        if (uByte == Ds18b20Reader::kConvertT) {
+            iConversions++;
+            _bConverted = !bSkipConvert;
+        }
+        else if (uByte == Ds18b20Reader::kReadScratchpad) {
+            buildScratchpad();
+            _iReadIndex = 0;
+        }
+    }
+
+    uint8_t read() override
+    {
+        iOps++;
+        if (!bPresent)
+            return 0xFF;
+        if (_iReadIndex < 0 || _iReadIndex >= 9)
+            return 0xFF;
+        return _aScratch[_iReadIndex++];
+    }
+
+private:
+    void buildScratchpad()
+    {
+        const int16_t iTemp = _bConverted ? iCounts : int16_t(0x0550);
+
+        _aScratch[0] = uint8_t(iTemp);
+        _aScratch[1] = uint8_t(uint16_t(iTemp) >> 8);
+        _aScratch[2] = 0x4B;                // TH
+        _aScratch[3] = 0x46;                // TL
+        _aScratch[4] = 0x7F;                // 12 bit config
+        _aScratch[5] = 0xFF;
+        _aScratch[6] = 0x0C;
+        _aScratch[7] = 0x10;
+        _aScratch[8] = crc8Maxim(_aScratch, 8);
+        if (bCorruptCrc)
+            _aScratch[8] ^= 0x01;
+    }
+
+    int         _iCmdBytes  = 0;
+    int         _iReadIndex = -1;
+    bool        _bConverted = false;
+    uint8_t     _aScratch[9] = {};
+};
+
+static const uint32_t kCycleMs = 20;
+
+/// Run the reader at the 50 Hz loop rate from uNowMs for uSpanMs.
+/// @return The most bus operations any single update() did
+static int runFor(Ds18b20Reader & reader, FakeDs18b20 & bus, uint32_t & uNowMs, uint32_t uSpanMs)
+{
+    int iMaxOps = 0;
+    for (uint32_t n = 0; n < uSpanMs / kCycleMs; n++, uNowMs += kCycleMs) {
+        bus.iOps = 0;
+        reader.update(uNowMs);
+        if (bus.iOps > iMaxOps)
+            iMaxOps = bus.iOps;
+    }
+    return iMaxOps;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+void test_first_reading_after_conversion_time()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 5000;
+
+    bus.iCounts = 0x0191;                   // 25.0625 C
+
+    runFor(reader, bus, uNowMs, Ds18b20Reader::kConvertMs - kCycleMs);
+    TEST_ASSERT_FALSE(reader.valid());
+    TEST_ASSERT_TRUE(reader.state() == Ds18b20Reader::State::Converting);
+
+    // Read command, then 9 bytes three at a time
+    runFor(reader, bus, uNowMs, 6 * kCycleMs);
+    TEST_ASSERT_TRUE(reader.valid());
+    TEST_ASSERT_EQUAL_FLOAT(25.0625f, reader.tempC());
+    TEST_ASSERT_EQUAL_UINT32(1, reader.readings());
+    TEST_ASSERT_EQUAL_UINT32(0, reader.errors());
+    TEST_ASSERT_TRUE(reader.ageMs(uNowMs) < 2 * kCycleMs);
+}
+
+void test_no_update_does_more_than_a_few_bus_ops()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0;
+
+    bus.iCounts = 0x0150;
+    const int iMaxOps = runFor(reader, bus, uNowMs, 10000);
+
+    // reset plus two command bytes, or kBytesPerUpdate reads
+    TEST_ASSERT_TRUE(iMaxOps <= 3);
+    TEST_ASSERT_EQUAL_INT(10, bus.iConversions);
+    TEST_ASSERT_EQUAL_UINT32(10, reader.readings());
+}
+
+void test_negative_temperature()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0;
+
+    bus.iCounts = int16_t(0xFE6F);          // -25.0625 C
+    runFor(reader, bus, uNowMs, 1000);
+
+    TEST_ASSERT_TRUE(reader.valid());
+    TEST_ASSERT_EQUAL_FLOAT(-25.0625f, reader.tempC());
+}
+
+void test_bad_crc_keeps_last_good_value()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0;
+
+    bus.iCounts = 0x00A0;                   // 10 C
+    runFor(reader, bus, uNowMs, 1000);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, reader.tempC());
+
+    bus.iCounts     = 0x0140;               // 20 C, but corrupted
+    bus.bCorruptCrc = true;
+    runFor(reader, bus, uNowMs, 1000);
+
+    TEST_ASSERT_TRUE(reader.valid());
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, reader.tempC());
+    TEST_ASSERT_EQUAL_UINT32(1, reader.errors());
+    TEST_ASSERT_TRUE(reader.ageMs(uNowMs) >= 1000);
+}
+
+void test_missing_sensor_never_valid()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0;
+
+    bus.bPresent = false;
+    const int iMaxOps = runFor(reader, bus, uNowMs, 3000);
+
+    // One failed reset a period, nothing else
+    TEST_ASSERT_FALSE(reader.valid());
+    TEST_ASSERT_EQUAL_INT(1, iMaxOps);
+    TEST_ASSERT_EQUAL_UINT32(3, reader.errors());
+    TEST_ASSERT_TRUE(reader.state() == Ds18b20Reader::State::Idle);
+}
+
+void test_power_on_value_rejected()
+{
+    // A sensor that browns out between convert and read comes back with
+    // the 85 C power-on value, which has a perfectly good CRC.
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0;
+
+    bus.bSkipConvert = true;
+    runFor(reader, bus, uNowMs, 1000);
+
+    TEST_ASSERT_FALSE(reader.valid());
+    TEST_ASSERT_EQUAL_UINT32(1, reader.errors());
+}
+
+void test_period_respected()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus, 2000);
+    uint32_t        uNowMs = 0;
+
+    runFor(reader, bus, uNowMs, 10000);
+    TEST_ASSERT_EQUAL_INT(5, bus.iConversions);
+}
+
+void test_clock_wrap()
+{
+    FakeDs18b20     bus;
+    Ds18b20Reader   reader(&bus);
+    uint32_t        uNowMs = 0xFFFFFFFFu - 400;
+
+    bus.iCounts = 0x0050;                   // 5 C
+    runFor(reader, bus, uNowMs, 3000);
+
+    TEST_ASSERT_EQUAL_UINT32(3, reader.readings());
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, reader.tempC());
+}
+
+void test_no_bus_does_nothing()
+{
+    Ds18b20Reader reader;
+
+    reader.update(0);
+    reader.update(2000);
+    TEST_ASSERT_FALSE(reader.valid());
+    TEST_ASSERT_EQUAL_UINT32(0, reader.errors());
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_reading_after_conversion_time);
+    RUN_TEST(test_no_update_does_more_than_a_few_bus_ops);
+    RUN_TEST(test_negative_temperature);
+    RUN_TEST(test_bad_crc_keeps_last_good_value);
+    RUN_TEST(test_missing_sensor_never_valid);
+    RUN_TEST(test_power_on_value_rejected);
+    RUN_TEST(test_period_respected);
+    RUN_TEST(test_clock_wrap);
+    RUN_TEST(test_no_bus_does_nothing);
+
+    return UNITY_END();
+}
@@ -0,0 +1,489 @@
+// test_efis_text_parser.cpp - Unit tests for the Dynon / Garmin text EFIS parsers
+
+#include <unity.h>
+#include <EfisTextParser.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// ============================================================================
+// Sentence helpers
+// ============================================================================
+
+// Write text at a fixed offset
+static void put(std::string & s, size_t off, const char * text)
+{
+    s.replace(off, std::strlen(text), text);
+}
+
+// Append the 2 hex digit additive checksum and CR LF
+static std::string finish(std::string body)
+{
+    unsigned sum = 0;
+    for (unsigned char c : body) sum += c;
+    char szCrc[3];
+    std::snprintf(szCrc, sizeof(szCrc), "%02X", sum & 0xFF);
+    return body + szCrc + "\r\n";
+}
+
+static std::string skyviewAdahrs(const char * pitch = "+045", const char * roll = "-0123",
+                                 const char * ias = "0987", const char * palt = "+05280")
+{
+    std::string s = "!11";
+    s += "12345678";        // time      3..10
+    s += pitch;             // pitch    11..14
+    s += roll;              // roll     15..19
+    s += "275";             // heading  20..22
+    s += ias;               // IAS      23..26
+    s += palt;              // Palt     27..32
+    s += "-012";            // turn     33..36
+    s += "+02";             // lat G    37..39
+    s += "+11";             // vert G   40..42
+    s += "45";              // AOA %    43..44
+    s += "-005";            // VSI      45..48
+    s += "+15";             // OAT      49..51
+    s += "1034";            // TAS      52..55
+    s += "992";             // baro     56..58
+    s += "+06100";          // DA       59..64
+    s += "270";             // wind dir 65..67
+    s += "15";              // wind spd 68..69
+    return finish(s);
+}
+
+static std::string skyviewEms()
+{
+    std::string s(221, '0');
+    put(s, 0,   "!31");
+    put(s, 18,  "2450");    // RPM
+    put(s, 26,  "235");     // MAP
+    put(s, 29,  "087");     // FF
+    put(s, 44,  "312");     // fuel remaining
+    put(s, 217, "065");     // percent power
+    return finish(s);
+}
+
+static std::string dynonD10(const char * status = "01")
+{
+    std::string s = "";
+    s += "12345678";        // time     0..7
+    s += "-023";            // pitch    8..11
+    s += "+0456";           // roll    12..16
+    s += "123";             // heading 17..19
+    s += "0612";            // IAS     20..23  m/s * 10
+    s += "01500";           // Palt    24..28  meters
+    s += "+025";            // VSI     29..32  ft/s * 10
+    s += "-05";             // lat G   33..35
+    s += "+10";             // vert G  36..38
+    s += "37";              // AOA %   39..40
+    s += "0000";            //         41..44
+    s += status;            // status  45..46
+    s += "00";              //         47..48
+    return finish(s);
+}
+
+static std::string garminAttitude(const char * ias = "1105", const char * pitch = "+032")
+{
+    std::string s = "=11";
+    s += "09301512";        // time      3..10
+    s += pitch;             // pitch    11..14
+    s += "-0150";           // roll     15..19
+    s += "090";             // heading  20..22
+    s += ias;               // IAS      23..26
+    s += "+08500";          // Palt     27..32
+    s += "+001";            // turn     33..36
+    s += "-01";             // lat G    37..39
+    s += "+10";             // vert G   40..42
+    s += "52";              // AOA %    43..44
+    s += "+050";            // VSI      45..48
+    s += "-05";             // OAT      49..51
+    s += "299";             // altset   52..54
+    return finish(s);
+}
+
+static std::string garminEngine()
+{
+    std::string s(217, '0');
+    put(s, 0,  "=31");
+    put(s, 18, "2300");     // RPM
+    put(s, 26, "241");      // MAP
+    put(s, 29, "092");      // FF
+    put(s, 44, "275");      // fuel remaining
+    return finish(s);
+}
+
+static EfisData zeroData()
+{
+    EfisData d;
+    std::memset(&d, 0, sizeof(d));
+    return d;
+}
+
+// ============================================================================
+// Legacy reference (the old String substring()/toFloat() code, on std::string)
+// ============================================================================
+
+static float legacyToFloat(const std::string & s) { return static_cast<float>(std::atof(s.c_str())); }
+static long  legacyToInt  (const std::string & s) { return std::atol(s.c_str()); }
+
+static bool legacySkyViewAdahrs(const std::string & b, EfisData & e)
+{
+    if (b.length() != 74 || b[0] != '!' || b[1] != '1') return false;
+    int calcCRC = 0;
+    for (int i = 0; i <= 69; i++) calcCRC += b[i];
+    calcCRC = calcCRC & 0xFF;
+    if (calcCRC != (int)std::strtol(b.substr(70, 2).c_str(), NULL, 16)) return false;
+
+    std::string p;
+    p = b.substr(23, 4); if (p != "XXXX")   e.IAS         = legacyToFloat(p)/10;  else e.IAS = -1;
+    p = b.substr(11, 4); if (p != "XXXX")   e.Pitch       = legacyToFloat(p)/10;  else e.Pitch = -100;
+    p = b.substr(15, 5); if (p != "XXXXX")  e.Roll        = legacyToFloat(p)/10;  else e.Roll = -180;
+    p = b.substr(20, 3); if (p != "XXX")    e.Heading     = legacyToInt(p);       else e.Heading = -1;
+    p = b.substr(37, 3); if (p != "XXX")    e.LateralG    = legacyToFloat(p)/100; else e.LateralG = -100;
+    p = b.substr(40, 3); if (p != "XXX")    e.VerticalG   = legacyToFloat(p)/10;  else e.VerticalG = -100;
+    p = b.substr(43, 2); if (p != "XX")     e.PercentLift = legacyToInt(p);       else e.PercentLift = -1;
+    p = b.substr(27, 6); if (p != "XXXXXX") e.Palt        = legacyToInt(p);       else e.Palt = -10000;
+    p = b.substr(45, 4); if (p != "XXXX")   e.VSI         = legacyToInt(p) * 10;  else e.VSI = -10000;
+    p = b.substr(52, 4); if (p != "XXXX")   e.TAS         = legacyToFloat(p)/10;  else e.TAS = -1;
+    p = b.substr(49, 3); if (p != "XXX")    e.OAT         = legacyToFloat(p);     else e.OAT = -100;
+    return true;
+}
+
+static bool legacyDynonD10(const std::string & b, EfisData & e)
+{
+    if (b.length() != 53) return false;
+    int calcCRC = 0;
+    for (int i = 0; i <= 48; i++) calcCRC += b[i];
+    calcCRC = calcCRC & 0xFF;
+    if (calcCRC != (int)std::strtol(b.substr(49, 2).c_str(), NULL, 16)) return false;
+
+    e.IAS         = legacyToFloat(b.substr(20, 4)) / 10 * 1.94384;
+    e.Pitch       = legacyToFloat(b.substr(8, 4))/10;
+    e.Roll        = legacyToFloat(b.substr(12, 5))/10;
+    e.LateralG    = legacyToFloat(b.substr(33, 3))/100;
+    e.VerticalG   = legacyToFloat(b.substr(36, 3))/10;
+    e.PercentLift = legacyToInt(b.substr(39, 2));
+    long statusBitInt = std::strtol(b.substr(46, 1).c_str(), NULL, 16);
+    if (statusBitInt & 1) {
+        e.Palt = legacyToInt(b.substr(24, 5))*3.28084;
+        e.VSI  = int(legacyToFloat(b.substr(29, 4))/10*60);
+    }
+    return true;
+}
+
+// Bitwise compare of the numeric fields
+static void assertSameNumbers(const EfisData & a, const EfisData & b)
+{
+    TEST_ASSERT_EQUAL_MEMORY(&a, &b, offsetof(EfisData, szTime));
+}
+
+// ============================================================================
+// Low-level helpers
+// ============================================================================
+
+void test_parse_fixed_int()
+{
+    TEST_ASSERT_EQUAL_INT32(45,     parseFixedInt("+045", 4));
+    TEST_ASSERT_EQUAL_INT32(-123,   parseFixedInt("-0123", 5));
+    TEST_ASSERT_EQUAL_INT32(987,    parseFixedInt("0987", 4));
+    TEST_ASSERT_EQUAL_INT32(12,     parseFixedInt(" 12", 3));
+    TEST_ASSERT_EQUAL_INT32(0,      parseFixedInt("+", 1));
+    TEST_ASSERT_EQUAL_INT32(12,     parseFixedInt("12X4", 4));   // atol stops at non-digit
+    TEST_ASSERT_EQUAL_INT32(12,     parseFixedInt("123456", 2)); // never reads past the width
+    TEST_ASSERT_EQUAL_INT32(-99999, parseFixedInt("-99999", 6));
+}
+
+void test_sentinel_and_hex()
+{
+    TEST_ASSERT_TRUE (isSentinelField("XXXX", 4, 'X'));
+    TEST_ASSERT_FALSE(isSentinelField("XX0X", 4, 'X'));
+    TEST_ASSERT_TRUE (isSentinelField("___", 3, '_'));
+
+    TEST_ASSERT_EQUAL_INT(0xA7, parseHexByte("A7"));
+    TEST_ASSERT_EQUAL_INT(0xA7, parseHexByte("a7"));
+    TEST_ASSERT_EQUAL_INT(-1,   parseHexByte("G7"));
+}
+
+// ============================================================================
+// Dynon SkyView
+// ============================================================================
+
+void test_skyview_adahrs_fields()
+{
+    std::string line = skyviewAdahrs();
+    TEST_ASSERT_EQUAL_UINT(74, line.size());
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+
+    TEST_ASSERT_EQUAL_FLOAT(98.7f,  d.IAS);
+    TEST_ASSERT_EQUAL_FLOAT(4.5f,   d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(-12.3f, d.Roll);
+    TEST_ASSERT_EQUAL_INT(275,      d.Heading);
+    TEST_ASSERT_EQUAL_FLOAT(0.02f,  d.LateralG);
+    TEST_ASSERT_EQUAL_FLOAT(1.1f,   d.VerticalG);
+    TEST_ASSERT_EQUAL_INT(45,       d.PercentLift);
+    TEST_ASSERT_EQUAL_INT(5280,     d.Palt);
+    TEST_ASSERT_EQUAL_INT(-50,      d.VSI);
+    TEST_ASSERT_EQUAL_FLOAT(103.4f, d.TAS);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f,  d.OAT);
+    TEST_ASSERT_EQUAL_STRING("12:34:56.78", d.szTime);
+}
+
+void test_skyview_adahrs_sentinels_set_invalid()
+{
+    std::string line = skyviewAdahrs("XXXX", "XXXXX", "XXXX", "XXXXXX");
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f,   d.IAS);
+    TEST_ASSERT_EQUAL_FLOAT(-100.0f, d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(-180.0f, d.Roll);
+    TEST_ASSERT_EQUAL_INT(-10000,    d.Palt);
+    TEST_ASSERT_EQUAL_INT(275,       d.Heading);   // untouched field still decoded
+}
+
+void test_skyview_bad_checksum_leaves_data()
+{
+    std::string line = skyviewAdahrs();
+    line[24] = '1';     // corrupt IAS, checksum no longer matches
+
+    EfisData d = zeroData();
+    d.IAS = 55.0f;
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), d) == EfisParseResult::BadChecksum);
+    TEST_ASSERT_EQUAL_FLOAT(55.0f, d.IAS);
+}
+
+void test_skyview_wrong_length_or_type_ignored()
+{
+    std::string line = skyviewAdahrs();
+    EfisData d = zeroData();
+
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size() - 1, d) == EfisParseResult::Ignored);
+
+    line[1] = '2';
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), d) == EfisParseResult::Ignored);
+}
+
+void test_skyview_ems_fields()
+{
+    std::string line = skyviewEms();
+    TEST_ASSERT_EQUAL_UINT(225, line.size());
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+
+    TEST_ASSERT_EQUAL_INT(2450,     d.RPM);
+    TEST_ASSERT_EQUAL_FLOAT(23.5f,  d.MAP);
+    TEST_ASSERT_EQUAL_FLOAT(8.7f,   d.FuelFlow);
+    TEST_ASSERT_EQUAL_FLOAT(31.2f,  d.FuelRemaining);
+    TEST_ASSERT_EQUAL_INT(65,       d.PercentPower);
+}
+
+// ============================================================================
+// Dynon D10
+// ============================================================================
+
+void test_d10_fields_with_altitude()
+{
+    std::string line = dynonD10("01");
+    TEST_ASSERT_EQUAL_UINT(53, line.size());
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseDynonD10Line(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 61.2f * 1.94384f, d.IAS);
+    TEST_ASSERT_EQUAL_FLOAT(-2.3f,   d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(45.6f,   d.Roll);
+    TEST_ASSERT_EQUAL_FLOAT(-0.05f,  d.LateralG);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f,    d.VerticalG);
+    TEST_ASSERT_EQUAL_INT(37,        d.PercentLift);
+    TEST_ASSERT_EQUAL_INT(4921,      d.Palt);      // 1500 m
+    TEST_ASSERT_EQUAL_INT(150,       d.VSI);       // 2.5 ft/s
+    TEST_ASSERT_EQUAL_STRING("12:34:56.78", d.szTime);
+}
+
+void test_d10_status_bit_clear_keeps_altitude()
+{
+    std::string line = dynonD10("00");
+
+    EfisData d = zeroData();
+    d.Palt = 1234;
+    d.VSI  = -300;
+    TEST_ASSERT_TRUE(parseDynonD10Line(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+    TEST_ASSERT_EQUAL_INT(1234, d.Palt);
+    TEST_ASSERT_EQUAL_INT(-300, d.VSI);
+}
+
+// ============================================================================
+// Garmin G5 / G3X
+// ============================================================================
+
+void test_g5_attitude_fields()
+{
+    std::string line = garminAttitude();
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseGarminG5Line(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+
+    TEST_ASSERT_EQUAL_FLOAT(110.5f, d.IAS);
+    TEST_ASSERT_EQUAL_FLOAT(3.2f,   d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(-15.0f, d.Roll);
+    TEST_ASSERT_EQUAL_INT(90,       d.Heading);
+    TEST_ASSERT_EQUAL_INT(8500,     d.Palt);
+    TEST_ASSERT_EQUAL_INT(500,      d.VSI);
+    TEST_ASSERT_EQUAL_INT(0,        d.PercentLift); // G5 doesn't use it
+    TEST_ASSERT_EQUAL_FLOAT(0.0f,   d.OAT);
+    TEST_ASSERT_EQUAL_STRING("09:30:15.12", d.szTime);
+}
+
+void test_garmin_underscores_keep_previous()
+{
+    std::string line = garminAttitude("____", "____");
+
+    EfisData d = zeroData();
+    d.IAS   = 77.0f;
+    d.Pitch = 2.0f;
+    TEST_ASSERT_TRUE(parseGarminG3XLine(line.c_str(), line.size(), d) == EfisParseResult::Ok);
+    TEST_ASSERT_EQUAL_FLOAT(77.0f, d.IAS);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f,  d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(-15.0f, d.Roll);
+}
+
+void test_g3x_attitude_and_engine()
+{
+    std::string att = garminAttitude();
+    std::string eng = garminEngine();
+    TEST_ASSERT_EQUAL_UINT(221, eng.size());
+
+    EfisData d = zeroData();
+    TEST_ASSERT_TRUE(parseGarminG3XLine(att.c_str(), att.size(), d) == EfisParseResult::Ok);
+    TEST_ASSERT_EQUAL_INT(52,      d.PercentLift);
+    TEST_ASSERT_EQUAL_FLOAT(-5.0f, d.OAT);
+
+    TEST_ASSERT_TRUE(parseGarminG3XLine(eng.c_str(), eng.size(), d) == EfisParseResult::Ok);
+    TEST_ASSERT_EQUAL_INT(2300,    d.RPM);
+    TEST_ASSERT_EQUAL_FLOAT(24.1f, d.MAP);
+    TEST_ASSERT_EQUAL_FLOAT(9.2f,  d.FuelFlow);
+    TEST_ASSERT_EQUAL_FLOAT(27.5f, d.FuelRemaining);
+    TEST_ASSERT_EQUAL_FLOAT(110.5f, d.IAS);        // attitude values untouched
+}
+
+// ============================================================================
+// Bit-exact against the legacy String code
+// ============================================================================
+
+void test_skyview_matches_legacy_decode()
+{
+    char szPitch[12], szRoll[12], szIas[12], szPalt[12];   // Room for any int
+    for (int i = 0; i < 2000; i++) {
+        const int iPitch = (i * 37) % 1799 - 899;
+        const int iRoll  = (i * 53) % 3599 - 1799;
+        std::snprintf(szPitch, sizeof(szPitch), "%+04d", iPitch);
+        std::snprintf(szRoll,  sizeof(szRoll),  "%+05d", iRoll);
+        std::snprintf(szIas,   sizeof(szIas),   "%04d",  (i * 7) % 3000);
+        std::snprintf(szPalt,  sizeof(szPalt),  "%+06d", i * 11 - 1000);
+        std::string line = skyviewAdahrs(szPitch, szRoll, szIas, szPalt);
+
+        EfisData dNew = zeroData();
+        EfisData dOld = zeroData();
+        TEST_ASSERT_TRUE(parseSkyViewLine(line.c_str(), line.size(), dNew) == EfisParseResult::Ok);
+        TEST_ASSERT_TRUE(legacySkyViewAdahrs(line, dOld));
+        assertSameNumbers(dOld, dNew);
+    }
+}
+
+void test_d10_matches_legacy_decode()
+{
+    const char * aszStatus[] = { "00", "01", "02", "03" };
+    for (const char * szStatus : aszStatus) {
+        std::string line = dynonD10(szStatus);
+        EfisData dNew = zeroData();
+        EfisData dOld = zeroData();
+        TEST_ASSERT_TRUE(parseDynonD10Line(line.c_str(), line.size(), dNew) == EfisParseResult::Ok);
+        TEST_ASSERT_TRUE(legacyDynonD10(line, dOld));
+        assertSameNumbers(dOld, dNew);
+    }
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_throughput()
+{
+    const std::string line = skyviewAdahrs();
+    const int         iIters = 200000;
+    EfisData          dNew = zeroData();
+    EfisData          dOld = zeroData();
+    int               iOk = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iIters; i++)
+        iOk += parseSkyViewLine(line.c_str(), line.size(), dNew) == EfisParseResult::Ok;
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iIters; i++)
+        iOk += legacySkyViewAdahrs(line, dOld);
+    auto t2 = std::chrono::steady_clock::now();
+
+    const double dNewNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / iIters;
+    const double dOldNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / iIters;
+
+    char szMsg[160];
+    std::snprintf(szMsg, sizeof(szMsg),
+        "SkyView !1: table parser %.0f ns/line (%.1f MB/s), substring reference %.0f ns/line",
+        dNewNs, line.size() * 1e3 / dNewNs, dOldNs);
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_EQUAL_INT(2 * iIters, iOk);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Helpers
+    RUN_TEST(test_parse_fixed_int);
+    RUN_TEST(test_sentinel_and_hex);
+
+    // SkyView
+    RUN_TEST(test_skyview_adahrs_fields);
+    RUN_TEST(test_skyview_adahrs_sentinels_set_invalid);
+    RUN_TEST(test_skyview_bad_checksum_leaves_data);
+    RUN_TEST(test_skyview_wrong_length_or_type_ignored);
+    RUN_TEST(test_skyview_ems_fields);
+
+    // D10
+    RUN_TEST(test_d10_fields_with_altitude);
+    RUN_TEST(test_d10_status_bit_clear_keeps_altitude);
+
+    // Garmin
+    RUN_TEST(test_g5_attitude_fields);
+    RUN_TEST(test_garmin_underscores_keep_previous);
+    RUN_TEST(test_g3x_attitude_and_engine);
+
+    // Legacy equivalence
+    RUN_TEST(test_skyview_matches_legacy_decode);
+    RUN_TEST(test_d10_matches_legacy_decode);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_throughput);
+#endif
+
+    return UNITY_END();
+}
@@ -0,0 +1,220 @@
+// test_filter_analysis.cpp - Unit tests for filter figures and the AOA filter choice
+
+#include <unity.h>
+#include <FilterAnalysis.h>
+#include <AlphaBetaFilter.h>
+
+#include <cmath>
+#include <cstdio>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Single filters wrapped for measureFilter()
+class AverageUnderTest : public SignalFilter {
+public:
+    explicit AverageUnderTest(int iWindow) : _Avg(iWindow) {}
+    void    reset() override                { _Avg.reset(); }
+    float   update(float fValue) override   { return _Avg.add(fValue); }
+private:
+    MovingAverage   _Avg;
+};
+
+class EmaUnderTest : public SignalFilter {
+public:
+    explicit EmaUnderTest(float fAlpha) : _Ema(fAlpha) {}
+    void    reset() override                { _Ema.reset(); }
+    float   update(float fValue) override   { return _Ema.update(fValue); }
+private:
+    EMAFilter       _Ema;
+};
+
+class AlphaBetaUnderTest : public SignalFilter {
+public:
+    explicit AlphaBetaUnderTest(float fTheta) : _Ab(fTheta) {}
+    void    reset() override                { _Ab.reset(); }
+    float   update(float fValue) override   { return _Ab.update(fValue); }
+private:
+    AlphaBetaFilter _Ab;
+};
+
+/// Default AOA_SMOOTHING 20 and PRESSURE_SMOOTHING 15 at a loop rate
+static SmoothingParams defaultParams(int iHz)
+{
+    return SmoothingParams::forRate(SmoothingTimes::fromConfig(20, 15), iHz);
+}
+
+// ============================================================================
+// Alpha-beta filter
+// ============================================================================
+
+void test_alpha_beta_gains_from_theta()
+{
+    AlphaBetaFilter f(0.9f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.19f, f.getAlpha());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.01f, f.getBeta());
+
+    f.setTheta(-1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, f.getAlpha());
+    f.setTheta(2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.999f, f.getTheta());
+}
+
+void test_alpha_beta_seeds_and_ignores_nan()
+{
+    AlphaBetaFilter f(0.95f);
+
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, f.update(7.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, f.rate());
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, f.update(NAN));
+
+    // Theta 0 is pass-through
+    AlphaBetaFilter pass(0.0f);
+    pass.update(1.0f);
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, pass.update(-3.0f));
+}
+
+void test_alpha_beta_tracks_ramp_rate()
+{
+    AlphaBetaFilter f(0.9f);
+
+    for (int k = 0; k < 500; k++)
+        f.update(0.25f * k);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.25f, f.rate());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.25f * 499, f.get());
+}
+
+// ============================================================================
+// Figures against theory
+// ============================================================================
+
+void test_moving_average_figures()
+{
+    // 11 samples at 50 Hz: group delay 5 samples, noise 1/sqrt(11)
+    AverageUnderTest avg(11);
+    FilterFigures    fig = measureFilter(avg, 50);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.1f, fig.fRampLagSec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.1f, fig.fStep50Sec);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fig.fOvershoot);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f / std::sqrt(11.0f), fig.fNoiseGain);
+}
+
+void test_ema_figures()
+{
+    // Group delay (1 - a) / a samples, noise sqrt(a / (2 - a))
+    const float     fAlpha = 0.05f;
+    EmaUnderTest    ema(fAlpha);
+    FilterFigures   fig = measureFilter(ema, 50);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, (1.0f - fAlpha) / fAlpha / 50.0f, fig.fRampLagSec);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, std::sqrt(fAlpha / (2.0f - fAlpha)), fig.fNoiseGain);
+}
+
+void test_alpha_beta_figures()
+{
+    // No ramp lag, noise per the closed form
+    const float         fTheta = 0.9f;
+    AlphaBetaUnderTest  ab(fTheta);
+    FilterFigures       fig = measureFilter(ab, 50);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, fig.fRampLagSec);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, std::sqrt(AlphaBetaFilter::noiseVarianceRatio(fTheta)), fig.fNoiseGain);
+    TEST_ASSERT_TRUE(fig.fOvershoot > 0.0f);
+}
+
+void test_default_chain_group_delay()
+{
+    // Median 15 (7 samples), average 10 (4.5) and EMA 1/20 (19): 30.5 samples
+    AoaFilterChain chain;
+    chain.configure(defaultParams(50), AoaFilterKind::Ema);
+    FilterFigures  fig = measureFilter(chain, 50);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 30.5f / 50.0f, fig.fRampLagSec);
+}
+
+// ============================================================================
+// Low-latency AOA at equal noise
+// ============================================================================
+
+void test_alpha_beta_chain_cuts_lag_at_equal_noise()
+{
+    char szMsg[200];
+
+    for (int iHz : { 50, 100, 200 }) {
+        const SmoothingParams params = defaultParams(iHz);
+        const float           fTheta = matchAlphaBetaTheta(params);
+
+        AoaFilterChain ema, ab;
+        ema.configure(params, AoaFilterKind::Ema);
+        ab.configure(params, AoaFilterKind::AlphaBeta, fTheta);
+        FilterFigures  figEma = measureFilter(ema, iHz);
+        FilterFigures  figAb  = measureFilter(ab, iHz);
+
+        std::snprintf(szMsg, sizeof(szMsg),
+            "%d Hz theta %.4f: lag %.3f / %.3f s, step 50%% %.3f / %.3f s, 90%% %.3f / %.3f s, overshoot %.3f, noise %.4f / %.4f",
+            iHz, fTheta, figEma.fRampLagSec, figAb.fRampLagSec, figEma.fStep50Sec, figAb.fStep50Sec,
+            figEma.fStep90Sec, figAb.fStep90Sec, figAb.fOvershoot, figEma.fNoiseGain, figAb.fNoiseGain);
+        TEST_MESSAGE(szMsg);
+
+        // Equal noise: no noisier, and within 2%
+        TEST_ASSERT_TRUE(figAb.fNoiseGain <= figEma.fNoiseGain);
+        TEST_ASSERT_FLOAT_WITHIN(0.02f * figEma.fNoiseGain, figEma.fNoiseGain, figAb.fNoiseGain);
+
+        // Ramp lag down to the pressure stages alone. On a step the rate
+        // term has to build up, so half way is a little later, 90% is no
+        // later, and it overshoots some
+        TEST_ASSERT_TRUE(figAb.fRampLagSec < 0.5f * figEma.fRampLagSec);
+        TEST_ASSERT_FLOAT_WITHIN(0.021f, 0.23f, figAb.fRampLagSec);
+        TEST_ASSERT_TRUE(figAb.fStep90Sec <= figEma.fStep90Sec);
+        TEST_ASSERT_TRUE(figAb.fStep50Sec <  figEma.fStep50Sec + 0.1f);
+        TEST_ASSERT_TRUE(figAb.fOvershoot <  0.15f);
+    }
+}
+
+void test_calculator_filter_choice()
+{
+    // Steadily rising P45: the alpha-beta calculator catches up with the
+    // true AOA, the EMA one stays behind
+    const SuCalibrationCurve curve = { { 0.0f, 0.0f, 20.0f, 0.0f }, 1 };
+    AOACalculator ema(20), ab(0);
+    ab.setFilter(AoaFilterKind::AlphaBeta);
+    ab.setTheta(0.98f);
+    TEST_ASSERT_TRUE(ab.filter() == AoaFilterKind::AlphaBeta);
+
+    float fEma = 0.0f, fAb = 0.0f, fTrue = 0.0f;
+    for (int k = 0; k < 1000; k++) {
+        const float p45 = 100.0f + 0.5f * k;
+        fTrue = 20.0f * p45 / 1000.0f;
+        fEma  = ema.calculate(1000.0f, p45, curve).aoa;
+        fAb   = ab.calculate(1000.0f, p45, curve).aoa;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, fTrue, fAb);
+    TEST_ASSERT_TRUE(fTrue - fEma > 0.1f);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Alpha-beta filter
+    RUN_TEST(test_alpha_beta_gains_from_theta);
+    RUN_TEST(test_alpha_beta_seeds_and_ignores_nan);
+    RUN_TEST(test_alpha_beta_tracks_ramp_rate);
+
+    // Figures against theory
+    RUN_TEST(test_moving_average_figures);
+    RUN_TEST(test_ema_figures);
+    RUN_TEST(test_alpha_beta_figures);
+    RUN_TEST(test_default_chain_group_delay);
+
+    // Low-latency AOA at equal noise
+    RUN_TEST(test_alpha_beta_chain_cuts_lag_at_equal_noise);
+    RUN_TEST(test_calculator_filter_choice);
+
+    return UNITY_END();
+}
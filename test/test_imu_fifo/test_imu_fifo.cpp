@@ -0,0 +1,409 @@
+// test_imu_fifo.cpp - Unit tests for the IMU FIFO decoder and multi-sample attitude update
+
+#include <unity.h>
+#include <ImuFifo.h>
+#include <MadgwickFusion.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const float kPi       = 3.14159265f;
+static const float kGyroRes  = 245.0f / 32768.0f;   // dps per count, as IMU330.cpp
+static const float kAccelRes =   8.0f / 32768.0f;   // g per count
+
+// ISM330 registers
+static const uint8_t kFifoStatus1  = 0x3A;
+static const uint8_t kFifoDataTag  = 0x78;
+static const uint8_t kFifoDataLast = 0x7E;
+
+// ============================================================================
+// Simulated FIFO
+// ============================================================================
+
+/// Register level model of the ISM330 FIFO in continuous mode with gyro and
+/// accel batched at the same rate. Each tick() queues a gyro then an accel
+/// word with the same TAG_CNT. read() behaves like an SPI burst: the
+/// address auto-increments, and in the FIFO output block it rolls back from
+/// the last data byte to the tag, popping a word each time round.
+class SimImuFifo {
+public:
+    explicit SimImuFifo(size_t uCapacityWords = 438) : _uCapacity(uCapacityWords) {}
+
+    void tick(const int16_t aiGyro[3], const int16_t aiAccel[3])
+    {
+        push(ImuFifoTag::Gyro,  aiGyro);
+        push(ImuFifoTag::Accel, aiAccel);
+        _uCount = (_uCount + 1) & 0x03;
+    }
+
+    void pushOther(ImuFifoTag enTag)
+    {
+        const int16_t aiZero[3] = { 0, 0, 0 };
+        push(enTag, aiZero);
+    }
+
+    /// Lose the word at the front, as if it was overwritten
+    void dropFront()        { _aWords.pop_front(); }
+
+    void read(uint8_t uReg, uint8_t * pOut, size_t uLen)
+    {
+        for (size_t i = 0; i < uLen; i++) {
+            pOut[i] = readByte(uReg);
+            if (uReg == kFifoDataLast) {
+                if (!_aWords.empty())
+                    _aWords.pop_front();
+                uReg = kFifoDataTag;
+            }
+            else
+                uReg++;
+        }
+    }
+
+    size_t words() const    { return _aWords.size(); }
+
+private:
+    struct Word { uint8_t auBytes[kImuFifoWordBytes]; };
+
+    void push(ImuFifoTag enTag, const int16_t aiXyz[3])
+    {
+        Word word;
+        word.auBytes[0] = uint8_t((uint8_t(enTag) << 3) | (_uCount << 1));
+        for (int i = 0; i < 3; i++) {
+            word.auBytes[1 + 2 * i] = uint8_t(uint16_t(aiXyz[i]) & 0xFF);
+            word.auBytes[2 + 2 * i] = uint8_t(uint16_t(aiXyz[i]) >> 8);
+        }
+
+        if (_aWords.size() == _uCapacity) {
+            _aWords.pop_front();
+            _bOverrun = true;
+        }
+        _aWords.push_back(word);
+    }
+
+    uint8_t readByte(uint8_t uReg)
+    {
+        if (uReg == kFifoStatus1)
+            return uint8_t(_aWords.size() & 0xFF);
+        if (uReg == kFifoStatus1 + 1) {
+            const uint8_t uStatus = uint8_t((_aWords.size() >> 8) & 0x03) | (_bOverrun ? 0x40 : 0x00);
+            _bOverrun = false;
+            return uStatus;
+        }
+        if (uReg >= kFifoDataTag && uReg <= kFifoDataLast)
+            return _aWords.empty() ? 0 : _aWords.front().auBytes[uReg - kFifoDataTag];
+        return 0;
+    }
+
+    std::deque<Word>    _aWords;
+    size_t              _uCapacity;
+    uint8_t             _uCount   = 0;
+    bool                _bOverrun = false;
+};
+
+/// Read everything queued the way IMU330 does: status, then one burst.
+static int readFifo(SimImuFifo & fifo, ImuFifoDecoder & decoder, ImuRawSample * pOut, int iMaxOut)
+{
+    uint8_t auStatus[2];
+    fifo.read(kFifoStatus1, auStatus, 2);
+
+    const ImuFifoStatus     status = ImuFifoStatus::decode(auStatus);
+    std::vector<uint8_t>    aData(size_t(status.iWords) * kImuFifoWordBytes);
+    fifo.read(kFifoDataTag, aData.data(), aData.size());
+    return decoder.decode(aData.data(), status.iWords, pOut, iMaxOut);
+}
+
+static void sampleAt(int n, int16_t aiGyro[3], int16_t aiAccel[3])
+{
+    for (int i = 0; i < 3; i++) {
+        aiGyro[i]  = int16_t(100 * n + i);
+        aiAccel[i] = int16_t(-100 * n - i);
+    }
+}
+
+// ============================================================================
+// Status and decoding
+// ============================================================================
+
+void test_status_decode()
+{
+    const uint8_t auStatus[2] = { 0x2C, 0x41 };
+    ImuFifoStatus status = ImuFifoStatus::decode(auStatus);
+
+    TEST_ASSERT_EQUAL_INT(0x12C, status.iWords);
+    TEST_ASSERT_TRUE(status.bOverrun);
+}
+
+void test_tag_fields()
+{
+    const uint8_t uTag = (0x02 << 3) | (3 << 1) | 1;
+
+    TEST_ASSERT_TRUE(imuFifoTagSensor(uTag) == ImuFifoTag::Accel);
+    TEST_ASSERT_EQUAL_INT(3, imuFifoTagCount(uTag));
+}
+
+void test_decodes_every_sample_in_order()
+{
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[16];
+    int16_t         aiGyro[3], aiAccel[3];
+
+    for (int n = 0; n < 5; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        fifo.tick(aiGyro, aiAccel);
+    }
+
+    TEST_ASSERT_EQUAL_INT(5, readFifo(fifo, decoder, aOut, 16));
+    TEST_ASSERT_EQUAL_size_t(0, fifo.words());
+    for (int n = 0; n < 5; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        for (int i = 0; i < 3; i++) {
+            TEST_ASSERT_EQUAL_INT(aiGyro[i],  aOut[n].aiGyro[i]);
+            TEST_ASSERT_EQUAL_INT(aiAccel[i], aOut[n].aiAccel[i]);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.droppedWords());
+}
+
+void test_pair_split_across_reads()
+{
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[4];
+    int16_t         aiGyro[3], aiAccel[3];
+    uint8_t         auData[kImuFifoWordBytes * 3];
+
+    for (int n = 0; n < 2; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        fifo.tick(aiGyro, aiAccel);
+    }
+
+    // Three words: sample 0 and the gyro half of sample 1
+    fifo.read(kFifoDataTag, auData, sizeof(auData));
+    TEST_ASSERT_EQUAL_INT(1, decoder.decode(auData, 3, aOut, 4));
+
+    TEST_ASSERT_EQUAL_INT(1, readFifo(fifo, decoder, aOut, 4));
+    sampleAt(1, aiGyro, aiAccel);
+    TEST_ASSERT_EQUAL_INT(aiGyro[2],  aOut[0].aiGyro[2]);
+    TEST_ASSERT_EQUAL_INT(aiAccel[2], aOut[0].aiAccel[2]);
+}
+
+void test_accel_before_gyro_pairs()
+{
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[2];
+    uint8_t         auData[kImuFifoWordBytes * 2] = {
+        (0x02 << 3) | (1 << 1), 1, 0, 2, 0, 3, 0,
+        (0x01 << 3) | (1 << 1), 4, 0, 5, 0, 6, 0,
+    };
+
+    TEST_ASSERT_EQUAL_INT(1, decoder.decode(auData, 2, aOut, 2));
+    TEST_ASSERT_EQUAL_INT(1, aOut[0].aiAccel[0]);
+    TEST_ASSERT_EQUAL_INT(6, aOut[0].aiGyro[2]);
+}
+
+void test_other_tags_skipped()
+{
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[4];
+    int16_t         aiGyro[3], aiAccel[3];
+
+    sampleAt(0, aiGyro, aiAccel);
+    fifo.tick(aiGyro, aiAccel);
+    fifo.pushOther(ImuFifoTag::Temperature);
+    fifo.pushOther(ImuFifoTag::Timestamp);
+    sampleAt(1, aiGyro, aiAccel);
+    fifo.tick(aiGyro, aiAccel);
+
+    TEST_ASSERT_EQUAL_INT(2, readFifo(fifo, decoder, aOut, 4));
+    TEST_ASSERT_EQUAL_INT(aiGyro[0], aOut[1].aiGyro[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, decoder.droppedWords());
+}
+
+void test_lost_word_drops_only_its_sample()
+{
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[8];
+    int16_t         aiGyro[3], aiAccel[3];
+
+    for (int n = 0; n < 4; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        fifo.tick(aiGyro, aiAccel);
+    }
+    fifo.dropFront();       // Sample 0's gyro word
+
+    TEST_ASSERT_EQUAL_INT(3, readFifo(fifo, decoder, aOut, 8));
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.droppedWords());
+    sampleAt(1, aiGyro, aiAccel);
+    TEST_ASSERT_EQUAL_INT(aiGyro[0], aOut[0].aiGyro[0]);
+}
+
+void test_output_full_counts_dropped()
+{
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    ImuRawSample    aOut[2];
+    int16_t         aiGyro[3], aiAccel[3];
+
+    for (int n = 0; n < 3; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        fifo.tick(aiGyro, aiAccel);
+    }
+
+    TEST_ASSERT_EQUAL_INT(2, readFifo(fifo, decoder, aOut, 2));
+    TEST_ASSERT_EQUAL_UINT32(2, decoder.droppedWords());
+}
+
+void test_overrun_reported_once()
+{
+    SimImuFifo      fifo(4);
+    uint8_t         auStatus[2];
+    int16_t         aiGyro[3], aiAccel[3];
+
+    for (int n = 0; n < 3; n++) {
+        sampleAt(n, aiGyro, aiAccel);
+        fifo.tick(aiGyro, aiAccel);
+    }
+
+    fifo.read(kFifoStatus1, auStatus, 2);
+    TEST_ASSERT_TRUE(ImuFifoStatus::decode(auStatus).bOverrun);
+    TEST_ASSERT_EQUAL_INT(4, ImuFifoStatus::decode(auStatus).iWords);
+    fifo.read(kFifoStatus1, auStatus, 2);
+    TEST_ASSERT_FALSE(ImuFifoStatus::decode(auStatus).bOverrun);
+}
+
+// ============================================================================
+// Sensor cycle
+// ============================================================================
+
+/// Run iSeconds of a 208 Hz IMU read every 20 msec. fRate(t) gives the roll
+/// rate in dps. With bFifo every queued sample is integrated at the IMU's
+/// dt, otherwise only the output registers at read time are, at the loop dt
+/// as before. Returns the largest roll error seen after each read.
+template <typename RateFn>
+static float runCycles(float fSeconds, bool bFifo, RateFn fRate, int * piSamples = nullptr)
+{
+    const float     fLoopDt = 0.02f;
+    SimImuFifo      fifo;
+    ImuFifoDecoder  decoder;
+    Madgwick        madg;
+    ImuRawSample    aOut[16];
+    int16_t         aiLatest[3] = { 0, 0, 0 };
+    const int16_t   aiNoAccel[3] = { 0, 0, 0 };
+    int             iTick    = 0;
+    int             iSamples = 0;
+    float           fMaxErr  = 0.0f;
+
+    madg.begin(50.0f, 0.0f, 0.0f);
+
+    for (int iCycle = 1; iCycle <= int(fSeconds / fLoopDt); iCycle++) {
+        const float fNow = float(iCycle) * fLoopDt;
+
+        // IMU ticks up to now
+        while (float(iTick + 1) / kImuFifoOdrHz <= fNow) {
+            iTick++;
+            aiLatest[0] = int16_t(std::lround(fRate(float(iTick) / kImuFifoOdrHz) / kGyroRes));
+            fifo.tick(aiLatest, aiNoAccel);
+        }
+
+        if (bFifo) {
+            const int iCount = readFifo(fifo, decoder, aOut, 16);
+            for (int i = 0; i < iCount; i++)
+                madg.UpdateIMU(float(aOut[i].aiGyro[0]) * kGyroRes, 0.0f, 0.0f,
+                               float(aOut[i].aiAccel[0]) * kAccelRes, 0.0f, 0.0f, 1.0f / kImuFifoOdrHz);
+            iSamples += iCount;
+        }
+        else {
+            madg.UpdateIMU(float(aiLatest[0]) * kGyroRes, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+            iSamples++;
+        }
+
+        // True roll is the integral of the rate, done finely, up to the
+        // newest sample integrated
+        const float fUpTo = bFifo ? float(iTick) / kImuFifoOdrHz : fNow;
+        const int   kSteps = 2000;
+        float       fTrue  = 0.0f;
+        for (int k = 0; k < kSteps; k++)
+            fTrue += fRate((float(k) + 0.5f) * fUpTo / kSteps) * fUpTo / kSteps;
+
+        fMaxErr = std::max(fMaxErr, std::fabs(madg.getRoll() - fTrue));
+    }
+
+    if (piSamples)
+        *piSamples = iSamples;
+    return fMaxErr;
+}
+
+void test_fifo_captures_every_sample()
+{
+    int iFifo, iDirect;
+
+    runCycles(1.0f, true,  [](float) { return 10.0f; }, &iFifo);
+    runCycles(1.0f, false, [](float) { return 10.0f; }, &iDirect);
+
+    TEST_ASSERT_EQUAL_INT(208, iFifo);
+    TEST_ASSERT_EQUAL_INT(50,  iDirect);
+}
+
+void test_fifo_integrates_at_true_dt()
+{
+    // Constant 30 dps for 2 sec is 60 deg of roll. The filter's own Euler
+    // step and fast inverse square root lose about 0.3% of that; the wrong
+    // dt would be off by a factor of four.
+    const float fErr = runCycles(2.0f, true, [](float) { return 30.0f; });
+
+    TEST_ASSERT_FLOAT_WITHIN(0.3f, 0.0f, fErr);
+}
+
+void test_fifo_avoids_aliasing()
+{
+    // 52 Hz vibration on the roll gyro. Sampled once per 20 msec it aliases
+    // down to 2 Hz and shows up as a slow roll oscillation that isn't there.
+    auto vibration = [](float t) { return 20.0f * std::sin(2.0f * kPi * 52.0f * t); };
+
+    const float fFifoErr   = runCycles(1.0f, true,  vibration);
+    const float fDirectErr = runCycles(1.0f, false, vibration);
+
+    char szMsg[120];
+    std::snprintf(szMsg, sizeof(szMsg), "52 Hz vibration roll error: FIFO %.3f deg, one sample per cycle %.3f deg",
+                  double(fFifoErr), double(fDirectErr));
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_TRUE(fFifoErr < 0.1f);
+    TEST_ASSERT_TRUE(fDirectErr > 10.0f * fFifoErr);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Status and decoding
+    RUN_TEST(test_status_decode);
+    RUN_TEST(test_tag_fields);
+    RUN_TEST(test_decodes_every_sample_in_order);
+    RUN_TEST(test_pair_split_across_reads);
+    RUN_TEST(test_accel_before_gyro_pairs);
+    RUN_TEST(test_other_tags_skipped);
+    RUN_TEST(test_lost_word_drops_only_its_sample);
+    RUN_TEST(test_output_full_counts_dropped);
+    RUN_TEST(test_overrun_reported_once);
+
+    // Sensor cycle
+    RUN_TEST(test_fifo_captures_every_sample);
+    RUN_TEST(test_fifo_integrates_at_true_dt);
+    RUN_TEST(test_fifo_avoids_aliasing);
+
+    return UNITY_END();
+}
@@ -5,7 +5,10 @@
 
 #include <unity.h>
 #include <KalmanFilter.h>
+#include <chrono>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 // Production tuning parameters from AHRS.cpp line 47
 static const float PROD_Z_VARIANCE = 0.79078f;
@@ -138,6 +141,200 @@ void test_turbulence_stability(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, v);
 }
 
+// ----------------------------------------------------------------------------
+// Steady-state gain mode
+// ----------------------------------------------------------------------------
+
+static const float LOOP_DT = 1.0f / 50.0f;  // AHRS runs the filter once per sensor cycle
+
+// Repeatable noise, roughly Gaussian with unit variance
+static float test_noise(uint32_t* state) {
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        *state = *state * 1664525u + 1013904223u;
+        sum += float(*state >> 8) * (1.0f / 16777216.0f);
+    }
+    return (sum - 2.0f) * 1.7320508f;
+}
+
+// Solved gains agree with the full filter run for four hours
+void test_steady_state_gains_match_full_filter(void) {
+    kf.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 0.0f, 0.0f, 0.0f);
+    TEST_ASSERT_TRUE(kf.EnableSteadyState(LOOP_DT));
+
+    float kz, kv, ka;
+    kf.SteadyStateGains(&kz, &kv, &ka);
+
+    // Full filter after 720000 samples: 0.0295512, 0.0221606, -3.58e-6 and
+    // the bias gain still creeping down
+    TEST_ASSERT_FLOAT_WITHIN(0.0295512f * 1e-4f, 0.0295512f, kz);
+    TEST_ASSERT_FLOAT_WITHIN(0.0221606f * 1e-4f, 0.0221606f, kv);
+    TEST_ASSERT_TRUE(ka < 0.0f && ka > -3.58e-6f);
+}
+
+// Full filter through start-up, fixed gains after, full again on Configure
+void test_steady_state_switches_after_startup(void) {
+    kf.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    TEST_ASSERT_TRUE(kf.EnableSteadyState(LOOP_DT));
+
+    volatile float z, v;
+    int switch_at = -1;
+    for (int i = 0; i < 50 * 600 && switch_at < 0; i++) {
+        kf.Update(1000.0f, 0.0f, LOOP_DT, &z, &v);
+        if (kf.IsSteadyState())
+            switch_at = i;
+    }
+
+    char msg[80];
+    std::snprintf(msg, sizeof(msg), "Switched to steady-state gains after %.1f s", switch_at * LOOP_DT);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(switch_at > 50 * 2);
+    TEST_ASSERT_TRUE(switch_at < 50 * 300);
+
+    kf.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    TEST_ASSERT_FALSE(kf.IsSteadyState());
+}
+
+// No solution leaves the full filter on
+void test_steady_state_rejects_bad_dt(void) {
+    kf.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 0.0f, 0.0f, 0.0f);
+    TEST_ASSERT_FALSE(kf.EnableSteadyState(0.0f));
+
+    volatile float z, v;
+    for (int i = 0; i < 50 * 600; i++)
+        kf.Update(0.0f, 0.0f, LOOP_DT, &z, &v);
+    TEST_ASSERT_FALSE(kf.IsSteadyState());
+}
+
+// Noisy baro and accelerometer with an accelerometer bias, climbs, descents
+// and level-offs: the steady-state filter stays close to the full one
+void test_steady_state_divergence_bounded(void) {
+    KalmanFilter full, steady;
+    full.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    steady.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    TEST_ASSERT_TRUE(steady.EnableSteadyState(LOOP_DT));
+
+    uint32_t noise = 1;
+    float alt = 1000.0f, vsi = 0.0f;
+    float max_dz = 0.0f, max_dv = 0.0f, max_err_v_full = 0.0f, max_err_v_steady = 0.0f;
+    const int samples = 50 * 1200;
+
+    for (int i = 0; i < samples; i++) {
+        // Vertical speed target changes every 40 sec between -5 and +5 m/s,
+        // reached at 1 m/s^2
+        const float target = 5.0f * std::sin(0.7f * float(i / (50 * 40)));
+        const float accel  = std::clamp(target - vsi, -LOOP_DT, LOOP_DT) / LOOP_DT;
+        vsi += accel * LOOP_DT;
+        alt += vsi * LOOP_DT;
+
+        const float baro = alt + std::sqrt(PROD_Z_VARIANCE) * test_noise(&noise);
+        const float meas = accel + 0.05f + 0.3f * test_noise(&noise);
+
+        volatile float zf, vf, zs, vs;
+        full.Update(baro, meas, LOOP_DT, &zf, &vf);
+        steady.Update(baro, meas, LOOP_DT, &zs, &vs);
+
+        if (steady.IsSteadyState()) {
+            max_dz = std::max(max_dz, std::fabs(zf - zs));
+            max_dv = std::max(max_dv, std::fabs(vf - vs));
+            max_err_v_full   = std::max(max_err_v_full,   std::fabs(vf - vsi));
+            max_err_v_steady = std::max(max_err_v_steady, std::fabs(vs - vsi));
+        }
+    }
+
+    char msg[200];
+    std::snprintf(msg, sizeof(msg),
+        "Steady-state vs full over 20 min: max difference %.3f m, %.3f m/s; max VSI error full %.3f, steady %.3f m/s",
+        max_dz, max_dv, max_err_v_full, max_err_v_steady);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_TRUE(steady.IsSteadyState());
+    TEST_ASSERT_TRUE(max_dz < 0.1f);
+    TEST_ASSERT_TRUE(max_dv < 0.05f);
+    TEST_ASSERT_TRUE(max_err_v_steady < max_err_v_full + 0.05f);
+}
+
+// A pull above the nominal acceleration variance drops back to the full
+// filter, which tracks it like a filter that never left, and the fixed
+// gains come back once the pull is over
+void test_steady_state_high_g_falls_back(void) {
+    KalmanFilter full, steady;
+    full.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    steady.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 1000.0f, 0.0f, 0.0f);
+    TEST_ASSERT_TRUE(steady.EnableSteadyState(LOOP_DT));
+
+    uint32_t noise = 7;
+    float alt = 1000.0f, vsi = 0.0f;
+    volatile float zf, vf, zs, vs;
+    auto step = [&](float accel) {
+        vsi += accel * LOOP_DT;
+        alt += vsi * LOOP_DT;
+        const float baro = alt + std::sqrt(PROD_Z_VARIANCE) * test_noise(&noise);
+        full.Update(baro, accel, LOOP_DT, &zf, &vf);
+        steady.Update(baro, accel, LOOP_DT, &zs, &vs);
+    };
+
+    for (int i = 0; i < 50 * 300 && !steady.IsSteadyState(); i++)
+        step(0.0f);
+    TEST_ASSERT_TRUE(steady.IsSteadyState());
+
+    // 0.4 s at 8 g up then 0.4 s at 8 g down, back to level
+    float max_dz = 0.0f, max_dv = 0.0f;
+    for (int i = 0; i < 40; i++) {
+        step(i < 20 ? 80.0f : -80.0f);
+        TEST_ASSERT_FALSE(steady.IsSteadyState());
+        max_dz = std::max(max_dz, std::fabs(zf - zs));
+        max_dv = std::max(max_dv, std::fabs(vf - vs));
+    }
+
+    int back_at = -1;
+    for (int i = 0; i < 50 * 300 && back_at < 0; i++) {
+        step(0.0f);
+        max_dz = std::max(max_dz, std::fabs(zf - zs));
+        max_dv = std::max(max_dv, std::fabs(vf - vs));
+        if (steady.IsSteadyState())
+            back_at = i;
+    }
+
+    char msg[120];
+    std::snprintf(msg, sizeof(msg), "8 g pull: max difference %.4f m, %.4f m/s; fixed gains again after %.1f s",
+        max_dz, max_dv, back_at * LOOP_DT);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(back_at >= 0);
+    TEST_ASSERT_TRUE(max_dz < 0.05f);
+    TEST_ASSERT_TRUE(max_dv < 0.05f);
+}
+
+#ifdef ONSPEED_BENCHMARKS
+// Per-sample cost, full filter against steady state
+void test_steady_state_benchmark(void) {
+    const int reps = 2000000;
+    KalmanFilter full, steady;
+    full.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 0.0f, 0.0f, 0.0f);
+    steady.Configure(PROD_Z_VARIANCE, PROD_ACCEL_VARIANCE, PROD_ACCEL_BIAS_VARIANCE, 0.0f, 0.0f, 0.0f);
+    steady.EnableSteadyState(LOOP_DT);
+
+    volatile float z, v;
+    for (int i = 0; i < 50 * 300 && !steady.IsSteadyState(); i++)
+        steady.Update(0.0f, 0.0f, LOOP_DT, &z, &v);
+    TEST_ASSERT_TRUE(steady.IsSteadyState());
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++)
+        full.Update(float(i & 1023) * 0.01f, 0.1f, LOOP_DT, &z, &v);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++)
+        steady.Update(float(i & 1023) * 0.01f, 0.1f, LOOP_DT, &z, &v);
+    auto t2 = std::chrono::steady_clock::now();
+
+    auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / reps; };
+    char msg[100];
+    std::snprintf(msg, sizeof(msg), "ns per Update, full %.1f, steady state %.1f", ns(t0, t1), ns(t1, t2));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_FALSE(std::isnan(z));
+}
+#endif // ONSPEED_BENCHMARKS
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_initial_state_preserved);
@@ -146,5 +343,13 @@ int main(int argc, char **argv) {
     RUN_TEST(test_acceleration_input_affects_state);
     RUN_TEST(test_zero_dt_no_crash);
     RUN_TEST(test_turbulence_stability);
+    RUN_TEST(test_steady_state_gains_match_full_filter);
+    RUN_TEST(test_steady_state_switches_after_startup);
+    RUN_TEST(test_steady_state_rejects_bad_dt);
+    RUN_TEST(test_steady_state_divergence_bounded);
+    RUN_TEST(test_steady_state_high_g_falls_back);
+#ifdef ONSPEED_BENCHMARKS
+    RUN_TEST(test_steady_state_benchmark);
+#endif
     return UNITY_END();
 }
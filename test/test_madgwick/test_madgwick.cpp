@@ -8,13 +8,18 @@
 //
 // Production usage from AHRS.cpp:
 //   MadgFilter.begin(208.0f, -SmoothedPitch, SmoothedRoll)
-//   MadgFilter.UpdateIMU(RollRate, PitchRate, YawRate, AccelFwd, AccelLat, AccelVert)
+//   MadgFilter.UpdateIMU(gx, gy, gz, ax, ay, az, dt)   // each IMU FIFO sample
 //   pitch = -MadgFilter.getPitch()
 //   roll = -MadgFilter.getRoll()
 
 #include <unity.h>
 #include <MadgwickFusion.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
 
 static const float SAMPLE_FREQ = 208.0f;
 static const float DEG2RAD = 3.14159265f / 180.0f;
@@ -121,7 +126,8 @@ void test_quaternion_remains_normalized(void) {
     madgwick.getQuaternion(&w, &x, &y, &z);
     float magnitude = sqrtf(w*w + x*x + y*y + z*z);
 
-    // Quaternion should stay very close to unit length (actual: 0.998313)
+    // Quaternion should stay very close to unit length (actual: 1.000000,
+    // 0.998313 with the old bit-trick invSqrt)
     TEST_ASSERT_FLOAT_WITHIN(0.005f, 1.0f, magnitude);
 }
 
@@ -168,6 +174,328 @@ void test_radians_accessors(void) {
     TEST_ASSERT_FLOAT_WITHIN(0.001f, pitch_deg * DEG2RAD, pitch_rad);
 }
 
+// ----------------------------------------------------------------------------
+// Against the original implementation
+// ----------------------------------------------------------------------------
+
+// The IMU update as it was before the fast path, kept here to compare
+// against. bExactInvSqrt swaps the bit-trick invSqrt for 1/sqrtf.
+template <bool bExactInvSqrt>
+class ReferenceMadgwick {
+public:
+    float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;
+    float beta = 0.011617f;
+
+    void set(const Madgwick & m) {
+        Madgwick copy = m;
+        copy.getQuaternion(&q0, &q1, &q2, &q3);
+    }
+
+    static float invSqrt(float x) {
+        if (bExactInvSqrt)
+            return 1.0f / sqrtf(x);
+        float xhalf = 0.5f*x;
+        unsigned int i;
+        memcpy(&i, &x, sizeof(i));
+        i = 0x5f375a86 - (i>>1);
+        memcpy(&x, &i, sizeof(i));
+        x = x*(1.5f - xhalf*x*x);
+        return x;
+    }
+
+    void UpdateIMU(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+        float recipNorm;
+        float s0, s1, s2, s3;
+        float qDot1, qDot2, qDot3, qDot4;
+        float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2 ,_8q1, _8q2, q0q0, q1q1, q2q2, q3q3;
+
+        gx *= 0.0174533f;
+        gy *= 0.0174533f;
+        gz *= 0.0174533f;
+
+        qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+        qDot2 = 0.5f * ( q0 * gx + q2 * gz - q3 * gy);
+        qDot3 = 0.5f * ( q0 * gy - q1 * gz + q3 * gx);
+        qDot4 = 0.5f * ( q0 * gz + q1 * gy - q2 * gx);
+
+        if(!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f))) {
+            recipNorm = invSqrt(ax * ax + ay * ay + az * az);
+            ax *= recipNorm;
+            ay *= recipNorm;
+            az *= recipNorm;
+
+            _2q0 = 2.0f * q0;
+            _2q1 = 2.0f * q1;
+            _2q2 = 2.0f * q2;
+            _2q3 = 2.0f * q3;
+            _4q0 = 4.0f * q0;
+            _4q1 = 4.0f * q1;
+            _4q2 = 4.0f * q2;
+            _8q1 = 8.0f * q1;
+            _8q2 = 8.0f * q2;
+            q0q0 = q0 * q0;
+            q1q1 = q1 * q1;
+            q2q2 = q2 * q2;
+            q3q3 = q3 * q3;
+
+            s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+            s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+            s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+            s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+            recipNorm = invSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+            s0 *= recipNorm;
+            s1 *= recipNorm;
+            s2 *= recipNorm;
+            s3 *= recipNorm;
+
+            qDot1 -= beta * s0;
+            qDot2 -= beta * s1;
+            qDot3 -= beta * s2;
+            qDot4 -= beta * s3;
+        }
+
+        q0 += qDot1 * dt;
+        q1 += qDot2 * dt;
+        q2 += qDot3 * dt;
+        q3 += qDot4 * dt;
+
+        recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        q0 *= recipNorm;
+        q1 *= recipNorm;
+        q2 *= recipNorm;
+        q3 *= recipNorm;
+    }
+
+    // Old computeAngles(), all three every time
+    void angles(float * pRoll, float * pPitch, float * pYaw) const {
+        *pRoll  = atan2f(q0*q1 + q2*q3, 0.5f - q1*q1 - q2*q2) * 57.29578f;
+        *pPitch = asinf(-2.0f * (q1*q3 - q0*q2)) * 57.29578f;
+        *pYaw   = atan2f(q1*q2 + q0*q3, 0.5f - q2*q2 - q3*q3) * 57.29578f + 180.0f;
+    }
+};
+
+// Repeatable noise, roughly Gaussian with unit variance
+static float test_noise(uint32_t * state) {
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        *state = *state * 1664525u + 1013904223u;
+        sum += float(*state >> 8) * (1.0f / 16777216.0f);
+    }
+    return (sum - 2.0f) * 1.7320508f;
+}
+
+// Attitude quaternion for roll and pitch in degrees, as begin() builds it
+static void attitude(float roll, float pitch, float q[4]) {
+    const float cr = cosf(roll * DEG2RAD * 0.5f), sr = sinf(roll * DEG2RAD * 0.5f);
+    const float cp = cosf(pitch * DEG2RAD * 0.5f), sp = sinf(pitch * DEG2RAD * 0.5f);
+    q[0] = cr * cp;
+    q[1] = sr * cp;
+    q[2] = cr * sp;
+    q[3] = -sr * sp;
+}
+
+// One IMU sample, gyro in deg/sec, accel in g
+struct Sample {
+    float gx, gy, gz;
+    float ax, ay, az;
+};
+
+// A minute of rolling and pitching at the IMU rate, with the gyro and
+// accelerometer samples that go with it plus some noise, and the true
+// pitch and roll from the same formulas the filter uses
+struct Flight {
+    std::vector<Sample> samples;
+    std::vector<float> roll, pitch;
+};
+
+static Flight make_flight(float noise_scale) {
+    Flight f;
+    uint32_t noise = 7;
+    const float dt = 1.0f / SAMPLE_FREQ;
+    const int n = int(SAMPLE_FREQ * 60.0f);
+
+    for (int i = 0; i < n; i++) {
+        const float t = i * dt;
+        float q[4], qn[4];
+        attitude(40.0f * sinf(0.3f * t), 15.0f * sinf(0.2f * t + 1.0f), q);
+        attitude(40.0f * sinf(0.3f * (t + dt)), 15.0f * sinf(0.2f * (t + dt) + 1.0f), qn);
+
+        // Body rates: 2 conj(q) (qn - q) / dt, vector part
+        const float d[4] = { (qn[0] - q[0]) / dt, (qn[1] - q[1]) / dt, (qn[2] - q[2]) / dt, (qn[3] - q[3]) / dt };
+        const float wx = 2.0f * (q[0]*d[1] - q[1]*d[0] - q[2]*d[3] + q[3]*d[2]);
+        const float wy = 2.0f * (q[0]*d[2] + q[1]*d[3] - q[2]*d[0] - q[3]*d[1]);
+        const float wz = 2.0f * (q[0]*d[3] - q[1]*d[2] + q[2]*d[1] - q[3]*d[0]);
+
+        Sample s;
+        s.gx = wx / DEG2RAD + noise_scale * 0.5f * test_noise(&noise);
+        s.gy = wy / DEG2RAD + noise_scale * 0.5f * test_noise(&noise);
+        s.gz = wz / DEG2RAD + noise_scale * 0.5f * test_noise(&noise);
+        s.ax = 2.0f * (q[1]*q[3] - q[0]*q[2])                   + noise_scale * 0.02f * test_noise(&noise);
+        s.ay = 2.0f * (q[0]*q[1] + q[2]*q[3])                   + noise_scale * 0.02f * test_noise(&noise);
+        s.az = q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3]    + noise_scale * 0.02f * test_noise(&noise);
+        f.samples.push_back(s);
+
+        f.roll.push_back(atan2f(q[0]*q[1] + q[2]*q[3], 0.5f - q[1]*q[1] - q[2]*q[2]) / DEG2RAD);
+        f.pitch.push_back(asinf(-2.0f * (q[1]*q[3] - q[0]*q[2])) / DEG2RAD);
+    }
+    return f;
+}
+
+// Same algorithm: within float rounding of the original with an exact
+// inverse square root
+void test_matches_original_update(void) {
+    const Flight f = make_flight(1.0f);
+    const float dt = 1.0f / SAMPLE_FREQ;
+
+    Madgwick fast;
+    fast.begin(SAMPLE_FREQ, f.pitch[0], f.roll[0]);
+    ReferenceMadgwick<true> ref;
+    ref.set(fast);
+
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < f.samples.size(); i++) {
+        const Sample & s = f.samples[i];
+        fast.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+        ref.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+
+        float roll, pitch, yaw;
+        ref.angles(&roll, &pitch, &yaw);
+        max_diff = std::max(max_diff, std::max(fabsf(fast.getRoll() - roll), fabsf(fast.getPitch() - pitch)));
+    }
+
+    char msg[100];
+    std::snprintf(msg, sizeof(msg), "Max difference from the original with exact invSqrt: %.5f deg", max_diff);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(max_diff < 0.001f);
+}
+
+// Against the original with its bit-trick invSqrt: the quaternion is now
+// unit length and the angles no less accurate
+void test_more_accurate_than_bit_trick(void) {
+    const Flight f = make_flight(0.0f);
+    const float dt = 1.0f / SAMPLE_FREQ;
+
+    Madgwick fast;
+    fast.begin(SAMPLE_FREQ, f.pitch[0], f.roll[0]);
+    ReferenceMadgwick<false> ref;
+    ref.set(fast);
+
+    float err_fast = 0.0f, err_ref = 0.0f, max_diff = 0.0f;
+    for (size_t i = 0; i < f.samples.size(); i++) {
+        const Sample & s = f.samples[i];
+        fast.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+        ref.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+
+        float roll, pitch, yaw;
+        ref.angles(&roll, &pitch, &yaw);
+        err_fast = std::max(err_fast, std::max(fabsf(fast.getRoll() - f.roll[i + 1 < f.roll.size() ? i + 1 : i]),
+                                               fabsf(fast.getPitch() - f.pitch[i + 1 < f.pitch.size() ? i + 1 : i])));
+        err_ref  = std::max(err_ref,  std::max(fabsf(roll  - f.roll[i + 1 < f.roll.size() ? i + 1 : i]),
+                                               fabsf(pitch - f.pitch[i + 1 < f.pitch.size() ? i + 1 : i])));
+        max_diff = std::max(max_diff, std::max(fabsf(fast.getRoll() - roll), fabsf(fast.getPitch() - pitch)));
+    }
+
+    float w, x, y, z;
+    fast.getQuaternion(&w, &x, &y, &z);
+    const float norm_fast = sqrtf(w*w + x*x + y*y + z*z);
+    const float norm_ref  = sqrtf(ref.q0*ref.q0 + ref.q1*ref.q1 + ref.q2*ref.q2 + ref.q3*ref.q3);
+
+    char msg[200];
+    std::snprintf(msg, sizeof(msg),
+        "Worst angle error, noise free: new %.4f deg, bit-trick %.4f deg, apart by %.4f deg. |q| new %.7f, bit-trick %.7f",
+        err_fast, err_ref, max_diff, norm_fast, norm_ref);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, norm_fast);
+    TEST_ASSERT_TRUE(err_fast <= err_ref);
+    TEST_ASSERT_TRUE(max_diff < 0.2f);
+}
+
+// Each angle follows the latest update, whichever were read before
+void test_angles_follow_updates(void) {
+    Madgwick m, fresh;
+    m.begin(SAMPLE_FREQ, 0.0f, 0.0f);
+    fresh.begin(SAMPLE_FREQ, 0.0f, 0.0f);
+
+    m.UpdateIMU(20.0f, 10.0f, 5.0f, 0.1f, 0.2f, 0.97f);
+    fresh.UpdateIMU(20.0f, 10.0f, 5.0f, 0.1f, 0.2f, 0.97f);
+    m.getPitch();
+
+    m.UpdateIMU(20.0f, 10.0f, 5.0f, 0.1f, 0.2f, 0.97f);
+    fresh.UpdateIMU(20.0f, 10.0f, 5.0f, 0.1f, 0.2f, 0.97f);
+    m.getRoll();
+
+    TEST_ASSERT_EQUAL_FLOAT(fresh.getPitch(), m.getPitch());
+    TEST_ASSERT_EQUAL_FLOAT(fresh.getRoll(),  m.getRoll());
+    TEST_ASSERT_EQUAL_FLOAT(fresh.getYaw(),   m.getYaw());
+
+    // begin() starts the angles over too
+    m.begin(SAMPLE_FREQ, 12.0f, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.0f, m.getPitch());
+}
+
+#ifdef ONSPEED_BENCHMARKS
+// Per-sample cost of the original and the new update. Then the whole cycle
+// as AHRS runs it: four samples (one 50 Hz cycle of 208 Hz FIFO samples),
+// then pitch and roll.
+void test_benchmark_against_original(void) {
+    const Flight f = make_flight(1.0f);
+    const float dt = 1.0f / SAMPLE_FREQ;
+    const int n = int(f.samples.size()) / 4 * 4;
+    const int passes = 40;
+
+    Madgwick fast;
+    fast.begin(SAMPLE_FREQ, 0.0f, 0.0f);
+    ReferenceMadgwick<false> ref;
+    ref.set(fast);
+    volatile float sink = 0.0f;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < n; i++) {
+            const Sample & s = f.samples[i];
+            ref.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+        }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < n; i++) {
+            const Sample & s = f.samples[i];
+            fast.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+        }
+    auto t2 = std::chrono::steady_clock::now();
+
+    // Whole cycles: the original computed all three angles
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < n; i += 4) {
+            for (int k = 0; k < 4; k++) {
+                const Sample & s = f.samples[i + k];
+                ref.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+            }
+            float roll, pitch, yaw;
+            ref.angles(&roll, &pitch, &yaw);
+            sink = sink + roll + pitch;
+        }
+    auto t3 = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; p++)
+        for (int i = 0; i < n; i += 4) {
+            for (int k = 0; k < 4; k++) {
+                const Sample & s = f.samples[i + k];
+                fast.UpdateIMU(s.gx, s.gy, s.gz, s.ax, s.ay, s.az, dt);
+            }
+            sink = sink + fast.getRoll() + fast.getPitch();
+        }
+    auto t4 = std::chrono::steady_clock::now();
+
+    auto ns = [](auto a, auto b, int count) { return std::chrono::duration<double, std::nano>(b - a).count() / count; };
+    char msg[200];
+    std::snprintf(msg, sizeof(msg),
+        "ns per sample: original %.1f, new %.1f. ns per 4-sample cycle with pitch and roll: original %.1f, new %.1f",
+        ns(t0, t1, passes * n), ns(t1, t2, passes * n), ns(t2, t3, passes * n / 4), ns(t3, t4, passes * n / 4));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(sink == sink);
+}
+#endif // ONSPEED_BENCHMARKS
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_level_initialization);
@@ -179,5 +507,11 @@ int main(int argc, char **argv) {
     RUN_TEST(test_zero_acceleration_handling);
     RUN_TEST(test_high_g_stability);
     RUN_TEST(test_radians_accessors);
+    RUN_TEST(test_matches_original_update);
+    RUN_TEST(test_more_accurate_than_bit_trick);
+    RUN_TEST(test_angles_follow_updates);
+#ifdef ONSPEED_BENCHMARKS
+    RUN_TEST(test_benchmark_against_original);
+#endif
     return UNITY_END();
 }
@@ -0,0 +1,297 @@
+// test_rate_filters.cpp - Unit tests for loop rate conversion and the rate-sized filters
+
+#include <unity.h>
+#include <RateFilters.h>
+#include <EMAFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const int kRates[] = { 50, 100, 200 };
+
+/// Deterministic uniform noise in [-1, 1)
+static float noise(uint32_t & uSeed)
+{
+    uSeed = uSeed * 1664525u + 1013904223u;
+    return float(uSeed >> 8) / float(1u << 23) - 1.0f;
+}
+
+// ============================================================================
+// Loop rate conversion
+// ============================================================================
+
+void test_valid_loop_rates()
+{
+    TEST_ASSERT_TRUE(isValidLoopRate(50));
+    TEST_ASSERT_TRUE(isValidLoopRate(100));
+    TEST_ASSERT_TRUE(isValidLoopRate(200));
+    TEST_ASSERT_FALSE(isValidLoopRate(0));
+    TEST_ASSERT_FALSE(isValidLoopRate(208));
+
+    TEST_ASSERT_EQUAL_INT(100, validLoopRate(100));
+    TEST_ASSERT_EQUAL_INT(kReferenceLoopHz, validLoopRate(75));
+}
+
+void test_span_conversion_keeps_group_delay()
+{
+    // 15 samples at 50 Hz span 280 ms
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.28f, spanForSamples(15, 50));
+    TEST_ASSERT_EQUAL_INT(15, samplesForSpan(0.28f, 50));
+    TEST_ASSERT_EQUAL_INT(29, samplesForSpan(0.28f, 100));
+    TEST_ASSERT_EQUAL_INT(57, samplesForSpan(0.28f, 200));
+
+    TEST_ASSERT_EQUAL_INT(1, samplesForSpan(0.0f, 200));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, spanForSamples(1, 50));
+}
+
+void test_ema_alpha_and_tau_round_trip()
+{
+    const float fTau = tauForEmaAlpha(0.05f, 50);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.05f, emaAlphaForTau(fTau, 50));
+    TEST_ASSERT_TRUE(emaAlphaForTau(fTau, 200) < 0.05f / 3.0f);
+
+    // No smoothing either way round
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, tauForEmaAlpha(1.0f, 50));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, emaAlphaForTau(0.0f, 200));
+}
+
+void test_params_at_reference_rate_match_old_constants()
+{
+    SmoothingParams params = SmoothingParams::forRate(SmoothingTimes::fromConfig(20, 15), 50);
+
+    TEST_ASSERT_EQUAL_INT(50, params.iHz);
+    TEST_ASSERT_EQUAL_INT(15, params.iPressureMedian);
+    TEST_ASSERT_EQUAL_INT(10, params.iPressureAverage);
+    TEST_ASSERT_EQUAL_INT(15, params.iDecelWindow);
+    TEST_ASSERT_EQUAL_INT(30, params.iGyroAverage);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.05f,     params.fAoaAlpha);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.060899f, params.fAccelAlpha);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0179f,   params.fTasDiffAlpha);
+}
+
+void test_params_scale_with_rate()
+{
+    SmoothingTimes  times = SmoothingTimes::fromConfig(20, 15);
+    SmoothingParams p200  = SmoothingParams::forRate(times, 200);
+    SmoothingParams pBad  = SmoothingParams::forRate(times, 123);
+
+    TEST_ASSERT_EQUAL_INT(57,  p200.iPressureMedian);
+    TEST_ASSERT_EQUAL_INT(37,  p200.iPressureAverage);
+    TEST_ASSERT_EQUAL_INT(117, p200.iGyroAverage);
+    TEST_ASSERT_TRUE(p200.iGyroAverage <= MovingAverage::kMaxWindow);
+    TEST_ASSERT_EQUAL_FLOAT(0.005f, p200.fDtSec);
+
+    TEST_ASSERT_EQUAL_INT(kReferenceLoopHz, pBad.iHz);
+
+    // AOA_SMOOTHING 0 still means none
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, SmoothingParams::forRate(SmoothingTimes::fromConfig(0, 15), 200).fAoaAlpha);
+}
+
+// ============================================================================
+// Filters
+// ============================================================================
+
+void test_moving_average_matches_brute_force()
+{
+    MovingAverage       avg(37);
+    std::vector<float>  aIn;
+    uint32_t            uSeed = 1;
+
+    for (int n = 0; n < 5000; n++) {
+        aIn.push_back(8000.0f + 500.0f * noise(uSeed));
+        avg.add(aIn.back());
+
+        const size_t uFirst = aIn.size() > 37 ? aIn.size() - 37 : 0;
+        double       fSum   = 0.0;
+        for (size_t i = uFirst; i < aIn.size(); i++)
+            fSum += aIn[i];
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, float(fSum / double(aIn.size() - uFirst)), avg.value());
+    }
+}
+
+void test_moving_median_matches_brute_force()
+{
+    const int aiWindows[] = { 1, 2, 15, 30, 57 };
+
+    for (int iWindow : aiWindows) {
+        MovingMedian        med(iWindow);
+        std::vector<float>  aIn;
+        uint32_t            uSeed = 7;
+
+        for (int n = 0; n < 600; n++) {
+            // Integer counts, so there are plenty of repeats
+            aIn.push_back(float(int(100.0f * noise(uSeed))));
+            med.add(aIn.back());
+
+            const size_t        uFirst = aIn.size() > size_t(iWindow) ? aIn.size() - iWindow : 0;
+            std::vector<float>  aWin(aIn.begin() + uFirst, aIn.end());
+            std::sort(aWin.begin(), aWin.end());
+            const size_t        uMid   = aWin.size() / 2;
+            const float         fMed   = (aWin.size() & 1) ? aWin[uMid] : 0.5f * (aWin[uMid - 1] + aWin[uMid]);
+
+            TEST_ASSERT_EQUAL_FLOAT(fMed, med.value());
+        }
+    }
+}
+
+void test_median_rejects_spike()
+{
+    MovingMedian med(15);
+
+    for (int n = 0; n < 20; n++)
+        med.add(1000.0f);
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f, med.add(16000.0f));
+}
+
+void test_slope_of_ramp_is_per_second_at_every_rate()
+{
+    for (int iHz : kRates) {
+        SlopeFilter slope;
+        slope.configure(samplesForSpan(0.28f, iHz), iHz);
+
+        for (int n = 0; n < 3 * iHz; n++)
+            slope.add(100.0f + 2.5f * float(n) / float(iHz));
+
+        TEST_ASSERT_FLOAT_WITHIN(1e-3f, 2.5f, slope.value());
+    }
+}
+
+void test_slope_before_window_full()
+{
+    SlopeFilter slope;
+    slope.configure(15, 50);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, slope.add(10.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 50.0f, slope.add(11.0f));
+}
+
+void test_windows_clamped()
+{
+    MovingAverage avg(1000);
+    MovingMedian  med(0);
+
+    TEST_ASSERT_EQUAL_INT(MovingAverage::kMaxWindow, avg.window());
+    TEST_ASSERT_EQUAL_INT(1, med.window());
+}
+
+// ============================================================================
+// Pipeline step response at each rate
+// ============================================================================
+
+/// Output of a filter driven by a unit step at t = 0, sampled every 20 ms
+/// for fSeconds, run at iHz.
+template <typename Step>
+static std::vector<float> stepAt(int iHz, float fSeconds, Step step)
+{
+    std::vector<float> aOut;
+    const int iDecim = iHz / kReferenceLoopHz;
+    for (int n = -iHz; n < int(fSeconds * float(iHz)); n++) {
+        const float fOut = step(n < 0 ? 0.0f : 1.0f);
+        if (n >= 0 && (n + 1) % iDecim == 0)
+            aOut.push_back(fOut);
+    }
+    return aOut;
+}
+
+void test_pressure_step_equivalent_at_every_rate()
+{
+    SmoothingTimes      times = SmoothingTimes::fromConfig(20, 15);
+    std::vector<float>  aRef;
+
+    for (int iHz : kRates) {
+        PressureSmoother smoother;
+        smoother.configure(SmoothingParams::forRate(times, iHz));
+
+        std::vector<float> aOut = stepAt(iHz, 1.0f, [&](float f) { return smoother.add(1000.0f * f); });
+        if (aRef.empty())
+            aRef = aOut;
+
+        // The 50 Hz average ramps in 10 steps, so allow one of them
+        for (size_t i = 0; i < aRef.size(); i++)
+            TEST_ASSERT_FLOAT_WITHIN(100.0f, aRef[i], aOut[i]);
+        TEST_ASSERT_EQUAL_FLOAT(1000.0f, aOut.back());
+    }
+}
+
+void test_ema_steps_identical_at_every_rate()
+{
+    SmoothingTimes      times = SmoothingTimes::fromConfig(20, 15);
+    std::vector<float>  aRefAoa, aRefAcc;
+
+    for (int iHz : kRates) {
+        SmoothingParams params = SmoothingParams::forRate(times, iHz);
+        EMAFilter       aoa(params.fAoaAlpha);
+        EMAFilter       acc(params.fAccelAlpha);
+
+        aoa.update(0.0f);
+        acc.update(0.0f);
+        std::vector<float> aAoa = stepAt(iHz, 2.0f, [&](float f) { return aoa.update(f); });
+        std::vector<float> aAcc = stepAt(iHz, 2.0f, [&](float f) { return acc.update(f); });
+        if (aRefAoa.empty()) {
+            aRefAoa = aAoa;
+            aRefAcc = aAcc;
+        }
+
+        for (size_t i = 0; i < aRefAoa.size(); i++) {
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, aRefAoa[i], aAoa[i]);
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, aRefAcc[i], aAcc[i]);
+        }
+    }
+}
+
+void test_report_step_half_times()
+{
+    SmoothingTimes  times = SmoothingTimes::fromConfig(20, 15);
+    char            szMsg[200];
+    int             iLen  = std::snprintf(szMsg, sizeof(szMsg), "Pressure step reaches 50%% at");
+
+    for (int iHz : kRates) {
+        PressureSmoother smoother;
+        smoother.configure(SmoothingParams::forRate(times, iHz));
+        for (int n = 0; n < iHz; n++)
+            smoother.add(0.0f);
+
+        int n = 0;
+        while (smoother.add(1.0f) < 0.5f)
+            n++;
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %d Hz %.0f ms;", iHz, 1000.0 * n / iHz);
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Loop rate conversion
+    RUN_TEST(test_valid_loop_rates);
+    RUN_TEST(test_span_conversion_keeps_group_delay);
+    RUN_TEST(test_ema_alpha_and_tau_round_trip);
+    RUN_TEST(test_params_at_reference_rate_match_old_constants);
+    RUN_TEST(test_params_scale_with_rate);
+
+    // Filters
+    RUN_TEST(test_moving_average_matches_brute_force);
+    RUN_TEST(test_moving_median_matches_brute_force);
+    RUN_TEST(test_median_rejects_spike);
+    RUN_TEST(test_slope_of_ramp_is_per_second_at_every_rate);
+    RUN_TEST(test_slope_before_window_full);
+    RUN_TEST(test_windows_clamped);
+
+    // Pipeline step response
+    RUN_TEST(test_pressure_step_equivalent_at_every_rate);
+    RUN_TEST(test_ema_steps_identical_at_every_rate);
+    RUN_TEST(test_report_step_half_times);
+
+    return UNITY_END();
+}
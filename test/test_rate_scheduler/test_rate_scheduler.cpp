@@ -0,0 +1,252 @@
+// test_rate_scheduler.cpp - Unit tests for the sensor task rate groups
+
+#include <unity.h>
+#include <RateScheduler.h>
+
+#include <cstdio>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/// Records the cycle of every run of one task into a shared log
+struct Recorder {
+    int                     iId;
+    RateScheduler *         pSched;
+    std::vector<int> *      pLog;
+    std::vector<uint32_t>   aCycles;
+};
+
+static void record(void * pContext)
+{
+    Recorder * pRec = static_cast<Recorder *>(pContext);
+    pRec->aCycles.push_back(pRec->pSched->cycle());
+    if (pRec->pLog != nullptr)
+        pRec->pLog->push_back(pRec->iId);
+}
+
+static void nothing(void *) {}
+
+// ============================================================================
+// Rates
+// ============================================================================
+
+void test_divisors_at_each_base_rate()
+{
+    const int aiBase[] = { 50, 100, 200 };
+
+    for (int iBase : aiBase) {
+        RateScheduler sched;
+        sched.configure(iBase);
+
+        const int i100 = sched.add("100", 100, nothing);
+        const int i50  = sched.add("50",  50,  nothing);
+        const int i10  = sched.add("10",  10,  nothing);
+        const int i1   = sched.add("1",   1,   nothing);
+
+        TEST_ASSERT_EQUAL_UINT32(iBase > 100 ? 2 : 1, sched.divisor(i100));
+        TEST_ASSERT_EQUAL_UINT32(iBase / 50, sched.divisor(i50));
+        TEST_ASSERT_EQUAL_UINT32(iBase / 10, sched.divisor(i10));
+        TEST_ASSERT_EQUAL_UINT32(iBase,      sched.divisor(i1));
+        TEST_ASSERT_EQUAL_FLOAT(10.0f, sched.rateHz(i10));
+    }
+}
+
+void test_each_task_runs_at_its_rate_with_even_spacing()
+{
+    RateScheduler   sched;
+    Recorder        aRec[4];
+    const int       aiHz[] = { 50, 25, 10, 1 };
+
+    sched.configure(50);
+    for (int i = 0; i < 4; i++) {
+        aRec[i] = { i, &sched, nullptr, {} };
+        sched.add("task", aiHz[i], record, &aRec[i]);
+    }
+
+    for (int n = 0; n < 50 * 10; n++)
+        sched.tick();
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(uint32_t(aiHz[i] * 10), sched.runs(i));
+        TEST_ASSERT_EQUAL_size_t(sched.runs(i), aRec[i].aCycles.size());
+        for (size_t n = 1; n < aRec[i].aCycles.size(); n++)
+            TEST_ASSERT_EQUAL_UINT32(sched.divisor(i), aRec[i].aCycles[n] - aRec[i].aCycles[n - 1]);
+    }
+}
+
+void test_odd_rates_round_to_nearest_divisor()
+{
+    RateScheduler sched;
+    sched.configure(50);
+
+    TEST_ASSERT_EQUAL_UINT32(3, sched.divisor(sched.add("17", 17, nothing)));    // 16.7 Hz
+    TEST_ASSERT_EQUAL_UINT32(1, sched.divisor(sched.add("400", 400, nothing)));
+}
+
+// ============================================================================
+// Phase staggering
+// ============================================================================
+
+void test_slow_tasks_spread_over_cycles()
+{
+    RateScheduler sched;
+    sched.configure(50);
+
+    // Five 10 Hz tasks fit one per cycle, a sixth has to double up somewhere
+    for (int i = 0; i < 5; i++)
+        sched.add("10", 10, nothing);
+    sched.plan();
+    TEST_ASSERT_EQUAL_UINT32(1, sched.peakCost());
+
+    sched.configure(50);
+    for (int i = 0; i < 6; i++)
+        sched.add("10", 10, nothing);
+    sched.plan();
+    TEST_ASSERT_EQUAL_UINT32(2, sched.peakCost());
+}
+
+void test_one_hz_tasks_avoid_ten_hz_tasks()
+{
+    RateScheduler sched;
+    sched.configure(50);
+
+    const int iStatic = sched.add("static", 10, nothing);
+    const int iFlaps  = sched.add("flaps",  1,  nothing);
+    const int iLog    = sched.add("log",    1,  nothing);
+    sched.plan();
+
+    TEST_ASSERT_EQUAL_UINT32(1, sched.peakCost());
+    TEST_ASSERT_TRUE(sched.phase(iFlaps) % 5 != sched.phase(iStatic));
+    TEST_ASSERT_TRUE(sched.phase(iLog) % 5 != sched.phase(iStatic));
+    TEST_ASSERT_TRUE(sched.phase(iFlaps) != sched.phase(iLog));
+}
+
+void test_costs_balance_heavy_tasks()
+{
+    RateScheduler sched;
+    sched.configure(50);
+
+    // Two heavy and two light 25 Hz tasks: each heavy one should share its
+    // cycle with a light one, not with the other heavy one
+    const int iHeavyA = sched.add("heavyA", 25, nothing, nullptr, 100);
+    sched.add("lightA", 25, nothing, nullptr, 10);
+    const int iHeavyB = sched.add("heavyB", 25, nothing, nullptr, 100);
+    sched.add("lightB", 25, nothing, nullptr, 10);
+    sched.plan();
+
+    TEST_ASSERT_TRUE(sched.phase(iHeavyA) != sched.phase(iHeavyB));
+    TEST_ASSERT_EQUAL_UINT32(110, sched.peakCost());
+}
+
+void test_schedule_is_deterministic()
+{
+    RateScheduler a, b;
+    const int     aiHz[] = { 10, 1, 10, 25, 1, 10, 50 };
+
+    a.configure(100);
+    b.configure(100);
+    for (int iHz : aiHz) {
+        a.add("t", iHz, nothing, nullptr, uint16_t(iHz));
+        b.add("t", iHz, nothing, nullptr, uint16_t(iHz));
+    }
+    a.plan();
+    b.plan();
+
+    for (int i = 0; i < a.taskCount(); i++)
+        TEST_ASSERT_EQUAL_UINT32(a.phase(i), b.phase(i));
+    for (uint32_t c = 0; c < 300; c++)
+        TEST_ASSERT_EQUAL_UINT32(a.costInCycle(c), b.costInCycle(c));
+}
+
+// ============================================================================
+// Running
+// ============================================================================
+
+void test_same_cycle_runs_in_registration_order()
+{
+    RateScheduler       sched;
+    std::vector<int>    aLog;
+    Recorder            aRec[3];
+
+    sched.configure(50);
+    for (int i = 0; i < 3; i++) {
+        aRec[i] = { i, &sched, &aLog, {} };
+        sched.add("every", 50, record, &aRec[i]);
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, sched.tick());
+    TEST_ASSERT_EQUAL_size_t(3, aLog.size());
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_EQUAL_INT(i, aLog[i]);
+}
+
+void test_rejects_bad_tasks()
+{
+    RateScheduler sched;
+    sched.configure(50);
+
+    TEST_ASSERT_EQUAL_INT(RateScheduler::kNone, sched.add("zero", 0, nothing));
+    TEST_ASSERT_EQUAL_INT(RateScheduler::kNone, sched.add("null", 10, nullptr));
+
+    for (int i = 0; i < RateScheduler::kMaxTasks; i++)
+        TEST_ASSERT_EQUAL_INT(i, sched.add("t", 10, nothing));
+    TEST_ASSERT_EQUAL_INT(RateScheduler::kNone, sched.add("full", 10, nothing));
+
+    sched.configure(50);
+    sched.add("t", 10, nothing);
+    sched.tick();
+    TEST_ASSERT_TRUE(sched.planned());
+    TEST_ASSERT_EQUAL_INT(RateScheduler::kNone, sched.add("late", 10, nothing));
+}
+
+void test_report_sensor_task_layout()
+{
+    // The SensorIO groups with rough costs in usec. All at once would be 760.
+    const int aiBase[] = { 50, 100, 200 };
+    char      szMsg[200];
+    int       iLen = std::snprintf(szMsg, sizeof(szMsg), "Sensor task slow work, peak usec per cycle:");
+
+    for (int iBase : aiBase) {
+        RateScheduler sched;
+        sched.configure(iBase);
+        sched.add("static",  10, nothing, nullptr, 60);
+        sched.add("imutemp", 10, nothing, nullptr, 20);
+        sched.add("oat",     10, nothing, nullptr, 250);
+        sched.add("flaps",   1,  nothing, nullptr, 30);
+        sched.add("debug",   1,  nothing, nullptr, 400);
+        sched.plan();
+
+        iLen += std::snprintf(szMsg + iLen, sizeof(szMsg) - size_t(iLen), " %d Hz %u;",
+                              iBase, unsigned(sched.peakCost()));
+        TEST_ASSERT_TRUE(sched.peakCost() <= 400);
+    }
+    TEST_MESSAGE(szMsg);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Rates
+    RUN_TEST(test_divisors_at_each_base_rate);
+    RUN_TEST(test_each_task_runs_at_its_rate_with_even_spacing);
+    RUN_TEST(test_odd_rates_round_to_nearest_divisor);
+
+    // Phase staggering
+    RUN_TEST(test_slow_tasks_spread_over_cycles);
+    RUN_TEST(test_one_hz_tasks_avoid_ten_hz_tasks);
+    RUN_TEST(test_costs_balance_heavy_tasks);
+    RUN_TEST(test_schedule_is_deterministic);
+
+    // Running
+    RUN_TEST(test_same_cycle_runs_in_registration_order);
+    RUN_TEST(test_rejects_bad_tasks);
+    RUN_TEST(test_report_sensor_task_layout);
+
+    return UNITY_END();
+}
@@ -0,0 +1,219 @@
+// test_sample_history.cpp - Unit tests for SampleHistory time-aligned resampling
+
+#include <unity.h>
+#include <SampleHistory.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+struct Sample {
+    float   fValue;
+    float   fRoll;
+    int     iCount;
+};
+
+static const LerpField<Sample> kFields[] = {
+    { &Sample::fValue, false },
+    { &Sample::fRoll,  true  },
+};
+static const size_t kFieldCount = sizeof(kFields) / sizeof(kFields[0]);
+
+static Sample make(float fValue, float fRoll = 0.0f, int iCount = 0)
+{
+    Sample s;
+    s.fValue = fValue;
+    s.fRoll  = fRoll;
+    s.iCount = iCount;
+    return s;
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+
+void test_empty_leaves_output_alone()
+{
+    SampleHistory<Sample, 4> hist;
+    Sample  out = make(7.0f);
+    int32_t iAge = 123;
+
+    TEST_ASSERT_TRUE(hist.sampleAt(1000, kFields, kFieldCount, out, iAge) == SampleFit::Empty);
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, out.fValue);
+    TEST_ASSERT_EQUAL_INT32(123, iAge);
+}
+
+void test_interpolates_listed_fields_holds_others()
+{
+    SampleHistory<Sample, 4> hist;
+    hist.push(1000, make(10.0f, 0.0f, 1));
+    hist.push(3000, make(20.0f, 10.0f, 2));
+
+    Sample  out;
+    int32_t iAge;
+    TEST_ASSERT_TRUE(hist.sampleAt(1500, kFields, kFieldCount, out, iAge) == SampleFit::Interpolated);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 12.5f, out.fValue);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 2.5f,  out.fRoll);
+    TEST_ASSERT_EQUAL_INT(1, out.iCount);
+    TEST_ASSERT_EQUAL_INT32(500, iAge);
+
+    // Exactly on a sample
+    TEST_ASSERT_TRUE(hist.sampleAt(1000, kFields, kFieldCount, out, iAge) == SampleFit::Interpolated);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, out.fValue);
+    TEST_ASSERT_EQUAL_INT32(0, iAge);
+}
+
+void test_after_newest_holds_with_age()
+{
+    SampleHistory<Sample, 4> hist;
+    hist.push(1000, make(10.0f));
+    hist.push(3000, make(20.0f, 0.0f, 5));
+
+    Sample  out;
+    int32_t iAge;
+    TEST_ASSERT_TRUE(hist.sampleAt(7500, kFields, kFieldCount, out, iAge) == SampleFit::Held);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, out.fValue);
+    TEST_ASSERT_EQUAL_INT(5, out.iCount);
+    TEST_ASSERT_EQUAL_INT32(4500, iAge);
+}
+
+void test_before_oldest_uses_oldest()
+{
+    SampleHistory<Sample, 3> hist;
+    for (uint32_t i = 0; i < 5; i++)
+        hist.push(1000 * (i + 1), make(float(i)));
+
+    // Capacity 3: samples at 3000, 4000, 5000 remain
+    TEST_ASSERT_EQUAL(3, hist.size());
+
+    Sample  out;
+    int32_t iAge;
+    TEST_ASSERT_TRUE(hist.sampleAt(2500, kFields, kFieldCount, out, iAge) == SampleFit::BeforeOldest);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, out.fValue);
+    TEST_ASSERT_EQUAL_INT32(-500, iAge);
+}
+
+void test_rejects_samples_going_backwards()
+{
+    SampleHistory<Sample, 4> hist;
+    TEST_ASSERT_TRUE(hist.push(2000, make(1.0f)));
+    TEST_ASSERT_FALSE(hist.push(1999, make(2.0f)));
+    TEST_ASSERT_TRUE(hist.push(2000, make(3.0f)));   // Same time is fine
+    TEST_ASSERT_EQUAL(2, hist.size());
+
+    // Zero span: earlier sample, no divide by zero
+    Sample  out;
+    int32_t iAge;
+    TEST_ASSERT_TRUE(hist.sampleAt(2000, kFields, kFieldCount, out, iAge) == SampleFit::Held);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, out.fValue);
+}
+
+void test_micros_wrap()
+{
+    SampleHistory<Sample, 4> hist;
+    const uint32_t uT0 = 0xFFFFFC18u;   // 1000 us before the wrap
+    hist.push(uT0,        make(0.0f));
+    hist.push(uT0 + 2000, make(20.0f)); // 1000 us after the wrap
+
+    Sample  out;
+    int32_t iAge;
+    TEST_ASSERT_TRUE(hist.sampleAt(0, kFields, kFieldCount, out, iAge) == SampleFit::Interpolated);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 10.0f, out.fValue);
+    TEST_ASSERT_EQUAL_INT32(1000, iAge);
+}
+
+void test_clear()
+{
+    SampleHistory<Sample, 4> hist;
+    hist.push(1000, make(1.0f));
+    hist.clear();
+    TEST_ASSERT_EQUAL(0, hist.size());
+}
+
+// ============================================================================
+// Angles
+// ============================================================================
+
+void test_angle_crosses_seam_short_way()
+{
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, -180.0f, lerpAngleDeg(170.0f, -170.0f, 0.5f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f,  175.0f, lerpAngleDeg(170.0f, -170.0f, 0.25f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f,  175.0f, lerpAngleDeg(-170.0f, 170.0f, 0.75f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f,   15.0f, lerpAngleDeg(10.0f, 20.0f, 0.5f));
+}
+
+// ============================================================================
+// Skew versus last-value logging
+// ============================================================================
+
+void test_alignment_reduces_skew()
+{
+    // 1.5 Hz, 5 degree oscillation: a pitch-up pull, sampled by an external
+    // source at ~50 Hz with jitter and by the sensor task on its own 50 Hz grid
+    auto truth = [](double dUs) { return static_cast<float>(5.0 * std::sin(2.0 * M_PI * 1.5 * dUs * 1e-6)); };
+
+    std::mt19937 rng(11);
+    SampleHistory<Sample, 16> hist;
+
+    double   dSumLast = 0, dSumAligned = 0, dMaxLast = 0, dMaxAligned = 0;
+    int      iCount   = 0;
+    uint32_t uNextExt = 3700;
+
+    for (uint32_t uSensor = 100000; uSensor < 10100000; uSensor += 20000) {
+        // Everything the external source sent up to 100 ms after this
+        // sensor sample has been received when the log line is written
+        while (uNextExt <= uSensor + 100000) {
+            hist.push(uNextExt, make(truth(uNextExt)));
+            uNextExt += 20000 + (rng() % 2001) - 1000;
+        }
+
+        // Old logger: newest value received by the sensor sample time
+        Sample  last = {}, aligned = {};
+        int32_t iAge;
+        hist.sampleAt(uSensor, nullptr, 0, last, iAge);
+        hist.sampleAt(uSensor, kFields, kFieldCount, aligned, iAge);
+
+        const double dLast    = std::fabs(last.fValue    - truth(uSensor));
+        const double dAligned = std::fabs(aligned.fValue - truth(uSensor));
+        dSumLast += dLast;        dMaxLast    = std::fmax(dMaxLast, dLast);
+        dSumAligned += dAligned;  dMaxAligned = std::fmax(dMaxAligned, dAligned);
+        iCount++;
+    }
+
+    char szMsg[160];
+    snprintf(szMsg, sizeof(szMsg), "Error vs truth (deg): last value mean %.3f max %.3f; interpolated mean %.4f max %.4f",
+             dSumLast / iCount, dMaxLast, dSumAligned / iCount, dMaxAligned);
+    TEST_MESSAGE(szMsg);
+
+    TEST_ASSERT_TRUE(dMaxAligned < 0.05);
+    TEST_ASSERT_TRUE(dSumAligned < dSumLast / 10);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Lookup
+    RUN_TEST(test_empty_leaves_output_alone);
+    RUN_TEST(test_interpolates_listed_fields_holds_others);
+    RUN_TEST(test_after_newest_holds_with_age);
+    RUN_TEST(test_before_oldest_uses_oldest);
+    RUN_TEST(test_rejects_samples_going_backwards);
+    RUN_TEST(test_micros_wrap);
+    RUN_TEST(test_clear);
+
+    // Angles
+    RUN_TEST(test_angle_crosses_seam_short_way);
+
+    // Skew
+    RUN_TEST(test_alignment_reduces_skew);
+
+    return UNITY_END();
+}
@@ -0,0 +1,272 @@
+// test_sensor_bus.cpp - Unit tests for the batched sensor SPI transaction planner
+
+#include <unity.h>
+#include <SensorBus.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Chip selects as wired on the board
+static const uint8_t kCsImu    = 4;
+static const uint8_t kCsStatic = 5;
+static const uint8_t kCsAoa    = 6;
+static const uint8_t kCsPitot  = 7;
+
+// ISM330 registers
+static const uint8_t kOutxLG = 0x22;
+static const uint8_t kOutxLA = 0x28;
+
+// ============================================================================
+// Mock bus
+// ============================================================================
+
+/// Records what it was asked to do. Register reads (first tx byte has the
+/// read bit) come from an auto-incrementing register file, other reads
+/// return the chip select number in every byte.
+class MockSensorBus : public SensorBus {
+public:
+    struct Issued {
+        uint8_t                 uChipSel;
+        std::vector<uint8_t>    aTx;
+    };
+
+    MockSensorBus()
+    {
+        for (int i = 0; i < 128; i++)
+            aRegs[i] = uint8_t(0x80 + i);
+    }
+
+    void transfer(const SensorBusSegment * pSegments, size_t uCount,
+                  const uint8_t * pTx, uint8_t * pRx) override
+    {
+        uTransactions++;
+        for (size_t s = 0; s < uCount; s++) {
+            const SensorBusSegment & seg = pSegments[s];
+            aIssued.push_back({ seg.uChipSel, std::vector<uint8_t>(pTx + seg.uOffset, pTx + seg.uOffset + seg.uLen) });
+
+            if (pTx[seg.uOffset] & 0x80) {
+                const uint8_t uReg = pTx[seg.uOffset] & 0x7F;
+                pRx[seg.uOffset] = 0xFF;
+                for (size_t j = 1; j < seg.uLen; j++)
+                    pRx[seg.uOffset + j] = aRegs[(uReg + j - 1) & 0x7F];
+            }
+            else
+                std::memset(pRx + seg.uOffset, seg.uChipSel, seg.uLen);
+        }
+    }
+
+    uint8_t                 aRegs[128];
+    std::vector<Issued>     aIssued;
+    unsigned                uTransactions = 0;
+};
+
+// The reads SensorIO makes every 20 msec
+struct CyclePlan {
+    SensorBusPlan   plan;
+    int             iPitot, iAoa, iStatic, iGyro, iAccel;
+
+    CyclePlan()
+    {
+        iPitot  = plan.addRead(kCsPitot, 2);
+        iAoa    = plan.addRead(kCsAoa, 2);
+        iStatic = plan.addRead(kCsStatic, 2);
+        iGyro   = plan.addRegisterRead(kCsImu, kOutxLG, 6);
+        iAccel  = plan.addRegisterRead(kCsImu, kOutxLA, 6);
+    }
+};
+
+// ============================================================================
+// Planning
+// ============================================================================
+
+void test_sensor_cycle_is_one_transaction()
+{
+    CyclePlan       cycle;
+    MockSensorBus   bus;
+
+    TEST_ASSERT_TRUE(cycle.plan.compile());
+    cycle.plan.run(bus);
+
+    TEST_ASSERT_EQUAL_UINT(1, bus.uTransactions);
+    TEST_ASSERT_EQUAL_size_t(4, bus.aIssued.size());
+    TEST_ASSERT_EQUAL_UINT8(kCsPitot,  bus.aIssued[0].uChipSel);
+    TEST_ASSERT_EQUAL_UINT8(kCsAoa,    bus.aIssued[1].uChipSel);
+    TEST_ASSERT_EQUAL_UINT8(kCsStatic, bus.aIssued[2].uChipSel);
+    TEST_ASSERT_EQUAL_UINT8(kCsImu,    bus.aIssued[3].uChipSel);
+
+    // Gyro and accel are adjacent so they go as one 12 byte burst from OUTX_L_G
+    TEST_ASSERT_EQUAL_size_t(13, bus.aIssued[3].aTx.size());
+    TEST_ASSERT_EQUAL_HEX8(0x80 | kOutxLG, bus.aIssued[3].aTx[0]);
+    TEST_ASSERT_EQUAL_size_t(19, cycle.plan.totalBytes());
+}
+
+void test_data_points_at_each_read()
+{
+    CyclePlan       cycle;
+    MockSensorBus   bus;
+
+    cycle.plan.compile();
+    cycle.plan.run(bus);
+
+    TEST_ASSERT_EQUAL_UINT8(kCsPitot,  cycle.plan.data(cycle.iPitot)[0]);
+    TEST_ASSERT_EQUAL_UINT8(kCsAoa,    cycle.plan.data(cycle.iAoa)[1]);
+    TEST_ASSERT_EQUAL_UINT8(kCsStatic, cycle.plan.data(cycle.iStatic)[0]);
+
+    for (int j = 0; j < 6; j++) {
+        TEST_ASSERT_EQUAL_UINT8(bus.aRegs[kOutxLG + j], cycle.plan.data(cycle.iGyro)[j]);
+        TEST_ASSERT_EQUAL_UINT8(bus.aRegs[kOutxLA + j], cycle.plan.data(cycle.iAccel)[j]);
+    }
+}
+
+void test_merges_when_added_in_reverse_order()
+{
+    SensorBusPlan   plan;
+    MockSensorBus   bus;
+
+    int iAccel = plan.addRegisterRead(kCsImu, kOutxLA, 6);
+    int iGyro  = plan.addRegisterRead(kCsImu, kOutxLG, 6);
+    TEST_ASSERT_TRUE(plan.compile());
+    plan.run(bus);
+
+    TEST_ASSERT_EQUAL_size_t(1, plan.segmentCount());
+    TEST_ASSERT_EQUAL_HEX8(0x80 | kOutxLG, bus.aIssued[0].aTx[0]);
+    TEST_ASSERT_EQUAL_UINT8(bus.aRegs[kOutxLG], plan.data(iGyro)[0]);
+    TEST_ASSERT_EQUAL_UINT8(bus.aRegs[kOutxLA], plan.data(iAccel)[0]);
+}
+
+void test_gap_or_other_chip_not_merged()
+{
+    SensorBusPlan plan;
+
+    plan.addRegisterRead(kCsImu, 0x20, 2);      // temperature
+    plan.addRegisterRead(kCsImu, 0x28, 6);      // accel, 6 registers away
+    plan.addRegisterRead(kCsAoa, 0x22, 6);      // adjacent register numbers, other chip
+    plan.addRegisterRead(kCsImu, 0x22, 6, 0x40);// other read bit
+    TEST_ASSERT_TRUE(plan.compile());
+
+    TEST_ASSERT_EQUAL_size_t(4, plan.segmentCount());
+}
+
+void test_overlapping_register_reads_share_bytes()
+{
+    SensorBusPlan   plan;
+    MockSensorBus   bus;
+
+    int iWide   = plan.addRegisterRead(kCsImu, 0x20, 8);
+    int iInside = plan.addRegisterRead(kCsImu, 0x22, 2);
+    plan.compile();
+    plan.run(bus);
+
+    TEST_ASSERT_EQUAL_size_t(1, plan.segmentCount());
+    TEST_ASSERT_EQUAL_size_t(9, plan.totalBytes());
+    TEST_ASSERT_EQUAL_PTR(plan.data(iWide) + 2, plan.data(iInside));
+}
+
+void test_plain_reads_never_merge()
+{
+    SensorBusPlan plan;
+
+    plan.addRead(kCsPitot, 2);
+    plan.addRead(kCsPitot, 2);
+    plan.compile();
+
+    TEST_ASSERT_EQUAL_size_t(2, plan.segmentCount());
+}
+
+// ============================================================================
+// Limits
+// ============================================================================
+
+void test_too_big_does_not_compile()
+{
+    SensorBusPlan   plan;
+    MockSensorBus   bus;
+
+    plan.addRead(kCsPitot, 40);
+    plan.addRead(kCsAoa, 40);
+    TEST_ASSERT_FALSE(plan.compile());
+    TEST_ASSERT_FALSE(plan.compiled());
+    TEST_ASSERT_NULL(plan.data(0));
+
+    plan.run(bus);
+    TEST_ASSERT_EQUAL_UINT(0, bus.uTransactions);
+}
+
+void test_add_rejects_full_compiled_and_empty()
+{
+    SensorBusPlan plan;
+
+    TEST_ASSERT_EQUAL(SensorBusPlan::kNone, plan.addRead(kCsPitot, 0));
+    for (size_t i = 0; i < SensorBusPlan::kMaxReads; i++)
+        TEST_ASSERT_NOT_EQUAL(SensorBusPlan::kNone, plan.addRead(kCsPitot, 1));
+    TEST_ASSERT_EQUAL(SensorBusPlan::kNone, plan.addRead(kCsPitot, 1));
+
+    SensorBusPlan compiled;
+    compiled.addRead(kCsPitot, 2);
+    compiled.compile();
+    TEST_ASSERT_EQUAL(SensorBusPlan::kNone, compiled.addRead(kCsAoa, 2));
+    TEST_ASSERT_NULL(compiled.data(1));
+}
+
+// ============================================================================
+// Bus cost
+// ============================================================================
+
+// What the old per-sensor calls put on the bus, for comparison: each read
+// was its own transaction, and SpiIO made one transfer() call per byte.
+void test_report_bus_cost()
+{
+    const unsigned  kOldTransactions = 5;           // pitot, AOA, static, accel, gyro
+    const unsigned  kOldBytes        = 2 + 2 + 2 + 7 + 7;
+    const unsigned  kOldCalls        = kOldBytes;
+
+    CyclePlan       cycle;
+    MockSensorBus   bus;
+    cycle.plan.compile();
+    cycle.plan.run(bus);
+
+    const unsigned  uNewBytes = unsigned(cycle.plan.totalBytes());
+    const unsigned  uNewCalls = unsigned(cycle.plan.segmentCount());
+
+    TEST_ASSERT_TRUE(bus.uTransactions < kOldTransactions);
+    TEST_ASSERT_TRUE(uNewBytes <= kOldBytes);
+
+    // Wire time at the sensor bus clock of 1 MHz is 8 us a byte
+    char szMsg[200];
+    std::snprintf(szMsg, sizeof(szMsg),
+        "Per cycle: before %u transactions, %u CS, %u driver calls, %u bytes (%u us on the wire); "
+        "after %u transaction, %u CS, %u driver calls, %u bytes (%u us on the wire)",
+        kOldTransactions, kOldTransactions, kOldCalls, kOldBytes, kOldBytes * 8,
+        bus.uTransactions, unsigned(bus.aIssued.size()), uNewCalls, uNewBytes, uNewBytes * 8);
+    TEST_MESSAGE(szMsg);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Planning
+    RUN_TEST(test_sensor_cycle_is_one_transaction);
+    RUN_TEST(test_data_points_at_each_read);
+    RUN_TEST(test_merges_when_added_in_reverse_order);
+    RUN_TEST(test_gap_or_other_chip_not_merged);
+    RUN_TEST(test_overlapping_register_reads_share_bytes);
+    RUN_TEST(test_plain_reads_never_merge);
+
+    // Limits
+    RUN_TEST(test_too_big_does_not_compile);
+    RUN_TEST(test_add_rejects_full_compiled_and_empty);
+
+    // Bus cost
+    RUN_TEST(test_report_bus_cost);
+
+    return UNITY_END();
+}
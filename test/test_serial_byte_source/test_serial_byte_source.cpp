@@ -0,0 +1,239 @@
+// test_serial_byte_source.cpp - Unit tests for event-driven serial ingestion timing
+
+#include <unity.h>
+#include <SerialByteSource.h>
+#include <SerialFramer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint32_t           kByteUs = 95;   // 115200 8E1
+static const UartRxEventConfig  kRxCfg  = { 120, 10, kByteUs };
+
+// ============================================================================
+// Simulated UART
+// ============================================================================
+// Bytes arrive on a timeline. The simulated driver raises an RX event when
+// uFifoFull bytes have collected or the line has been idle for
+// uTimeoutSymbols, and the handler runs some latency later. The byte source
+// then behaves the way the firmware's UART source does.
+
+struct TimedByte {
+    uint8_t     b;
+    uint32_t    uArrivalUs;
+};
+
+class SimUartSource : public SerialByteSource {
+public:
+    explicit SimUartSource(const UartRxEventConfig & cfg) : _cfg(cfg) {}
+
+    /// Handler woke at uHandleUs: everything that has arrived is readable.
+    void handleEvent(const std::vector<TimedByte> & line, size_t & uNext, uint32_t uHandleUs)
+    {
+        size_t uNew = 0;
+        while (uNext < line.size() && line[uNext].uArrivalUs <= uHandleUs) {
+            _rx.push_back(line[uNext++].b);
+            uNew++;
+        }
+        _uNewestUs = estimateLastByteUs(uHandleUs, uNew, _cfg);
+    }
+
+    size_t read(uint8_t * pBuf, size_t uMax) override
+    {
+        size_t n = std::min(uMax, _rx.size());
+        for (size_t i = 0; i < n; i++) {
+            pBuf[i] = _rx.front();
+            _rx.pop_front();
+        }
+        // Bytes still buffered arrived after the last one we hand out
+        _uLastUs = _uNewestUs - static_cast<uint32_t>(_rx.size()) * _cfg.uByteTimeUs;
+        return n;
+    }
+
+    uint32_t lastByteUs() const override { return _uLastUs; }
+
+private:
+    UartRxEventConfig   _cfg;
+    std::deque<uint8_t> _rx;
+    uint32_t            _uNewestUs = 0;
+    uint32_t            _uLastUs   = 0;
+};
+
+// Event times the UART would raise for this timeline
+static std::vector<uint32_t> rxEventTimes(const std::vector<TimedByte> & line, const UartRxEventConfig & cfg)
+{
+    std::vector<uint32_t> events;
+    size_t uCount = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        uCount++;
+        if (uCount >= cfg.uFifoFull) {
+            events.push_back(line[i].uArrivalUs);
+            uCount = 0;
+            continue;
+        }
+        uint32_t uIdleAt = line[i].uArrivalUs + cfg.uTimeoutSymbols * cfg.uByteTimeUs;
+        if (i + 1 == line.size() || line[i + 1].uArrivalUs > uIdleAt) {
+            events.push_back(uIdleAt);
+            uCount = 0;
+        }
+    }
+    return events;
+}
+
+// VN-300 style packets at 50 Hz, bytes back to back within a packet
+static std::vector<TimedByte> makeTimeline(int iPackets, std::vector<uint32_t> & lastByteTimes)
+{
+    std::vector<TimedByte> line;
+    for (int p = 0; p < iPackets; p++) {
+        uint32_t uStart = 1000 + p * 20000;
+        for (int i = 0; i < VN300Framer::kPacketLen; i++) {
+            uint8_t b = (i == 0) ? 0xFA : (i == 1) ? 0x19 : static_cast<uint8_t>(p + i);
+            line.push_back({ b, uStart + i * kByteUs });
+        }
+        lastByteTimes.push_back(line.back().uArrivalUs);
+    }
+    return line;
+}
+
+class TimeSink : public SerialFrameSink {
+public:
+    void onFrame(const SerialFrame & frame) override
+    {
+        starts.push_back(frame.uStartUs);
+        ends.push_back(frame.uEndUs);
+    }
+    std::vector<uint32_t> starts, ends;
+};
+
+// ============================================================================
+// pumpSerial
+// ============================================================================
+
+void test_pump_moves_everything_and_respects_cap()
+{
+    std::vector<uint32_t> truth;
+    auto line = makeTimeline(4, truth);
+
+    SimUartSource src(kRxCfg);
+    size_t uNext = 0;
+    src.handleEvent(line, uNext, line.back().uArrivalUs);
+
+    VN300Framer framer(kByteUs);
+    TimeSink    sink;
+
+    TEST_ASSERT_EQUAL(100, pumpSerial(src, framer, sink, 100));
+    TEST_ASSERT_EQUAL(0, sink.ends.size());
+    TEST_ASSERT_EQUAL(line.size() - 100, pumpSerial(src, framer, sink));
+    TEST_ASSERT_EQUAL(4, sink.ends.size());
+    TEST_ASSERT_EQUAL(0, pumpSerial(src, framer, sink));
+}
+
+void test_pump_timestamps_exact_when_read_at_arrival()
+{
+    std::vector<uint32_t> truth;
+    auto line = makeTimeline(3, truth);
+
+    // One FIFO-full event exactly on each packet's last byte, no handler latency
+    UartRxEventConfig cfg = { VN300Framer::kPacketLen, 10, kByteUs };
+    SimUartSource src(cfg);
+    VN300Framer   framer(kByteUs);
+    TimeSink      sink;
+    size_t        uNext = 0;
+    for (uint32_t uLast : truth) {
+        src.handleEvent(line, uNext, uLast);
+        pumpSerial(src, framer, sink);
+    }
+
+    TEST_ASSERT_EQUAL(3, sink.ends.size());
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(truth[i], sink.ends[i]);
+        TEST_ASSERT_EQUAL_UINT32(truth[i] - 126 * kByteUs, sink.starts[i]);
+    }
+}
+
+// ============================================================================
+// Event timing
+// ============================================================================
+
+void test_estimate_fifo_full_vs_timeout()
+{
+    TEST_ASSERT_EQUAL_UINT32(5000, estimateLastByteUs(5000, 120, kRxCfg));
+    TEST_ASSERT_EQUAL_UINT32(5000 - 10 * kByteUs, estimateLastByteUs(5000, 7, kRxCfg));
+}
+
+void test_event_driven_error_vs_10ms_polling()
+{
+    std::vector<uint32_t> truth;
+    auto line   = makeTimeline(500, truth);
+    auto events = rxEventTimes(line, kRxCfg);
+
+    // Event driven, 20-200 us handler latency
+    std::mt19937  rng(5);
+    SimUartSource src(kRxCfg);
+    VN300Framer   framer(kByteUs);
+    TimeSink      sink;
+    size_t        uNext = 0;
+    for (uint32_t uEvent : events) {
+        src.handleEvent(line, uNext, uEvent + 20 + rng() % 180);
+        pumpSerial(src, framer, sink);
+    }
+
+    // Old scheme: loop() every 10 ms, timestamp = time of the poll
+    std::vector<uint32_t> pollEnds;
+    {
+        size_t   uPos = 0;
+        for (uint32_t uPoll = 0; uPos < line.size(); uPoll += 10000 + rng() % 2000) {
+            while (uPos < line.size() && line[uPos].uArrivalUs <= uPoll) {
+                if ((uPos + 1) % VN300Framer::kPacketLen == 0)
+                    pollEnds.push_back(uPoll);
+                uPos++;
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL(truth.size(), sink.ends.size());
+    TEST_ASSERT_EQUAL(truth.size(), pollEnds.size());
+
+    double dMaxEvent = 0, dMaxPoll = 0, dSumEvent = 0, dSumPoll = 0;
+    for (size_t i = 0; i < truth.size(); i++) {
+        double dEvent = std::fabs(double(sink.ends[i]) - double(truth[i]));
+        double dPoll  = std::fabs(double(pollEnds[i])  - double(truth[i]));
+        dMaxEvent = std::max(dMaxEvent, dEvent);  dSumEvent += dEvent;
+        dMaxPoll  = std::max(dMaxPoll,  dPoll);   dSumPoll  += dPoll;
+    }
+
+    char szMsg[160];
+    snprintf(szMsg, sizeof(szMsg), "Frame time error: event driven mean %.0f us max %.0f us; 10 ms polling mean %.0f us max %.0f us",
+             dSumEvent / truth.size(), dMaxEvent, dSumPoll / truth.size(), dMaxPoll);
+    TEST_MESSAGE(szMsg);
+
+    // Bounded by handler latency plus a character time
+    TEST_ASSERT_TRUE(dMaxEvent <= 200 + kByteUs);
+    TEST_ASSERT_TRUE(dMaxEvent < dMaxPoll);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // pumpSerial
+    RUN_TEST(test_pump_moves_everything_and_respects_cap);
+    RUN_TEST(test_pump_timestamps_exact_when_read_at_arrival);
+
+    // Event timing
+    RUN_TEST(test_estimate_fifo_full_vs_timeout);
+    RUN_TEST(test_event_driven_error_vs_10ms_polling);
+
+    return UNITY_END();
+}
@@ -0,0 +1,447 @@
+// test_serial_framer.cpp - Unit tests for the incremental serial framers
+
+#include <unity.h>
+#include <SerialFramer.h>
+#include <Checksum.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Collects emitted frames
+class FrameLog : public SerialFrameSink {
+public:
+    struct Entry {
+        std::vector<uint8_t> data;
+        uint32_t             uStartUs;
+        uint32_t             uEndUs;
+    };
+
+    void onFrame(const SerialFrame & frame) override
+    {
+        frames.push_back({ std::vector<uint8_t>(frame.pData, frame.pData + frame.uLen),
+                           frame.uStartUs, frame.uEndUs });
+    }
+
+    std::string text(size_t i) const
+    {
+        return std::string(frames[i].data.begin(), frames[i].data.end());
+    }
+
+    std::vector<Entry> frames;
+};
+
+static std::vector<uint8_t> bytes(const std::string & s)
+{
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+// Push a stream in chunks of the given sizes (cycled)
+static void pushChunked(SerialFramer & framer, const std::vector<uint8_t> & stream,
+                        const std::vector<size_t> & chunks, SerialFrameSink & sink)
+{
+    size_t uPos = 0, uChunk = 0;
+    while (uPos < stream.size()) {
+        size_t n = std::min(chunks[uChunk++ % chunks.size()], stream.size() - uPos);
+        framer.push(stream.data() + uPos, n, 0, sink);
+        uPos += n;
+    }
+}
+
+static std::vector<uint8_t> makeVnPacket(uint8_t uSeed)
+{
+    std::vector<uint8_t> pkt(VN300Framer::kPacketLen);
+    pkt[0] = 0xFA;
+    pkt[1] = 0x19;
+    for (size_t i = 2; i < pkt.size(); i++)
+        pkt[i] = static_cast<uint8_t>(uSeed + i * 7);
+    return pkt;
+}
+
+static std::vector<uint8_t> makeMglMessage(uint8_t uLen, uint8_t uType)
+{
+    size_t uTotal = (uLen == 0 ? 256 : uLen) + 20;
+    std::vector<uint8_t> msg(uTotal, 0x33);
+    msg[0] = 0x05;
+    msg[1] = 0x02;
+    msg[2] = uLen;
+    msg[3] = static_cast<uint8_t>(uLen ^ 0xFF);
+    msg[4] = uType;
+
+    uint32_t uCrc = crc32(msg.data() + 4, uTotal - 8);
+    for (int i = 0; i < 4; i++)
+        msg[uTotal - 4 + i] = static_cast<uint8_t>(uCrc >> (8 * i));
+    return msg;
+}
+
+// ============================================================================
+// Line framer
+// ============================================================================
+
+void test_line_skips_partial_first_line()
+{
+    LineFramer<231> framer(95, 0, true);
+    FrameLog        log;
+
+    auto stream = bytes("tial line\r\n!1ABC\r\n!3DEF\r\n");
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(2, log.frames.size());
+    TEST_ASSERT_EQUAL_STRING("!1ABC\r\n", log.text(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("!3DEF\r\n", log.text(1).c_str());
+    TEST_ASSERT_EQUAL_UINT32(11, framer.stats().uDiscarded);
+}
+
+void test_line_start_char_excludes_terminator()
+{
+    LineFramer<127> framer(87, '$', false);
+    FrameLog        log;
+
+    auto stream = bytes("xx\n$ONSPEED,1,2*3F\r\nnoise$A\n");
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(2, log.frames.size());
+    TEST_ASSERT_EQUAL_STRING("$ONSPEED,1,2*3F\r", log.text(0).c_str());
+    TEST_ASSERT_EQUAL_STRING("$A", log.text(1).c_str());
+}
+
+void test_line_overflow_drops_line_and_recovers()
+{
+    LineFramer<16> framer(95, 0, true);
+    FrameLog       log;
+
+    std::string s = "\n" + std::string(40, 'Z') + "\nOK\n";
+    auto stream = bytes(s);
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+    TEST_ASSERT_EQUAL_STRING("OK\n", log.text(0).c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, framer.stats().uOverflows);
+}
+
+void test_line_chunking_invariant()
+{
+    std::string s = "junk\n";
+    for (int i = 0; i < 50; i++)
+        s += "=11" + std::to_string(i * 12345) + "XYZ\r\n";
+    auto stream = bytes(s);
+
+    LineFramer<231> whole(95, 0, true);
+    FrameLog        logWhole;
+    whole.push(stream.data(), stream.size(), 0, logWhole);
+
+    std::mt19937 rng(1);
+    for (int iTrial = 0; iTrial < 20; iTrial++) {
+        std::vector<size_t> chunks;
+        for (int i = 0; i < 16; i++)
+            chunks.push_back(1 + rng() % 40);
+
+        LineFramer<231> framer(95, 0, true);
+        FrameLog        log;
+        pushChunked(framer, stream, chunks, log);
+
+        TEST_ASSERT_EQUAL(logWhole.frames.size(), log.frames.size());
+        for (size_t i = 0; i < log.frames.size(); i++)
+            TEST_ASSERT_TRUE(log.frames[i].data == logWhole.frames[i].data);
+    }
+    TEST_ASSERT_EQUAL(50, logWhole.frames.size());
+}
+
+// ============================================================================
+// VN-300 framer
+// ============================================================================
+
+void test_vn_resyncs_after_garbage()
+{
+    VN300Framer framer(95);
+    FrameLog    log;
+
+    std::vector<uint8_t> stream = { 0x00, 0xFA, 0x00, 0x19, 0xFA, 0xFA };
+    auto pkt = makeVnPacket(3);
+    // Last 0xFA above is the real start: drop the one from pkt
+    stream.insert(stream.end(), pkt.begin() + 1, pkt.end());
+    auto pkt2 = makeVnPacket(9);
+    stream.insert(stream.end(), pkt2.begin(), pkt2.end());
+
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(2, log.frames.size());
+    TEST_ASSERT_TRUE(log.frames[0].data == pkt);
+    TEST_ASSERT_TRUE(log.frames[1].data == pkt2);
+    TEST_ASSERT_EQUAL_UINT32(5, framer.stats().uDiscarded);
+}
+
+void test_vn_byte_at_a_time_matches_whole()
+{
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 10; i++) {
+        auto pkt = makeVnPacket(static_cast<uint8_t>(i));
+        stream.insert(stream.end(), pkt.begin(), pkt.end());
+    }
+
+    VN300Framer framer(95);
+    FrameLog    log;
+    pushChunked(framer, stream, { 1 }, log);
+
+    TEST_ASSERT_EQUAL(10, log.frames.size());
+    for (int i = 0; i < 10; i++)
+        TEST_ASSERT_TRUE(log.frames[i].data == makeVnPacket(static_cast<uint8_t>(i)));
+    TEST_ASSERT_EQUAL_UINT32(0, framer.stats().uDiscarded);
+}
+
+// ============================================================================
+// MGL framer
+// ============================================================================
+
+void test_mgl_frames_by_length()
+{
+    MglFramer framer(95);
+    FrameLog  log;
+
+    auto m1 = makeMglMessage(24, 1);    // 44 bytes, primary flight
+    auto m3 = makeMglMessage(20, 3);    // 40 bytes, attitude
+    auto m0 = makeMglMessage(0, 9);     // 276 bytes, length 0 means 256
+
+    std::vector<uint8_t> stream = { 0x11, 0x05, 0x05 };
+    stream.insert(stream.end(), m1.begin() + 1, m1.end());
+    stream.insert(stream.end(), m3.begin(), m3.end());
+    stream.insert(stream.end(), m0.begin(), m0.end());
+
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(3, log.frames.size());
+    TEST_ASSERT_EQUAL(44,  log.frames[0].data.size());
+    TEST_ASSERT_EQUAL(40,  log.frames[1].data.size());
+    TEST_ASSERT_EQUAL(276, log.frames[2].data.size());
+    TEST_ASSERT_EQUAL_UINT8(3, log.frames[1].data[4]);
+}
+
+void test_mgl_bad_length_check_rejected()
+{
+    MglFramer framer(95);
+    FrameLog  log;
+
+    auto bad = makeMglMessage(24, 1);
+    bad[3] = 0x00;
+    auto good = makeMglMessage(20, 3);
+
+    std::vector<uint8_t> stream = bad;
+    stream.insert(stream.end(), good.begin(), good.end());
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+    TEST_ASSERT_TRUE(log.frames[0].data == good);
+}
+
+void test_mgl_bad_crc_rejected()
+{
+    MglFramer framer(95, true);
+    FrameLog  log;
+
+    auto bad = makeMglMessage(20, 3);
+    bad[12] ^= 0x01;                    // pitch LSB
+    auto good = makeMglMessage(24, 1);
+
+    std::vector<uint8_t> stream = bad;
+    stream.insert(stream.end(), good.begin(), good.end());
+    framer.push(stream.data(), stream.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+    TEST_ASSERT_TRUE(log.frames[0].data == good);
+    TEST_ASSERT_EQUAL_UINT32(1, framer.stats().uRejected);
+    TEST_ASSERT_TRUE(MglFramer::crcOk(good.data(), good.size()));
+    TEST_ASSERT_FALSE(MglFramer::crcOk(bad.data(), bad.size()));
+}
+
+void test_mgl_crc_check_off_by_default()
+{
+    MglFramer framer(95);
+    FrameLog  log;
+
+    auto msg = makeMglMessage(20, 3);
+    msg[12] ^= 0x01;
+    framer.push(msg.data(), msg.size(), 0, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+}
+
+// ============================================================================
+// Timestamps
+// ============================================================================
+
+void test_timestamps_back_dated_within_chunk()
+{
+    LineFramer<64> framer(100, '$', false);
+    FrameLog       log;
+
+    // "$AB\n" arrives in one chunk whose last byte is at t=10000
+    auto stream = bytes("$AB\n");
+    framer.push(stream.data(), stream.size(), 10000, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+    TEST_ASSERT_EQUAL_UINT32(9700,  log.frames[0].uStartUs);
+    TEST_ASSERT_EQUAL_UINT32(10000, log.frames[0].uEndUs);
+}
+
+void test_timestamps_span_chunks()
+{
+    VN300Framer framer(95);
+    FrameLog    log;
+    auto        pkt = makeVnPacket(1);
+
+    framer.push(pkt.data(), 10, 5000, log);
+    framer.push(pkt.data() + 10, pkt.size() - 10, 20000, log);
+
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+    TEST_ASSERT_EQUAL_UINT32(5000 - 9 * 95, log.frames[0].uStartUs);
+    TEST_ASSERT_EQUAL_UINT32(20000, log.frames[0].uEndUs);
+}
+
+void test_uart_byte_time()
+{
+    TEST_ASSERT_EQUAL_UINT32(87, uartByteTimeUs(115200, 10));
+    TEST_ASSERT_EQUAL_UINT32(95, uartByteTimeUs(115200, 11));
+    TEST_ASSERT_EQUAL_UINT32(1042, uartByteTimeUs(9600, 10));
+}
+
+// ============================================================================
+// Robustness
+// ============================================================================
+
+void test_random_noise_never_overruns()
+{
+    std::mt19937 rng(42);
+    std::vector<uint8_t> noise(200000);
+    for (auto & b : noise) {
+        // Bias toward sync bytes so the state machines get exercised
+        uint32_t r = rng();
+        b = (r & 7) == 0 ? 0xFA : (r & 7) == 1 ? 0x05 : (r & 7) == 2 ? '\n' : static_cast<uint8_t>(r >> 8);
+    }
+
+    VN300Framer     vn(95);
+    MglFramer       mgl(95);
+    LineFramer<231> line(95, 0, true);
+    FrameLog        log;
+
+    pushChunked(vn,   noise, { 1, 7, 64, 300 }, log);
+    pushChunked(mgl,  noise, { 3, 128 }, log);
+    pushChunked(line, noise, { 5, 17, 1 }, log);
+
+    for (auto & f : log.frames)
+        TEST_ASSERT_TRUE(f.data.size() <= MglFramer::kMaxMsgLen);
+    TEST_ASSERT_EQUAL_UINT32(noise.size(), vn.stats().uBytes);
+    TEST_ASSERT_TRUE(vn.bufferedLength()   <= VN300Framer::kPacketLen);
+    TEST_ASSERT_TRUE(mgl.bufferedLength()  <= MglFramer::kMaxMsgLen);
+    TEST_ASSERT_TRUE(line.bufferedLength() <= 231);
+}
+
+void test_reset_drops_partial_frame()
+{
+    VN300Framer framer(95);
+    FrameLog    log;
+    auto        pkt = makeVnPacket(5);
+
+    framer.push(pkt.data(), 60, 0, log);
+    TEST_ASSERT_EQUAL_UINT16(60, framer.bufferedLength());
+    framer.reset();
+    TEST_ASSERT_EQUAL_UINT16(0, framer.bufferedLength());
+
+    framer.push(pkt.data(), pkt.size(), 0, log);
+    TEST_ASSERT_EQUAL(1, log.frames.size());
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+class CountSink : public SerialFrameSink {
+public:
+    void onFrame(const SerialFrame & frame) override { uBytes += frame.uLen; }
+    size_t uBytes = 0;
+};
+
+void test_benchmark_throughput()
+{
+    std::vector<uint8_t> vnStream, textStream;
+    for (int i = 0; i < 2000; i++) {
+        auto pkt = makeVnPacket(static_cast<uint8_t>(i));
+        vnStream.insert(vnStream.end(), pkt.begin(), pkt.end());
+    }
+    std::string line = "!1121144703-014+00003310811+01736+003-03+1013-033+110013XXXXX0Y9A20059B\r\n";
+    while (textStream.size() < vnStream.size())
+        textStream.insert(textStream.end(), line.begin(), line.end());
+
+    CountSink sink;
+    const int kReps = 50;
+
+    VN300Framer vn(95);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kReps; r++)
+        pushChunked(vn, vnStream, { 64 }, sink);
+    auto t1 = std::chrono::steady_clock::now();
+
+    LineFramer<231> text(95, 0, true);
+    for (int r = 0; r < kReps; r++)
+        pushChunked(text, textStream, { 64 }, sink);
+    auto t2 = std::chrono::steady_clock::now();
+
+    double dVnMBs   = vnStream.size()   * kReps / std::chrono::duration<double>(t1 - t0).count() / 1e6;
+    double dTextMBs = textStream.size() * kReps / std::chrono::duration<double>(t2 - t1).count() / 1e6;
+
+    char szMsg[128];
+    snprintf(szMsg, sizeof(szMsg), "VN-300 framer %.1f MB/s, text line framer %.1f MB/s (UART is 0.0115 MB/s)",
+             dVnMBs, dTextMBs);
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(sink.uBytes > 0);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // Line framer
+    RUN_TEST(test_line_skips_partial_first_line);
+    RUN_TEST(test_line_start_char_excludes_terminator);
+    RUN_TEST(test_line_overflow_drops_line_and_recovers);
+    RUN_TEST(test_line_chunking_invariant);
+
+    // VN-300 framer
+    RUN_TEST(test_vn_resyncs_after_garbage);
+    RUN_TEST(test_vn_byte_at_a_time_matches_whole);
+
+    // MGL framer
+    RUN_TEST(test_mgl_frames_by_length);
+    RUN_TEST(test_mgl_bad_length_check_rejected);
+    RUN_TEST(test_mgl_bad_crc_rejected);
+    RUN_TEST(test_mgl_crc_check_off_by_default);
+
+    // Timestamps
+    RUN_TEST(test_timestamps_back_dated_within_chunk);
+    RUN_TEST(test_timestamps_span_chunks);
+    RUN_TEST(test_uart_byte_time);
+
+    // Robustness
+    RUN_TEST(test_random_noise_never_overruns);
+    RUN_TEST(test_reset_drops_partial_frame);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_throughput);
+#endif
+
+    return UNITY_END();
+}
@@ -0,0 +1,260 @@
+// test_vn300_packet.cpp - Unit tests for the VN-300 packet decoder and CRC-16-CCITT
+
+#include <unity.h>
+#include <Vn300Packet.h>
+#include <Checksum.h>
+#include <SerialFramer.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Reference packet in the configured output layout (taxiing, 3D fix)
+static const uint8_t kRecordedPacket[127] = {
+    0xFA, 0x19, 0xE0, 0x01, 0x91, 0x00, 0x42, 0x01, 0xCD, 0xCC, 0x4C, 0x3C, 0xB6, 0xF3, 0xFD, 0xBC,
+    0x27, 0xA0, 0x89, 0x3B, 0x17, 0x7C, 0xBB, 0xA1, 0x00, 0xC3, 0x46, 0x40, 0xA7, 0x49, 0xBE, 0x4C,
+    0x73, 0xAB, 0x5E, 0xC0, 0xCD, 0xCC, 0xCC, 0xCC, 0xCC, 0x0C, 0x63, 0x40, 0xCD, 0xCC, 0x24, 0x42,
+    0x00, 0x00, 0x60, 0xC0, 0xCD, 0xCC, 0x4C, 0x3F, 0x66, 0x66, 0xE6, 0xBE, 0x8F, 0xC2, 0xF5, 0x3D,
+    0x52, 0xB8, 0x1E, 0xC1, 0x19, 0x0A, 0x13, 0x0E, 0x25, 0x34, 0x90, 0x01, 0x03, 0x00, 0x00, 0x24,
+    0x42, 0x9A, 0x99, 0x59, 0xC0, 0x00, 0x00, 0x40, 0x3F, 0x00, 0xC0, 0x87, 0x43, 0x00, 0x00, 0x88,
+    0x40, 0x00, 0x00, 0x48, 0xC1, 0x52, 0xB8, 0x9E, 0xBE, 0x0A, 0xD7, 0xA3, 0x3D, 0x29, 0x5C, 0x0F,
+    0x3E, 0xB8, 0x1E, 0x05, 0x3F, 0xAE, 0x47, 0xE1, 0x3D, 0xEC, 0x51, 0xB8, 0x3D, 0xDB, 0x32,
+};
+
+// The bit-twiddling CRC from the VectorNav manual that EfisSerial used before
+static uint16_t legacyVnCrc(const uint8_t * p, size_t uLen)
+{
+    uint16_t vnCrc = 0;
+    for (size_t i = 0; i < uLen; i++) {
+        vnCrc = (uint16_t) (vnCrc >> 8) | (vnCrc << 8);
+        vnCrc ^= (uint8_t) p[i];
+        vnCrc ^= (uint16_t) (((uint8_t) (vnCrc & 0xFF)) >> 4);
+        vnCrc ^= (uint16_t) ((vnCrc << 8) << 4);
+        vnCrc ^= (uint16_t) (((vnCrc & 0xFF) << 4) << 1);
+    }
+    return vnCrc;
+}
+
+static std::vector<uint8_t> recorded()
+{
+    return std::vector<uint8_t>(kRecordedPacket, kRecordedPacket + sizeof(kRecordedPacket));
+}
+
+class DecodeSink : public SerialFrameSink {
+public:
+    void onFrame(const SerialFrame & frame) override
+    {
+        if (decodeVn300Packet(frame.pData, frame.uLen, data) == Vn300Result::Ok)
+            uGood++;
+        else
+            uBad++;
+    }
+
+    Vn300Data   data = {};
+    uint32_t    uGood = 0;
+    uint32_t    uBad = 0;
+};
+
+// ============================================================================
+// CRC-16-CCITT
+// ============================================================================
+
+void test_crc16_known_vector()
+{
+    // CRC-16/XMODEM check value
+    const char * sz = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x31C3, crc16Ccitt(reinterpret_cast<const uint8_t *>(sz), 9));
+}
+
+void test_crc16_matches_legacy_bitwise()
+{
+    std::mt19937 rng(7);
+    std::vector<uint8_t> buf(300);
+    for (int iTrial = 0; iTrial < 200; iTrial++) {
+        size_t uLen = rng() % buf.size();
+        for (auto & b : buf) b = static_cast<uint8_t>(rng());
+        TEST_ASSERT_EQUAL_HEX16(legacyVnCrc(buf.data(), uLen), crc16Ccitt(buf.data(), uLen));
+    }
+}
+
+void test_crc16_continues_across_calls()
+{
+    const uint8_t * p = kRecordedPacket + 1;
+    uint16_t uWhole = crc16Ccitt(p, 100);
+    uint16_t uSplit = crc16Ccitt(p + 40, 60, crc16Ccitt(p, 40));
+    TEST_ASSERT_EQUAL_HEX16(uWhole, uSplit);
+}
+
+// ============================================================================
+// Decoder
+// ============================================================================
+
+void test_recorded_packet_decodes()
+{
+    Vn300Data d = {};
+    TEST_ASSERT_EQUAL(Vn300Result::Ok, decodeVn300Packet(kRecordedPacket, 127, d));
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0125f,  d.AngularRateRoll);
+    TEST_ASSERT_EQUAL_FLOAT(-0.031f,  d.AngularRatePitch);
+    TEST_ASSERT_EQUAL_FLOAT(0.0042f,  d.AngularRateYaw);
+    TEST_ASSERT_TRUE(d.GnssLat == 45.52345678);         // full double precision
+    TEST_ASSERT_TRUE(d.GnssLon == -122.67891234);
+    TEST_ASSERT_EQUAL_FLOAT(41.2f,    d.VelNedNorth);
+    TEST_ASSERT_EQUAL_FLOAT(0.8f,     d.VelNedDown);
+    TEST_ASSERT_EQUAL_FLOAT(-9.92f,   d.AccelVert);
+    TEST_ASSERT_EQUAL_UINT8(14, d.UtcHour);
+    TEST_ASSERT_EQUAL_UINT8(37, d.UtcMinute);
+    TEST_ASSERT_EQUAL_UINT8(52, d.UtcSecond);
+    TEST_ASSERT_EQUAL_UINT8(3,  d.GPSFix);
+    TEST_ASSERT_EQUAL_FLOAT(0.75f,    d.GnssVelNedDown);
+    TEST_ASSERT_EQUAL_FLOAT(271.5f,   d.Yaw);
+    TEST_ASSERT_EQUAL_FLOAT(4.25f,    d.Pitch);
+    TEST_ASSERT_EQUAL_FLOAT(-12.5f,   d.Roll);
+    TEST_ASSERT_EQUAL_FLOAT(-0.31f,   d.LinAccFwd);
+    TEST_ASSERT_EQUAL_FLOAT(0.14f,    d.LinAccVert);
+    TEST_ASSERT_EQUAL_FLOAT(0.52f,    d.YawSigma);
+    TEST_ASSERT_EQUAL_FLOAT(0.09f,    d.PitchSigma);
+}
+
+void test_decode_matches_legacy_offsets()
+{
+    // The old code read fields at fixed offsets with memcpy
+    Vn300Data d = {};
+    decodeVn300Packet(kRecordedPacket, 127, d);
+
+    float f;
+    memcpy(&f, kRecordedPacket + 93, 4);    TEST_ASSERT_EQUAL_FLOAT(f, d.Pitch);
+    memcpy(&f, kRecordedPacket + 97, 4);    TEST_ASSERT_EQUAL_FLOAT(f, d.Roll);
+    memcpy(&f, kRecordedPacket + 52, 4);    TEST_ASSERT_EQUAL_FLOAT(f, d.VelNedDown);
+    memcpy(&f, kRecordedPacket + 121, 4);   TEST_ASSERT_EQUAL_FLOAT(f, d.PitchSigma);
+    TEST_ASSERT_EQUAL_UINT8(kRecordedPacket[76], d.GPSFix);
+}
+
+void test_every_single_bit_flip_rejected()
+{
+    for (size_t uByte = 0; uByte < 127; uByte++) {
+        for (int iBit = 0; iBit < 8; iBit++) {
+            auto pkt = recorded();
+            pkt[uByte] ^= static_cast<uint8_t>(1 << iBit);
+
+            Vn300Data d = {};
+            d.Pitch = 123.0f;
+            Vn300Result r = decodeVn300Packet(pkt.data(), pkt.size(), d);
+
+            TEST_ASSERT_TRUE(r == Vn300Result::BadHeader || r == Vn300Result::BadCrc);
+            TEST_ASSERT_EQUAL_FLOAT(123.0f, d.Pitch);   // untouched
+        }
+    }
+}
+
+void test_wrong_length_rejected()
+{
+    Vn300Data d = {};
+    TEST_ASSERT_EQUAL(Vn300Result::BadLength, decodeVn300Packet(kRecordedPacket, 126, d));
+}
+
+void test_other_output_config_rejected()
+{
+    // Same groups without lat/lon (103 byte packet) - header differs
+    auto pkt = recorded();
+    pkt[2] = 0xA0;
+    Vn300Data d = {};
+    TEST_ASSERT_EQUAL(Vn300Result::BadHeader, decodeVn300Packet(pkt.data(), pkt.size(), d));
+}
+
+// ============================================================================
+// Stream
+// ============================================================================
+
+void test_stream_with_corrupted_frames()
+{
+    std::vector<uint8_t> stream = { 0x00, 0x13, 0xFA };     // join mid-packet
+    auto good = recorded();
+    auto bad  = recorded();
+    bad[60] ^= 0x40;                                        // line noise in the payload
+
+    for (int i = 0; i < 5; i++) stream.insert(stream.end(), good.begin(), good.end());
+    stream.insert(stream.end(), bad.begin(), bad.end());
+    for (int i = 0; i < 5; i++) stream.insert(stream.end(), good.begin(), good.end());
+
+    VN300Framer framer(95);
+    DecodeSink  sink;
+    for (size_t i = 0; i < stream.size(); i += 37)
+        framer.push(stream.data() + i, std::min<size_t>(37, stream.size() - i), 0, sink);
+
+    TEST_ASSERT_EQUAL_UINT32(10, sink.uGood);
+    TEST_ASSERT_EQUAL_UINT32(1,  sink.uBad);
+    TEST_ASSERT_EQUAL_FLOAT(4.25f, sink.data.Pitch);
+}
+
+#ifdef ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+void test_benchmark_crc_and_decode()
+{
+    const int kIter = 200000;
+    volatile uint32_t uSink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIter; i++)
+        uSink = uSink + legacyVnCrc(kRecordedPacket + 1, 126);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIter; i++)
+        uSink = uSink + crc16Ccitt(kRecordedPacket + 1, 126);
+    auto t2 = std::chrono::steady_clock::now();
+
+    Vn300Data d = {};
+    for (int i = 0; i < kIter; i++) {
+        decodeVn300Packet(kRecordedPacket, 127, d);
+        uSink = uSink + d.GPSFix;
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    auto ns = [&](auto a, auto b) { return std::chrono::duration<double, std::nano>(b - a).count() / kIter; };
+    char szMsg[160];
+    snprintf(szMsg, sizeof(szMsg), "Per packet: bitwise CRC %.0f ns, table CRC %.0f ns, full validate+decode %.0f ns",
+             ns(t0, t1), ns(t1, t2), ns(t2, t3));
+    TEST_MESSAGE(szMsg);
+    TEST_ASSERT_TRUE(uSink != 0);
+}
+
+#endif // ONSPEED_BENCHMARKS
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+
+    // CRC-16-CCITT
+    RUN_TEST(test_crc16_known_vector);
+    RUN_TEST(test_crc16_matches_legacy_bitwise);
+    RUN_TEST(test_crc16_continues_across_calls);
+
+    // Decoder
+    RUN_TEST(test_recorded_packet_decodes);
+    RUN_TEST(test_decode_matches_legacy_offsets);
+    RUN_TEST(test_every_single_bit_flip_rejected);
+    RUN_TEST(test_wrong_length_rejected);
+    RUN_TEST(test_other_output_config_rejected);
+
+    // Stream
+    RUN_TEST(test_stream_with_corrupted_frames);
+
+#ifdef ONSPEED_BENCHMARKS
+    // Benchmark
+    RUN_TEST(test_benchmark_crc_and_decode);
+#endif
+
+    return UNITY_END();
+}